@@ -40,6 +40,8 @@
 #include <OpenMS/CONCEPT/Exception.h>
 #include <OpenMS/CONCEPT/Macros.h>
 
+#include <vector>
+
 #ifdef NDEBUG
 #define DEBUG_ONLY if (false)
 #else
@@ -1068,5 +1070,69 @@ namespace OpenMS
     ::seqan::PatternAuxData<PeptideDB> dh_;   ///< auxiliary data to hold a state after searching
   }; // class FuzzyAC
 
+  /**
+    @brief k-mer prefilter for AhoCorasickAmbiguous, which skips protein regions that cannot contain a hit.
+
+    Proteins with many ambiguous amino acids (in particular 'X') make the automaton spawn many
+    branches, most of which die without reporting a hit. This filter records all k-mers of the peptides
+    in a bitset (k = 5, or the length of the shortest peptide if smaller). Since every k-mer of a hit
+    (without mismatches) must match a peptide k-mer, a protein window can only be part of a hit if it
+    contains at most 'aaa_max' ambiguous amino acids and one of its expansions (e.g. B = D or N) is a
+    peptide k-mer. getCandidateRegions() returns the maximal runs of such windows; searching only these
+    regions finds exactly the same hits (at the same positions, after adding the region offset).
+
+    The filter is inactive (i.e. returns the whole protein) if mismatches are allowed, if peptides are
+    shorter than 3 amino acids, or if the peptides cover too many of all possible k-mers to be selective.
+  */
+  class OPENMS_DLLAPI AhoCorasickPrefilter
+  {
+  public:
+    /// Maximum k-mer length (bitset of 2^(5 * MAX_K) bits)
+    static const Size MAX_K = 5;
+
+    /// Default constructor (inactive filter)
+    AhoCorasickPrefilter();
+
+    /**
+      @brief Records the k-mers of @p pep_db
+
+      @param pep_db Set of peptides (without ambiguous amino acids)
+      @param aaa_max Maximum allowed ambiguous characters in the matching protein sequence (see AhoCorasickAmbiguous::initPattern())
+      @param mm_max Maximum allowed mismatches (the filter is inactive if larger than 0)
+    */
+    void init(const AhoCorasickAmbiguous::PeptideDB& pep_db, const int aaa_max, const int mm_max);
+
+    /// Is the filter used (otherwise getCandidateRegions() returns the whole protein)?
+    bool isActive() const;
+
+    /// Length of the k-mers
+    Size getK() const;
+
+    /// Fraction of all unambiguous k-mers which occur in the peptides
+    double getFillRatio() const;
+
+    /**
+      @brief Computes the regions [begin, end) of @p protein which can contain a hit
+
+      Regions are sorted and do not overlap. Can be called from multiple threads.
+    */
+    void getCandidateRegions(const String& protein, std::vector<std::pair<Size, Size> >& regions) const;
+
+  protected:
+    /// Does the (possibly ambiguous) k-mer starting at @p codes match a peptide k-mer?
+    bool matchesAmbiguous_(const std::vector<UInt>& codes, Size pos) const;
+
+    bool testBit_(UInt64 key) const
+    {
+      return (bits_[key >> 6] >> (key & 63)) & 1;
+    }
+
+    Size k_;
+    int aaa_max_;
+    bool active_;
+    double fill_ratio_;
+    std::vector<UInt64> bits_; ///< one bit per k-mer (5 bits per amino acid)
+  };
+
 } // namespace OpenMS
 
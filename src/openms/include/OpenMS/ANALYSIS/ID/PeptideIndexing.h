@@ -56,6 +56,11 @@
 #include <atomic>
 #include <algorithm>
 #include <fstream>
+#include <unordered_map>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
 
 
 namespace OpenMS
@@ -119,6 +124,12 @@ namespace OpenMS
   Threading:
   This tool support multiple threads (@p threads option) to speed up computation, at the cost of little extra memory.
 
+  Memory:
+  The FASTA database is read chunk-wise (the next chunk is loaded while the current one is searched), so its size hardly matters.
+  The search index (trie) of all distinct peptide sequences, however, needs to be kept in memory. For very large sets of peptides,
+  the parameter @p memory_budget limits the size of the trie: peptides are then split into shards, which are searched one after
+  another, each with a separate pass over the database.
+
 */
 
  class OPENMS_DLLAPI PeptideIndexing :
@@ -266,38 +277,44 @@ public:
       FoundProteinFunctor func(enzyme, xtandem_fix_parameters); // store the matches
       Map<String, Size> acc_to_prot; // map: accessions --> FASTA protein index
       std::vector<bool> protein_is_decoy; // protein index -> is decoy?
-      std::vector<std::string> protein_accessions; // protein index -> accession
+      Map<Size, String> protein_accessions; // protein index -> accession (only for proteins with peptide hits)
+      std::vector<Size> hit_to_peptide; // peptide hit (in order of pep_ids) -> index of its sequence in the peptide DB
 
       bool invalid_protein_sequence = false; // check for proteins with modifications, i.e. '[' or '(', and throw an exception
 
       { // new scope - forget data after search
       
         /*
-        BUILD Peptide DB
+        BUILD Peptide DB (each distinct sequence only once, since many PSMs share the same sequence)
         */
         bool has_illegal_AAs(false);
-        AhoCorasickAmbiguous::PeptideDB pep_DB;
-        for (std::vector<PeptideIdentification>::const_iterator it1 = pep_ids.begin(); it1 != pep_ids.end(); ++it1)
+        std::vector<String> peptides; // distinct sequences, in order of first occurrence
         {
-          //String run_id = it1->getIdentifier();
-          const std::vector<PeptideHit>& hits = it1->getHits();
-          for (std::vector<PeptideHit>::const_iterator it2 = hits.begin(); it2 != hits.end(); ++it2)
+          std::unordered_map<String, Size> peptide_to_index;
+          for (std::vector<PeptideIdentification>::const_iterator it1 = pep_ids.begin(); it1 != pep_ids.end(); ++it1)
           {
-            //
-            // Warning:
-            // do not skip over peptides here, since the results are iterated in the same way
-            //
-            String seq = it2->getSequence().toUnmodifiedString().remove('*'); // make a copy, i.e. do NOT change the peptide sequence!
-            if (seqan::isAmbiguous(seqan::AAString(seq.c_str())))
-            { // do not quit here, to show the user all sequences .. only quit after loop
-              OPENMS_LOG_ERROR << "Peptide sequence '" << it2->getSequence() << "' contains one or more ambiguous amino acids (B|J|Z|X).\n";
-              has_illegal_AAs = true;
-            }
-            if (IL_equivalent_) // convert L to I;
+            //String run_id = it1->getIdentifier();
+            const std::vector<PeptideHit>& hits = it1->getHits();
+            for (std::vector<PeptideHit>::const_iterator it2 = hits.begin(); it2 != hits.end(); ++it2)
             {
-              seq.substitute('L', 'I');
+              //
+              // Warning:
+              // do not skip over peptides here, since the results are iterated in the same way
+              //
+              String seq = it2->getSequence().toUnmodifiedString().remove('*'); // make a copy, i.e. do NOT change the peptide sequence!
+              if (seqan::isAmbiguous(seqan::AAString(seq.c_str())))
+              { // do not quit here, to show the user all sequences .. only quit after loop
+                OPENMS_LOG_ERROR << "Peptide sequence '" << it2->getSequence() << "' contains one or more ambiguous amino acids (B|J|Z|X).\n";
+                has_illegal_AAs = true;
+              }
+              if (IL_equivalent_) // convert L to I;
+              {
+                seq.substitute('L', 'I');
+              }
+              auto ins = peptide_to_index.emplace(seq, peptides.size());
+              if (ins.second) peptides.push_back(seq);
+              hit_to_peptide.push_back(ins.first->second);
             }
-            appendValue(pep_DB, seq.c_str());
           }
         }
         if (has_illegal_AAs)
@@ -306,163 +323,218 @@ public:
                     << "\nPlease either remove the peptide or replace it with one of the unambiguous ones (while allowing for ambiguous AA's to match the protein)." << std::endl;;
         }
 
-        OPENMS_LOG_INFO << "Mapping " << length(pep_DB) << " peptides to " << (proteins.size() == PROTEIN_CACHE_SIZE ? "? (unknown number of)" : String(proteins.size()))  << " proteins." << std::endl;
+        // split the peptides into shards whose trie fits into the memory budget (only one shard without budget)
+        std::vector<Size> shard_begin(1, 0); // index of the first peptide of each shard (plus past-the-end entry)
+        if (memory_budget_ > 0)
+        {
+          const double max_residues = memory_budget_ * 1024 * 1024 / TRIE_BYTES_PER_RESIDUE;
+          Size residues(0);
+          for (Size i = 0; i < peptides.size(); ++i)
+          {
+            if (residues > 0 && residues + peptides[i].size() > max_residues)
+            {
+              shard_begin.push_back(i);
+              residues = 0;
+            }
+            residues += peptides[i].size();
+          }
+        }
+        shard_begin.push_back(peptides.size());
+        const Size n_shards = shard_begin.size() - 1;
 
-        if (length(pep_DB) == 0)
+        OPENMS_LOG_INFO << "Mapping " << hit_to_peptide.size() << " peptides (" << peptides.size() << " distinct sequences) to " << (proteins.size() == PROTEIN_CACHE_SIZE ? "? (unknown number of)" : String(proteins.size()))  << " proteins." << std::endl;
+
+        if (peptides.empty())
         { // Aho-Corasick will crash if given empty needles as input
           OPENMS_LOG_WARN << "Warning: Peptide identifications have no hits inside! Output will be empty as well." << std::endl;
           return PEPTIDE_IDS_EMPTY;
         }
+        if (n_shards > 1)
+        {
+          OPENMS_LOG_INFO << "Splitting peptides into " << n_shards << " shards to stay within the memory budget of " << memory_budget_ << " MB. The database will be read once per shard." << std::endl;
+        }
 
         /*
            Aho Corasick (fast)
         */
         OPENMS_LOG_INFO << "Searching with up to " << aaa_max_ << " ambiguous amino acid(s) and " << mm_max_ << " mismatch(es)!" << std::endl;
         SysInfo::MemUsage mu;
-        OPENMS_LOG_INFO << "Building trie ...";
         StopWatch s;
-        s.start();
-        AhoCorasickAmbiguous::FuzzyACPattern pattern;
-        AhoCorasickAmbiguous::initPattern(pep_DB, aaa_max_, mm_max_, pattern);
-        s.stop();
-        OPENMS_LOG_INFO << " done (" << int(s.getClockTime()) << "s)" << std::endl;
-        s.reset();
+        StopWatch s_merge;
 
         uint16_t count_j_proteins(0);
-        bool has_active_data = true; // becomes false if end of FASTA file is reached
         const std::string jumpX(aaa_max_ + mm_max_ + 1, 'X'); // jump over stretches of 'X' which cost a lot of time; +1 because  AXXA is a valid hit for aaa_max == 2 (cannot split it)
-        // use very large target value for progress if DB size is unknown (did not fit into first chunk)
-        this->startProgress(0, proteins.size() == PROTEIN_CACHE_SIZE ? std::numeric_limits<SignedSize>::max() : proteins.size(), "Aho-Corasick");
-        std::atomic<int> progress_prots(0);
+        Size n_proteins = (proteins.size() == PROTEIN_CACHE_SIZE ? 0 : proteins.size()); // 0 if unknown (did not fit into first chunk)
+
+        // results of each thread; joined after each shard (i.e. without locking)
+        int n_threads(1);
 #ifdef _OPENMP
-#pragma omp parallel
+        n_threads = omp_get_max_threads();
 #endif
+        std::vector<FoundProteinFunctor> func_threads(n_threads, func);
+        std::vector<std::vector<std::pair<Size, String> > > accessions_threads(n_threads); // proteins with hits (index, accession)
+
+        for (Size shard = 0; shard < n_shards; ++shard)
         {
-          FoundProteinFunctor func_threads(enzyme, xtandem_fix_parameters);
-          Map<String, Size> acc_to_prot_thread; // map: accessions --> FASTA protein index
-          AhoCorasickAmbiguous fuzzyAC;
-          String prot;
+          AhoCorasickAmbiguous::PeptideDB pep_DB;
+          for (Size i = shard_begin[shard]; i < shard_begin[shard + 1]; ++i)
+          {
+            appendValue(pep_DB, peptides[i].c_str());
+          }
+          const Size pep_offset = shard_begin[shard];
+
+          if (shard > 0)
+          { // start another pass over the database
+            proteins.reset();
+            proteins.cacheChunk(PROTEIN_CACHE_SIZE);
+          }
 
-          while (true) 
+          OPENMS_LOG_INFO << "Building trie" << (n_shards > 1 ? " for shard " + String(shard + 1) + "/" + String(n_shards) : String()) << " ...";
+          s.start();
+          AhoCorasickAmbiguous::FuzzyACPattern pattern;
+          AhoCorasickAmbiguous::initPattern(pep_DB, aaa_max_, mm_max_, pattern);
+          AhoCorasickPrefilter prefilter;
+          prefilter.init(pep_DB, aaa_max_, mm_max_);
+          s.stop();
+          OPENMS_LOG_INFO << " done (" << int(s.getClockTime()) << "s)" << std::endl;
+          s.reset();
+          if (prefilter.isActive())
           {
-            #pragma omp barrier // all threads need to be here, since we are about to swap protein data
-            #pragma omp single
-            {
-              DEBUG_ONLY std::cerr << " activating cache ...\n";
-              has_active_data = proteins.activateCache(); // swap in last cache
-              protein_accessions.resize(proteins.getChunkOffset() + proteins.chunkSize());
-            } // implicit barrier here
-            
-            if (!has_active_data) break; // leave while-loop
-            SignedSize prot_count = (SignedSize)proteins.chunkSize();
-
-            #pragma omp master
-            {
-              DEBUG_ONLY std::cerr << "Filling Protein Cache ...";
-              proteins.cacheChunk(PROTEIN_CACHE_SIZE);
-              protein_is_decoy.resize(proteins.getChunkOffset() + prot_count);
-              for (SignedSize i = 0; i < prot_count; ++i)
-              { // do this in master only, to avoid false sharing
-                const String& seq = proteins.chunkAt(i).identifier;
-                protein_is_decoy[i + proteins.getChunkOffset()] = (prefix_ ? seq.hasPrefix(decoy_string_) : seq.hasSuffix(decoy_string_));
-              }
-              DEBUG_ONLY std::cerr << " done" << std::endl;
-            }
-            DEBUG_ONLY std::cerr << " starting for loop \n";
-            // search all peptides in each protein
-            #pragma omp for schedule(dynamic, 100) nowait
-            for (SignedSize i = 0; i < prot_count; ++i)
-            {
-              ++progress_prots; // atomic
-              if (omp_get_thread_num() == 0)
-              {
-                this->setProgress(progress_prots);
-              }
+            OPENMS_LOG_INFO << "Using " << prefilter.getK() << "-mer prefilter (" << int(prefilter.getFillRatio() * 100) << "% of all " << prefilter.getK() << "-mers occur in peptides)." << std::endl;
+          }
 
-              prot = proteins.chunkAt(i).sequence;
-              prot.remove('*');
+          bool has_active_data = true; // becomes false if end of FASTA file is reached
+          // use very large target value for progress if DB size is unknown (did not fit into first chunk)
+          this->startProgress(0, n_proteins == 0 ? std::numeric_limits<SignedSize>::max() : n_proteins, "Aho-Corasick");
+          std::atomic<int> progress_prots(0);
+#ifdef _OPENMP
+#pragma omp parallel
+#endif
+          {
+            int thread_num(0);
+#ifdef _OPENMP
+            thread_num = omp_get_thread_num();
+#endif
+            FoundProteinFunctor& func_thread = func_threads[thread_num];
+            std::vector<std::pair<Size, String> >& accessions_thread = accessions_threads[thread_num];
+            AhoCorasickAmbiguous fuzzyAC;
+            String prot;
+            std::vector<std::pair<Size, Size> > regions;
 
-              // check for invalid sequences with modifications
-              if (prot.has('[') || prot.has('('))
-              { 
-                 invalid_protein_sequence = true; // not omp-critical because its write-only
-                 // we cannot throw an exception here, since we'd need to catch it within the parallel region
-              }
+            while (true) 
+            {
+              #pragma omp barrier // all threads need to be here, since we are about to swap protein data
+              #pragma omp single
+              {
+                DEBUG_ONLY std::cerr << " activating cache ...\n";
+                has_active_data = proteins.activateCache(); // swap in last cache
+              } // implicit barrier here
               
-              // convert  L/J to I; also replace 'J' in proteins
-              if (IL_equivalent_)
+              if (!has_active_data) break; // leave while-loop
+              SignedSize prot_count = (SignedSize)proteins.chunkSize();
+
+              #pragma omp master
               {
-                prot.substitute('L', 'I');
-                prot.substitute('J', 'I');
-              }
-              else
-              { // warn if 'J' is found (it eats into aaa_max)
-                if (prot.has('J'))
+                DEBUG_ONLY std::cerr << "Filling Protein Cache ...";
+                proteins.cacheChunk(PROTEIN_CACHE_SIZE);
+                if (shard == 0)
                 {
-                 #pragma omp atomic
-                 ++count_j_proteins;
+                  protein_is_decoy.resize(proteins.getChunkOffset() + prot_count);
+                  for (SignedSize i = 0; i < prot_count; ++i)
+                  { // do this in master only, to avoid false sharing
+                    const String& seq = proteins.chunkAt(i).identifier;
+                    protein_is_decoy[i + proteins.getChunkOffset()] = (prefix_ ? seq.hasPrefix(decoy_string_) : seq.hasSuffix(decoy_string_));
+                  }
                 }
+                DEBUG_ONLY std::cerr << " done" << std::endl;
               }
-
-              Size prot_idx = i + proteins.getChunkOffset();
-              
-              // test if protein was a hit
-              Size hits_total = func_threads.filter_passed + func_threads.filter_rejected;
-
-              // check if there are stretches of 'X'
-              if (prot.has('X'))
+              DEBUG_ONLY std::cerr << " starting for loop \n";
+              // search all peptides in each protein
+              #pragma omp for schedule(dynamic, 100) nowait
+              for (SignedSize i = 0; i < prot_count; ++i)
               {
-                // create chunks of the protein (splitting it at stretches of 'X..X') and feed them to AC one by one
-                size_t offset = -1, start = 0;
-                while ((offset = prot.find(jumpX, offset + 1)) != std::string::npos)
+                ++progress_prots; // atomic
+                if (thread_num == 0)
                 {
-                  //std::cout << "found X..X at " << offset << " in protein " << proteins[i].identifier << "\n";
-                  addHits_(fuzzyAC, pattern, pep_DB, prot.substr(start, offset + jumpX.size() - start), prot, prot_idx, (int)start, func_threads);
-                  // skip ahead while we encounter more X...
-                  while (offset + jumpX.size() < prot.size() && prot[offset + jumpX.size()] == 'X') ++offset;
-                  start = offset;
-                  //std::cout << "  new start: " << start << "\n";
+                  this->setProgress(progress_prots);
                 }
-                // last chunk
-                if (start < prot.size())
+
+                prot = proteins.chunkAt(i).sequence;
+                prot.remove('*');
+
+                // check for invalid sequences with modifications
+                if (prot.has('[') || prot.has('('))
+                { 
+                   invalid_protein_sequence = true; // not omp-critical because its write-only
+                   // we cannot throw an exception here, since we'd need to catch it within the parallel region
+                }
+                
+                // convert  L/J to I; also replace 'J' in proteins
+                if (IL_equivalent_)
                 {
-                  addHits_(fuzzyAC, pattern, pep_DB, prot.substr(start), prot, prot_idx, (int)start, func_threads);
+                  prot.substitute('L', 'I');
+                  prot.substitute('J', 'I');
+                }
+                else
+                { // warn if 'J' is found (it eats into aaa_max)
+                  if (shard == 0 && prot.has('J'))
+                  {
+                   #pragma omp atomic
+                   ++count_j_proteins;
+                  }
                 }
-              }
-              else
-              {
-                addHits_(fuzzyAC, pattern, pep_DB, prot, prot, prot_idx, 0, func_threads);
-              }
-              // was protein found?
-              if (hits_total < func_threads.filter_passed + func_threads.filter_rejected)
-              {
-                protein_accessions[prot_idx] = proteins.chunkAt(i).identifier;
-                acc_to_prot_thread[protein_accessions[prot_idx]] = prot_idx;
-              }
-            } // end parallel FOR
 
-            // join results again
-            DEBUG_ONLY std::cerr << " critical now \n";
-            #ifdef _OPENMP
-            #pragma omp critical(PeptideIndexer_joinAC)
-            #endif
+                Size prot_idx = i + proteins.getChunkOffset();
+                
+                // test if protein was a hit
+                Size hits_total = func_thread.filter_passed + func_thread.filter_rejected;
+
+                // search only regions which can contain a hit
+                prefilter.getCandidateRegions(prot, regions);
+                for (const auto& region : regions)
+                {
+                  searchRegion_(fuzzyAC, pattern, pep_DB, pep_offset, prot, region.first, region.second, jumpX, prot_idx, func_thread);
+                }
+                // was protein found?
+                if (hits_total < func_thread.filter_passed + func_thread.filter_rejected)
+                {
+                  accessions_thread.emplace_back(prot_idx, proteins.chunkAt(i).identifier);
+                }
+              } // end parallel FOR
+            } // end readChunk
+          } // OMP end parallel
+          this->endProgress();
+          n_proteins = proteins.size(); // known after the first pass
+
+          // join results of all threads
+          s_merge.start();
+          for (int t = 0; t < n_threads; ++t)
+          {
+            func.merge(func_threads[t]); // hits
+            for (auto& acc : accessions_threads[t]) // index -> accession
             {
-              s.start();
-              // hits
-              func.merge(func_threads);
-              // accession -> index
-              acc_to_prot.insert(acc_to_prot_thread.begin(), acc_to_prot_thread.end());
-              acc_to_prot_thread.clear();
-              s.stop();
-            } // OMP end critical
-          } // end readChunk
-        } // OMP end parallel
-        this->endProgress();
-        std::cout << "Merge took: " << s.toString() << "\n";
+              protein_accessions[acc.first].swap(acc.second);
+            }
+            accessions_threads[t].clear();
+          }
+          s_merge.stop();
+        } // end shards
+
+        // accession -> index
+        for (const auto& acc : protein_accessions)
+        {
+          acc_to_prot.insert(std::make_pair(acc.second, acc.first));
+        }
+        std::cout << "Merge took: " << s_merge.toString() << "\n";
         mu.after();
         std::cout << mu.delta("Aho-Corasick") << "\n\n";
+        size_t peak_memory(0);
+        if (SysInfo::getProcessPeakMemoryConsumption(peak_memory))
+        {
+          OPENMS_LOG_INFO << "Peak memory usage: " << peak_memory / 1024 << " MB" << (memory_budget_ > 0 ? " (memory budget for the peptide trie: " + String(memory_budget_) + " MB)" : String()) << std::endl;
+        }
 
-        OPENMS_LOG_INFO << "\nAho-Corasick done:\n  found " << func.filter_passed << " hits for " << func.pep_to_prot.size() << " of " << length(pep_DB) << " peptides.\n";
+        OPENMS_LOG_INFO << "\nAho-Corasick done:\n  found " << func.filter_passed << " hits for " << func.pep_to_prot.size() << " of " << peptides.size() << " distinct peptides.\n";
 
         // write some stats
         OPENMS_LOG_INFO << "Peptide hits passing enzyme filter: " << func.filter_passed << "\n"
@@ -519,8 +591,8 @@ public:
 
           std::set<Size> prot_indices; /// protein hits of this peptide
           // add new protein references
-          for (std::set<PeptideProteinMatchInformation>::const_iterator it_i = func.pep_to_prot[pep_idx].begin();
-            it_i != func.pep_to_prot[pep_idx].end(); ++it_i)
+          const std::set<PeptideProteinMatchInformation>& matches = func.pep_to_prot[hit_to_peptide[pep_idx]];
+          for (std::set<PeptideProteinMatchInformation>::const_iterator it_i = matches.begin(); it_i != matches.end(); ++it_i)
           {
             prot_indices.insert(it_i->protein_index);
             const String& accession = protein_accessions[it_i->protein_index];
@@ -815,13 +887,42 @@ public:
 
     };
 
-    inline void addHits_(AhoCorasickAmbiguous& fuzzyAC, const AhoCorasickAmbiguous::FuzzyACPattern& pattern, const AhoCorasickAmbiguous::PeptideDB& pep_DB, const String& prot, const String& full_prot, SignedSize idx_prot, Int offset, FoundProteinFunctor& func_threads) const
+    /// search @p prot (part of @p full_prot, starting at @p offset) for peptides of @p pep_DB; peptide indices are reported with @p pep_offset added
+    inline void addHits_(AhoCorasickAmbiguous& fuzzyAC, const AhoCorasickAmbiguous::FuzzyACPattern& pattern, const AhoCorasickAmbiguous::PeptideDB& pep_DB, Size pep_offset, const String& prot, const String& full_prot, SignedSize idx_prot, Int offset, FoundProteinFunctor& func_threads) const
     {
       fuzzyAC.setProtein(prot);
       while (fuzzyAC.findNext(pattern))
       {
         const seqan::Peptide& tmp_pep = pep_DB[fuzzyAC.getHitDBIndex()];
-        func_threads.addHit(fuzzyAC.getHitDBIndex(), idx_prot, length(tmp_pep), full_prot, fuzzyAC.getHitProteinPosition() + offset);
+        func_threads.addHit(fuzzyAC.getHitDBIndex() + pep_offset, idx_prot, length(tmp_pep), full_prot, fuzzyAC.getHitProteinPosition() + offset);
+      }
+    }
+
+    /// search the region [@p begin, @p end) of @p prot, skipping stretches of 'X' which cannot be part of a hit
+    inline void searchRegion_(AhoCorasickAmbiguous& fuzzyAC, const AhoCorasickAmbiguous::FuzzyACPattern& pattern, const AhoCorasickAmbiguous::PeptideDB& pep_DB, Size pep_offset, const String& prot, Size begin, Size end, const std::string& jumpX, SignedSize idx_prot, FoundProteinFunctor& func_threads) const
+    {
+      const String region = (begin == 0 && end == prot.size()) ? prot : prot.substr(begin, end - begin);
+      // check if there are stretches of 'X'
+      if (region.has('X'))
+      {
+        // create chunks of the protein (splitting it at stretches of 'X..X') and feed them to AC one by one
+        size_t offset = -1, start = 0;
+        while ((offset = region.find(jumpX, offset + 1)) != std::string::npos)
+        {
+          addHits_(fuzzyAC, pattern, pep_DB, pep_offset, region.substr(start, offset + jumpX.size() - start), prot, idx_prot, (int)(begin + start), func_threads);
+          // skip ahead while we encounter more X...
+          while (offset + jumpX.size() < region.size() && region[offset + jumpX.size()] == 'X') ++offset;
+          start = offset;
+        }
+        // last chunk
+        if (start < region.size())
+        {
+          addHits_(fuzzyAC, pattern, pep_DB, pep_offset, region.substr(start), prot, idx_prot, (int)(begin + start), func_threads);
+        }
+      }
+      else
+      {
+        addHits_(fuzzyAC, pattern, pep_DB, pep_offset, region, prot, idx_prot, (int)begin, func_threads);
       }
     }
 
@@ -841,6 +942,10 @@ public:
 
     Int aaa_max_;
     Int mm_max_;
+    double memory_budget_; ///< approximate memory (MB) for the peptide trie; 0 = unlimited
+
+    /// rough estimate of the memory (bytes) per residue of the peptide trie (one node per residue, with edges for all amino acids, suffix link, depth and output list)
+    static constexpr double TRIE_BYTES_PER_RESIDUE = 160;
  };
 }
 
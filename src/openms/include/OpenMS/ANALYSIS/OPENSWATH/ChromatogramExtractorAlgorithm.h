@@ -96,8 +96,25 @@ public:
      * dimension in Th or ppm (e.g. a window of 50 ppm means an extraction of
      * 25 ppm on either side)
      * @param ppm Whether mz_extraction_window is in ppm or in Th
+     * @param im_extraction_window Extracts a window of this size in ion
+     * mobility dimension (only for coordinates with ion_mobility >= 0; no
+     * ion mobility filtering if <= 0)
      * @param filter Which function to apply in m/z space (currently "tophat" only)
      *
+     * All coordinates are extracted in a single sweep over each spectrum. The
+     * spectra are processed in parallel (using thread-local copies of @p input,
+     * see OpenSwath::ISpectrumAccess::lightClone()) unless called from within
+     * a parallel region, the results are appended to @p output in the order
+     * of the spectra. The integrated intensities are identical to those
+     * obtained by calling extract_value_tophat() for each coordinate.
+     *
+     * If @p input is a SpectrumAccessIMIndexed, coordinates with ion mobility
+     * are extracted through its (m/z, ion mobility) index instead, which
+     * only visits the peaks in the ion mobility range. These intensities are
+     * the sum over all peaks strictly inside the window (this only differs
+     * from extract_value_tophat() in the summation order and for peaks at the
+     * border of the spectrum).
+     *
     */
     void extractChromatograms(const OpenSwath::SpectrumAccessPtr input,
         std::vector< OpenSwath::ChromatogramPtr >& output,
@@ -0,0 +1,145 @@
+// --------------------------------------------------------------------------
+//                   OpenMS -- Open-Source Mass Spectrometry
+// --------------------------------------------------------------------------
+// Copyright The OpenMS Team -- Eberhard Karls University Tuebingen,
+// ETH Zurich, and Freie Universitaet Berlin 2002-2020.
+//
+// This software is released under a three-clause BSD license:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of any author or any participating institution
+//    may be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+// For a full list of authors, refer to the file AUTHORS.
+// --------------------------------------------------------------------------
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL ANY OF THE AUTHORS OR THE CONTRIBUTING
+// INSTITUTIONS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// --------------------------------------------------------------------------
+// $Maintainer: agent $
+// $Authors: agent $
+// --------------------------------------------------------------------------
+
+#pragma once
+
+#include <OpenMS/ANALYSIS/OPENSWATH/DATAACCESS/SpectrumAccessTransforming.h>
+#include <OpenMS/CONCEPT/Types.h>
+
+#include <boost/shared_ptr.hpp>
+
+namespace OpenMS
+{
+
+  /**
+   * @brief Spectrum access with a two-dimensional (m/z, ion mobility) index per spectrum
+   *
+   * Wraps another spectrum access (usually SpectrumAccessOpenMSInMemory) and
+   * builds an index over the peaks of every spectrum that carries an ion
+   * mobility array (e.g. timsTOF / diaPASEF frames). The peaks of a spectrum
+   * are sorted by ion mobility and cut into blocks of @p block_size peaks;
+   * within each block the peaks are kept in their original (m/z sorted)
+   * order. A query for an m/z x ion mobility box therefore only visits the
+   * blocks overlapping the ion mobility range and performs a binary search
+   * in m/z within each of them, instead of scanning every peak of the frame.
+   *
+   * The index only stores the peak positions (4 bytes per peak) and a few
+   * values per block, the peak data itself is read from the wrapped spectra.
+   * Spectra returned by getSpectrumById() are the unmodified spectra of the
+   * wrapped access. The index is shared between light clones.
+   *
+   * All ranges are open intervals (lower < value < upper), as used by
+   * ChromatogramExtractorAlgorithm and by the drift time filter in
+   * OpenSwathScoring.
+   */
+  class OPENMS_DLLAPI SpectrumAccessIMIndexed :
+    public SpectrumAccessTransforming
+  {
+public:
+
+    /**
+     * @brief Constructor, builds the index for all spectra of @p sptr
+     *
+     * @param sptr The wrapped spectrum access
+     * @param block_size Number of peaks per ion mobility block
+     *
+     * @exception Exception::IllegalArgument is thrown if @p block_size is zero
+     */
+    explicit SpectrumAccessIMIndexed(OpenSwath::SpectrumAccessPtr sptr, Size block_size = 256);
+
+    ~SpectrumAccessIMIndexed() override;
+
+    /// Light clone operator (the index is shared, the wrapped access is light cloned)
+    boost::shared_ptr<OpenSwath::ISpectrumAccess> lightClone() const override;
+
+    /// Whether spectrum @p id has an ion mobility index (i.e. an ion mobility array)
+    bool hasIMIndex(int id) const;
+
+    /**
+     * @brief Returns all peaks of spectrum @p id with drift_lower < ion mobility < drift_upper
+     *
+     * The result is sorted by m/z and contains m/z, intensity and ion
+     * mobility arrays (identical to filtering the full spectrum peak by
+     * peak). If the spectrum has no ion mobility index, the unfiltered
+     * spectrum is returned.
+     */
+    OpenSwath::SpectrumPtr getSpectrumByIdInIMRange(int id, double drift_lower, double drift_upper);
+
+    /**
+     * @brief Sums the intensity of all peaks of spectrum @p id inside an m/z x ion mobility box
+     *
+     * The spectrum is passed by the caller (to extract many boxes from the
+     * same spectrum without retrieving it again) and has to be the spectrum
+     * returned by getSpectrumById(@p id).
+     *
+     * @param id Spectrum index
+     * @param spectrum The spectrum @p id
+     * @param mz_lower Lower m/z bound (exclusive)
+     * @param mz_upper Upper m/z bound (exclusive)
+     * @param im_lower Lower ion mobility bound (exclusive)
+     * @param im_upper Upper ion mobility bound (exclusive)
+     *
+     * @exception Exception::IllegalArgument is thrown if the spectrum has no ion mobility index
+     */
+    double integrateBox(int id, const OpenSwath::SpectrumPtr& spectrum,
+                        double mz_lower, double mz_upper, double im_lower, double im_upper) const;
+
+protected:
+
+    /// Index of a single spectrum
+    struct IMIndex
+    {
+      std::vector<UInt32> peaks; ///< peak positions, block by block (ion mobility sorted), ascending within a block
+      std::vector<Size> block_start; ///< start of each block in peaks (plus past-the-end entry)
+      std::vector<double> block_im_min; ///< smallest ion mobility of each block
+      std::vector<double> block_im_max; ///< largest ion mobility of each block
+      bool has_im = false; ///< whether the spectrum had an ion mobility array
+    };
+
+    /// Light clone constructor
+    SpectrumAccessIMIndexed(OpenSwath::SpectrumAccessPtr sptr, boost::shared_ptr<const std::vector<IMIndex> > index);
+
+    /// Builds the index of a single spectrum
+    static void buildIndex_(const OpenSwath::SpectrumPtr& spectrum, Size block_size, IMIndex& index);
+
+    /// Calls @p f(position) for every peak of @p spectrum inside the box (in block order)
+    template <typename F>
+    static void visitBox_(const IMIndex& index, const OpenSwath::SpectrumPtr& spectrum,
+                          double mz_lower, double mz_upper, double im_lower, double im_upper, F f);
+
+    boost::shared_ptr<const std::vector<IMIndex> > index_;
+  };
+
+}
+
@@ -9,6 +9,7 @@ SimpleOpenMSSpectraAccessFactory.h
 SpectrumAccessOpenMS.h
 SpectrumAccessOpenMSCached.h
 SpectrumAccessOpenMSInMemory.h
+SpectrumAccessIMIndexed.h
 SpectrumAccessSqMass.h
 SpectrumAccessTransforming.h
 SpectrumAccessQuadMZTransforming.h
@@ -137,10 +137,26 @@ public:
     void dia_ms1_isotope_scores(double precursor_mz, SpectrumPtrType spectrum, size_t charge_state, 
                                 double& isotope_corr, double& isotope_overlap, const std::string& sum_formula = "");
 
+    /**
+      @brief Precursor isotope scores using a precomputed theoretical isotope envelope
+
+      Same as above, but compares against the relative intensities in @p
+      theoretical_isotopes (monoisotopic peak first, e.g. as stored in a PQP
+      library) instead of computing an averagine distribution. Falls back to
+      the averagine model if fewer than dia_nr_isotopes + 1 values are given.
+    */
+    void dia_ms1_isotope_scores(double precursor_mz, SpectrumPtrType spectrum, size_t charge_state,
+                                const std::vector<double>& theoretical_isotopes,
+                                double& isotope_corr, double& isotope_overlap);
+
     /// b/y ion scores
     void dia_by_ion_score(SpectrumPtrType spectrum, AASequence& sequence,
                           int charge, double& bseries_score, double& yseries_score);
 
+    /// b/y ion scores using precomputed b and y ion m/z values (e.g. as stored in a PQP library)
+    void dia_by_ion_score(SpectrumPtrType spectrum, const std::vector<double>& bseries,
+                          const std::vector<double>& yseries, double& bseries_score, double& yseries_score);
+
     /// Dotproduct / Manhatten score with theoretical spectrum
     void score_with_isotopes(SpectrumPtrType spectrum,
                              const std::vector<TransitionType>& transitions,
@@ -192,6 +208,10 @@ private:
     */
     void largePeaksBeforeFirstIsotope_(SpectrumPtrType spectrum, double mono_mz, double mono_int, int& nr_occurrences, double& max_ratio);
 
+    /// Integrates the signal of the monoisotopic peak and the next dia_nr_isotopes isotopes of a precursor
+    void getIsotopeIntensities_(double precursor_mz, SpectrumPtrType spectrum, size_t charge_state,
+                                std::vector<double>& isotopes_int);
+
     /**
       @brief Compare an experimental isotope pattern to a theoretical one
 
@@ -209,6 +209,29 @@ public:
       ms1_map_ = ms1_map;
     }
 
+    /** @brief Set the cache for the spectra used in DIA scoring
+     *
+     * By default, a cache of "spectrum_cache_size" MB is created (replaced
+     * whenever the parameters are set) and shared by all transition groups
+     * scored with this object. Use this function to provide a cache instead,
+     * e.g. to inspect its statistics afterwards (a null pointer disables
+     * caching). The cache must be cleared whenever the spectrum addition
+     * parameters change.
+     *
+     * @param cache The spectrum cache
+     *
+    */
+    void setSpectrumCache(OpenSwathScoring::SpectrumCachePtr cache)
+    {
+      spectrum_cache_ = cache;
+    }
+
+    /// Returns the cache for the spectra used in DIA scoring (may be a null pointer)
+    OpenSwathScoring::SpectrumCachePtr getSpectrumCache() const
+    {
+      return spectrum_cache_;
+    }
+
     /** @brief Map the chromatograms to the transitions.
      *
      * Map an input chromatogram experiment (mzML) and transition list (TraML)
@@ -314,6 +337,7 @@ private:
 
     // data
     OpenSwath::SpectrumAccessPtr ms1_map_;
+    OpenSwathScoring::SpectrumCachePtr spectrum_cache_;
 
   };
 }
@@ -40,8 +40,11 @@
 #include <OpenMS/CONCEPT/UniqueIdGenerator.h>
 
 #include <OpenMS/KERNEL/FeatureMap.h>
+#include <OpenMS/DATASTRUCTURES/DataValue.h>
 
 #include <fstream>
+#include <memory>
+#include <mutex>
 
 namespace OpenMS
 {
@@ -54,6 +57,13 @@ namespace OpenMS
     directly linked to the PQP file format described in the TransitionPQPFile class.
     See also OpenSwathTSVWriter for another output format.
 
+    For large outputs, prepareRows() and writeRows() should be used instead of
+    prepareLine() and writeLines(): the values are bound to cached prepared
+    statements (no SQL text is generated or parsed) and written by a
+    background thread in large transactions, so that the scoring threads do
+    not have to wait for the database. writeRows() can be called from
+    multiple threads, call flush() to make sure all rows are committed.
+
     The file format has the following tables:
 
       <table>
@@ -122,8 +132,37 @@ namespace OpenMS
     bool sonar_;
     bool enable_uis_scoring_;
 
+    /// Background writer (created by the first call to writeRows(), shared between copies)
+    struct BulkWriter_;
+    std::shared_ptr<BulkWriter_> bulk_writer_;
+    /// Guards the creation of bulk_writer_ (shared between copies, like the writer itself)
+    std::shared_ptr<std::mutex> bulk_writer_mutex_;
+
   public:
 
+    /**
+      @brief Rows of the feature tables, prepared for insertion (see prepareRows())
+
+      Each row holds the values of one table row in the order of the columns
+      of the table (as created by writeHeader()). Empty values and NaN are
+      written as NULL.
+    */
+    struct OSWRows
+    {
+      std::vector< std::vector<DataValue> > feature; ///< Rows of FEATURE
+      std::vector< std::vector<DataValue> > feature_ms1; ///< Rows of FEATURE_MS1
+      std::vector< std::vector<DataValue> > feature_precursor; ///< Rows of FEATURE_PRECURSOR
+      std::vector< std::vector<DataValue> > feature_ms2; ///< Rows of FEATURE_MS2
+      std::vector< std::vector<DataValue> > feature_transition; ///< Rows of FEATURE_TRANSITION (MS2 transitions)
+      std::vector< std::vector<DataValue> > feature_transition_uis; ///< Rows of FEATURE_TRANSITION (UIS transitions, including scores)
+
+      /// Total number of rows
+      Size size() const;
+
+      /// Removes all rows
+      void clear();
+    };
+
     OpenSwathOSWWriter(const String& output_filename,
                        const String& input_filename = "inputfile",
                        bool ms1_scores = false,
@@ -135,7 +174,8 @@ namespace OpenMS
       doWrite_(!output_filename.empty()),
       use_ms1_traces_(ms1_scores),
       sonar_(sonar),
-      enable_uis_scoring_(uis_scores)
+      enable_uis_scoring_(uis_scores),
+      bulk_writer_mutex_(std::make_shared<std::mutex>())
       {}
 
     bool isActive() const;
@@ -205,6 +245,46 @@ namespace OpenMS
      */
     void writeLines(const std::vector<String>& to_osw_output);
 
+    /**
+     * @brief Prepare the rows of a set of features for output
+     *
+     * Same as prepareLine(), but the values are stored as DataValue (to be
+     * bound to prepared statements by writeRows()) instead of SQL text.
+     *
+     * @param pep The compound (peptide/metabolite) used for extraction
+     * @param transition The transition used for extraction
+     * @param output The feature map containing all features (each feature will generate one entry in the output)
+     * @param id The transition group identifier (peptide/metabolite id)
+     * @param rows The rows are appended here
+     *
+     */
+    void prepareRows(const OpenSwath::LightCompound& /* pep */,
+        const OpenSwath::LightTransition* /* transition */,
+        const FeatureMap& output, const String& id, OSWRows& rows) const;
+
+    /**
+     * @brief Queue rows for writing to disk
+     *
+     * The rows are written by a background thread using prepared statements
+     * within large transactions. If more than @p max_queued_rows rows are
+     * waiting to be written, the call blocks until the writer has caught up.
+     * Can be called from several threads at the same time (no critical
+     * section required).
+     *
+     * @param rows Rows generated by prepareRows (will be empty afterwards)
+     * @param max_queued_rows Maximal number of rows waiting to be written
+     *
+     * @exception Exception::IllegalArgument is thrown if writing previously queued rows failed
+     */
+    void writeRows(OSWRows& rows, Size max_queued_rows = 1000000);
+
+    /**
+     * @brief Waits until all queued rows are written and commits them
+     *
+     * @exception Exception::IllegalArgument is thrown if writing failed
+     */
+    void flush();
+
   };
 
 }
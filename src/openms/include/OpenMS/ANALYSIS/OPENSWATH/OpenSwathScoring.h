@@ -45,6 +45,8 @@
 #include <OpenMS/ANALYSIS/OPENSWATH/OpenSwathScores.h>
 #include <OpenMS/ANALYSIS/OPENSWATH/DIAScoring.h>
 
+#include <list>
+#include <map>
 #include <vector>
 #include <boost/shared_ptr.hpp>
 #include <boost/make_shared.hpp>
@@ -70,6 +72,79 @@ namespace OpenMS
 
   public:
 
+    /** @brief Cache for the spectra used in DIA scoring
+     *
+     * Fetching a spectrum at the apex of a peak group (see
+     * fetchSpectrumSwath()) may involve reading several spectra, filtering
+     * them by ion mobility and adding them up. All peak groups of a SWATH
+     * window close to the same retention time (as well as the different DIA
+     * scores of a single peak group) use the same spectrum, which can thus be
+     * reused from this cache.
+     *
+     * Spectra are identified by the map(s) and the index of the spectrum
+     * closest to the requested retention time in each map, the number of
+     * spectra to add up and the drift time range. The least recently used
+     * spectra are evicted once the total size of the cached spectra exceeds
+     * the given limit. The cache keeps the maps of the cached spectra alive.
+     *
+     * @note A cache should only be shared by OpenSwathScoring objects with
+     * the same spectrum addition settings. It is not thread-safe.
+     */
+    class OPENMS_DLLAPI SpectrumCache
+    {
+    public:
+
+      /// Identifies an (added up) spectrum
+      struct Key
+      {
+        std::vector<std::pair<const OpenSwath::ISpectrumAccess*, int> > spectra; ///< map and index of the closest spectrum (-1 if none), for each map
+        int nr_spectra_to_add;
+        double drift_lower;
+        double drift_upper;
+
+        bool operator<(const Key& rhs) const;
+      };
+
+      /// Constructor (cache up to @p max_size_mb megabytes of spectra)
+      explicit SpectrumCache(double max_size_mb = 64.0);
+
+      /// Returns the cached spectrum (or a null pointer if @p key is not cached)
+      OpenSwath::SpectrumPtr get(const Key& key);
+
+      /// Adds a spectrum (computed from the given maps) to the cache
+      void insert(const Key& key, const OpenSwath::SpectrumPtr& spectrum, const std::vector<OpenSwath::SpectrumAccessPtr>& maps);
+
+      /// Removes all spectra (the statistics are kept)
+      void clear();
+
+      /// Number of spectra in the cache
+      Size size() const;
+
+      /// Number of lookups that returned a cached spectrum
+      Size getHits() const;
+
+      /// Number of lookups that did not find the spectrum
+      Size getMisses() const;
+
+    protected:
+
+      struct Entry
+      {
+        Key key;
+        OpenSwath::SpectrumPtr spectrum;
+        std::vector<OpenSwath::SpectrumAccessPtr> maps; ///< keeps the maps alive (the key uses their addresses)
+        Size bytes;
+      };
+
+      Size max_bytes_;
+      Size bytes_;
+      Size hits_;
+      Size misses_;
+      std::list<Entry> entries_; ///< most recently used first
+      std::map<Key, std::list<Entry>::iterator> index_;
+    };
+    typedef boost::shared_ptr<SpectrumCache> SpectrumCachePtr;
+
     /// Constructor
     OpenSwathScoring();
 
@@ -94,6 +169,15 @@ namespace OpenMS
                     const OpenSwath_Scores_Usage & su,
                     const std::string& spectrum_addition_method);
 
+    /** @brief Use a cache for the spectra fetched for DIA scoring
+     *
+     * All spectra returned by fetchSpectrumSwath() are taken from (or added
+     * to) @p cache, which can be shared by the scoring objects of all
+     * transition groups of a SWATH window. A null pointer disables caching
+     * (default).
+    */
+    void setSpectrumCache(SpectrumCachePtr cache);
+
     /** @brief Score a single peakgroup in a chromatogram using only chromatographic properties.
      *
      * This function only uses the chromatographic properties (coelution,
@@ -291,6 +375,11 @@ namespace OpenMS
 
   protected:
 
+    SpectrumCachePtr spectrum_cache_;
+
+    /// Index of the spectrum closest to @p RT in @p swath_map (-1 if the map is empty)
+    static int getClosestSpectrum_(const OpenSwath::SpectrumAccessPtr& swath_map, double RT);
+
     /** @brief Returns an averaged spectrum
      *
      * This function will sum up (add) the intensities of multiple spectra
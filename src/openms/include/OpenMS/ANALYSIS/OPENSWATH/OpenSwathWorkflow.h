@@ -47,6 +47,7 @@
 #include <OpenMS/ANALYSIS/OPENSWATH/DATAACCESS/SpectrumAccessOpenMS.h>
 #include <OpenMS/ANALYSIS/OPENSWATH/DATAACCESS/SpectrumAccessTransforming.h>
 #include <OpenMS/ANALYSIS/OPENSWATH/DATAACCESS/SpectrumAccessOpenMSInMemory.h>
+#include <OpenMS/ANALYSIS/OPENSWATH/DATAACCESS/SpectrumAccessIMIndexed.h>
 #include <OpenMS/OPENSWATHALGO/DATAACCESS/SwathMap.h>
 
 // Helpers
@@ -119,13 +120,9 @@ protected:
     /** @brief Constructor
      *
      *  @param use_ms1_traces Whether to use MS1 data
-     *  @param threads_outer_loop How many threads should be used for the outer
-     *  loop (-1 will use all threads in the outer loop)
-     *
-     *  @note The total number of threads should be divisible by this number
-     *  (e.g. use 8 in outer loop if you have 24 threads in total and 3 will be
-     *  used for the inner loop).
-     *
+     *  @param threads_outer_loop Maximal number of SWATH windows that are
+     *  analyzed (and held in memory) at the same time (-1: no limit). All
+     *  threads are shared between the batches of these windows.
      *
      **/
     OpenSwathWorkflowBase(bool use_ms1_traces, bool use_ms1_ion_mobility, bool prm, int threads_outer_loop) :
@@ -231,6 +228,12 @@ protected:
    *   - Extract chromatograms across the whole RT range using simpleExtractChromatograms_()
    *   - Compute calibration functions for RT and m/z using doDataNormalization_()
    *
+   * The calibrant peptides are scored in parallel and the wall time of each
+   * step is reported. Alternatively, reuseCachedCalibration() checks whether
+   * the RT calibration of a previous run (on the same instrument and method)
+   * still fits the data and only performs the m/z and ion mobility
+   * calibration in that case.
+   *
   */
   class OPENMS_DLLAPI OpenSwathCalibrationWorkflow :
     public OpenSwathWorkflowBase
@@ -285,6 +288,46 @@ protected:
       bool sonar = false,
       bool load_into_memory = false);
 
+    /** @brief Reuse the RT calibration of a previous run if it still fits the data
+     *
+     * Extracts the RT normalization chromatograms around the retention times
+     * predicted by @p cached_trafo (using the rt_extraction_window of @p
+     * cp_irt), finds the calibrants and computes their residuals in
+     * normalized RT. If at least two peptides and at least a fraction of @p
+     * min_coverage of all peptides lie within @p max_residual, the cached
+     * calibration is accepted and the m/z and ion mobility calibration is
+     * performed using these peptides (see SwathMapMassCorrection). Outlier
+     * detection and the fitting of the RT model are skipped.
+     *
+     * @param irt_transitions A set of transitions used for the RT normalization peptides
+     * @param swath_maps The raw data (swath maps, only changed if the cached calibration is accepted)
+     * @param cached_trafo The cached RT transformation (experimental to normalized RT, with a fitted model)
+     * @param im_trafo The ion mobility transformation (output)
+     * @param max_residual Maximal residual in normalized RT of a peptide to be retained
+     * @param min_coverage Minimal fraction of peptides that need to be retained
+     * @param feature_finder_param Parameter set for the feature finding in chromatographic dimension
+     * @param cp_irt Parameter set for the chromatogram extraction
+     * @param irt_detection_param Parameter set for the detection of the iRTs (outlier detection, peptides per bin etc)
+     * @param calibration_param Parameter for the m/z and im calibration (see SwathMapMassCorrection)
+     * @param sonar Whether the data is SONAR data
+     * @param load_into_memory Whether to cache the current SWATH map in memory
+     *
+     * @return Whether the cached calibration was accepted
+     *
+    */
+    bool reuseCachedCalibration(const OpenSwath::LightTargetedExperiment& irt_transitions,
+      std::vector< OpenSwath::SwathMap > & swath_maps,
+      const TransformationDescription& cached_trafo,
+      TransformationDescription& im_trafo,
+      double max_residual,
+      double min_coverage,
+      const Param& feature_finder_param,
+      const ChromExtractParams& cp_irt,
+      const Param& irt_detection_param,
+      const Param& calibration_param,
+      bool sonar = false,
+      bool load_into_memory = false);
+
   public:
 
     /** @brief Perform retention time and m/z calibration
@@ -353,6 +396,41 @@ protected:
     */
     static void addChromatograms(MSChromatogram& base_chrom, const MSChromatogram& newchrom);
 
+  protected:
+
+    /** @brief Find the calibrants in the extracted chromatograms
+     *
+     * Runs MRMFeatureFinderScoring (without RT scoring) on the chromatograms.
+     * The peptides are distributed over one group per thread and the groups
+     * are scored in parallel.
+     *
+     * @param targeted_exp The transitions for the normalization peptides
+     * @param chromatograms The extracted chromatograms
+     * @param default_ffparam Parameter set for the feature finding in chromatographic dimension
+     * @param irt_detection_param Parameter set for the detection of the iRTs
+     * @param transition_group_map The picked transition groups (output)
+     *
+    */
+    void pickCalibrants_(const OpenSwath::LightTargetedExperiment& targeted_exp,
+      const std::vector< OpenMS::MSChromatogram >& chromatograms,
+      const Param& default_ffparam,
+      const Param& irt_detection_param,
+      OpenMS::MRMFeatureFinderScoring::TransitionGroupMapType& transition_group_map);
+
+    /** @brief Perform m/z and ion mobility calibration on the peptides used for the RT calibration
+     *
+     * Only the best features of @p best_features whose RT is part of @p
+     * pairs_corrected are used (see SwathMapMassCorrection).
+     *
+    */
+    void correctMassAndIonMobility_(OpenMS::MRMFeatureFinderScoring::TransitionGroupMapType& transition_group_map,
+      const std::map<std::string, double>& best_features,
+      const std::vector<std::pair<double, double> >& pairs_corrected,
+      std::vector< OpenSwath::SwathMap > & swath_maps,
+      TransformationDescription& im_trafo,
+      const OpenSwath::LightTargetedExperiment& targeted_exp,
+      const Param& calibration_param);
+
   };
 
   /**
@@ -367,16 +445,17 @@ protected:
    *
    *    - Obtain precursor ion chromatograms (if enabled) through MS1Extraction_()
    *    - Perform scoring of precursor ion chromatograms if no MS2 is given
-   *    - Iterate through each SWATH-MS window:
-   *      - Select which transitions to extract (proceed in batches) using OpenSwathHelper::selectSwathTransitions()
-   *      - Iterate through each batch of transitions:
-   *        - Extract current batch of transitions from current SWATH window:
-   *          - Select transitions for current batch (see selectCompoundsForBatch_())
-   *          - Prepare transition extraction (see prepareExtractionCoordinates_())
-   *          - Extract transitions using ChromatogramExtractor::extractChromatograms()
-   *          - Convert data to OpenMS format using ChromatogramExtractor::return_chromatogram()
-   *        - Score extracted transitions (see scoreAllChromatograms_())
-   *        - Write scored chromatograms and peak groups to disk (see writeOutFeaturesAndChroms_())
+   *    - For each SWATH-MS window, select which transitions to extract using OpenSwathHelper::selectSwathTransitions()
+   *    - Split the transitions of each window into batches, each (window, batch) pair is one task
+   *    - Process all tasks in parallel, in the order of the windows (all threads take tasks from a shared queue):
+   *      - Extract current batch of transitions from current SWATH window:
+   *        - Select transitions for current batch (see selectCompoundsForBatch_())
+   *        - Prepare transition extraction (see prepareExtractionCoordinates_())
+   *        - Extract transitions using ChromatogramExtractor::extractChromatograms()
+   *        - Convert data to OpenMS format using ChromatogramExtractor::return_chromatogram()
+   *      - Score extracted transitions (see scoreAllChromatograms_())
+   *      - Write scored chromatograms and peak groups to disk (see writeOutFeaturesAndChroms_()),
+   *        in task order, independent of the order in which the tasks finish
    *
    */
   class OPENMS_DLLAPI OpenSwathWorkflow :
@@ -391,15 +470,11 @@ protected:
      *
      *  @param use_ms1_traces Whether to use MS1 data
      *  @param use_ms1_ion_mobility Whether to use ion mobility extraction on MS1 traces
-     *  @param threads_outer_loop How many threads should be used for the outer
-     *  loop (-1 will use all threads in the outer loop)
+     *  @param threads_outer_loop Maximal number of SWATH windows that are
+     *  analyzed (and held in memory) at the same time (-1: no limit). All
+     *  threads are shared between the batches of these windows.
      *  @param prm Whether data is acquired in targeted DIA (e.g. PRM mode) with potentially overlapping windows
      *
-     *  @note The total number of threads should be divisible by this number
-     *  (e.g. use 8 in outer loop if you have 24 threads in total and 3 will be
-     *  used for the inner loop).
-     *
-     *
      **/
     OpenSwathWorkflow(bool use_ms1_traces, bool use_ms1_ion_mobility, bool prm, int threads_outer_loop) :
       OpenSwathWorkflowBase(use_ms1_traces, use_ms1_ion_mobility, prm, threads_outer_loop)
@@ -422,6 +497,7 @@ protected:
      * @param result_osw OSW Writer object to store identified features in SQLite format (set store_features to false if using this option)
      * @param result_chromatograms Chromatogram consumer object to store the extracted chromatograms
      * @param batchSize Size of the batches which should be extracted and scored
+     * (0: one batch per window, or several if there are fewer windows than threads)
      * @param int ms1_isotopes Number of MS1 isotopes to extract (zero means only monoisotopic peak)
      * @param load_into_memory Whether to cache the current SWATH map in memory
      *
@@ -503,6 +579,9 @@ protected:
      * @param tsv_writer TSV writer for storing output (on the fly)
      * @param osw_writer OSW Writer object to store identified features in SQLite format
      * @param ms1only If true, will only score on MS1 level and ignore MS2 level
+     * @param spectrum_cache Cache for the spectra used in DIA scoring, shared
+     *        by all assays (if null, the default cache of
+     *        MRMFeatureFinderScoring is used)
      *
     */
     void scoreAllChromatograms_(
@@ -517,7 +596,8 @@ protected:
         OpenSwathTSVWriter & tsv_writer,
         OpenSwathOSWWriter & osw_writer,
         int nr_ms1_isotopes = 0,
-        bool ms1only = false) const;
+        bool ms1only = false,
+        OpenSwathScoring::SpectrumCachePtr spectrum_cache = OpenSwathScoring::SpectrumCachePtr()) const;
 
     /** @brief Select which compounds to analyze in the next batch (and copy to output)
      *
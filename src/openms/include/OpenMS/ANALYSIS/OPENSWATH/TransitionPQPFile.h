@@ -134,6 +134,9 @@ namespace OpenMS
         <tr> <td BGCOLOR="#EBEBEB">LIBRARY_INTENSITY</td> <td>TEXT</td> <td> %Precursor library intensity </td> </tr>
         <tr> <td BGCOLOR="#EBEBEB">LIBRARY_RT</td> <td>TEXT</td> <td> Library retention time (RT) </td> </tr>
         <tr> <td BGCOLOR="#EBEBEB">LIBRARY_DRIFT_TIME</td> <td>TEXT</td> <td> Library drift time (ion mobility drift time or collisional cross-section) </td> </tr>
+        <tr> <td BGCOLOR="#EBEBEB">ISOTOPE_ENVELOPE</td> <td>TEXT</td> <td> Theoretical (averagine) isotope envelope of the precursor, semicolon-separated relative intensities starting with the monoisotopic peak<sup>3</sup></td> </tr>
+        <tr> <td BGCOLOR="#EBEBEB">BSERIES</td> <td>TEXT</td> <td> Theoretical singly charged b ion m/z values, semicolon-separated<sup>3</sup></td> </tr>
+        <tr> <td BGCOLOR="#EBEBEB">YSERIES</td> <td>TEXT</td> <td> Theoretical singly charged y ion m/z values, semicolon-separated<sup>3</sup></td> </tr>
         <tr> <td BGCOLOR="#EBEBEB">DECOY</td> <td>INT (0 or 1)</td> <td> Whether this is a decoy precursor (1: decoy, 0: target) </td> </tr>
       </table>
       </td><td valign="top">
@@ -209,6 +212,13 @@ namespace OpenMS
             <li> PEPT(Phosphorylation)IDEAK[+8] -> gets label "PEPTIDEAK_gr2"  </li>
             </ul>
         </li>
+        <li>
+          3. optional columns (only filled for peptide precursors). If present,
+          OpenSWATH uses these precomputed values for the DIA precursor isotope
+          and b/y ion scores instead of computing them for every peak group.
+          Libraries without these columns are still supported, the values are
+          then computed on the fly.
+        </li>
       </ul>
       </p>
 
@@ -231,6 +241,20 @@ private:
     */
     void readPQPInput_(const char* filename, std::vector<TSVTransition>& transition_list, bool legacy_traml_id = false);
 
+    /** @brief Read the precomputed theoretical values of the precursors (if present)
+     *
+     * Fills the isotope envelope and the b/y ion series of the compounds in
+     * @p targeted_exp from the optional ISOTOPE_ENVELOPE, BSERIES and YSERIES
+     * columns of the PRECURSOR table. Nothing is done if the columns are
+     * absent (older files).
+     *
+     * @param filename The input file
+     * @param targeted_exp The targeted experiment (compounds are matched by id)
+     * @param legacy_traml_id Should legacy TraML IDs be used (boolean)?
+     *
+    */
+    void readPQPTheoreticalValues_(const char* filename, OpenSwath::LightTargetedExperiment& targeted_exp, bool legacy_traml_id = false);
+
     /** @brief Write a TargetedExperiment to a file
      *
      * @param filename Name of the output file
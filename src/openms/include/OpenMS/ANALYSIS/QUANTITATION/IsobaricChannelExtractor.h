@@ -39,11 +39,14 @@
 #include <OpenMS/KERNEL/MSExperiment.h>
 #include <OpenMS/KERNEL/StandardTypes.h>
 
+#include <functional>
+
 namespace OpenMS
 {
   class IsobaricQuantitationMethod;
   class ConsensusMap;
   class ConsensusFeature;
+  class OnDiscMSExperiment;
 
   /**
     @brief Extracts individual channels from MS/MS spectra for isobaric labeling experiments.
@@ -91,48 +94,54 @@ public:
     */
     void extractChannels(const PeakMap& ms_exp_data, ConsensusMap& consensus_map);
 
-private:
     /**
-      @brief Small struct to capture the current state of the purity computation.
-
-      It basically contains two iterators pointing to the current potential
-      MS1 precursor scan of an MS2 scan and the MS1 scan immediately
-      following the current MS2 scan.
-    */
-    struct PuritySate_
-    {
-      /// Iterator pointing to the potential MS1 precursor scan
-      PeakMap::ConstIterator precursorScan;
-      /// Iterator pointing to the potential follow up MS1 scan
-      PeakMap::ConstIterator followUpScan;
-
-      /// Indicates if a follow up scan was found
-      bool hasFollowUpScan;
-      /// reference to the experiment to analyze
-      const PeakMap& baseExperiment;
+      @brief Extracts the isobaric channels from tandem MS data on disk (indexed mzML) and stores intensity values in a consensus map.
 
-      /**
-        @brief C'tor taking the experiment that will be analyzed.
+      Only the spectra used for quantification and the MS1 spectra needed for the precursor purity computation are
+      decoded, a few at a time. The result is identical to extractChannels(const PeakMap&, ConsensusMap&) on the fully
+      loaded data.
 
-        @param targetExp The experiment that will be analyzed.
-      */
-      PuritySate_(const PeakMap& targetExp);
-
-      /**
-        @brief Searches the experiment for the next MS1 spectrum with a retention time bigger then @p rt.
+      @param ms_exp_data Raw data to search for isobaric quantitation channels. The meta data of the spectra must have been loaded.
+      @param consensus_map Output map containing the identified channels and the corresponding intensities.
 
-        @param rt The next follow up scan should have a retention bigger then this value.
-      */
-      void advanceFollowUp(const double rt);
+      @throw Exception::MissingInformation if the meta data of @p ms_exp_data is not available
+    */
+    void extractChannels(const OnDiscMSExperiment& ms_exp_data, ConsensusMap& consensus_map);
 
-      /**
-        @brief Check if the currently selected follow up scan has a retention time bigger then the given value.
+private:
+    /// Positions (in the experiment) of a quantitation scan and of the spectra needed to process it
+    struct QuantScan_
+    {
+      /// The MS2 or MS3 scan used for quantification
+      Size scan;
+      /// The preceding MS1 scan (the potential precursor scan)
+      Size precursor_scan;
+      /// The following MS1 scan (used for interpolation of the precursor purity)
+      Size follow_up_scan;
+      /// The MS2 scan with the MS1 precursor information (the scan itself for MS2 quantification)
+      Size ms2_scan;
+      /// Whether the precursor fulfills all constraints for extraction
+      bool valid_precursor;
+    };
 
-        @param rt The retention time to check.
-      */
-      bool followUpValid(const double rt);
+    /// Channel intensities and quality control information extracted from a single quantitation scan
+    struct ScanResult_
+    {
+      /// Whether the scan has no peaks (it is skipped)
+      bool empty = true;
+      /// Precursor purity (negative if it could not be computed)
+      double precursor_purity = -1.0;
+      /// Reporter intensities (one per channel)
+      std::vector<Peak2D::IntensityType> intensities;
+      /// Distance between expected and observed reporter ion m/z (one per channel, NaN if no signal was found)
+      std::vector<double> mz_deltas;
+      /// Whether more than one peak was found within the allowed reporter mass shift (one per channel)
+      std::vector<bool> signal_not_unique;
     };
 
+    /// Provides the spectrum with a given index (either from memory, or decoded into the given buffer)
+    typedef std::function<const MSSpectrum& (Size, MSSpectrum&)> SpectrumLoader_;
+
     /// The used quantitation method (itraq4plex, tmt6plex,..).
     const IsobaricQuantitationMethod* quant_method_;
 
@@ -164,7 +173,7 @@ private:
     bool interpolate_precursor_purity_;
 
     /// add channel information to the map after it has been filled
-    void registerChannelsInOutputMap_(ConsensusMap& consensus_map);
+    void registerChannelsInOutputMap_(ConsensusMap& consensus_map) const;
 
     /**
       @brief Checks if the given precursor fulfills all constraints for extractions.
@@ -183,22 +192,63 @@ private:
     bool hasLowIntensityReporter_(const ConsensusFeature& cf) const;
 
     /**
-      @brief Computes the purity of the precursor given an iterator pointing to the MS/MS spectrum and one to the precursor spectrum.
+      @brief Computes the purity of the precursor of an MS/MS spectrum, interpolated between the precursor spectrum and the following MS1 spectrum.
 
-      @param ms2_spec Iterator pointing to the MS2 spectrum.
-      @param precursor Iterator pointing to the precursor spectrum of ms2_spec.
+      @param ms2_spec The MS/MS spectrum.
+      @param precursor_spec The precursor spectrum of @p ms2_spec.
+      @param follow_up_spec The MS1 spectrum following @p ms2_spec (null if there is none).
       @return Fraction of the total intensity in the isolation window of the precursor spectrum that was assigned to the precursor.
     */
-    double computePrecursorPurity_(const PeakMap::ConstIterator& ms2_spec, const PuritySate_& pState) const;
+    double computePrecursorPurity_(const MSSpectrum& ms2_spec, const MSSpectrum& precursor_spec, const MSSpectrum* follow_up_spec) const;
 
     /**
-      @brief Computes the purity of the precursor given an iterator pointing to the MS/MS spectrum and a reference to the potential precursor spectrum.
+      @brief Computes the purity of the precursor given the MS/MS spectrum and the potential precursor spectrum.
 
-      @param ms2_spec Iterator pointing to the MS2 spectrum.
-      @param precursor Iterator pointing to the precursor spectrum of ms2_spec.
+      @param ms2_spec The MS/MS spectrum.
+      @param precursor_spec The potential precursor spectrum of @p ms2_spec.
       @return Fraction of the total intensity in the isolation window of the precursor spectrum that was assigned to the precursor.
     */
-    double computeSingleScanPrecursorPurity_(const PeakMap::ConstIterator& ms2_spec, const PeakMap::SpectrumType& precursor_spec) const;
+    double computeSingleScanPrecursorPurity_(const MSSpectrum& ms2_spec, const MSSpectrum& precursor_spec) const;
+
+    /**
+      @brief Selects the scans used for quantification (highest MS level with a valid activation method) and locates the MS1 and MS2 scans needed to process them.
+
+      Only the meta data of the spectra is used.
+
+      @param exp_meta The experiment (peak data is not required).
+      @param quant_scans Output: the quantitation scans in the order of the experiment.
+      @return $false$ if no scans pass the activation mode filter, $true$ otherwise.
+    */
+    bool selectQuantScans_(const PeakMap& exp_meta, std::vector<QuantScan_>& quant_scans) const;
+
+    /**
+      @brief Computes the precursor purity and reporter intensities of all quantitation scans.
+
+      Scans sharing the same precursor scan are processed together, these groups are processed in parallel.
+
+      @param quant_scans The quantitation scans (see selectQuantScans_()).
+      @param make_loader Creates a spectrum loader for the current thread.
+      @param results Output: one result per quantitation scan.
+    */
+    void extractQuantScans_(const std::vector<QuantScan_>& quant_scans, const std::function<SpectrumLoader_()>& make_loader, std::vector<ScanResult_>& results) const;
+
+    /**
+      @brief Extracts the reporter intensities from a single quantitation spectrum.
+
+      @param spec The quantitation spectrum.
+      @param result Output: intensities and quality control information.
+    */
+    void extractReporterIntensities_(const MSSpectrum& spec, ScanResult_& result) const;
+
+    /**
+      @brief Applies the filters to the extraction results and fills the consensus map (in the order of the quantitation scans).
+
+      @param exp_meta The experiment (peak data is not required).
+      @param quant_scans The quantitation scans.
+      @param results The extraction results for @p quant_scans.
+      @param consensus_map Output map.
+    */
+    void fillConsensusMap_(const PeakMap& exp_meta, const std::vector<QuantScan_>& quant_scans, const std::vector<ScanResult_>& results, ConsensusMap& consensus_map) const;
 
     /**
       @brief Get the first (of potentially many) activation methods (HCD,CID,...) of this spectrum.
@@ -41,6 +41,10 @@
 #include <OpenMS/METADATA/ProteinIdentification.h>
 #include <OpenMS/METADATA/ExperimentalDesign.h>
 
+#include <boost/container/flat_map.hpp>
+
+#include <numeric>
+
 namespace OpenMS
 {
   /**
@@ -48,6 +52,10 @@ namespace OpenMS
 
       This class is used by @ref TOPP_ProteinQuantifier. See there for further documentation.
 
+      Peptides (in quantifyPeptides()) and proteins (in quantifyProteins()) are quantified in parallel, abundances are collected in vectors indexed by sample ID for the aggregation and normalization steps.
+
+      Per-sample abundances (SampleAbundances) are stored in sorted flat maps rather than node-based maps, which keeps the memory footprint close to that of a plain vector of (sample, abundance) pairs for studies with many samples.
+
       @htmlinclude OpenMS_PeptideAndProteinQuant.parameters
   */
   class OPENMS_DLLAPI PeptideAndProteinQuant :
@@ -55,8 +63,8 @@ namespace OpenMS
   {
 public:
 
-    /// Mapping: sample ID -> abundance
-    typedef std::map<UInt64, double> SampleAbundances;
+    /// Mapping: sample ID -> abundance (sorted by sample ID)
+    typedef boost::container::flat_map<UInt64, double> SampleAbundances;
 
     /// Quantitative and associated data for a peptide
     struct PeptideData
@@ -163,7 +163,23 @@ namespace OpenMS
     /// Choose best SVM parameters based on cross-validation results
     std::pair<double, double> chooseBestParameters_() const;
 
-    /// Run cross-validation to optimize SVM parameters
+    /// Assign the training observations to cross-validation partitions (stratified by class, reproducible)
+    std::vector<Size> partitionData_() const;
+
+    /**
+       @brief Train on all but one partition of the training data and predict the remaining one
+
+       @return Number of correctly predicted observations in partition @p part
+    */
+    Size crossValidatePartition_(const struct svm_parameter& params,
+                                 const std::vector<Size>& partitions,
+                                 Size part) const;
+
+    /**
+       @brief Run cross-validation to optimize SVM parameters
+
+       All combinations of parameter values and partitions are evaluated in parallel (if OpenMP is enabled); the results do not depend on the number of threads.
+    */
     void optimizeParameters_();
   };
 }
@@ -42,6 +42,8 @@
 #include <OpenMS/CHEMISTRY/EnzymaticDigestion.h>
 //#include <numeric>
 
+#include <unordered_map>
+
 namespace OpenMS
 {
   class OPENMS_DLLAPI OPXLDataStructs
@@ -294,6 +296,29 @@ namespace OpenMS
         }
       };
 
+      /**
+       * @brief The LinearFragmentLadders struct holds the linear fragment ions of all peptides of a search.
+
+          For every peptide, the ladder contains the m/z values of all linear fragment ions that could be part of a
+          linear theoretical spectrum of this peptide (i.e. for any cross-link position), sorted in ascending order.
+          It is computed once per search by OPXLHelper::computeLinearFragmentLadders and is used to reject candidates
+          with too few linear fragment matches before generating their theoretical spectra (see OPXLHelper::hasLinearFragmentMatches).
+          The m/z values are stored in single precision to keep the memory footprint of large databases low.
+          The peptides are identified by the addresses of their sequences, so the vector of peptides the ladders were computed for
+          must not be modified while they are in use.
+       */
+      struct LinearFragmentLadders
+      {
+        std::vector< std::vector< float > > ladders; ///< sorted linear fragment ion m/z values of each peptide
+        std::unordered_map< const AASequence*, Size > peptide_index; ///< index in ladders of each peptide sequence
+
+        /// returns the ladder of @p peptide, throws std::out_of_range if it is not part of the indexed peptides
+        const std::vector< float >& getLadder(const AASequence* peptide) const
+        {
+          return ladders[peptide_index.at(peptide)];
+        }
+      };
+
       /**
        * @brief The PreprocessedPairSpectra struct represents the result of comparing a light and a heavy labeled spectra to each other.
 
@@ -36,6 +36,7 @@
 
 #include <OpenMS/KERNEL/StandardTypes.h>
 #include <OpenMS/ANALYSIS/XLMS/OPXLDataStructs.h>
+#include <OpenMS/CHEMISTRY/SimpleTSGXLMS.h>
 #include <OpenMS/CHEMISTRY/ResidueModification.h>
 #include <OpenMS/FORMAT/FASTAFile.h>
 #include <OpenMS/CHEMISTRY/EnzymaticDigestion.h>
@@ -98,6 +99,10 @@ namespace OpenMS
           Assumes the list of peptides and the list of spectrum precursor masses are sorted by mass in ascending order,
           and the list of mono-link masses is sorted in descending order.
 
+          For each precursor mass and alpha peptide, only the beta peptides complementing the precursor mass within the tolerance
+          are visited (binary search in the sorted peptide list). The alpha peptides are processed in parallel, the order of the
+          result does not depend on the number of threads.
+
        * @param peptides The peptides with precomputed masses from the digestDatabase function
        * @param cross_link_mass_light Mass of the cross-linker, only the light one if a labeled linker is used
        * @param cross_link_mass_mono_link A list of possible masses for the cross-link, if it is attached to a peptide on one side
@@ -111,6 +116,38 @@ namespace OpenMS
        */
       static std::vector<OPXLDataStructs::XLPrecursor> enumerateCrossLinksAndMasses(const std::vector<OPXLDataStructs::AASeqWithMass>&  peptides, double cross_link_mass_light, const DoubleList& cross_link_mass_mono_link, const StringList& cross_link_residue1, const StringList& cross_link_residue2, const std::vector< double >& spectrum_precursors, std::vector< int >& precursor_correction_positions, double precursor_mass_tolerance, bool precursor_mass_tolerance_unit_ppm);
 
+      /**
+       * @brief Precomputes the linear fragment ion ladders of all peptides of a search
+
+          The ladder of a peptide is the union of the linear theoretical spectra of @p spec_gen for all cross-link positions,
+          i.e. all prefix ions and all suffix ions of the peptide up to @p charge. It is a superset of every linear
+          theoretical spectrum generated for a candidate containing this peptide with the same generator and charge.
+          The ladders are computed in parallel.
+
+       * @param peptides The peptides of the search, e.g. from digestDatabase. Must not be modified while the ladders are in use.
+       * @param spec_gen The spectrum generator used to generate the linear theoretical spectra during the search
+       * @param charge The maximal charge of the linear fragment ions
+       * @return The ladders of all peptides
+       */
+      static OPXLDataStructs::LinearFragmentLadders computeLinearFragmentLadders(const std::vector<OPXLDataStructs::AASeqWithMass>& peptides, const SimpleTSGXLMS& spec_gen, int charge);
+
+      /**
+       * @brief Fast check, whether a peptide could have at least @p min_matches linear fragment peak matches
+
+          Counts the ions in the ladder that have an experimental peak within the fragment mass tolerance (ignoring charges).
+          Since the ladder is a superset of the linear theoretical spectrum of the peptide for any cross-link position,
+          this count is an upper bound of the number of matches found by OPXLSpectrumProcessingAlgorithms::getSpectrumAlignmentSimple.
+          If this function returns false, the candidate can be rejected without generating its theoretical spectra.
+
+       * @param ladder The ladder of the peptide from computeLinearFragmentLadders
+       * @param exp_spectrum The experimental spectrum (sorted by m/z)
+       * @param min_matches The minimal number of matching ions
+       * @param fragment_mass_tolerance The fragment mass tolerance
+       * @param fragment_mass_tolerance_unit_ppm Whether the fragment mass tolerance is in ppm (or Da)
+       * @return Whether at least @p min_matches ions of the ladder have a matching experimental peak
+       */
+      static bool hasLinearFragmentMatches(const std::vector< float >& ladder, const PeakSpectrum& exp_spectrum, Size min_matches, double fragment_mass_tolerance, bool fragment_mass_tolerance_unit_ppm);
+
       /**
        * @brief Digests a database with the given EnzymaticDigestion settings and precomputes masses for all peptides
 
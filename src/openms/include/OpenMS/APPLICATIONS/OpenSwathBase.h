@@ -374,6 +374,12 @@ protected:
    *        the transformation parameters will be stored in this file)
    * @param irt_mzml_out Output Chromatogram mzML containing the iRT peptides (if not empty,
    *        iRT chromatograms will be stored in this file)
+   * @param calibration_cache_in trafoXML file with the calibration of a previous run (if not empty,
+   *        the calibration is reused if it still fits the data, see
+   *        OpenMS::OpenSwathCalibrationWorkflow::reuseCachedCalibration; otherwise a full
+   *        calibration is performed)
+   * @param calibration_cache_out Output trafoXML file for the calibration (reused or new) to be
+   *        passed as @p calibration_cache_in to later runs (if not empty)
    *
    */
   TransformationDescription performCalibration(String trafo_in,
@@ -389,21 +395,28 @@ protected:
         bool sonar,
         bool load_into_memory,
         const String& irt_trafo_out,
-        const String& irt_mzml_out)
+        const String& irt_mzml_out,
+        const String& calibration_cache_in = "",
+        const String& calibration_cache_out = "")
   {
     TransformationDescription trafo_rtnorm;
 
-    if (!trafo_in.empty())
+    // get read RT normalization file
+    auto loadTrafo = [&](const String& file, TransformationDescription& trafo)
     {
-      // get read RT normalization file
       TransformationXMLFile trafoxml;
-      trafoxml.load(trafo_in, trafo_rtnorm, false);
+      trafoxml.load(file, trafo, false);
       Param model_params = getParam_().copy("model:", true);
       model_params.setValue("symmetric_regression", "false");
       model_params.setValue("span", irt_detection_param.getValue("lowess:span"));
       model_params.setValue("num_nodes", irt_detection_param.getValue("b_spline:num_nodes"));
       String model_type = irt_detection_param.getValue("alignmentMethod");
-      trafo_rtnorm.fitModel(model_type, model_params);
+      trafo.fitModel(model_type, model_params);
+    };
+
+    if (!trafo_in.empty())
+    {
+      loadTrafo(trafo_in, trafo_rtnorm);
     }
     else if (!irt_tr_file.empty())
     {
@@ -418,12 +431,35 @@ protected:
       OpenSwathCalibrationWorkflow wf;
       wf.setLogType(log_type_);
       TransformationDescription im_trafo;
-      trafo_rtnorm = wf.performRTNormalization(irt_transitions, swath_maps, im_trafo,
-                                               min_rsq, min_coverage,
-                                               feature_finder_param,
-                                               cp_irt, irt_detection_param,
-                                               calibration_param, irt_mzml_out, debug_level, sonar,
-                                               load_into_memory);
+
+      // try to reuse the calibration of a previous run
+      bool cache_used = false;
+      if (!calibration_cache_in.empty())
+      {
+        std::cout << "Will try to reuse the calibration stored in " << calibration_cache_in << std::endl;
+        loadTrafo(calibration_cache_in, trafo_rtnorm);
+        ChromExtractParams cp_cache = cp_irt;
+        cp_cache.rt_extraction_window = irt_detection_param.getValue("cacheRTExtractionWindow");
+        cache_used = wf.reuseCachedCalibration(irt_transitions, swath_maps, trafo_rtnorm, im_trafo,
+                                               irt_detection_param.getValue("cacheMaxResidual"), min_coverage,
+                                               feature_finder_param, cp_cache, irt_detection_param,
+                                               calibration_param, sonar, load_into_memory);
+      }
+
+      if (!cache_used)
+      {
+        trafo_rtnorm = wf.performRTNormalization(irt_transitions, swath_maps, im_trafo,
+                                                 min_rsq, min_coverage,
+                                                 feature_finder_param,
+                                                 cp_irt, irt_detection_param,
+                                                 calibration_param, irt_mzml_out, debug_level, sonar,
+                                                 load_into_memory);
+      }
+
+      if (!calibration_cache_out.empty())
+      {
+        TransformationXMLFile().store(calibration_cache_out, trafo_rtnorm);
+      }
 
       if (!irt_trafo_out.empty())
       {
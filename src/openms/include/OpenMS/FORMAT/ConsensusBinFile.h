@@ -0,0 +1,152 @@
+// --------------------------------------------------------------------------
+//                   OpenMS -- Open-Source Mass Spectrometry
+// --------------------------------------------------------------------------
+// Copyright The OpenMS Team -- Eberhard Karls University Tuebingen,
+// ETH Zurich, and Freie Universitaet Berlin 2002-2020.
+//
+// This software is released under a three-clause BSD license:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of any author or any participating institution
+//    may be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+// For a full list of authors, refer to the file AUTHORS.
+// --------------------------------------------------------------------------
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL ANY OF THE AUTHORS OR THE CONTRIBUTING
+// INSTITUTIONS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// --------------------------------------------------------------------------
+// $Maintainer: agent $
+// $Authors: agent $
+// --------------------------------------------------------------------------
+
+
+#pragma once
+
+#include <OpenMS/CONCEPT/ProgressLogger.h>
+#include <OpenMS/FORMAT/HANDLERS/ColumnarBinaryHandler.h>
+#include <OpenMS/FORMAT/OPTIONS/FeatureFileOptions.h>
+#include <OpenMS/KERNEL/ConsensusMap.h>
+
+namespace OpenMS
+{
+  /**
+    @brief Binary, memory-mappable alternative to consensusXML (.consensusBin)
+
+    Consensus features and their feature handles are stored column by column
+    (see FeatureBinFile), followed by optional sections for ratios and peptide
+    identifications (stored as in IdBinFile).
+
+    Of the load options (FeatureFileOptions) the RT, m/z and intensity ranges,
+    the metadata-only flag and the peptide identification flag apply, the
+    convex hull and subordinate flags are ignored. Consensus features outside
+    of the ranges are discarded based on the coordinate columns, without
+    reading their handles or identifications.
+
+    For tools that only need coordinates and intensities (e.g. normalization),
+    open() maps the file into memory and provides direct access to single
+    columns of the consensus features and their handles.
+
+    @ingroup FileIO
+  */
+  class OPENMS_DLLAPI ConsensusBinFile :
+    public ProgressLogger
+  {
+public:
+    /// Content tag of the file header
+    static const char* const CONTENT_TAG;
+
+    /// Constructor
+    ConsensusBinFile();
+
+    /// Destructor
+    ~ConsensusBinFile();
+
+    /**
+      @brief Loads a consensusBin file into @p consensus_map and calls updateRanges()
+
+      @exception Exception::FileNotFound is thrown if the file could not be opened
+      @exception Exception::ParseError is thrown if the file is not a valid consensusBin file
+    */
+    void load(const String& filename, ConsensusMap& consensus_map);
+
+    /**
+      @brief Stores @p consensus_map in a consensusBin file
+
+      @exception Exception::UnableToCreateFile is thrown if the file could not be created
+    */
+    void store(const String& filename, const ConsensusMap& consensus_map);
+
+    /// Mutable access to the options for loading
+    FeatureFileOptions& getOptions();
+
+    /// Non-mutable access to the options for loading
+    const FeatureFileOptions& getOptions() const;
+
+    /// Sets the options for loading
+    void setOptions(const FeatureFileOptions& options);
+
+    /** @name Lazy access
+
+        After calling open(), the following functions read single columns
+        directly from the memory-mapped file. They throw
+        Exception::IllegalArgument if no file is open.
+    */
+    //@{
+    /**
+      @brief Maps a consensusBin file into memory for lazy access
+
+      @exception Exception::FileNotFound is thrown if the file could not be opened
+      @exception Exception::ParseError is thrown if the file is not a valid consensusBin file
+    */
+    void open(const String& filename);
+
+    /// Number of consensus features
+    Size size() const;
+
+    /// Retention times of all consensus features
+    std::vector<double> getRTs() const;
+
+    /// m/z values of all consensus features
+    std::vector<double> getMZs() const;
+
+    /// Intensities of all consensus features
+    std::vector<float> getIntensities() const;
+
+    /// Qualities of all consensus features
+    std::vector<float> getQualities() const;
+
+    /// Index of the first handle of each consensus feature (plus one past-the-end entry)
+    std::vector<UInt64> getHandleOffsets() const;
+
+    /// Map indices of all feature handles
+    std::vector<UInt64> getHandleMapIndices() const;
+
+    /// Intensities of all feature handles
+    std::vector<float> getHandleIntensities() const;
+    //@}
+
+protected:
+    /// Throws if no file has been opened
+    void checkOpen_() const;
+
+    /// Options for loading
+    FeatureFileOptions options_;
+
+    /// Reader of the file opened for lazy access
+    Internal::ColumnarBinaryReader reader_;
+  };
+
+} // namespace OpenMS
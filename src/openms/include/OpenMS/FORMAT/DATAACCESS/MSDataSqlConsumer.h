@@ -94,6 +94,11 @@ namespace OpenMS
       */
       void flush();
 
+      /**
+        @brief Use byte shuffling for lossless compression (see MzMLSqliteHandler::setByteShuffle())
+      */
+      void setByteShuffle(bool byte_shuffle);
+
       /**
         @brief Write a spectrum to the output file
       */
@@ -0,0 +1,174 @@
+// --------------------------------------------------------------------------
+//                   OpenMS -- Open-Source Mass Spectrometry
+// --------------------------------------------------------------------------
+// Copyright The OpenMS Team -- Eberhard Karls University Tuebingen,
+// ETH Zurich, and Freie Universitaet Berlin 2002-2020.
+//
+// This software is released under a three-clause BSD license:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of any author or any participating institution
+//    may be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+// For a full list of authors, refer to the file AUTHORS.
+// --------------------------------------------------------------------------
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL ANY OF THE AUTHORS OR THE CONTRIBUTING
+// INSTITUTIONS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// --------------------------------------------------------------------------
+// $Maintainer: agent $
+// $Authors: agent $
+// --------------------------------------------------------------------------
+
+
+#pragma once
+
+#include <OpenMS/CONCEPT/ProgressLogger.h>
+#include <OpenMS/FORMAT/HANDLERS/ColumnarBinaryHandler.h>
+#include <OpenMS/FORMAT/OPTIONS/FeatureFileOptions.h>
+#include <OpenMS/KERNEL/FeatureMap.h>
+
+namespace OpenMS
+{
+  /**
+    @brief Binary, memory-mappable alternative to featureXML (.featureBin)
+
+    Features are stored column by column (RT, m/z, intensity, qualities,
+    charge, ...), followed by optional sections for convex hulls and peptide
+    identifications (stored as in IdBinFile). Subordinate features are stored
+    in the same columns, directly after their parent feature.
+
+    Because every section can be read independently, the options
+    (see FeatureFileOptions) are applied without reading the skipped data at
+    all: convex hulls, subordinates or peptide identifications are simply not
+    touched, and features outside of the RT, m/z or intensity range are
+    discarded based on the coordinate columns before anything else is
+    materialized.
+
+    For tools that only need coordinates and intensities, open() maps the file
+    into memory and provides direct access to single columns of the
+    (top-level) features, e.g. getRTs() or getIntensities().
+
+    @note Model descriptions of features are not stored, as in featureXML.
+
+    @ingroup FileIO
+  */
+  class OPENMS_DLLAPI FeatureBinFile :
+    public ProgressLogger
+  {
+public:
+    /// Content tag of the file header
+    static const char* const CONTENT_TAG;
+
+    /// Constructor
+    FeatureBinFile();
+
+    /// Destructor
+    ~FeatureBinFile();
+
+    /**
+      @brief Loads a featureBin file into @p feature_map and calls updateRanges()
+
+      @exception Exception::FileNotFound is thrown if the file could not be opened
+      @exception Exception::ParseError is thrown if the file is not a valid featureBin file
+    */
+    void load(const String& filename, FeatureMap& feature_map);
+
+    /// Returns the number of (top-level) features stored in @p filename
+    Size loadSize(const String& filename);
+
+    /**
+      @brief Stores @p feature_map in a featureBin file
+
+      @exception Exception::UnableToCreateFile is thrown if the file could not be created
+    */
+    void store(const String& filename, const FeatureMap& feature_map);
+
+    /// Mutable access to the options for loading
+    FeatureFileOptions& getOptions();
+
+    /// Non-mutable access to the options for loading
+    const FeatureFileOptions& getOptions() const;
+
+    /// Sets the options for loading
+    void setOptions(const FeatureFileOptions& options);
+
+    /** @name Lazy access
+
+        After calling open(), the following functions read single columns of
+        the top-level features directly from the memory-mapped file. They throw
+        Exception::IllegalArgument if no file is open.
+    */
+    //@{
+    /**
+      @brief Maps a featureBin file into memory for lazy access
+
+      @exception Exception::FileNotFound is thrown if the file could not be opened
+      @exception Exception::ParseError is thrown if the file is not a valid featureBin file
+    */
+    void open(const String& filename);
+
+    /// Number of (top-level) features
+    Size size() const;
+
+    /// Retention times of all features
+    std::vector<double> getRTs() const;
+
+    /// m/z values of all features
+    std::vector<double> getMZs() const;
+
+    /// Intensities of all features
+    std::vector<float> getIntensities() const;
+
+    /// Overall qualities of all features
+    std::vector<float> getQualities() const;
+
+    /// Charges of all features
+    std::vector<Int> getCharges() const;
+
+    /// Unique ids of all features
+    std::vector<UInt64> getUniqueIds() const;
+    //@}
+
+protected:
+    /// Throws if no file has been opened
+    void checkOpen_() const;
+
+    /// Returns the values of column @p name for all top-level features
+    template <typename T>
+    std::vector<T> getTopLevelColumn_(const String& name) const
+    {
+      checkOpen_();
+      Internal::ColumnarBinaryReader::ColumnView<T> column = reader_.getColumn<T>(name);
+      std::vector<T> result;
+      result.reserve(top_level_.size());
+      for (UInt64 i : top_level_)
+      {
+        result.push_back(column[i]);
+      }
+      return result;
+    }
+
+    /// Options for loading
+    FeatureFileOptions options_;
+
+    /// Reader of the file opened for lazy access
+    Internal::ColumnarBinaryReader reader_;
+
+    /// Row of each top-level feature in the feature columns
+    std::vector<UInt64> top_level_;
+  };
+
+} // namespace OpenMS
@@ -114,6 +114,9 @@ namespace OpenMS
       JSON,               ///< JavaScript Object Notation file (.json)
       RAW,                ///< Thermo Raw File (.raw)
       EXE,                ///< Executable (.exe)
+      IDBIN,              ///< %OpenMS binary columnar identification format (.idBin), see IdBinFile
+      FEATUREBIN,         ///< %OpenMS binary columnar feature format (.featureBin), see FeatureBinFile
+      CONSENSUSBIN,       ///< %OpenMS binary columnar consensus feature format (.consensusBin), see ConsensusBinFile
       SIZE_OF_TYPE        ///< No file type. Simply stores the number of types
     };
 
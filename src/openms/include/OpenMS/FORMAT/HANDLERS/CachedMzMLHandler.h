@@ -47,6 +47,7 @@
 #include <fstream>
 
 #define CACHED_MZML_FILE_IDENTIFIER 8094
+#define CACHED_MZML_FILE_IDENTIFIER_COMPRESSED 8095
 
 namespace OpenMS
 {
@@ -62,6 +63,15 @@ namespace Internal
     be very fast and done in random order (once the in-memory index is built
     for the file).
 
+    Optionally (see setCompression()), the m/z (or retention time) and
+    intensity arrays of each spectrum and chromatogram are stored as a single
+    byte-shuffled and zlib-compressed block (see
+    ZlibCompression::compressShuffled()). This is lossless, reduces the file
+    size and thus the amount of data to be read from disk, at the cost of
+    decompressing the block on access. Such files carry a different file
+    identifier (CACHED_MZML_FILE_IDENTIFIER_COMPRESSED) and are rejected by
+    older versions; all reading functions support both variants.
+
   */
   class OPENMS_DLLAPI CachedMzMLHandler :
     public ProgressLogger
@@ -93,6 +103,12 @@ public:
     CachedMzMLHandler& operator=(const CachedMzMLHandler& rhs);
     //@}
 
+    /// Set whether to write the data arrays as compressed blocks (default: false)
+    void setCompression(bool compress);
+
+    /// Whether the data arrays are written as compressed blocks
+    bool getCompression() const;
+
     /** @name Read / Write a complete mass spectrometric experiment (or its meta data)
     */
     //@{
@@ -217,10 +233,16 @@ protected:
     static inline void readDataFast_(std::ifstream& ifs, std::vector<OpenSwath::BinaryDataArrayPtr>& data, const Size& data_size, 
       const Size& nr_float_arrays);
 
+    /// helper method to write the two main data arrays (uncompressed or as a compressed block)
+    void writeData_(const Datavector& data1, const Datavector& data2, std::ofstream& ofs) const;
+
     /// Members
     std::vector<std::streampos> spectra_index_;
     std::vector<std::streampos> chrom_index_;
 
+    /// Whether to write compressed data blocks
+    bool compress_;
+
   };
 }
 }
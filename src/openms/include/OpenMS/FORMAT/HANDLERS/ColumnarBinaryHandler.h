@@ -0,0 +1,438 @@
+// --------------------------------------------------------------------------
+//                   OpenMS -- Open-Source Mass Spectrometry
+// --------------------------------------------------------------------------
+// Copyright The OpenMS Team -- Eberhard Karls University Tuebingen,
+// ETH Zurich, and Freie Universitaet Berlin 2002-2020.
+//
+// This software is released under a three-clause BSD license:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of any author or any participating institution
+//    may be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+// For a full list of authors, refer to the file AUTHORS.
+// --------------------------------------------------------------------------
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL ANY OF THE AUTHORS OR THE CONTRIBUTING
+// INSTITUTIONS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// --------------------------------------------------------------------------
+// $Maintainer: agent $
+// $Authors: agent $
+// --------------------------------------------------------------------------
+
+#pragma once
+
+#include <OpenMS/CONCEPT/Exception.h>
+#include <OpenMS/CONCEPT/Types.h>
+#include <OpenMS/DATASTRUCTURES/String.h>
+#include <OpenMS/METADATA/MetaInfoInterface.h>
+
+#include <boost/iostreams/device/mapped_file.hpp>
+
+#include <cstdint>
+#include <fstream>
+#include <map>
+#include <unordered_map>
+#include <vector>
+
+namespace OpenMS
+{
+namespace Internal
+{
+
+  /**
+    @brief Type tags and traits shared by ColumnarBinaryWriter and ColumnarBinaryReader
+
+    A columnar binary file consists of a fixed size header, a sequence of
+    named, 8-byte aligned sections ("columns") and a section table at the end
+    of the file. Each column stores a contiguous array of a single plain type
+    or a string column (offsets + character data). Since the data of a column
+    is stored exactly as it is laid out in memory, a memory-mapped file can be
+    accessed without any parsing or copying.
+
+    Header layout (32 bytes):
+    - 8 bytes magic ("OMSCOLB1")
+    - 8 bytes content tag (e.g. "idBin"), zero-padded
+    - uint32 endianness marker (0x01020304) and uint32 format version
+    - uint64 offset of the section table
+
+    @note Files are written in native byte order. Reading a file written on a
+    machine with different endianness is detected and refused.
+  */
+  struct OPENMS_DLLAPI ColumnarBinaryFormat
+  {
+    /// Element types of a column
+    enum ColumnType
+    {
+      INT8 = 0,
+      UINT8,
+      INT32,
+      UINT32,
+      INT64,
+      UINT64,
+      FLOAT,
+      DOUBLE,
+      STRING,
+      SIZE_OF_COLUMNTYPE
+    };
+
+    /// Maps a plain C++ type to its ColumnType
+    template <typename T> struct TypeOf;
+
+    /// Length of the magic and content tag fields in the header
+    static const Size TAG_LENGTH = 8;
+
+    /// Size of the file header in bytes
+    static const Size HEADER_SIZE = 32;
+
+    /// Magic at the start of every columnar binary file
+    static const char MAGIC[TAG_LENGTH + 1];
+
+    /// Current format version
+    static const UInt32 VERSION = 1;
+
+    /// Returns true if @p filename starts with the columnar magic and the given @p content_tag
+    static bool hasContentTag(const String& filename, const String& content_tag);
+  };
+
+  template <> struct ColumnarBinaryFormat::TypeOf<std::int8_t> { static const ColumnType value = INT8; };
+  template <> struct ColumnarBinaryFormat::TypeOf<std::uint8_t> { static const ColumnType value = UINT8; };
+  template <> struct ColumnarBinaryFormat::TypeOf<Int32> { static const ColumnType value = INT32; };
+  template <> struct ColumnarBinaryFormat::TypeOf<UInt32> { static const ColumnType value = UINT32; };
+  template <> struct ColumnarBinaryFormat::TypeOf<Int64> { static const ColumnType value = INT64; };
+  template <> struct ColumnarBinaryFormat::TypeOf<UInt64> { static const ColumnType value = UINT64; };
+  template <> struct ColumnarBinaryFormat::TypeOf<float> { static const ColumnType value = FLOAT; };
+  template <> struct ColumnarBinaryFormat::TypeOf<double> { static const ColumnType value = DOUBLE; };
+
+  /**
+    @brief Writes named columns into a columnar binary file
+
+    Columns are written to disk as soon as they are added, so only the column
+    currently being written needs to be held in memory by the caller. The
+    section table is written by close() (or the destructor).
+
+    @code
+    ColumnarBinaryWriter writer("out.idBin", "idBin");
+    writer.addColumn("pep.rt", rts);
+    writer.addStringColumn("pool", strings);
+    writer.close();
+    @endcode
+  */
+  class OPENMS_DLLAPI ColumnarBinaryWriter
+  {
+public:
+    /**
+      @brief Opens @p filename for writing and writes the header
+
+      @exception Exception::UnableToCreateFile is thrown if the file cannot be created
+    */
+    ColumnarBinaryWriter(const String& filename, const String& content_tag);
+
+    /// Destructor (closes the file if not done yet)
+    ~ColumnarBinaryWriter();
+
+    /// Writes a column of plain values
+    template <typename T>
+    void addColumn(const String& name, const std::vector<T>& values)
+    {
+      addColumn(name, values.data(), values.size());
+    }
+
+    /// Writes a column of plain values
+    template <typename T>
+    void addColumn(const String& name, const T* values, Size size)
+    {
+      writeSection_(name, ColumnarBinaryFormat::TypeOf<T>::value, size,
+                    reinterpret_cast<const char*>(values), size * sizeof(T));
+    }
+
+    /// Writes a string column
+    void addStringColumn(const String& name, const std::vector<String>& values);
+
+    /// Writes the section table and closes the file
+    void close();
+
+protected:
+    /// Writes raw bytes of a section and registers it in the section table
+    void writeSection_(const String& name, ColumnarBinaryFormat::ColumnType type, Size size, const char* data, Size bytes);
+
+    /// Pads the output with zeros to the next 8-byte boundary
+    void align_();
+
+    struct Entry_
+    {
+      String name;
+      std::uint8_t type;
+      UInt64 size;
+      UInt64 offset;
+      UInt64 bytes;
+    };
+
+    String filename_;
+    std::ofstream ofs_;
+    std::vector<Entry_> entries_;
+    bool closed_;
+
+private:
+    ColumnarBinaryWriter(const ColumnarBinaryWriter&) = delete;
+    ColumnarBinaryWriter& operator=(const ColumnarBinaryWriter&) = delete;
+  };
+
+  /**
+    @brief Read-only view on a memory-mapped columnar binary file
+
+    Opening a file only maps it into memory and parses the section table; no
+    column data is read until accessed. Plain columns are exposed as views
+    pointing directly into the mapping (zero copy); string columns are
+    decoded on access.
+
+    Views stay valid as long as the reader is alive.
+  */
+  class OPENMS_DLLAPI ColumnarBinaryReader
+  {
+public:
+    /// Non-owning view on a plain column
+    template <typename T>
+    struct ColumnView
+    {
+      const T* data = nullptr;
+      Size length = 0;
+
+      Size size() const { return length; }
+      bool empty() const { return length == 0; }
+      const T& operator[](Size i) const { return data[i]; }
+      const T* begin() const { return data; }
+      const T* end() const { return data + length; }
+    };
+
+    /// Non-owning view on a string column
+    struct OPENMS_DLLAPI StringColumnView
+    {
+      const UInt64* offsets = nullptr;
+      const char* chars = nullptr;
+      Size length = 0;
+
+      Size size() const { return length; }
+      bool empty() const { return length == 0; }
+      /// Returns the string at position @p i (copied from the mapping)
+      String operator[](Size i) const;
+      /// Returns all strings as vector
+      std::vector<String> toVector() const;
+    };
+
+    /// Constructor (no file opened)
+    ColumnarBinaryReader();
+
+    /**
+      @brief Maps @p filename into memory and parses the section table
+
+      @exception Exception::FileNotFound is thrown if the file does not exist
+      @exception Exception::ParseError is thrown if the file is not a columnar binary file with the given @p content_tag
+    */
+    ColumnarBinaryReader(const String& filename, const String& content_tag);
+
+    /// Maps a file (see constructor)
+    void open(const String& filename, const String& content_tag);
+
+    /// Returns true if a file is mapped
+    bool isOpen() const;
+
+    /// Returns true if a column with the given name exists
+    bool hasColumn(const String& name) const;
+
+    /// Returns the number of elements of a column (0 if it does not exist)
+    Size getColumnSize(const String& name) const;
+
+    /**
+      @brief Returns a view on a plain column
+
+      @exception Exception::ElementNotFound is thrown if the column does not exist
+      @exception Exception::ParseError is thrown if the stored type does not match @p T
+    */
+    template <typename T>
+    ColumnView<T> getColumn(const String& name) const
+    {
+      const Entry_& e = findEntry_(name, ColumnarBinaryFormat::TypeOf<T>::value);
+      ColumnView<T> view;
+      view.data = reinterpret_cast<const T*>(file_.data() + e.offset);
+      view.length = e.size;
+      return view;
+    }
+
+    /// Returns a copy of a plain column or an empty vector if the column does not exist
+    template <typename T>
+    std::vector<T> getColumnOrEmpty(const String& name) const
+    {
+      if (!hasColumn(name)) return std::vector<T>();
+      ColumnView<T> view = getColumn<T>(name);
+      return std::vector<T>(view.begin(), view.end());
+    }
+
+    /**
+      @brief Returns a view on a string column
+
+      @exception Exception::ElementNotFound is thrown if the column does not exist
+      @exception Exception::ParseError is thrown if the column is not a string column
+    */
+    StringColumnView getStringColumn(const String& name) const;
+
+    /// Names of all columns in the file
+    std::vector<String> getColumnNames() const;
+
+protected:
+    struct Entry_
+    {
+      std::uint8_t type;
+      UInt64 size;
+      UInt64 offset;
+      UInt64 bytes;
+    };
+
+    /// Looks up a column and checks its type
+    const Entry_& findEntry_(const String& name, ColumnarBinaryFormat::ColumnType type) const;
+
+    String filename_;
+    boost::iostreams::mapped_file_source file_;
+    std::unordered_map<std::string, Entry_> entries_;
+  };
+
+  /**
+    @brief Deduplicating pool of strings, stored as a single string column
+
+    Repeated strings (score types, identifiers, accessions, ...) are stored
+    once and referenced by their index in the pool.
+  */
+  class OPENMS_DLLAPI ColumnarStringPool
+  {
+public:
+    /// Returns the index of @p s, adding it to the pool if necessary
+    UInt32 index(const String& s);
+
+    /// All strings in order of insertion
+    const std::vector<String>& strings() const;
+
+    /// Number of strings in the pool
+    Size size() const;
+
+protected:
+    std::vector<String> strings_;
+    std::unordered_map<std::string, UInt32> index_;
+  };
+
+  /**
+    @brief Stores the meta values of many MetaInfoInterface objects in columnar form
+
+    Meta values are collected per object ("row") and written as a set of
+    parallel columns with the given prefix, grouped by meta value key (in the
+    order in which the keys were first seen, i.e. by their index in @em p.meta.keys,
+    not by name) so that the values of a single key form a contiguous range (a
+    "meta value column") which can be read without touching the others. Within a
+    key, the values keep the order of the rows.
+
+    Columns (prefix @em p): @em p.meta.keys (names), @em p.meta.row, @em p.meta.key,
+    @em p.meta.type, @em p.meta.int, @em p.meta.double, @em p.meta.size and
+    @em p.meta.strings, @em p.meta.list_int, @em p.meta.list_double for the
+    payload of strings and lists.
+  */
+  class OPENMS_DLLAPI ColumnarMetaInfoWriter
+  {
+public:
+    /// Adds all meta values of @p meta for row @p row
+    void add(UInt64 row, const MetaInfoInterface& meta);
+
+    /// Writes the collected meta values
+    void write(ColumnarBinaryWriter& writer, const String& prefix);
+
+protected:
+    struct Entry_
+    {
+      UInt64 row;
+      UInt32 key;
+      DataValue value;
+    };
+
+    std::vector<Entry_> entries_;
+    ColumnarStringPool keys_;
+  };
+
+  /// Counterpart of ColumnarMetaInfoWriter
+  class OPENMS_DLLAPI ColumnarMetaInfoReader
+  {
+public:
+    /**
+      @brief Reads the meta values written with @p prefix
+
+      @p target is called with the row index and must return the
+      MetaInfoInterface of that row (or nullptr to skip the value).
+      Missing meta columns are silently ignored.
+    */
+    template <typename RowToMeta>
+    static void read(const ColumnarBinaryReader& reader, const String& prefix, RowToMeta target)
+    {
+      ColumnarMetaInfoReader r(reader, prefix);
+      for (Size i = 0; i < r.size(); ++i)
+      {
+        MetaInfoInterface* meta = target(r.row(i));
+        if (meta != nullptr)
+        {
+          meta->setMetaValue(r.key(i), r.value(i));
+        }
+      }
+    }
+
+    /// Opens the meta columns with @p prefix (empty if not present)
+    ColumnarMetaInfoReader(const ColumnarBinaryReader& reader, const String& prefix);
+
+    /// Number of stored meta values
+    Size size() const;
+
+    /// Row of the @p i-th meta value
+    UInt64 row(Size i) const;
+
+    /// Name of the @p i-th meta value
+    const String& key(Size i) const;
+
+    /// Value of the @p i-th meta value
+    DataValue value(Size i) const;
+
+    /// Returns all (row, value) pairs for one meta value name
+    std::vector<std::pair<UInt64, DataValue> > getColumn(const String& key) const;
+
+    /**
+      @brief Indices of all meta values that belong to rows [@p first, @p last)
+
+      The first call builds a row index (not thread-safe).
+    */
+    std::vector<Size> findRows(UInt64 first, UInt64 last) const;
+
+protected:
+    std::vector<String> keys_;
+    ColumnarBinaryReader::ColumnView<UInt64> rows_;
+    ColumnarBinaryReader::ColumnView<UInt32> key_idx_;
+    ColumnarBinaryReader::ColumnView<std::uint8_t> types_;
+    ColumnarBinaryReader::ColumnView<Int64> ints_;
+    ColumnarBinaryReader::ColumnView<double> doubles_;
+    ColumnarBinaryReader::ColumnView<UInt64> sizes_;
+    ColumnarBinaryReader::StringColumnView strings_;
+    ColumnarBinaryReader::ColumnView<Int64> list_ints_;
+    ColumnarBinaryReader::ColumnView<double> list_doubles_;
+    /// start of each list value in its list column
+    std::vector<UInt64> list_start_;
+    /// meta value indices sorted by row (built on demand)
+    mutable std::vector<Size> by_row_;
+  };
+
+} // namespace Internal
+} // namespace OpenMS
@@ -0,0 +1,96 @@
+// --------------------------------------------------------------------------
+//                   OpenMS -- Open-Source Mass Spectrometry
+// --------------------------------------------------------------------------
+// Copyright The OpenMS Team -- Eberhard Karls University Tuebingen,
+// ETH Zurich, and Freie Universitaet Berlin 2002-2020.
+//
+// This software is released under a three-clause BSD license:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of any author or any participating institution
+//    may be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+// For a full list of authors, refer to the file AUTHORS.
+// --------------------------------------------------------------------------
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL ANY OF THE AUTHORS OR THE CONTRIBUTING
+// INSTITUTIONS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// --------------------------------------------------------------------------
+// $Maintainer: agent $
+// $Authors: agent $
+// --------------------------------------------------------------------------
+
+
+#pragma once
+
+#include <OpenMS/FORMAT/HANDLERS/ColumnarBinaryHandler.h>
+#include <OpenMS/FORMAT/OPTIONS/FeatureFileOptions.h>
+#include <OpenMS/KERNEL/BaseFeature.h>
+#include <OpenMS/METADATA/DataProcessing.h>
+#include <OpenMS/METADATA/DocumentIdentifier.h>
+#include <OpenMS/CONCEPT/UniqueIdInterface.h>
+
+#include <vector>
+
+namespace OpenMS
+{
+  namespace Internal
+  {
+    /**
+      @brief Columns shared by the columnar binary feature and consensus map formats
+
+      Writes and reads the map level information (unique id, document
+      identifier, meta values and data processing) and the BaseFeature
+      columns (position, intensity, quality, charge, width, unique id) of
+      FeatureBinFile and ConsensusBinFile.
+    */
+    class OPENMS_DLLAPI ColumnarMapHandler
+    {
+public:
+      /// Views on the BaseFeature columns written with writeBaseFeatures()
+      struct OPENMS_DLLAPI BaseFeatureColumns
+      {
+        /// Opens the columns with @p prefix
+        BaseFeatureColumns(const ColumnarBinaryReader& reader, const String& prefix);
+
+        /// Number of features
+        Size size() const;
+
+        /// Sets the BaseFeature members of @p feature from row @p index (peptide identifications and meta values are not touched)
+        void fill(Size index, BaseFeature& feature) const;
+
+        /// Returns @c true if the feature in row @p index passes the RT, m/z and intensity ranges of @p options
+        bool passesFilter(Size index, const FeatureFileOptions& options) const;
+
+        ColumnarBinaryReader::ColumnView<double> rt;
+        ColumnarBinaryReader::ColumnView<double> mz;
+        ColumnarBinaryReader::ColumnView<float> intensity;
+        ColumnarBinaryReader::ColumnView<float> quality;
+        ColumnarBinaryReader::ColumnView<Int32> charge;
+        ColumnarBinaryReader::ColumnView<float> width;
+        ColumnarBinaryReader::ColumnView<UInt64> unique_id;
+      };
+
+      /// Writes unique id, identifier, meta values and data processing of a map
+      static void writeMapInfo(ColumnarBinaryWriter& writer, const UniqueIdInterface& unique_id, const DocumentIdentifier& document, const MetaInfoInterface& meta, const std::vector<DataProcessing>& data_processing);
+
+      /// Counterpart of writeMapInfo()
+      static void readMapInfo(const ColumnarBinaryReader& reader, UniqueIdInterface& unique_id, DocumentIdentifier& document, MetaInfoInterface& meta, std::vector<DataProcessing>& data_processing);
+
+      /// Writes the BaseFeature columns of @p features with @p prefix
+      static void writeBaseFeatures(ColumnarBinaryWriter& writer, const String& prefix, const std::vector<const BaseFeature*>& features);
+    };
+  }
+}
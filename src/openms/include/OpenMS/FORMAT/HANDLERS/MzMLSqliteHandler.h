@@ -68,7 +68,9 @@ namespace OpenMS
         back).
 
         This class also supports writing data using the lossy numpress
-        compression format.
+        compression format. For lossless compression, the data arrays can
+        optionally be byte-shuffled before zlib compression (see
+        setByteShuffle()), which yields smaller files that decode faster.
 
         This class contains the internal data structures and SQL statements for
         communication with the SQLite database
@@ -120,6 +122,36 @@ public:
       */
       void readChromatograms(std::vector<MSChromatogram> & exp, const std::vector<int> & indices, bool meta_only = false) const;
 
+      /**
+          @brief Read the spectra with indices [@p first, @p last)
+
+          Each call opens its own connection to the file, thus multiple
+          ranges can be read concurrently from different threads.
+
+          @param exp The result (empty if @p first >= @p last)
+          @param first Index of the first spectrum
+          @param last Index past the last spectrum
+          @param meta_only Only read the meta data
+
+          @exception Exception::IllegalArgument is thrown if the range exceeds the number of spectra
+      */
+      void readSpectrumRange(std::vector<MSSpectrum> & exp, Size first, Size last, bool meta_only = false) const;
+
+      /**
+          @brief Read the chromatograms with indices [@p first, @p last)
+
+          Each call opens its own connection to the file, thus multiple
+          ranges can be read concurrently from different threads.
+
+          @param exp The result (empty if @p first >= @p last)
+          @param first Index of the first chromatogram
+          @param last Index past the last chromatogram
+          @param meta_only Only read the meta data
+
+          @exception Exception::IllegalArgument is thrown if the range exceeds the number of chromatograms
+      */
+      void readChromatogramRange(std::vector<MSChromatogram> & exp, Size first, Size last, bool meta_only = false) const;
+
       /**
           @brief Get number of spectra in the file
 
@@ -150,6 +182,22 @@ public:
         sql_batch_size_ = sql_batch_size; 
       }
 
+      /**
+          @brief Use byte shuffling for lossless compression
+
+          If set, data arrays which are not compressed with numpress are
+          stored byte-shuffled and zlib-compressed (compression id 8, see
+          ZlibCompression::compressShuffled()) instead of zlib-compressed only.
+          Files written with this option can only be read by versions of
+          OpenMS which support it (reading is always supported).
+
+          @param byte_shuffle Whether to use byte shuffling (default: false)
+      */
+      void setByteShuffle(bool byte_shuffle)
+      {
+        use_byte_shuffle_ = byte_shuffle;
+      }
+
       /**
           @brief Get spectral indices around a specific retention time
 
@@ -250,6 +298,7 @@ protected:
       double linear_abs_mass_acc_; 
       double write_full_meta_; 
       int sql_batch_size_; 
+      bool use_byte_shuffle_;
     };
 
 
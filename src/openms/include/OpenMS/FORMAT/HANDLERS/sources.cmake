@@ -4,6 +4,8 @@ set(directory include/OpenMS/FORMAT/HANDLERS)
 ### list all header files of the directory here
 set(sources_list_h
 AcqusHandler.h
+ColumnarBinaryHandler.h
+ColumnarMapHandler.h
 FidHandler.h
 IndexedMzMLDecoder.h
 IndexedMzMLHandler.h
@@ -0,0 +1,181 @@
+// --------------------------------------------------------------------------
+//                   OpenMS -- Open-Source Mass Spectrometry
+// --------------------------------------------------------------------------
+// Copyright The OpenMS Team -- Eberhard Karls University Tuebingen,
+// ETH Zurich, and Freie Universitaet Berlin 2002-2020.
+//
+// This software is released under a three-clause BSD license:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of any author or any participating institution
+//    may be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+// For a full list of authors, refer to the file AUTHORS.
+// --------------------------------------------------------------------------
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL ANY OF THE AUTHORS OR THE CONTRIBUTING
+// INSTITUTIONS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// --------------------------------------------------------------------------
+// $Maintainer: agent $
+// $Authors: agent $
+// --------------------------------------------------------------------------
+
+#pragma once
+
+#include <OpenMS/CONCEPT/ProgressLogger.h>
+#include <OpenMS/FORMAT/HANDLERS/ColumnarBinaryHandler.h>
+#include <OpenMS/METADATA/PeptideIdentification.h>
+#include <OpenMS/METADATA/ProteinIdentification.h>
+
+#include <memory>
+#include <vector>
+
+namespace OpenMS
+{
+  /**
+    @brief Binary, memory-mappable alternative to idXML (.idBin)
+
+    Stores the same information as IdXMLFile, but column by column instead of
+    element by element: all retention times of the peptide identifications
+    form one array, all scores of the peptide hits another, and so on.
+    Repeated strings (identifiers, score types, accessions) are stored once in
+    a string pool, peptide sequences in a separate, deduplicated pool (so each
+    distinct sequence is parsed only once when loading). Meta values are
+    stored as columns per meta value name (see Internal::ColumnarMetaInfoWriter).
+
+    Loading a complete file with load() avoids XML parsing altogether. For
+    tools that only need a few fields, open() maps the file into memory and
+    allows to access single columns (e.g. getRTs(), getHitScores()) or to
+    materialize single PeptideIdentification objects on demand without
+    reading the rest of the file.
+
+    @note Protein hit modifications are not stored, as in idXML.
+
+    @ingroup FileIO
+  */
+  class OPENMS_DLLAPI IdBinFile :
+    public ProgressLogger
+  {
+public:
+    /// Content tag of the file header
+    static const char* const CONTENT_TAG;
+
+    /// Constructor
+    IdBinFile();
+
+    /// Destructor
+    ~IdBinFile();
+
+    /**
+      @brief Loads all identifications of an idBin file
+
+      @exception Exception::FileNotFound is thrown if the file could not be opened
+      @exception Exception::ParseError is thrown if the file is not a valid idBin file
+    */
+    void load(const String& filename, std::vector<ProteinIdentification>& protein_ids, std::vector<PeptideIdentification>& peptide_ids);
+
+    /**
+      @brief Stores identifications in an idBin file
+
+      @exception Exception::UnableToCreateFile is thrown if the file could not be created
+    */
+    void store(const String& filename, const std::vector<ProteinIdentification>& protein_ids, const std::vector<PeptideIdentification>& peptide_ids);
+
+    /**
+      @brief Writes the identification columns to an open columnar binary file
+
+      Allows other columnar formats (e.g. FeatureBinFile) to embed identifications.
+      The file can be read again with open(const Internal::ColumnarBinaryReader&).
+    */
+    void store(Internal::ColumnarBinaryWriter& writer, const std::vector<ProteinIdentification>& protein_ids, const std::vector<PeptideIdentification>& peptide_ids);
+
+    /** @name Lazy access
+
+        After calling open(), the following functions read directly from the
+        memory-mapped file. They throw Exception::IllegalArgument if no file
+        is open.
+    */
+    //@{
+    /**
+      @brief Maps an idBin file into memory for lazy access
+
+      @exception Exception::FileNotFound is thrown if the file could not be opened
+      @exception Exception::ParseError is thrown if the file is not a valid idBin file
+    */
+    void open(const String& filename);
+
+    /// Uses the identification columns of an already opened columnar binary file (see store(Internal::ColumnarBinaryWriter&, ...))
+    void open(const Internal::ColumnarBinaryReader& reader);
+
+    /// Number of peptide identifications in the opened file
+    Size getNrOfPeptideIdentifications() const;
+
+    /// Total number of peptide hits in the opened file
+    Size getNrOfPeptideHits() const;
+
+    /// Retention times of all peptide identifications
+    std::vector<double> getRTs() const;
+
+    /// Precursor m/z of all peptide identifications
+    std::vector<double> getMZs() const;
+
+    /// Index of the first hit of each peptide identification (plus one past-the-end entry)
+    std::vector<UInt64> getHitOffsets() const;
+
+    /// Scores of all peptide hits (use getHitOffsets() to map them to peptide identifications)
+    std::vector<double> getHitScores() const;
+
+    /// Charges of all peptide hits
+    std::vector<Int> getHitCharges() const;
+
+    /// Sequences of all peptide hits, as strings
+    std::vector<String> getHitSequences() const;
+
+    /// Values of one meta value of the peptide hits as (hit index, value) pairs
+    std::vector<std::pair<UInt64, DataValue> > getHitMetaValues(const String& name) const;
+
+    /// Loads the protein identifications (runs) of the opened file
+    void getProteinIdentifications(std::vector<ProteinIdentification>& protein_ids) const;
+
+    /// Materializes a single peptide identification (including hits and meta values)
+    PeptideIdentification getPeptideIdentification(Size index) const;
+
+    /**
+      @brief Materializes the peptide identifications [@p first, @p last)
+
+      @exception Exception::IndexOverflow is thrown if the range exceeds the number of peptide identifications
+    */
+    void getPeptideIdentifications(Size first, Size last, std::vector<PeptideIdentification>& peptide_ids) const;
+    //@}
+
+protected:
+    /// Throws if no file has been opened
+    void checkOpen_() const;
+
+    /// Materializes peptide identifications [@p first, @p last) from the opened file
+    void readPeptideIdentifications_(Size first, Size last, std::vector<PeptideIdentification>& peptide_ids) const;
+
+    /// Reader of the file opened for lazy access
+    Internal::ColumnarBinaryReader reader_;
+
+    /// String pool of the opened file
+    std::vector<String> pool_;
+
+    /// Meta values of peptide identifications and hits of the opened file
+    std::shared_ptr<Internal::ColumnarMetaInfoReader> pep_meta_;
+    std::shared_ptr<Internal::ColumnarMetaInfoReader> hit_meta_;
+  };
+
+} // namespace OpenMS
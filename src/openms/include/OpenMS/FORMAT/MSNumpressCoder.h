@@ -265,6 +265,32 @@ public:
                      std::vector<double> & out,
                      const NumpressConfig & config);
 
+    /**
+     * @brief Decode the raw byte array "in" directly into a caller-provided buffer
+     *
+     * Same as decodeNPRaw() above, but avoids all intermediate copies and
+     * allocations: the data is decoded directly into @p out, which must
+     * provide space for at least decodedSizeBound(@p in_size, @p config)
+     * values (e.g. a buffer that is reused for many arrays).
+     *
+     * @param in The raw numpress encoded byte array
+     * @param in_size The number of bytes in @p in
+     * @param out The buffer for the decoded values
+     * @param config The numpress configuration defining the compression strategy
+     *
+     * @return The number of decoded values written to @p out
+     *
+     * @throw throws Exception::ConversionError if the data cannot be converted
+     *
+    */
+    Size decodeNPRaw(const unsigned char* in,
+                     size_t in_size,
+                     double* out,
+                     const NumpressConfig & config);
+
+    /// Upper bound on the number of values decoded from @p in_size bytes of raw numpress data (0 if no compression is set)
+    static Size decodedSizeBound(size_t in_size, const NumpressConfig & config);
+
 private:
 
     void decodeNPInternal_(const unsigned char* in, size_t in_size, std::vector<double>& out, const NumpressConfig & config);
@@ -45,6 +45,7 @@
 
 #include <vector>
 #include <algorithm>
+#include <memory>
 
 namespace OpenMS
 {
@@ -53,6 +54,22 @@ namespace OpenMS
 /**
     @brief File adapter for MzTab files
 
+    Rows are formatted in blocks on all available threads and written to
+    disk block by block, so the complete file is never held in memory as
+    text. Besides storing a complete MzTab object with store(), rows can be
+    written incrementally with beginStore(), storeRows() and endStore(),
+    which avoids building the complete MzTab object for large exports:
+
+    @code
+    MzTabFile f;
+    f.beginStore("out.mzTab", meta_data);
+    for (...)
+    {
+      f.storeRows(psm_rows, psm_optional_columns); // e.g. one block per run
+    }
+    f.endStore();
+    @endcode
+
     @ingroup FileIO
   */
   class OPENMS_DLLAPI MzTabFile
@@ -68,6 +85,46 @@ namespace OpenMS
     // store MzTab file
     void store(const String& filename, const MzTab& mz_tab) const;
 
+    /** @name Incremental storing
+
+        Sections have to be written in the order of the mzTab specification
+        (protein, peptide, PSM, small molecule, nucleic acid, oligonucleotide,
+        OSM), but each section can be written in any number of blocks. The
+        section header is generated from the meta data and the first block of
+        the section (e.g. whether search engine scores per MS run are present),
+        so all blocks of a section must have the same layout.
+    */
+    //@{
+    /**
+      @brief Opens @p filename and writes the meta data section
+
+      @exception Exception::UnableToCreateFile is thrown if the file could not be created or has an invalid extension
+    */
+    void beginStore(const String& filename, const MzTabMetaData& meta_data);
+
+    /**
+      @brief Appends rows to the current section (or starts the next section)
+
+      Empty blocks are ignored.
+
+      @exception Exception::IllegalArgument is thrown if no file is open or the section order is violated
+    */
+    void storeRows(const MzTabProteinSectionRows& rows, const std::vector<String>& optional_columns);
+    void storeRows(const MzTabPeptideSectionRows& rows, const std::vector<String>& optional_columns);
+    void storeRows(const MzTabPSMSectionRows& rows, const std::vector<String>& optional_columns);
+    void storeRows(const MzTabSmallMoleculeSectionRows& rows, const std::vector<String>& optional_columns);
+    void storeRows(const MzTabNucleicAcidSectionRows& rows, const std::vector<String>& optional_columns);
+    void storeRows(const MzTabOligonucleotideSectionRows& rows, const std::vector<String>& optional_columns);
+    void storeRows(const MzTabOSMSectionRows& rows, const std::vector<String>& optional_columns);
+
+    /**
+      @brief Finishes the last section and closes the file
+
+      @exception Exception::IllegalArgument is thrown if no file is open
+    */
+    void endStore();
+    //@}
+
     // Set store behaviour of optional "reliability" and "uri" columns (default=no)
     void storeProteinReliabilityColumn(bool store);
     void storePeptideReliabilityColumn(bool store);
@@ -83,6 +140,12 @@ namespace OpenMS
     void load(const String& filename, MzTab& mz_tab);
 
   protected:
+    /// Output state of store() and of incremental storing (beginStore())
+    struct StoreStream_;
+
+    /// Open output of incremental storing (null if none)
+    std::unique_ptr<StoreStream_> stream_;
+
     bool store_protein_reliability_;
     bool store_peptide_reliability_;
     bool store_psm_reliability_;
@@ -130,16 +193,32 @@ namespace OpenMS
 
     String generateMzTabSectionRow_(const MzTabOSMSectionRow& row, const std::vector<String>& optional_columns) const;
 
-    /// Generate an mzTab section comprising multiple rows of the same type
-    template <typename SectionRow> void generateMzTabSection_(const std::vector<SectionRow>& rows, const std::vector<String>& optional_columns, StringList& output) const
-    {
-      output.reserve(output.size() + rows.size() + 1);
-      for (const auto& row : rows)
-      {
-        output.push_back(generateMzTabSectionRow_(row, optional_columns));
-      }
-      output.push_back(String("\n"));
-    }
+    /// Header of a section, derived from the meta data and the (first block of) rows of the section
+    String generateMzTabSectionHeader_(const MzTabProteinSectionRows& rows, const MzTabMetaData& meta_data, const std::vector<String>& optional_columns) const;
+    String generateMzTabSectionHeader_(const MzTabPeptideSectionRows& rows, const MzTabMetaData& meta_data, const std::vector<String>& optional_columns) const;
+    String generateMzTabSectionHeader_(const MzTabPSMSectionRows& rows, const MzTabMetaData& meta_data, const std::vector<String>& optional_columns) const;
+    String generateMzTabSectionHeader_(const MzTabSmallMoleculeSectionRows& rows, const MzTabMetaData& meta_data, const std::vector<String>& optional_columns) const;
+    String generateMzTabSectionHeader_(const MzTabNucleicAcidSectionRows& rows, const MzTabMetaData& meta_data, const std::vector<String>& optional_columns) const;
+    String generateMzTabSectionHeader_(const MzTabOligonucleotideSectionRows& rows, const MzTabMetaData& meta_data, const std::vector<String>& optional_columns) const;
+    String generateMzTabSectionHeader_(const MzTabOSMSectionRows& rows, const MzTabMetaData& meta_data, const std::vector<String>& optional_columns) const;
+
+    /// Opens the output file of @p stream and writes the meta data section
+    void openStoreStream_(StoreStream_& stream, const String& filename, const MzTabMetaData& meta_data) const;
+
+    /**
+      @brief Writes rows of section number @p section (see storeRows()) to @p stream
+
+      Starts a new section (with header) if @p section differs from the current
+      one. Rows are formatted in parallel, in blocks, and written in order.
+    */
+    template <typename SectionRows>
+    void writeMzTabSection_(StoreStream_& stream, Size section, const SectionRows& rows, const std::vector<String>& optional_columns) const;
+
+    /// Terminates the current section and closes the output file of @p stream
+    void closeStoreStream_(StoreStream_& stream) const;
+
+    /// Returns the open incremental output, throws Exception::IllegalArgument if there is none
+    StoreStream_& getStoreStream_();
 
     // auxiliary functions
 
@@ -63,11 +63,13 @@ public:
       bool write_full_meta; ///< write full meta data
       bool use_lossy_numpress; ///< use lossy numpress compression
       double linear_fp_mass_acc; ///< desired mass accuracy for numpress linear encoding (-1 no effect, use 0.0001 for 0.2 ppm accuracy @ 500 m/z)
+      bool use_byte_shuffle; ///< use byte shuffling + zlib for lossless compression (faster decoding, not readable by older versions)
 
       SqMassConfig () :
         write_full_meta(true),
         use_lossy_numpress(false),
-        linear_fp_mass_acc(-1) {}
+        linear_fp_mass_acc(-1),
+        use_byte_shuffle(false) {}
     };
 
     typedef MSExperiment MapType;
@@ -76,12 +76,16 @@ public:
     static void compressString(const QByteArray& raw_data, QByteArray& compressed_data);
 
     /**
-      * @brief Uncompresses data using Qt (wrapper around Qt function)
+      * @brief Uncompresses data using zlib directly
+      *
+      * The data is inflated directly into @p raw_data, whose capacity is
+      * reused (thus, passing the same string repeatedly avoids reallocations).
       *
       * @param compressed_data Compressed data
       * @param nr_bytes Number of bytes in compressed data
       * @param raw_data Uncompressed result data
       * 
+      * @exception Exception::ConversionError is thrown if the data is not a valid zlib stream
     */
     static void uncompressString(const void * compressed_data, size_t nr_bytes, std::string& raw_data);
 
@@ -94,6 +98,34 @@ public:
     */
     static void uncompressString(const QByteArray& compressed_data, QByteArray& raw_data);
 
+    /**
+      * @brief Compresses an array of doubles using byte shuffling and zlib
+      *
+      * The bytes of the values are reordered such that all first bytes are
+      * stored first, then all second bytes etc. before compressing the data
+      * with zlib. For the slowly varying values of mass spectrometric data
+      * (m/z, retention time, intensity), the high-order bytes are then mostly
+      * identical and the data compresses better and decompresses faster
+      * than the unshuffled values. The compression is lossless.
+      *
+      * @param data Data to be compressed
+      * @param compressed_data Compressed result data
+      *
+    */
+    static void compressShuffled(const std::vector<double>& data, std::string& compressed_data);
+
+    /**
+      * @brief Uncompresses an array of doubles compressed with compressShuffled()
+      *
+      * @param compressed_data Compressed data
+      * @param nr_bytes Number of bytes in compressed data
+      * @param buffer Buffer for the shuffled data (reused between calls)
+      * @param data Uncompressed result data
+      *
+      * @exception Exception::ConversionError is thrown if the data cannot be uncompressed
+    */
+    static void uncompressShuffled(const void * compressed_data, size_t nr_bytes, std::string& buffer, std::vector<double>& data);
+
   };
 
 } // namespace OpenMS
@@ -26,6 +26,7 @@ CachedMzML.h
 ChromeleonFile.h
 CompressedInputSource.h
 CVMappingFile.h
+ConsensusBinFile.h
 ConsensusXMLFile.h
 ControlledVocabulary.h
 CsvFile.h
@@ -34,11 +35,13 @@ DTAFile.h
 EDTAFile.h
 ExperimentalDesignFile.h
 FASTAFile.h
+FeatureBinFile.h
 FeatureXMLFile.h
 FileHandler.h
 GzipIfstream.h
 GzipInputStream.h
 IBSpectraFile.h
+IdBinFile.h
 IdXMLFile.h
 IndexedMzMLFileLoader.h
 InspectInfile.h
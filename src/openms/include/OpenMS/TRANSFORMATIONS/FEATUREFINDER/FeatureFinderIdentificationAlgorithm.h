@@ -63,6 +63,9 @@ public:
   /// Main method for actual FeatureFinder
   /// External IDs (@p peptides_ext, @p proteins_ext) may be empty, 
   /// in which case no machine learning or FDR estimation will be performed.
+  /// The batches of assays (see parameter "extract:batch_size") are extracted
+  /// and scored in parallel (if OpenMP is enabled), the result does not
+  /// depend on the number of threads.
   void run(
     std::vector<PeptideIdentification> peptides,
     const std::vector<ProteinIdentification>& proteins,
@@ -216,9 +219,11 @@ protected:
 
   ProgressLogger prog_log_;
 
-  /// generate transitions (isotopic traces) for a peptide ion and add them to the library:
+  /// generate transitions (isotopic traces) for a peptide ion and add them to @p library (and their isotope probabilities to @p isotope_probs):
   void generateTransitions_(const String& peptide_id, double mz, Int charge,
-                            const IsotopeDistribution& iso_dist);
+                            const IsotopeDistribution& iso_dist,
+                            TargetedExperiment& library,
+                            std::map<String, double>& isotope_probs) const;
 
   void addPeptideRT_(TargetedExperiment::Peptide& peptide, double rt) const;
 
@@ -240,9 +245,11 @@ protected:
   /// some statistics on detected features
   void statistics_(const FeatureMap& features) const;
 
-  /// creates an assay library out of the peptide sequences and their RT elution windows
-  /// the PeptideMap is mutable since we clear it on-the-go
-  void createAssayLibrary_(const PeptideMap::iterator& begin, const PeptideMap::iterator& end, PeptideRefRTMap& ref_rt_map);
+  /// creates an assay library (@p library, with isotope probabilities of the transitions in @p isotope_probs)
+  /// out of the peptide sequences and their RT elution windows
+  /// the PeptideMap is mutable since we clear it on-the-go (only the entries in [begin, end) are accessed)
+  void createAssayLibrary_(const PeptideMap::iterator& begin, const PeptideMap::iterator& end, PeptideRefRTMap& ref_rt_map,
+                           TargetedExperiment& library, std::map<String, double>& isotope_probs) const;
 
   void addPeptideToMap_(PeptideIdentification& peptide, 
     PeptideMap& peptide_map,
@@ -154,6 +154,24 @@ protected:
      */
     bool filterPeakPositions_(const MSSpectrum::ConstIterator& it_mz, const MSExperiment::ConstIterator& it_rt_begin, const MSExperiment::ConstIterator& it_rt_band_begin, const MSExperiment::ConstIterator& it_rt_band_end, const MultiplexIsotopicPeakPattern& pattern, MultiplexFilteredPeak& peak) const;
 
+    /**
+     * @brief check if the blacklist changed in the region inspected by filterPeakPositions_()
+     *
+     * Only peaks blacklisted since the last call of updateWhiteMSExperiment_() are
+     * considered. If there are none in the RT band and the m/z range of the pattern
+     * (plus tolerance), all filters yield the same result for this peak as they
+     * did for the blacklist at that time.
+     *
+     * @param mz    m/z of the primary peak
+     * @param it_rt_begin    RT iterator of the very first spectrum of the experiment (needed to determine indices)
+     * @param it_rt_band_begin    RT iterator of the first spectrum in the RT band
+     * @param it_rt_band_end    RT iterator of the spectrum after the last spectrum in the RT band
+     * @param pattern    m/z pattern to search for
+     *
+     * @return boolean if a peak in this region has been blacklisted
+     */
+    bool blacklistChanged_(double mz, const MSExperiment::ConstIterator& it_rt_begin, const MSExperiment::ConstIterator& it_rt_band_begin, const MSExperiment::ConstIterator& it_rt_band_end, const MultiplexIsotopicPeakPattern& pattern) const;
+
     /**
      * @brief blacklist this peak
      * 
@@ -224,6 +242,13 @@ protected:
      */
     White2Original exp_centroided_mapping_;
 
+    /**
+     * @brief m/z positions of the peaks blacklisted since the last update of <exp_centroided_white_>
+     *
+     * one m/z-sorted list per spectrum of <exp_centroided_>
+     */
+    std::vector<std::vector<double> > blacklist_changes_;
+
     /**
      * @brief list of peak patterns
      */
@@ -88,6 +88,10 @@ public:
      * @brief filter for patterns
      * (generates a filter result for each of the patterns)
      *
+     * For each pattern, all peaks are first filtered in parallel. Peaks are then
+     * accepted in order of RT and m/z, peaks near previously blacklisted ones are
+     * filtered again. The result is the same as for a purely sequential search.
+     *
      * @see MultiplexIsotopicPeakPattern, MultiplexFilterResult
      */
     std::vector<MultiplexFilteredMSExperiment> filter();
@@ -97,6 +97,10 @@ public:
      * @brief filter for patterns
      * (generates a filter result for each of the patterns)
      *
+     * For each pattern, all peaks are first filtered in parallel. Peaks are then
+     * accepted in order of RT and m/z, peaks near previously blacklisted ones are
+     * filtered again. The result is the same as for a purely sequential search.
+     *
      * @throw Exception::IllegalArgument if number of peaks and number of peak boundaries differ
      *
      * @see MultiplexIsotopicPeakPattern
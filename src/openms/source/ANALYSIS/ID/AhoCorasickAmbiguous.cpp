@@ -34,14 +34,211 @@
 
 #include <OpenMS/ANALYSIS/ID/AhoCorasickAmbiguous.h>
 
+#include <cmath>
+
 //using namespace OpenMS;
 using namespace std;
 
 
 namespace OpenMS
 {
+  namespace
+  {
+    /// ordValue() of the first ambiguous amino acid ('B'); all unambiguous ones are smaller
+    const UInt AMBIGUOUS_BEGIN = ::seqan::ordValue(::seqan::AAcid('B'));
+    /// ordValue() of the last ambiguous amino acid ('X'); larger values (the terminator '*') never match
+    const UInt AMBIGUOUS_END = ::seqan::ordValue(::seqan::AAcid('X'));
+    /// maximum number of expansions tested for a k-mer with ambiguous amino acids; windows with more are assumed to match
+    const Size MAX_EXPANSIONS = 512;
+    /// filters with a larger fill ratio are not selective enough to be worth their cost
+    const double MAX_FILL_RATIO = 0.5;
+  }
+
+  AhoCorasickPrefilter::AhoCorasickPrefilter() :
+    k_(0),
+    aaa_max_(0),
+    active_(false),
+    fill_ratio_(1.0),
+    bits_()
+  {
+  }
+
+  void AhoCorasickPrefilter::init(const AhoCorasickAmbiguous::PeptideDB& pep_db, const int aaa_max, const int mm_max)
+  {
+    aaa_max_ = aaa_max;
+    k_ = 0;
+    active_ = false;
+    fill_ratio_ = 1.0;
+    bits_.clear();
+
+    // every k-mer of a hit has to match a peptide k-mer only without mismatches
+    if (mm_max > 0 || ::seqan::length(pep_db) == 0) return;
+
+    Size min_length = std::numeric_limits<Size>::max();
+    for (Size i = 0; i < ::seqan::length(pep_db); ++i)
+    {
+      min_length = std::min(min_length, (Size)::seqan::length(pep_db[i]));
+    }
+    k_ = std::min(MAX_K, min_length);
+    if (k_ < 3) return;
+
+    bits_.assign(((UInt64(1) << (5 * k_)) + 63) / 64, 0);
+    const UInt64 mask = (UInt64(1) << (5 * k_)) - 1;
+    Size n_kmers(0);
+    for (Size i = 0; i < ::seqan::length(pep_db); ++i)
+    {
+      const ::seqan::AAString& pep = pep_db[i];
+      UInt64 key(0);
+      for (Size j = 0; j < ::seqan::length(pep); ++j)
+      {
+        key = ((key << 5) | ::seqan::ordValue(pep[j])) & mask;
+        if (j + 1 < k_) continue;
+        UInt64& word = bits_[key >> 6];
+        const UInt64 bit = UInt64(1) << (key & 63);
+        if (!(word & bit))
+        {
+          word |= bit;
+          ++n_kmers;
+        }
+      }
+    }
+    fill_ratio_ = n_kmers / std::pow(double(AMBIGUOUS_BEGIN), double(k_));
+    active_ = (fill_ratio_ <= MAX_FILL_RATIO);
+    if (!active_) bits_.clear();
+  }
+
+  bool AhoCorasickPrefilter::isActive() const
+  {
+    return active_;
+  }
+
+  Size AhoCorasickPrefilter::getK() const
+  {
+    return k_;
+  }
+
+  double AhoCorasickPrefilter::getFillRatio() const
+  {
+    return fill_ratio_;
+  }
+
+  bool AhoCorasickPrefilter::matchesAmbiguous_(const std::vector<UInt>& codes, Size pos) const
+  {
+    // number of expansions
+    Size n_expansions(1);
+    for (Size j = pos; j < pos + k_; ++j)
+    {
+      if (codes[j] < AMBIGUOUS_BEGIN) continue;
+      UInt first, last;
+      ::seqan::_getSpawnRange(::seqan::AAcid(codes[j]), first, last);
+      n_expansions *= last - first + 1;
+      if (n_expansions > MAX_EXPANSIONS) return true; // too expensive to test; assume a match
+    }
+    // enumerate all expansions (like an odometer)
+    std::vector<UInt> first(k_), last(k_), current(k_);
+    for (Size j = 0; j < k_; ++j)
+    {
+      const UInt c = codes[pos + j];
+      if (c < AMBIGUOUS_BEGIN)
+      {
+        first[j] = last[j] = c;
+      }
+      else
+      {
+        ::seqan::_getSpawnRange(::seqan::AAcid(c), first[j], last[j]);
+      }
+      current[j] = first[j];
+    }
+    while (true)
+    {
+      UInt64 key(0);
+      for (Size j = 0; j < k_; ++j)
+      {
+        key = (key << 5) | current[j];
+      }
+      if (testBit_(key)) return true;
+      // next expansion
+      Size j = k_;
+      while (j > 0)
+      {
+        --j;
+        if (current[j] < last[j])
+        {
+          ++current[j];
+          break;
+        }
+        current[j] = first[j];
+        if (j == 0) return false;
+      }
+    }
+  }
+
+  void AhoCorasickPrefilter::getCandidateRegions(const String& protein, std::vector<std::pair<Size, Size> >& regions) const
+  {
+    regions.clear();
+    if (!active_)
+    {
+      if (!protein.empty()) regions.emplace_back(0, protein.size());
+      return;
+    }
+    if (protein.size() < k_) return; // shorter than any peptide
+
+    // encode the protein in the same way as AhoCorasickAmbiguous
+    std::vector<UInt> codes(protein.size());
+    for (Size i = 0; i < protein.size(); ++i)
+    {
+      codes[i] = ::seqan::ordValue(::seqan::AAcid(protein[i]));
+    }
+
+    const UInt64 mask = (UInt64(1) << (5 * k_)) - 1;
+    UInt64 key(0);
+    int n_ambiguous(0); // ambiguous amino acids in the current window
+    int n_invalid(0); // amino acids in the current window which never match (e.g. '*')
+    for (Size i = 0; i < codes.size(); ++i)
+    {
+      // add amino acid i to the window
+      const UInt c = codes[i];
+      if (c > AMBIGUOUS_END) ++n_invalid;
+      else if (c >= AMBIGUOUS_BEGIN) ++n_ambiguous;
+      key = ((key << 5) | (c < AMBIGUOUS_BEGIN ? c : 0)) & mask;
+      if (i + 1 < k_) continue;
+
+      // remove the amino acid in front of the window
+      if (i >= k_)
+      {
+        const UInt c_out = codes[i - k_];
+        if (c_out > AMBIGUOUS_END) --n_invalid;
+        else if (c_out >= AMBIGUOUS_BEGIN) --n_ambiguous;
+      }
 
-  // ...
+      // can the window [i - k + 1, i] be part of a hit?
+      const Size window_begin = i + 1 - k_;
+      bool possible;
+      if (n_invalid > 0 || n_ambiguous > aaa_max_)
+      {
+        possible = false;
+      }
+      else if (n_ambiguous == 0)
+      {
+        possible = testBit_(key);
+      }
+      else
+      {
+        possible = matchesAmbiguous_(codes, window_begin);
+      }
 
+      if (possible)
+      {
+        if (!regions.empty() && window_begin < regions.back().second)
+        { // continue (or overlap with) the last region
+          regions.back().second = i + 1;
+        }
+        else
+        {
+          regions.emplace_back(window_begin, i + 1);
+        }
+      }
+    }
+  }
 
 }
@@ -91,6 +91,9 @@ using namespace std;
     defaults_.setValue("IL_equivalent", "false", "Treat the isobaric amino acids isoleucine ('I') and leucine ('L') as equivalent (indistinguishable). Also occurences of 'J' will be treated as 'I' thus avoiding ambiguous matching.");
     defaults_.setValidStrings("IL_equivalent", ListUtils::create<String>("true,false"));
 
+    defaults_.setValue("memory_budget", 0.0, "Approximate memory (in MB) available for the search index of the peptide sequences. If the index of all peptides would be larger, peptides are split into shards which are searched one after another, each with a separate pass over the database (slower, but bounded memory for huge sets of peptides). 0 = no limit.", ListUtils::create<String>("advanced"));
+    defaults_.setMinFloat("memory_budget", 0.0);
+
     defaultsToParam_();
   }
 
@@ -114,6 +117,7 @@ using namespace std;
     IL_equivalent_ = param_.getValue("IL_equivalent").toBool();
     aaa_max_ = static_cast<Int>(param_.getValue("aaa_max"));
     mm_max_ = static_cast<Int>(param_.getValue("mismatches_max"));
+    memory_budget_ = param_.getValue("memory_budget");
   }
 
 const String &PeptideIndexing::getDecoyString() const
@@ -33,12 +33,18 @@
 // --------------------------------------------------------------------------
 
 #include <OpenMS/ANALYSIS/OPENSWATH/ChromatogramExtractorAlgorithm.h>
+#include <OpenMS/ANALYSIS/OPENSWATH/DATAACCESS/SpectrumAccessIMIndexed.h>
 
 #include <OpenMS/DATASTRUCTURES/String.h>
 
 #include <OpenMS/CONCEPT/Exception.h>
+#include <exception>
 #include <iostream>
 
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
 namespace OpenMS
 {
 
@@ -267,6 +273,79 @@ namespace OpenMS
     }
   }
 
+  namespace
+  {
+    /// Extraction window of one coordinate, precomputed once for all spectra
+    struct ExtractionWindow_
+    {
+      double mz; ///< target m/z
+      double left; ///< lower m/z bound (exclusive)
+      double right; ///< upper m/z bound (exclusive)
+      double left_im; ///< lower ion mobility bound (exclusive)
+      double right_im; ///< upper ion mobility bound (exclusive)
+      double rt_start; ///< start of RT range
+      double rt_end; ///< end of RT range
+      bool use_rt; ///< restricted to RT range?
+      bool use_im; ///< filter by ion mobility?
+    };
+
+    /// Is @p i inside the (m/z and ion mobility) window @p w?
+    inline bool inWindow_(const ExtractionWindow_& w, const double* mz, const double* im, Size i)
+    {
+      return mz[i] > w.left && mz[i] < w.right && (im == nullptr || (im[i] > w.left_im && im[i] < w.right_im));
+    }
+
+    /**
+      @brief Index-based equivalent of ChromatogramExtractorAlgorithm::extract_value_tophat()
+
+      Visits (and sums) the peaks in exactly the same order, so results are
+      bit-identical. @p pos is the index of the first peak not smaller than
+      the m/z of the previous coordinate and is advanced monotonically
+      (i.e. a single sweep over the spectrum for all coordinates sorted by m/z).
+      If @p im is null, ion mobility is not considered. @p n must be larger than 0.
+    */
+    inline double extractTophat_(const ExtractionWindow_& w, const double* mz, const double* intensity, const double* im, Size n, Size& pos)
+    {
+      double integrated_intensity = 0;
+
+      // advance until we hit the m/z value of the next coordinate
+      while (pos != n && mz[pos] < w.mz) ++pos;
+
+      // current peak (or the last peak, if we moved past the end of the spectrum)
+      const Size center = (pos == n) ? n - 1 : pos;
+      if (inWindow_(w, mz, im, center))
+      {
+        integrated_intensity += intensity[center];
+      }
+
+      // (i) walk to the left (the first peak is only visited as direct neighbour, like extract_value_tophat)
+      Size walker = pos;
+      if (pos != 0)
+      {
+        --walker;
+        if (walker == 0 && inWindow_(w, mz, im, walker))
+        {
+          integrated_intensity += intensity[walker];
+        }
+      }
+      while (walker != 0 && mz[walker] > w.left && mz[walker] < w.right)
+      {
+        if (im == nullptr || (im[walker] > w.left_im && im[walker] < w.right_im)) integrated_intensity += intensity[walker];
+        --walker;
+      }
+
+      // (ii) walk to the right
+      walker = pos;
+      if (pos != n) ++walker;
+      while (walker != n && mz[walker] > w.left && mz[walker] < w.right)
+      {
+        if (im == nullptr || (im[walker] > w.left_im && im[walker] < w.right_im)) integrated_intensity += intensity[walker];
+        ++walker;
+      }
+      return integrated_intensity;
+    }
+  }
+
   void ChromatogramExtractorAlgorithm::extractChromatograms(const OpenSwath::SpectrumAccessPtr input,
       std::vector< OpenSwath::ChromatogramPtr >& output,
       const std::vector<ExtractionCoordinates>& extraction_coordinates,
@@ -288,6 +367,10 @@ namespace OpenMS
     }
 
     int used_filter = getFilterNr_(filter);
+    if (used_filter == 2 && !extraction_coordinates.empty())
+    {
+      throw Exception::NotImplemented(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION);
+    }
     // assert that they are sorted!
     if (std::adjacent_find(extraction_coordinates.begin(), extraction_coordinates.end(),
           ExtractionCoordinates::SortExtractionCoordinatesReverseByMZ) != extraction_coordinates.end())
@@ -296,83 +379,156 @@ namespace OpenMS
         "Input to extractChromatogram needs to be sorted by m/z");
     }
 
-    //go through all spectra
-    startProgress(0, input_size, "Extracting chromatograms");
-    for (Size scan_idx = 0; scan_idx < input_size; ++scan_idx)
+    // compute the extraction windows once (instead of once per spectrum)
+    const bool has_im = (im_extraction_window > 0.0);
+    std::vector<ExtractionWindow_> windows(extraction_coordinates.size());
+    for (Size k = 0; k < extraction_coordinates.size(); ++k)
     {
-      setProgress(scan_idx);
-
-      OpenSwath::SpectrumPtr sptr = input->getSpectrumById(scan_idx);
-      OpenSwath::SpectrumMeta s_meta = input->getSpectrumMetaById(scan_idx);
-
-      OpenSwath::BinaryDataArrayPtr mz_arr = sptr->getMZArray();
-      OpenSwath::BinaryDataArrayPtr int_arr = sptr->getIntensityArray();
-      std::vector<double>::const_iterator mz_start = mz_arr->data.begin();
-      std::vector<double>::const_iterator mz_end = mz_arr->data.end();
-      std::vector<double>::const_iterator mz_it = mz_arr->data.begin();
-      std::vector<double>::const_iterator int_it = int_arr->data.begin();
-      std::vector<double>::const_iterator im_it;
-
-      if (sptr->getMZArray()->data.size() == 0)
+      const ExtractionCoordinates& coord = extraction_coordinates[k];
+      ExtractionWindow_& w = windows[k];
+      w.mz = coord.mz;
+      if (ppm)
+      {
+        w.left  = coord.mz - coord.mz * mz_extraction_window / 2.0 * 1.0e-6;
+        w.right = coord.mz + coord.mz * mz_extraction_window / 2.0 * 1.0e-6;
+      }
+      else
       {
-        continue;
+        w.left  = coord.mz - mz_extraction_window / 2.0;
+        w.right = coord.mz + mz_extraction_window / 2.0;
       }
+      w.left_im  = coord.ion_mobility - im_extraction_window / 2.0;
+      w.right_im = coord.ion_mobility + im_extraction_window / 2.0;
+      w.rt_start = coord.rt_start;
+      w.rt_end = coord.rt_end;
+      w.use_rt = (coord.rt_end - coord.rt_start > 0);
+      w.use_im = (coord.ion_mobility >= 0.0 && has_im);
+    }
 
-      // Look for ion mobility array
-      bool has_im = (im_extraction_window > 0.0);
-      if (has_im)
+    // spectra are extracted in parallel, in blocks of consecutive spectra;
+    // results are appended to the chromatograms in the order of the spectra
+    int n_threads = 1;
+#ifdef _OPENMP
+    if (!omp_in_parallel()) n_threads = omp_get_max_threads(); // no nested parallelism (e.g. OpenSwathWorkflow extracts SWATH windows in parallel)
+#endif
+    std::vector<OpenSwath::SpectrumAccessPtr> inputs(n_threads, input);
+    for (int t = 1; t < n_threads; ++t)
+    {
+      inputs[t] = input->lightClone(); // spectrum access is not thread-safe
+    }
+
+    struct SpectrumResult
+    {
+      bool empty = true;
+      double rt = 0;
+      std::vector<std::pair<Size, double> > intensities; ///< (coordinate index, integrated intensity)
+    };
+    const SignedSize block_size = 64 * n_threads;
+    std::vector<SpectrumResult> results(std::min((SignedSize)input_size, block_size));
+
+    startProgress(0, input_size, "Extracting chromatograms");
+    for (SignedSize block_start = 0; block_start < (SignedSize)input_size; block_start += block_size)
+    {
+      const SignedSize block_end = std::min((SignedSize)input_size, block_start + block_size);
+      bool missing_im = false;
+      std::exception_ptr error;
+
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic, 1) num_threads(n_threads)
+#endif
+      for (SignedSize scan_idx = block_start; scan_idx < block_end; ++scan_idx)
       {
-        OpenSwath::BinaryDataArrayPtr im_arr = sptr->getDriftTimeArray();
-        if (im_arr != nullptr)
+        int thread_num = 0;
+#ifdef _OPENMP
+        thread_num = omp_get_thread_num();
+#endif
+        SpectrumResult& result = results[scan_idx - block_start];
+        result.intensities.clear();
+        result.empty = true;
+
+        OpenSwath::SpectrumPtr sptr;
+        try
         {
-          im_it = im_arr->data.begin();
+          sptr = inputs[thread_num]->getSpectrumById(scan_idx);
+          result.rt = inputs[thread_num]->getSpectrumMetaById(scan_idx).RT;
         }
-        else
+        catch (...)
         {
-          throw Exception::IllegalArgument(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION,
-            "Requested ion mobility extraction but no ion mobility array found.");
+#ifdef _OPENMP
+#pragma omp critical (ChromatogramExtractorAlgorithm_error)
+#endif
+          if (!error) error = std::current_exception();
+          continue;
         }
-      }
 
-      // go through all transitions / chromatograms which are sorted by
-      // ProductMZ. We can use this to step through the spectrum and at the
-      // same time step through the transitions. We increase the peak counter
-      // until we hit the next transition and then extract the signal.
-      for (Size k = 0; k < extraction_coordinates.size(); ++k)
-      {
-        double integrated_intensity = 0;
-        double current_rt = s_meta.RT;
-        if (extraction_coordinates[k].rt_end - extraction_coordinates[k].rt_start > 0 &&
-             (current_rt < extraction_coordinates[k].rt_start ||
-              current_rt > extraction_coordinates[k].rt_end) )
+        const std::vector<double>& mz_data = sptr->getMZArray()->data;
+        result.empty = mz_data.empty();
+        if (result.empty)
         {
           continue;
         }
-
-        const bool use_im = (extraction_coordinates[k].ion_mobility >= 0.0 && has_im);
-        if (!use_im && used_filter == 1)
+        const double* mz = mz_data.data();
+        const double* intensity = sptr->getIntensityArray()->data.data();
+        const Size n = mz_data.size();
+
+        // Look for ion mobility array
+        const double* im = nullptr;
+        const SpectrumAccessIMIndexed* indexed_input = nullptr;
+        if (has_im)
         {
-          extract_value_tophat(mz_start, mz_it, mz_end, int_it,
-                               extraction_coordinates[k].mz, integrated_intensity, mz_extraction_window, ppm);
+          OpenSwath::BinaryDataArrayPtr im_arr = sptr->getDriftTimeArray();
+          if (im_arr == nullptr)
+          {
+            missing_im = true; // write-only, we cannot throw inside the parallel region
+            continue;
+          }
+          im = im_arr->data.data();
+
+          // with an ion mobility index, m/z x ion mobility windows are queried directly
+          indexed_input = dynamic_cast<const SpectrumAccessIMIndexed*>(inputs[thread_num].get());
+          if (indexed_input != nullptr && !indexed_input->hasIMIndex(scan_idx)) indexed_input = nullptr;
         }
-        else if (use_im && used_filter == 1)
+
+        // go through all coordinates (sorted by m/z) and step through the
+        // spectrum at the same time (single sweep)
+        Size pos = 0;
+        for (Size k = 0; k < windows.size(); ++k)
         {
-          if (extraction_coordinates[k].ion_mobility < 0)
+          const ExtractionWindow_& w = windows[k];
+          if (w.use_rt && (result.rt < w.rt_start || result.rt > w.rt_end))
           {
-            std::cerr << "WARNING : Drift time of ion is negative!" << std::endl;
+            continue;
           }
-          extract_value_tophat(mz_start, mz_it, mz_end, int_it, im_it,
-                               extraction_coordinates[k].mz, extraction_coordinates[k].ion_mobility,
-                               integrated_intensity, mz_extraction_window, im_extraction_window, ppm);
+          if (w.use_im && indexed_input != nullptr)
+          {
+            result.intensities.emplace_back(k, indexed_input->integrateBox(scan_idx, sptr, w.left, w.right, w.left_im, w.right_im));
+            continue;
+          }
+          result.intensities.emplace_back(k, extractTophat_(w, mz, intensity, w.use_im ? im : nullptr, n, pos));
         }
-        else if (used_filter == 2)
+      }
+
+      if (error)
+      {
+        std::rethrow_exception(error);
+      }
+      if (missing_im)
+      {
+        throw Exception::IllegalArgument(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION,
+          "Requested ion mobility extraction but no ion mobility array found.");
+      }
+
+      for (SignedSize scan_idx = block_start; scan_idx < block_end; ++scan_idx)
+      {
+        const SpectrumResult& result = results[scan_idx - block_start];
+        if (result.empty) continue;
+        for (const auto& k_intensity : result.intensities)
         {
-          throw Exception::NotImplemented(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION);
+          output[k_intensity.first]->getTimeArray()->data.push_back(result.rt);
+          output[k_intensity.first]->getIntensityArray()->data.push_back(k_intensity.second);
         }
-
-        output[k]->getTimeArray()->data.push_back(current_rt);
-        output[k]->getIntensityArray()->data.push_back(integrated_intensity);
       }
+      setProgress(block_end);
     }
     endProgress();
   }
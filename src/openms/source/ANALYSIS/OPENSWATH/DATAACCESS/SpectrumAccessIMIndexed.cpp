@@ -0,0 +1,243 @@
+// --------------------------------------------------------------------------
+//                   OpenMS -- Open-Source Mass Spectrometry
+// --------------------------------------------------------------------------
+// Copyright The OpenMS Team -- Eberhard Karls University Tuebingen,
+// ETH Zurich, and Freie Universitaet Berlin 2002-2020.
+//
+// This software is released under a three-clause BSD license:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of any author or any participating institution
+//    may be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+// For a full list of authors, refer to the file AUTHORS.
+// --------------------------------------------------------------------------
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL ANY OF THE AUTHORS OR THE CONTRIBUTING
+// INSTITUTIONS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// --------------------------------------------------------------------------
+// $Maintainer: agent $
+// $Authors: agent $
+// --------------------------------------------------------------------------
+
+
+#include <OpenMS/ANALYSIS/OPENSWATH/DATAACCESS/SpectrumAccessIMIndexed.h>
+
+#include <OpenMS/CONCEPT/Exception.h>
+#include <OpenMS/CONCEPT/Macros.h>
+#include <OpenMS/DATASTRUCTURES/String.h>
+
+#include <algorithm>
+#include <exception>
+#include <limits>
+#include <numeric>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+namespace OpenMS
+{
+
+  SpectrumAccessIMIndexed::SpectrumAccessIMIndexed(OpenSwath::SpectrumAccessPtr sptr, Size block_size) :
+    SpectrumAccessTransforming(sptr)
+  {
+    if (block_size == 0)
+    {
+      throw Exception::IllegalArgument(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION,
+        "Block size of the ion mobility index needs to be larger than zero.");
+    }
+
+    boost::shared_ptr<std::vector<IMIndex> > index(new std::vector<IMIndex>(sptr_->getNrSpectra()));
+
+    // the spectra are indexed in parallel (using thread-local copies of the spectrum access)
+    int n_threads = 1;
+#ifdef _OPENMP
+    if (!omp_in_parallel()) n_threads = omp_get_max_threads();
+#endif
+    std::vector<OpenSwath::SpectrumAccessPtr> inputs(n_threads, sptr_);
+    for (int t = 1; t < n_threads; ++t)
+    {
+      inputs[t] = sptr_->lightClone();
+    }
+
+    std::exception_ptr error;
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic, 1) num_threads(n_threads)
+#endif
+    for (SignedSize i = 0; i < (SignedSize)index->size(); ++i)
+    {
+      int thread_num = 0;
+#ifdef _OPENMP
+      thread_num = omp_get_thread_num();
+#endif
+      try
+      {
+        buildIndex_(inputs[thread_num]->getSpectrumById(i), block_size, (*index)[i]);
+      }
+      catch (...)
+      {
+#ifdef _OPENMP
+#pragma omp critical (SpectrumAccessIMIndexed_error)
+#endif
+        if (!error) error = std::current_exception();
+      }
+    }
+    if (error)
+    {
+      std::rethrow_exception(error);
+    }
+
+    index_ = index;
+  }
+
+  SpectrumAccessIMIndexed::SpectrumAccessIMIndexed(OpenSwath::SpectrumAccessPtr sptr, boost::shared_ptr<const std::vector<IMIndex> > index) :
+    SpectrumAccessTransforming(sptr),
+    index_(index)
+  {
+  }
+
+  SpectrumAccessIMIndexed::~SpectrumAccessIMIndexed() {}
+
+  boost::shared_ptr<OpenSwath::ISpectrumAccess> SpectrumAccessIMIndexed::lightClone() const
+  {
+    // the index is read-only and can be shared
+    return boost::shared_ptr<SpectrumAccessIMIndexed>(new SpectrumAccessIMIndexed(sptr_->lightClone(), index_));
+  }
+
+  bool SpectrumAccessIMIndexed::hasIMIndex(int id) const
+  {
+    OPENMS_PRECONDITION(id >= 0, "Id needs to be larger than zero");
+    OPENMS_PRECONDITION(id < (int)index_->size(), "Id cannot be larger than number of spectra");
+    return (*index_)[id].has_im;
+  }
+
+  void SpectrumAccessIMIndexed::buildIndex_(const OpenSwath::SpectrumPtr& spectrum, Size block_size, IMIndex& index)
+  {
+    OpenSwath::BinaryDataArrayPtr im_arr = spectrum->getDriftTimeArray();
+    if (im_arr == nullptr)
+    {
+      return;
+    }
+    const std::vector<double>& im = im_arr->data;
+    if (im.size() != spectrum->getMZArray()->data.size() || im.size() > std::numeric_limits<UInt32>::max())
+    {
+      throw Exception::IllegalArgument(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION,
+        "Cannot index spectrum: ion mobility array does not match the m/z array.");
+    }
+    index.has_im = true;
+
+    // sort the peaks by ion mobility ...
+    std::vector<UInt32>& peaks = index.peaks;
+    peaks.resize(im.size());
+    std::iota(peaks.begin(), peaks.end(), 0);
+    std::stable_sort(peaks.begin(), peaks.end(), [&im](UInt32 a, UInt32 b) { return im[a] < im[b]; });
+
+    // ... and restore the original (m/z) order within each block
+    for (Size start = 0; start < peaks.size(); start += block_size)
+    {
+      const Size end = std::min(start + block_size, peaks.size());
+      index.block_start.push_back(start);
+      index.block_im_min.push_back(im[peaks[start]]);
+      index.block_im_max.push_back(im[peaks[end - 1]]);
+      std::sort(peaks.begin() + start, peaks.begin() + end);
+    }
+    index.block_start.push_back(peaks.size());
+  }
+
+  template <typename F>
+  void SpectrumAccessIMIndexed::visitBox_(const IMIndex& index, const OpenSwath::SpectrumPtr& spectrum,
+                                          double mz_lower, double mz_upper, double im_lower, double im_upper, F f)
+  {
+    const std::vector<double>& mz = spectrum->getMZArray()->data;
+    const std::vector<double>& im = spectrum->getDriftTimeArray()->data;
+
+    // the blocks are sorted by ion mobility: start with the first block that
+    // can contain values above im_lower, stop once all values exceed im_upper
+    Size b = std::distance(index.block_im_max.begin(),
+                           std::upper_bound(index.block_im_max.begin(), index.block_im_max.end(), im_lower));
+    for (; b < index.block_im_min.size() && index.block_im_min[b] < im_upper; ++b)
+    {
+      auto first = index.peaks.begin() + index.block_start[b];
+      auto last = index.peaks.begin() + index.block_start[b + 1];
+      // peaks within a block are sorted by m/z
+      auto p = std::upper_bound(first, last, mz_lower, [&mz](double value, UInt32 pos) { return value < mz[pos]; });
+      for (; p != last && mz[*p] < mz_upper; ++p)
+      {
+        if (im[*p] > im_lower && im[*p] < im_upper)
+        {
+          f(*p);
+        }
+      }
+    }
+  }
+
+  OpenSwath::SpectrumPtr SpectrumAccessIMIndexed::getSpectrumByIdInIMRange(int id, double drift_lower, double drift_upper)
+  {
+    OpenSwath::SpectrumPtr spectrum = sptr_->getSpectrumById(id);
+    const IMIndex& index = (*index_)[id];
+    if (!index.has_im)
+    {
+      return spectrum;
+    }
+
+    std::vector<UInt32> positions;
+    visitBox_(index, spectrum, -std::numeric_limits<double>::infinity(), std::numeric_limits<double>::infinity(),
+              drift_lower, drift_upper, [&positions](UInt32 pos) { positions.push_back(pos); });
+    std::sort(positions.begin(), positions.end()); // original order, i.e. sorted by m/z
+
+    const std::vector<double>& mz = spectrum->getMZArray()->data;
+    const std::vector<double>& intensity = spectrum->getIntensityArray()->data;
+    OpenSwath::BinaryDataArrayPtr im_arr = spectrum->getDriftTimeArray();
+
+    OpenSwath::BinaryDataArrayPtr mz_arr_out(new OpenSwath::BinaryDataArray);
+    OpenSwath::BinaryDataArrayPtr intens_arr_out(new OpenSwath::BinaryDataArray);
+    OpenSwath::BinaryDataArrayPtr im_arr_out(new OpenSwath::BinaryDataArray);
+    im_arr_out->description = im_arr->description;
+    mz_arr_out->data.reserve(positions.size());
+    intens_arr_out->data.reserve(positions.size());
+    im_arr_out->data.reserve(positions.size());
+    for (UInt32 pos : positions)
+    {
+      mz_arr_out->data.push_back(mz[pos]);
+      intens_arr_out->data.push_back(intensity[pos]);
+      im_arr_out->data.push_back(im_arr->data[pos]);
+    }
+
+    OpenSwath::SpectrumPtr output(new OpenSwath::Spectrum);
+    output->setMZArray(mz_arr_out);
+    output->setIntensityArray(intens_arr_out);
+    output->getDataArrays().push_back(im_arr_out);
+    return output;
+  }
+
+  double SpectrumAccessIMIndexed::integrateBox(int id, const OpenSwath::SpectrumPtr& spectrum,
+                                               double mz_lower, double mz_upper, double im_lower, double im_upper) const
+  {
+    const IMIndex& index = (*index_)[id];
+    if (!index.has_im)
+    {
+      throw Exception::IllegalArgument(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION,
+        "Spectrum " + String(id) + " has no ion mobility array.");
+    }
+    const std::vector<double>& intensity = spectrum->getIntensityArray()->data;
+
+    double integrated_intensity = 0;
+    visitBox_(index, spectrum, mz_lower, mz_upper, im_lower, im_upper,
+              [&integrated_intensity, &intensity](UInt32 pos) { integrated_intensity += intensity[pos]; });
+    return integrated_intensity;
+  }
+
+}
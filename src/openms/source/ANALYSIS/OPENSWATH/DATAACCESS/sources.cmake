@@ -7,6 +7,7 @@ MRMFeatureAccessOpenMS.cpp
 SpectrumAccessOpenMS.cpp
 SpectrumAccessOpenMSCached.cpp
 SpectrumAccessOpenMSInMemory.cpp
+SpectrumAccessIMIndexed.cpp
 SpectrumAccessSqMass.cpp
 SpectrumAccessTransforming.cpp
 SpectrumAccessQuadMZTransforming.cpp
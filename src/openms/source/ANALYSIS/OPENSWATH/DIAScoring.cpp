@@ -200,14 +200,10 @@ namespace OpenMS
     }
   }
 
-  /// Precursor isotope scores
-  void DIAScoring::dia_ms1_isotope_scores(double precursor_mz, SpectrumPtrType spectrum, size_t charge_state,
-                                          double& isotope_corr, double& isotope_overlap, const std::string& sum_formula)
+  void DIAScoring::getIsotopeIntensities_(double precursor_mz, SpectrumPtrType spectrum, size_t charge_state,
+                                          std::vector<double>& isotopes_int)
   {
     // collect the potential isotopes of this peak
-    double max_ratio;
-    int nr_occurences;
-    std::vector<double> isotopes_int;
     for (int iso = 0; iso <= dia_nr_isotopes_; ++iso)
     {
       double left  = precursor_mz + iso * C13C12_MASSDIFF_U / static_cast<double>(charge_state);
@@ -217,6 +213,16 @@ namespace OpenMS
       DIAHelpers::integrateWindow(spectrum, left, right, mz, intensity, dia_centroided_);
       isotopes_int.push_back(intensity);
     }
+  }
+
+  /// Precursor isotope scores
+  void DIAScoring::dia_ms1_isotope_scores(double precursor_mz, SpectrumPtrType spectrum, size_t charge_state,
+                                          double& isotope_corr, double& isotope_overlap, const std::string& sum_formula)
+  {
+    double max_ratio;
+    int nr_occurences;
+    std::vector<double> isotopes_int;
+    getIsotopeIntensities_(precursor_mz, spectrum, charge_state, isotopes_int);
 
     // calculate the scores:
     // isotope correlation (forward) and the isotope overlap (backward) scores
@@ -225,17 +231,50 @@ namespace OpenMS
     isotope_overlap = max_ratio;
   }
 
+  void DIAScoring::dia_ms1_isotope_scores(double precursor_mz, SpectrumPtrType spectrum, size_t charge_state,
+                                          const std::vector<double>& theoretical_isotopes,
+                                          double& isotope_corr, double& isotope_overlap)
+  {
+    if (theoretical_isotopes.size() < static_cast<Size>(dia_nr_isotopes_) + 1)
+    {
+      dia_ms1_isotope_scores(precursor_mz, spectrum, charge_state, isotope_corr, isotope_overlap);
+      return;
+    }
+
+    double max_ratio;
+    int nr_occurences;
+    std::vector<double> isotopes_int;
+    getIsotopeIntensities_(precursor_mz, spectrum, charge_state, isotopes_int);
+
+    // the Pearson correlation does not depend on the scaling of the theoretical pattern
+    isotope_corr = OpenSwath::cor_pearson(isotopes_int.begin(), isotopes_int.end(), theoretical_isotopes.begin());
+    if (boost::math::isnan(isotope_corr))
+    {
+      isotope_corr = 0;
+    }
+    largePeaksBeforeFirstIsotope_(spectrum, precursor_mz, isotopes_int[0], nr_occurences, max_ratio);
+    isotope_overlap = max_ratio;
+  }
+
   void DIAScoring::dia_by_ion_score(SpectrumPtrType spectrum,
                                     AASequence& sequence, int charge, double& bseries_score,
                                     double& yseries_score)
   {
-    bseries_score = 0;
-    yseries_score = 0;
     OPENMS_PRECONDITION(charge > 0, "Charge is a positive integer"); // for peptides, charge should be positive
 
-    double mz, intensity, left, right;
     std::vector<double> yseries, bseries;
     OpenMS::DIAHelpers::getBYSeries(sequence, bseries, yseries, generator, charge);
+    dia_by_ion_score(spectrum, bseries, yseries, bseries_score, yseries_score);
+  }
+
+  void DIAScoring::dia_by_ion_score(SpectrumPtrType spectrum,
+                                    const std::vector<double>& bseries, const std::vector<double>& yseries,
+                                    double& bseries_score, double& yseries_score)
+  {
+    bseries_score = 0;
+    yseries_score = 0;
+
+    double mz, intensity, left, right;
     for (Size it = 0; it < bseries.size(); it++)
     {
       left = bseries[it];
@@ -106,6 +106,8 @@ namespace OpenMS
     defaults_.setValidStrings("scoring_model", ListUtils::create<String>("default,single_transition"));
     defaults_.setValue("im_extra_drift", 0.0, "Extra drift time to extract for IM scoring (as a fraction, e.g. 0.25 means 25% extra on each side)", ListUtils::create<String>("advanced"));
     defaults_.setMinFloat("im_extra_drift", 0.0);
+    defaults_.setValue("spectrum_cache_size", 64.0, "Size (in MB) of the cache for the (added up) spectra at the peak group apices used for DIA scoring, which allows peak groups at similar retention times to reuse them (0 disables caching).", ListUtils::create<String>("advanced"));
+    defaults_.setMinFloat("spectrum_cache_size", 0.0);
 
     defaults_.insert("TransitionGroupPicker:", MRMTransitionGroupPicker().getDefaults());
 
@@ -197,6 +199,9 @@ namespace OpenMS
     // Store the peptide retention times in an intermediate map
     prepareProteinPeptideMaps_(transition_exp);
 
+    // Cached spectra from a previous run are of no use for these maps
+    if (spectrum_cache_) spectrum_cache_->clear();
+
     // Store the proteins from the input in the output feature map
     std::vector<ProteinHit> protein_hits;
     for (const ProteinType& prot : transition_exp.getProteins())
@@ -544,6 +549,7 @@ namespace OpenMS
                       im_extra_drift_,
                       su_,
                       spectrum_addition_method_);
+    scorer.setSpectrumCache(spectrum_cache_);
 
     ProteaseDigestion pd;
     pd.setEnzyme("Trypsin");
@@ -1011,6 +1017,8 @@ namespace OpenMS
     spectrum_addition_method_ = param_.getValue("spectrum_addition_method");
     spacing_for_spectra_resampling_ = param_.getValue("spacing_for_spectra_resampling");
     im_extra_drift_ = (double)param_.getValue("im_extra_drift");
+    double spectrum_cache_size = (double)param_.getValue("spectrum_cache_size");
+    spectrum_cache_.reset(spectrum_cache_size > 0 ? new OpenSwathScoring::SpectrumCache(spectrum_cache_size) : nullptr);
     uis_threshold_sn_ = param_.getValue("uis_threshold_sn");
     uis_threshold_peak_area_ = param_.getValue("uis_threshold_peak_area");
     scoring_model_ = param_.getValue("scoring_model");
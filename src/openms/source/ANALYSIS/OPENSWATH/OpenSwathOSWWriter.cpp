@@ -34,10 +34,19 @@
 
 #include <OpenMS/ANALYSIS/OPENSWATH/OpenSwathOSWWriter.h>
 
+#include <OpenMS/CONCEPT/LogStream.h>
+#include <OpenMS/DATASTRUCTURES/ListUtils.h>
 #include <OpenMS/FORMAT/SqliteConnector.h>
 
 #include <sqlite3.h>
 
+#include <cmath>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <mutex>
+#include <thread>
+
 namespace OpenMS
 {
 
@@ -214,45 +223,340 @@ namespace OpenMS
     return separated_scores;
   }
 
-  String OpenSwathOSWWriter::prepareLine(const OpenSwath::LightCompound& /* pep */,
-                                         const OpenSwath::LightTransition* /* transition */,
-                                         FeatureMap& output,
-                                         String id) const
+  namespace
+  {
+    /// Table name and columns of the rows in OpenSwathOSWWriter::OSWRows (in the order of its members)
+    struct OSWTable_
+    {
+      const char* name;
+      std::vector<const char*> columns;
+    };
+
+    const std::vector<OSWTable_>& oswTables_()
+    {
+      static const std::vector<OSWTable_> tables =
+      {
+        {"FEATURE", {"ID", "RUN_ID", "PRECURSOR_ID", "EXP_RT", "EXP_IM", "NORM_RT", "DELTA_RT", "LEFT_WIDTH", "RIGHT_WIDTH"}},
+        {"FEATURE_MS1", {"FEATURE_ID", "AREA_INTENSITY", "APEX_INTENSITY",
+          "VAR_MASSDEV_SCORE", "VAR_IM_MS1_DELTA_SCORE",
+          "VAR_MI_SCORE", "VAR_MI_CONTRAST_SCORE", "VAR_MI_COMBINED_SCORE", "VAR_ISOTOPE_CORRELATION_SCORE",
+          "VAR_ISOTOPE_OVERLAP_SCORE", "VAR_XCORR_COELUTION", "VAR_XCORR_COELUTION_CONTRAST",
+          "VAR_XCORR_COELUTION_COMBINED", "VAR_XCORR_SHAPE", "VAR_XCORR_SHAPE_CONTRAST", "VAR_XCORR_SHAPE_COMBINED"}},
+        {"FEATURE_PRECURSOR", {"FEATURE_ID", "ISOTOPE", "AREA_INTENSITY", "APEX_INTENSITY"}},
+        {"FEATURE_MS2", {"FEATURE_ID", "AREA_INTENSITY", "TOTAL_AREA_INTENSITY", "APEX_INTENSITY", "TOTAL_MI",
+          "VAR_BSERIES_SCORE", "VAR_DOTPROD_SCORE", "VAR_INTENSITY_SCORE",
+          "VAR_ISOTOPE_CORRELATION_SCORE", "VAR_ISOTOPE_OVERLAP_SCORE", "VAR_LIBRARY_CORR",
+          "VAR_LIBRARY_DOTPROD", "VAR_LIBRARY_MANHATTAN", "VAR_LIBRARY_RMSD", "VAR_LIBRARY_ROOTMEANSQUARE",
+          "VAR_LIBRARY_SANGLE", "VAR_LOG_SN_SCORE", "VAR_MANHATTAN_SCORE", "VAR_MASSDEV_SCORE", "VAR_MASSDEV_SCORE_WEIGHTED",
+          "VAR_MI_SCORE", "VAR_MI_WEIGHTED_SCORE", "VAR_MI_RATIO_SCORE", "VAR_NORM_RT_SCORE",
+          "VAR_XCORR_COELUTION", "VAR_XCORR_COELUTION_WEIGHTED", "VAR_XCORR_SHAPE",
+          "VAR_XCORR_SHAPE_WEIGHTED", "VAR_YSERIES_SCORE", "VAR_ELUTION_MODEL_FIT_SCORE",
+          "VAR_IM_XCORR_SHAPE", "VAR_IM_XCORR_COELUTION", "VAR_IM_DELTA_SCORE",
+          "VAR_SONAR_LAG", "VAR_SONAR_SHAPE", "VAR_SONAR_LOG_SN", "VAR_SONAR_LOG_DIFF", "VAR_SONAR_LOG_TREND", "VAR_SONAR_RSQ"}},
+        {"FEATURE_TRANSITION", {"FEATURE_ID", "TRANSITION_ID", "AREA_INTENSITY", "TOTAL_AREA_INTENSITY", "APEX_INTENSITY", "TOTAL_MI"}},
+        {"FEATURE_TRANSITION", {"FEATURE_ID", "TRANSITION_ID", "AREA_INTENSITY", "TOTAL_AREA_INTENSITY",
+          "APEX_INTENSITY", "TOTAL_MI", "VAR_INTENSITY_SCORE", "VAR_INTENSITY_RATIO_SCORE",
+          "VAR_LOG_INTENSITY", "VAR_XCORR_COELUTION", "VAR_XCORR_SHAPE", "VAR_LOG_SN_SCORE",
+          "VAR_MASSDEV_SCORE", "VAR_MI_SCORE", "VAR_MI_RATIO_SCORE",
+          "VAR_ISOTOPE_CORRELATION_SCORE", "VAR_ISOTOPE_OVERLAP_SCORE"}}
+      };
+      return tables;
+    }
+
+    /// The rows of @p rows, in the order of oswTables_()
+    std::vector< std::vector< std::vector<DataValue> >* > oswRowsByTable_(OpenSwathOSWWriter::OSWRows& rows)
+    {
+      return {&rows.feature, &rows.feature_ms1, &rows.feature_precursor, &rows.feature_ms2,
+              &rows.feature_transition, &rows.feature_transition_uis};
+    }
+
+    /// INSERT statement for @p table, either with placeholders (@p values is null) or with the given values as SQL literals
+    String insertStatement_(const OSWTable_& table, const std::vector<DataValue>* values = nullptr)
+    {
+      String sql = String("INSERT INTO ") + table.name + " (" + ListUtils::concatenate(std::vector<String>(table.columns.begin(), table.columns.end()), ", ") + ") VALUES (";
+      for (Size i = 0; i < table.columns.size(); ++i)
+      {
+        if (i > 0) sql += ", ";
+        if (values == nullptr)
+        {
+          sql += "?";
+          continue;
+        }
+        const DataValue& value = (*values)[i];
+        if (value.isEmpty() || (value.valueType() == DataValue::DOUBLE_VALUE && std::isnan((double)value)))
+        {
+          sql += "NULL";
+        }
+        else
+        {
+          sql += value.toString();
+        }
+      }
+      return sql + "); ";
+    }
+
+    /// Binds @p value to parameter @p pos of @p stmt (NULL for empty values, NaN and "nan" / "NULL" strings)
+    void bindValue_(sqlite3* db, sqlite3_stmt* stmt, int pos, const DataValue& value)
+    {
+      int rc;
+      switch (value.valueType())
+      {
+        case DataValue::INT_VALUE:
+          rc = sqlite3_bind_int64(stmt, pos, (long long)value);
+          break;
+
+        case DataValue::DOUBLE_VALUE:
+        {
+          double d = value;
+          rc = std::isnan(d) ? sqlite3_bind_null(stmt, pos) : sqlite3_bind_double(stmt, pos, d);
+          break;
+        }
+
+        case DataValue::EMPTY_VALUE:
+          rc = sqlite3_bind_null(stmt, pos);
+          break;
+
+        default:
+        {
+          String str = value.toString();
+          String lower = str;
+          lower.toLower();
+          if (lower == "null" || lower == "nan" || lower == "-nan")
+          {
+            rc = sqlite3_bind_null(stmt, pos);
+          }
+          else
+          {
+            // column affinity converts numeric text (e.g. identifiers) into numbers
+            rc = sqlite3_bind_text(stmt, pos, str.c_str(), (int)str.size(), SQLITE_TRANSIENT);
+          }
+        }
+      }
+      if (rc != SQLITE_OK)
+      {
+        throw Exception::IllegalArgument(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, sqlite3_errmsg(db));
+      }
+    }
+  }
+
+  Size OpenSwathOSWWriter::OSWRows::size() const
+  {
+    return feature.size() + feature_ms1.size() + feature_precursor.size() + feature_ms2.size() +
+           feature_transition.size() + feature_transition_uis.size();
+  }
+
+  void OpenSwathOSWWriter::OSWRows::clear()
+  {
+    for (auto table_rows : oswRowsByTable_(*this)) table_rows->clear();
+  }
+
+  /**
+    @brief Writes OSWRows to the database in a background thread
+
+    Rows are queued by the scoring threads and inserted using one cached
+    prepared statement per table. Inserts are grouped into large transactions
+    and the database uses WAL journaling without synchronous writes while
+    writing (the journal mode is reset when the writer is done).
+  */
+  struct OpenSwathOSWWriter::BulkWriter_
   {
-    std::stringstream sql, sql_feature, sql_feature_ms1, sql_feature_ms1_precursor, sql_feature_ms2, sql_feature_ms2_transition, sql_feature_uis_transition;
+    /// Number of rows per transaction
+    static constexpr Size ROWS_PER_TRANSACTION = 250000;
 
+    explicit BulkWriter_(const String& filename) :
+      filename_(filename)
+    {
+      thread_ = std::thread(&BulkWriter_::run_, this);
+    }
+
+    ~BulkWriter_()
+    {
+      {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+      }
+      cv_writer_.notify_all();
+      thread_.join();
+      if (error_ && !error_reported_)
+      {
+        try
+        {
+          std::rethrow_exception(error_);
+        }
+        catch (std::exception& e)
+        {
+          OPENMS_LOG_ERROR << "Error writing OSW file '" << filename_ << "': " << e.what() << std::endl;
+        }
+      }
+    }
+
+    void push(OSWRows& rows, Size max_queued_rows)
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      cv_producer_.wait(lock, [&] { return error_ || queued_rows_ == 0 || queued_rows_ + rows.size() <= max_queued_rows; });
+      throwError_();
+      queued_rows_ += rows.size();
+      queue_.push_back(OSWRows());
+      std::swap(queue_.back(), rows);
+      cv_writer_.notify_one();
+    }
+
+    void flush()
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      ++flush_requested_;
+      cv_writer_.notify_one();
+      cv_producer_.wait(lock, [&] { return error_ || flush_requested_ == 0; });
+      throwError_();
+    }
+
+  protected:
+    /// Rethrows the error of the writer thread (call with locked mutex)
+    void throwError_()
+    {
+      if (error_)
+      {
+        error_reported_ = true;
+        std::rethrow_exception(error_);
+      }
+    }
+
+    /// Writer thread
+    void run_()
+    {
+      std::vector<sqlite3_stmt*> statements(oswTables_().size(), nullptr);
+      try
+      {
+        SqliteConnector conn(filename_);
+        sqlite3* db = conn.getDB();
+        conn.executeStatement("PRAGMA journal_mode = WAL; PRAGMA synchronous = OFF; PRAGMA temp_store = MEMORY;");
+        for (Size t = 0; t < statements.size(); ++t)
+        {
+          conn.prepareStatement(&statements[t], insertStatement_(oswTables_()[t]));
+        }
+
+        bool in_transaction = false;
+        Size rows_in_transaction = 0;
+        while (true)
+        {
+          OSWRows rows;
+          bool commit = false, done = false;
+          {
+            std::unique_lock<std::mutex> lock(mutex_);
+            cv_writer_.wait(lock, [&] { return !queue_.empty() || stop_ || flush_requested_ > 0; });
+            if (!queue_.empty())
+            {
+              std::swap(rows, queue_.front());
+              queue_.pop_front();
+              queued_rows_ -= rows.size();
+              cv_producer_.notify_all();
+            }
+            else
+            {
+              commit = true;
+              done = stop_;
+            }
+          }
+
+          if (!in_transaction && rows.size() > 0)
+          {
+            conn.executeStatement("BEGIN TRANSACTION");
+            in_transaction = true;
+          }
+          auto table_rows = oswRowsByTable_(rows);
+          for (Size t = 0; t < table_rows.size(); ++t)
+          {
+            for (const auto& row : *table_rows[t])
+            {
+              for (Size k = 0; k < row.size(); ++k)
+              {
+                bindValue_(db, statements[t], (int)k + 1, row[k]);
+              }
+              if (sqlite3_step(statements[t]) != SQLITE_DONE)
+              {
+                throw Exception::IllegalArgument(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, sqlite3_errmsg(db));
+              }
+              sqlite3_reset(statements[t]);
+            }
+          }
+          rows_in_transaction += rows.size();
+
+          if (in_transaction && (commit || rows_in_transaction >= ROWS_PER_TRANSACTION))
+          {
+            conn.executeStatement("END TRANSACTION");
+            in_transaction = false;
+            rows_in_transaction = 0;
+          }
+
+          if (commit)
+          {
+            std::lock_guard<std::mutex> lock(mutex_);
+            flush_requested_ = 0;
+            cv_producer_.notify_all();
+          }
+          if (done) break;
+        }
+
+        for (sqlite3_stmt* stmt : statements) sqlite3_finalize(stmt);
+        statements.clear();
+        conn.executeStatement("PRAGMA journal_mode = DELETE;");
+      }
+      catch (...)
+      {
+        for (sqlite3_stmt* stmt : statements) sqlite3_finalize(stmt);
+        std::lock_guard<std::mutex> lock(mutex_);
+        error_ = std::current_exception();
+        cv_producer_.notify_all();
+      }
+    }
+
+    String filename_;
+    std::thread thread_;
+    std::mutex mutex_;
+    std::condition_variable cv_writer_; ///< wakes up the writer thread
+    std::condition_variable cv_producer_; ///< wakes up threads waiting in push() or flush()
+    std::deque<OSWRows> queue_;
+    Size queued_rows_ = 0;
+    Size flush_requested_ = 0;
+    bool stop_ = false;
+    std::exception_ptr error_;
+    bool error_reported_ = false;
+  };
+
+  void OpenSwathOSWWriter::prepareRows(const OpenSwath::LightCompound& /* pep */,
+                                       const OpenSwath::LightTransition* /* transition */,
+                                       const FeatureMap& output,
+                                       const String& id,
+                                       OSWRows& rows) const
+  {
+    // Conversion from UInt64 to int64_t to support SQLite (and conversion to 63 bits)
+    const DataValue run_id(static_cast<long long>(run_id_ & ~(1ULL << 63)));
+
+    // score as DataValue (empty if not set, NULL in the database)
+    auto score = [](const Feature& feature, const char* score_name)
+    {
+      return feature.getMetaValue(score_name);
+    };
+
+    std::vector< std::vector<DataValue> > ms2_transitions, uis_transitions;
     for (const auto& feature_it : output)
     {
       UInt64 uint64_feature_id = feature_it.getUniqueId();
-      int64_t feature_id = static_cast<int64_t >(uint64_feature_id & ~(1ULL << 63)); // clear sign bit
+      const DataValue feature_id(static_cast<long long>(uint64_feature_id & ~(1ULL << 63))); // clear sign bit
 
       for (const auto& sub_it : feature_it.getSubordinates())
       {
         if (sub_it.metaValueExists("FeatureLevel") && sub_it.getMetaValue("FeatureLevel") == "MS2")
         {
-          std::string total_mi = "NULL"; // total_mi is not guaranteed to be set
-          if (!sub_it.getMetaValue("total_mi").isEmpty())
-          {
-            total_mi = sub_it.getMetaValue("total_mi").toString();
-          }
-          sql_feature_ms2_transition  << "INSERT INTO FEATURE_TRANSITION "\
-            "(FEATURE_ID, TRANSITION_ID, AREA_INTENSITY, TOTAL_AREA_INTENSITY, APEX_INTENSITY, TOTAL_MI) VALUES ("
-                                      << feature_id << ", "
-                                      << sub_it.getMetaValue("native_id") << ", "
-                                      << sub_it.getIntensity() << ", "
-                                      << sub_it.getMetaValue("total_xic") << ", "
-                                      << sub_it.getMetaValue("peak_apex_int") << ", "
-                                      << total_mi << "); ";
+          // total_mi is not guaranteed to be set
+          ms2_transitions.push_back({feature_id, sub_it.getMetaValue("native_id"), (double)sub_it.getIntensity(),
+                                     sub_it.getMetaValue("total_xic"), sub_it.getMetaValue("peak_apex_int"), sub_it.getMetaValue("total_mi")});
         }
         else if (sub_it.metaValueExists("FeatureLevel") && sub_it.getMetaValue("FeatureLevel") == "MS1" && sub_it.getIntensity() > 0.0)
         {
           std::vector<String> precursor_id;
           OpenMS::String(sub_it.getMetaValue("native_id")).split(OpenMS::String("Precursor_i"), precursor_id);
-          sql_feature_ms1_precursor  << "INSERT INTO FEATURE_PRECURSOR (FEATURE_ID, ISOTOPE, AREA_INTENSITY, APEX_INTENSITY) VALUES ("
-                                      << feature_id << ", "
-                                      << precursor_id[1] << ", "
-                                      << sub_it.getIntensity() << ", "
-                                      << sub_it.getMetaValue("peak_apex_int") << "); ";
+          rows.feature_precursor.push_back({feature_id, precursor_id[1], (double)sub_it.getIntensity(), sub_it.getMetaValue("peak_apex_int")});
         }
       }
 
@@ -261,211 +565,140 @@ namespace OpenMS
       if (feature_it.metaValueExists("norm_RT") ) norm_rt = feature_it.getMetaValue("norm_RT");
       if (feature_it.metaValueExists("delta_rt") ) delta_rt = feature_it.getMetaValue("delta_rt");
 
-      sql_feature << "INSERT INTO FEATURE (ID, RUN_ID, PRECURSOR_ID, EXP_RT, EXP_IM, NORM_RT, DELTA_RT, LEFT_WIDTH, RIGHT_WIDTH) VALUES ("
-                  << feature_id << ", "
-                  // Conversion from UInt64 to int64_t to support SQLite (and conversion to 63 bits)
-                  <<  static_cast<int64_t >(run_id_ & ~(1ULL << 63)) << ", "
-                  << id << ", "
-                  << feature_it.getRT() << ", "
-                  << getScore(feature_it, "im_drift") << ", "
-                  << norm_rt << ", "
-                  << delta_rt << ", "
-                  << feature_it.getMetaValue("leftWidth") << ", "
-                  << feature_it.getMetaValue("rightWidth") << "); ";
-
-      sql_feature_ms2 << "INSERT INTO FEATURE_MS2 " \
-        "(FEATURE_ID, AREA_INTENSITY, TOTAL_AREA_INTENSITY, APEX_INTENSITY, TOTAL_MI, "\
-        "VAR_BSERIES_SCORE, VAR_DOTPROD_SCORE, VAR_INTENSITY_SCORE, " \
-        "VAR_ISOTOPE_CORRELATION_SCORE, VAR_ISOTOPE_OVERLAP_SCORE, VAR_LIBRARY_CORR,  "\
-        "VAR_LIBRARY_DOTPROD, VAR_LIBRARY_MANHATTAN, VAR_LIBRARY_RMSD, VAR_LIBRARY_ROOTMEANSQUARE, "\
-        "VAR_LIBRARY_SANGLE, VAR_LOG_SN_SCORE, VAR_MANHATTAN_SCORE, VAR_MASSDEV_SCORE, VAR_MASSDEV_SCORE_WEIGHTED, "\
-        "VAR_MI_SCORE, VAR_MI_WEIGHTED_SCORE, VAR_MI_RATIO_SCORE, VAR_NORM_RT_SCORE, "\
-        "VAR_XCORR_COELUTION,VAR_XCORR_COELUTION_WEIGHTED, VAR_XCORR_SHAPE, "\
-        "VAR_XCORR_SHAPE_WEIGHTED, VAR_YSERIES_SCORE, VAR_ELUTION_MODEL_FIT_SCORE, "\
-        "VAR_IM_XCORR_SHAPE, VAR_IM_XCORR_COELUTION, VAR_IM_DELTA_SCORE, " \
-        "VAR_SONAR_LAG, VAR_SONAR_SHAPE, VAR_SONAR_LOG_SN, VAR_SONAR_LOG_DIFF, VAR_SONAR_LOG_TREND, VAR_SONAR_RSQ "\
-        ") VALUES ("
-                      << feature_id << ", "
-                      << feature_it.getIntensity() << ", "
-                      << getScore(feature_it, "total_xic") << ", "
-                      << getScore(feature_it, "peak_apices_sum") << ", "
-                      << getScore(feature_it, "total_mi") << ", "
-                      << getScore(feature_it, "var_bseries_score") << ", "
-                      << getScore(feature_it, "var_dotprod_score") << ", "
-                      << getScore(feature_it, "var_intensity_score") << ", "
-                      << getScore(feature_it, "var_isotope_correlation_score") << ", "
-                      << getScore(feature_it, "var_isotope_overlap_score") << ", "
-                      << getScore(feature_it, "var_library_corr") << ", "
-                      << getScore(feature_it, "var_library_dotprod") << ", "
-                      << getScore(feature_it, "var_library_manhattan") << ", "
-                      << getScore(feature_it, "var_library_rmsd") << ", "
-                      << getScore(feature_it, "var_library_rootmeansquare") << ", "
-                      << getScore(feature_it, "var_library_sangle") << ", "
-                      << getScore(feature_it, "var_log_sn_score") << ", "
-                      << getScore(feature_it, "var_manhatt_score") << ", "
-                      << getScore(feature_it, "var_massdev_score") << ", "
-                      << getScore(feature_it, "var_massdev_score_weighted") << ", "
-                      << getScore(feature_it, "var_mi_score") << ", "
-                      << getScore(feature_it, "var_mi_weighted_score") << ", "
-                      << getScore(feature_it, "var_mi_ratio_score") << ", "
-                      << getScore(feature_it, "var_norm_rt_score") << ", "
-                      << getScore(feature_it, "var_xcorr_coelution") << ", "
-                      << getScore(feature_it, "var_xcorr_coelution_weighted") << ", "
-                      << getScore(feature_it, "var_xcorr_shape") << ", "
-                      << getScore(feature_it, "var_xcorr_shape_weighted") << ", "
-                      << getScore(feature_it, "var_yseries_score") << ", "
-                      << getScore(feature_it, "var_elution_model_fit_score") << ", "
-                      << getScore(feature_it, "var_im_xcorr_shape") << ", "
-                      << getScore(feature_it, "var_im_xcorr_coelution") << ", "
-                      << getScore(feature_it, "var_im_delta_score") << ", "
-                      << getScore(feature_it, "var_sonar_lag") << ", "
-                      << getScore(feature_it, "var_sonar_shape") << ", "
-                      << getScore(feature_it, "var_sonar_log_sn") << ", "
-                      << getScore(feature_it, "var_sonar_log_diff") << ", "
-                      << getScore(feature_it, "var_sonar_log_trend") << ", "
-                      << getScore(feature_it, "var_sonar_rsq") << "); ";
+      rows.feature.push_back({feature_id, run_id, id, feature_it.getRT(), score(feature_it, "im_drift"), norm_rt, delta_rt,
+                              feature_it.getMetaValue("leftWidth"), feature_it.getMetaValue("rightWidth")});
+
+      rows.feature_ms2.push_back({feature_id,
+                                  (double)feature_it.getIntensity(),
+                                  score(feature_it, "total_xic"),
+                                  score(feature_it, "peak_apices_sum"),
+                                  score(feature_it, "total_mi"),
+                                  score(feature_it, "var_bseries_score"),
+                                  score(feature_it, "var_dotprod_score"),
+                                  score(feature_it, "var_intensity_score"),
+                                  score(feature_it, "var_isotope_correlation_score"),
+                                  score(feature_it, "var_isotope_overlap_score"),
+                                  score(feature_it, "var_library_corr"),
+                                  score(feature_it, "var_library_dotprod"),
+                                  score(feature_it, "var_library_manhattan"),
+                                  score(feature_it, "var_library_rmsd"),
+                                  score(feature_it, "var_library_rootmeansquare"),
+                                  score(feature_it, "var_library_sangle"),
+                                  score(feature_it, "var_log_sn_score"),
+                                  score(feature_it, "var_manhatt_score"),
+                                  score(feature_it, "var_massdev_score"),
+                                  score(feature_it, "var_massdev_score_weighted"),
+                                  score(feature_it, "var_mi_score"),
+                                  score(feature_it, "var_mi_weighted_score"),
+                                  score(feature_it, "var_mi_ratio_score"),
+                                  score(feature_it, "var_norm_rt_score"),
+                                  score(feature_it, "var_xcorr_coelution"),
+                                  score(feature_it, "var_xcorr_coelution_weighted"),
+                                  score(feature_it, "var_xcorr_shape"),
+                                  score(feature_it, "var_xcorr_shape_weighted"),
+                                  score(feature_it, "var_yseries_score"),
+                                  score(feature_it, "var_elution_model_fit_score"),
+                                  score(feature_it, "var_im_xcorr_shape"),
+                                  score(feature_it, "var_im_xcorr_coelution"),
+                                  score(feature_it, "var_im_delta_score"),
+                                  score(feature_it, "var_sonar_lag"),
+                                  score(feature_it, "var_sonar_shape"),
+                                  score(feature_it, "var_sonar_log_sn"),
+                                  score(feature_it, "var_sonar_log_diff"),
+                                  score(feature_it, "var_sonar_log_trend"),
+                                  score(feature_it, "var_sonar_rsq")});
 
       if (use_ms1_traces_)
       {
-        sql_feature_ms1 << "INSERT INTO FEATURE_MS1 "\
-          "(FEATURE_ID, AREA_INTENSITY, APEX_INTENSITY, "\
-          " VAR_MASSDEV_SCORE, VAR_IM_MS1_DELTA_SCORE, "\
-          " VAR_MI_SCORE, VAR_MI_CONTRAST_SCORE, VAR_MI_COMBINED_SCORE, VAR_ISOTOPE_CORRELATION_SCORE, "\
-          " VAR_ISOTOPE_OVERLAP_SCORE, VAR_XCORR_COELUTION, VAR_XCORR_COELUTION_CONTRAST, "\
-          " VAR_XCORR_COELUTION_COMBINED, VAR_XCORR_SHAPE, VAR_XCORR_SHAPE_CONTRAST, VAR_XCORR_SHAPE_COMBINED "\
-          ") VALUES ("
-                        << feature_id << ", "
-                        << getScore(feature_it, "ms1_area_intensity") << ", "
-                        << getScore(feature_it, "ms1_apex_intensity") << ", "
-                        << getScore(feature_it, "var_ms1_ppm_diff") << ", "
-                        << getScore(feature_it, "var_im_ms1_delta_score") << ", "
-                        << getScore(feature_it, "var_ms1_mi_score") << ", "
-                        << getScore(feature_it, "var_ms1_mi_contrast_score") << ", "
-                        << getScore(feature_it, "var_ms1_mi_combined_score") << ", "
-                        << getScore(feature_it, "var_ms1_isotope_correlation") << ", "
-                        << getScore(feature_it, "var_ms1_isotope_overlap") << ", "
-                        << getScore(feature_it, "var_ms1_xcorr_coelution") << ", "
-                        << getScore(feature_it, "var_ms1_xcorr_coelution_contrast") << ", "
-                        << getScore(feature_it, "var_ms1_xcorr_coelution_combined") << ", "
-                        << getScore(feature_it, "var_ms1_xcorr_shape") << ", "
-                        << getScore(feature_it, "var_ms1_xcorr_shape_contrast") << ", "
-                        << getScore(feature_it, "var_ms1_xcorr_shape_combined") << "); ";
+        rows.feature_ms1.push_back({feature_id,
+                                    score(feature_it, "ms1_area_intensity"),
+                                    score(feature_it, "ms1_apex_intensity"),
+                                    score(feature_it, "var_ms1_ppm_diff"),
+                                    score(feature_it, "var_im_ms1_delta_score"),
+                                    score(feature_it, "var_ms1_mi_score"),
+                                    score(feature_it, "var_ms1_mi_contrast_score"),
+                                    score(feature_it, "var_ms1_mi_combined_score"),
+                                    score(feature_it, "var_ms1_isotope_correlation"),
+                                    score(feature_it, "var_ms1_isotope_overlap"),
+                                    score(feature_it, "var_ms1_xcorr_coelution"),
+                                    score(feature_it, "var_ms1_xcorr_coelution_contrast"),
+                                    score(feature_it, "var_ms1_xcorr_coelution_combined"),
+                                    score(feature_it, "var_ms1_xcorr_shape"),
+                                    score(feature_it, "var_ms1_xcorr_shape_contrast"),
+                                    score(feature_it, "var_ms1_xcorr_shape_combined")});
       }
 
       if (enable_uis_scoring_)
       {
-        auto id_target_transition_names = getSeparateScore(feature_it, "id_target_transition_names");
-        auto id_target_area_intensity = getSeparateScore(feature_it, "id_target_area_intensity");
-        auto id_target_total_area_intensity = getSeparateScore(feature_it, "id_target_total_area_intensity");
-        auto id_target_apex_intensity = getSeparateScore(feature_it, "id_target_apex_intensity");
-        auto id_target_total_mi = getSeparateScore(feature_it, "id_target_apex_intensity");
-        auto id_target_intensity_score = getSeparateScore(feature_it, "id_target_intensity_score");
-        auto id_target_intensity_ratio_score = getSeparateScore(feature_it, "id_target_intensity_ratio_score");
-        auto id_target_log_intensity = getSeparateScore(feature_it, "id_target_ind_log_intensity");
-        auto id_target_ind_xcorr_coelution = getSeparateScore(feature_it, "id_target_ind_xcorr_coelution");
-        auto id_target_ind_xcorr_shape = getSeparateScore(feature_it, "id_target_ind_xcorr_shape");
-        auto id_target_ind_log_sn_score = getSeparateScore(feature_it, "id_target_ind_log_sn_score");
-        auto id_target_ind_massdev_score = getSeparateScore(feature_it, "id_target_ind_massdev_score");
-        auto id_target_ind_mi_score = getSeparateScore(feature_it, "id_target_ind_mi_score");
-        auto id_target_ind_mi_ratio_score = getSeparateScore(feature_it, "id_target_ind_mi_ratio_score");
-        auto id_target_ind_isotope_correlation = getSeparateScore(feature_it, "id_target_ind_isotope_correlation");
-        auto id_target_ind_isotope_overlap = getSeparateScore(feature_it, "id_target_ind_isotope_overlap");
-
-        if (feature_it.metaValueExists("id_target_num_transitions"))
+        for (const String prefix : {"id_target_", "id_decoy_"})
         {
-          int id_target_num_transitions = feature_it.getMetaValue("id_target_num_transitions");
+          if (!feature_it.metaValueExists(prefix + "num_transitions")) continue;
 
-          for (int i = 0; i < id_target_num_transitions; ++i)
+          // note that targets historically report the apex intensity as total MI
+          const std::vector< std::vector<String> > columns =
           {
-            sql_feature_uis_transition  << "INSERT INTO FEATURE_TRANSITION "\
-              "(FEATURE_ID, TRANSITION_ID, AREA_INTENSITY, TOTAL_AREA_INTENSITY, "\
-              " APEX_INTENSITY, TOTAL_MI, VAR_INTENSITY_SCORE, VAR_INTENSITY_RATIO_SCORE, "\
-              " VAR_LOG_INTENSITY, VAR_XCORR_COELUTION, VAR_XCORR_SHAPE, VAR_LOG_SN_SCORE, "\
-              " VAR_MASSDEV_SCORE, VAR_MI_SCORE, VAR_MI_RATIO_SCORE, "\
-              " VAR_ISOTOPE_CORRELATION_SCORE, VAR_ISOTOPE_OVERLAP_SCORE "\
-              ") VALUES ("
-                                        << feature_id << ", "
-                                        << id_target_transition_names[i] << ", "
-                                        << id_target_area_intensity[i] << ", "
-                                        << id_target_total_area_intensity[i] << ", "
-                                        << id_target_apex_intensity[i] << ", "
-                                        << id_target_total_mi[i] << ", "
-                                        << id_target_intensity_score[i] << ", "
-                                        << id_target_intensity_ratio_score[i] << ", "
-                                        << id_target_log_intensity[i] << ", "
-                                        << id_target_ind_xcorr_coelution[i] << ", "
-                                        << id_target_ind_xcorr_shape[i] << ", "
-                                        << id_target_ind_log_sn_score[i] << ", "
-                                        << id_target_ind_massdev_score[i] << ", "
-                                        << id_target_ind_mi_score[i] << ", "
-                                        << id_target_ind_mi_ratio_score[i] << ", "
-                                        << id_target_ind_isotope_correlation[i] << ", "
-                                        << id_target_ind_isotope_overlap[i] << "); ";
-          }
-        }
-
-        auto id_decoy_transition_names = getSeparateScore(feature_it, "id_decoy_transition_names");
-        auto id_decoy_area_intensity = getSeparateScore(feature_it, "id_decoy_area_intensity");
-        auto id_decoy_total_area_intensity = getSeparateScore(feature_it, "id_decoy_total_area_intensity");
-        auto id_decoy_apex_intensity = getSeparateScore(feature_it, "id_decoy_apex_intensity");
-        auto id_decoy_total_mi = getSeparateScore(feature_it, "id_decoy_total_mi");
-        auto id_decoy_intensity_score = getSeparateScore(feature_it, "id_decoy_intensity_score");
-        auto id_decoy_intensity_ratio_score = getSeparateScore(feature_it, "id_decoy_intensity_ratio_score");
-        auto id_decoy_log_intensity = getSeparateScore(feature_it, "id_decoy_ind_log_intensity");
-        auto id_decoy_ind_xcorr_coelution = getSeparateScore(feature_it, "id_decoy_ind_xcorr_coelution");
-        auto id_decoy_ind_xcorr_shape = getSeparateScore(feature_it, "id_decoy_ind_xcorr_shape");
-        auto id_decoy_ind_log_sn_score = getSeparateScore(feature_it, "id_decoy_ind_log_sn_score");
-        auto id_decoy_ind_massdev_score = getSeparateScore(feature_it, "id_decoy_ind_massdev_score");
-        auto id_decoy_ind_mi_score = getSeparateScore(feature_it, "id_decoy_ind_mi_score");
-        auto id_decoy_ind_mi_ratio_score = getSeparateScore(feature_it, "id_decoy_ind_mi_ratio_score");
-        auto id_decoy_ind_isotope_correlation = getSeparateScore(feature_it, "id_decoy_ind_isotope_correlation");
-        auto id_decoy_ind_isotope_overlap = getSeparateScore(feature_it, "id_decoy_ind_isotope_overlap");
-
-        if (feature_it.metaValueExists("id_decoy_num_transitions"))
-        {
-          int id_decoy_num_transitions = feature_it.getMetaValue("id_decoy_num_transitions");
-
-          for (int i = 0; i < id_decoy_num_transitions; ++i)
+            getSeparateScore(feature_it, prefix + "transition_names"),
+            getSeparateScore(feature_it, prefix + "area_intensity"),
+            getSeparateScore(feature_it, prefix + "total_area_intensity"),
+            getSeparateScore(feature_it, prefix + "apex_intensity"),
+            getSeparateScore(feature_it, prefix + (prefix == "id_target_" ? "apex_intensity" : "total_mi")),
+            getSeparateScore(feature_it, prefix + "intensity_score"),
+            getSeparateScore(feature_it, prefix + "intensity_ratio_score"),
+            getSeparateScore(feature_it, prefix + "ind_log_intensity"),
+            getSeparateScore(feature_it, prefix + "ind_xcorr_coelution"),
+            getSeparateScore(feature_it, prefix + "ind_xcorr_shape"),
+            getSeparateScore(feature_it, prefix + "ind_log_sn_score"),
+            getSeparateScore(feature_it, prefix + "ind_massdev_score"),
+            getSeparateScore(feature_it, prefix + "ind_mi_score"),
+            getSeparateScore(feature_it, prefix + "ind_mi_ratio_score"),
+            getSeparateScore(feature_it, prefix + "ind_isotope_correlation"),
+            getSeparateScore(feature_it, prefix + "ind_isotope_overlap")
+          };
+
+          int num_transitions = feature_it.getMetaValue(prefix + "num_transitions");
+          for (int i = 0; i < num_transitions; ++i)
           {
-             sql_feature_uis_transition  << "INSERT INTO FEATURE_TRANSITION "\
-                "(FEATURE_ID, TRANSITION_ID, AREA_INTENSITY, TOTAL_AREA_INTENSITY, "\
-                " APEX_INTENSITY, TOTAL_MI, VAR_INTENSITY_SCORE, VAR_INTENSITY_RATIO_SCORE, "\
-                " VAR_LOG_INTENSITY, VAR_XCORR_COELUTION, VAR_XCORR_SHAPE, VAR_LOG_SN_SCORE, "\
-                " VAR_MASSDEV_SCORE, VAR_MI_SCORE, VAR_MI_RATIO_SCORE, "\
-                " VAR_ISOTOPE_CORRELATION_SCORE, VAR_ISOTOPE_OVERLAP_SCORE) "\
-                "VALUES ("
-                                        << feature_id << ", "
-                                        << id_decoy_transition_names[i] << ", "
-                                        << id_decoy_area_intensity[i] << ", "
-                                        << id_decoy_total_area_intensity[i] << ", "
-                                        << id_decoy_apex_intensity[i] << ", "
-                                        << id_decoy_total_mi[i] << ", "
-                                        << id_decoy_intensity_score[i] << ", "
-                                        << id_decoy_intensity_ratio_score[i] << ", "
-                                        << id_decoy_log_intensity[i] << ", "
-                                        << id_decoy_ind_xcorr_coelution[i] << ", "
-                                        << id_decoy_ind_xcorr_shape[i] << ", "
-                                        << id_decoy_ind_log_sn_score[i] << ", "
-                                        << id_decoy_ind_massdev_score[i] << ", "
-                                        << id_decoy_ind_mi_score[i] << ", "
-                                        << id_decoy_ind_mi_ratio_score[i] << ", "
-                                        << id_decoy_ind_isotope_correlation[i] << ", "
-                                        << id_decoy_ind_isotope_overlap[i] << "); ";
+            std::vector<DataValue> row(1, feature_id);
+            for (const auto& column : columns)
+            {
+              row.push_back(column[i]);
+            }
+            uis_transitions.push_back(std::move(row));
           }
         }
       }
     }
 
-    if (enable_uis_scoring_ && !sql_feature_uis_transition.str().empty() )
+    if (enable_uis_scoring_ && !uis_transitions.empty())
     {
-      sql << sql_feature.str() << sql_feature_ms1.str() << sql_feature_ms1_precursor.str() << sql_feature_ms2.str() << sql_feature_uis_transition.str();
+      rows.feature_transition_uis.insert(rows.feature_transition_uis.end(),
+          std::make_move_iterator(uis_transitions.begin()), std::make_move_iterator(uis_transitions.end()));
     }
     else
     {
-      sql << sql_feature.str() << sql_feature_ms1.str() << sql_feature_ms1_precursor.str() << sql_feature_ms2.str() << sql_feature_ms2_transition.str();
+      rows.feature_transition.insert(rows.feature_transition.end(),
+          std::make_move_iterator(ms2_transitions.begin()), std::make_move_iterator(ms2_transitions.end()));
     }
+  }
+
+  String OpenSwathOSWWriter::prepareLine(const OpenSwath::LightCompound& pep,
+                                         const OpenSwath::LightTransition* transition,
+                                         FeatureMap& output,
+                                         String id) const
+  {
+    OSWRows rows;
+    prepareRows(pep, transition, output, id, rows);
 
-    return sql.str();
+    String sql;
+    auto table_rows = oswRowsByTable_(rows);
+    for (Size t = 0; t < table_rows.size(); ++t)
+    {
+      for (const auto& row : *table_rows[t])
+      {
+        sql += insertStatement_(oswTables_()[t], &row);
+      }
+    }
+    return sql;
   }
 
   void OpenSwathOSWWriter::writeLines(const std::vector<String>& to_osw_output)
@@ -478,5 +711,20 @@ namespace OpenMS
     }
     conn.executeStatement("END TRANSACTION");
   }
-}
 
+  void OpenSwathOSWWriter::writeRows(OSWRows& rows, Size max_queued_rows)
+  {
+    if (!doWrite_ || rows.size() == 0) return;
+
+    {
+      std::lock_guard<std::mutex> lock(*bulk_writer_mutex_);
+      if (bulk_writer_ == nullptr) bulk_writer_ = std::make_shared<BulkWriter_>(output_filename_);
+    }
+    bulk_writer_->push(rows, max_queued_rows);
+  }
+
+  void OpenSwathOSWWriter::flush()
+  {
+    if (bulk_writer_ != nullptr) bulk_writer_->flush();
+  }
+}
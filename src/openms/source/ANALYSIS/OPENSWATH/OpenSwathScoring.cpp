@@ -45,9 +45,12 @@
 
 // auxiliary
 #include <OpenMS/ANALYSIS/OPENSWATH/DATAACCESS/DataAccessHelper.h>
+#include <OpenMS/ANALYSIS/OPENSWATH/DATAACCESS/SpectrumAccessIMIndexed.h>
 #include <OpenMS/MATH/STATISTICS/StatisticFunctions.h>
 #include <OpenMS/ANALYSIS/OPENSWATH/SpectrumAddition.h>
 
+#include <tuple>
+
 // basic file operations
 
 namespace OpenMS
@@ -96,6 +99,81 @@ namespace OpenMS
 namespace OpenMS
 {
 
+  bool OpenSwathScoring::SpectrumCache::Key::operator<(const Key& rhs) const
+  {
+    return std::tie(spectra, nr_spectra_to_add, drift_lower, drift_upper) <
+           std::tie(rhs.spectra, rhs.nr_spectra_to_add, rhs.drift_lower, rhs.drift_upper);
+  }
+
+  OpenSwathScoring::SpectrumCache::SpectrumCache(double max_size_mb) :
+    max_bytes_(static_cast<Size>(std::max(0.0, max_size_mb) * 1024 * 1024)),
+    bytes_(0),
+    hits_(0),
+    misses_(0)
+  {
+  }
+
+  OpenSwath::SpectrumPtr OpenSwathScoring::SpectrumCache::get(const Key& key)
+  {
+    auto it = index_.find(key);
+    if (it == index_.end())
+    {
+      ++misses_;
+      return OpenSwath::SpectrumPtr();
+    }
+    ++hits_;
+    // move to front (most recently used)
+    entries_.splice(entries_.begin(), entries_, it->second);
+    return it->second->spectrum;
+  }
+
+  void OpenSwathScoring::SpectrumCache::insert(const Key& key, const OpenSwath::SpectrumPtr& spectrum,
+                                               const std::vector<OpenSwath::SpectrumAccessPtr>& maps)
+  {
+    if (index_.find(key) != index_.end()) return;
+
+    Size bytes = sizeof(Entry);
+    for (const auto& da : spectrum->getDataArrays())
+    {
+      bytes += da->data.size() * sizeof(double);
+    }
+    if (bytes > max_bytes_) return;
+
+    // evict least recently used spectra
+    while (bytes_ + bytes > max_bytes_)
+    {
+      bytes_ -= entries_.back().bytes;
+      index_.erase(entries_.back().key);
+      entries_.pop_back();
+    }
+
+    entries_.push_front(Entry{key, spectrum, maps, bytes});
+    index_[key] = entries_.begin();
+    bytes_ += bytes;
+  }
+
+  void OpenSwathScoring::SpectrumCache::clear()
+  {
+    entries_.clear();
+    index_.clear();
+    bytes_ = 0;
+  }
+
+  Size OpenSwathScoring::SpectrumCache::size() const
+  {
+    return entries_.size();
+  }
+
+  Size OpenSwathScoring::SpectrumCache::getHits() const
+  {
+    return hits_;
+  }
+
+  Size OpenSwathScoring::SpectrumCache::getMisses() const
+  {
+    return misses_;
+  }
+
   /// Constructor
   OpenSwathScoring::OpenSwathScoring() :
     rt_normalization_factor_(1.0),
@@ -126,6 +204,11 @@ namespace OpenMS
     this->su_ = su;
   }
 
+  void OpenSwathScoring::setSpectrumCache(SpectrumCachePtr cache)
+  {
+    spectrum_cache_ = cache;
+  }
+
   void OpenSwathScoring::calculateDIAScores(OpenSwath::IMRMFeature* imrmfeature,
                                             const std::vector<TransitionType>& transitions,
                                             const std::vector<OpenSwath::SwathMap>& swath_maps,
@@ -201,11 +284,18 @@ namespace OpenMS
     // Peptide-specific scores
     if (compound.isPeptide())
     {
-      // Presence of b/y series score
-      OpenMS::AASequence aas;
-      int by_charge_state = 1; // for which charge states should we check b/y series
-      OpenSwathDataAccessHelper::convertPeptideToAASequence(compound, aas);
-      diascoring.dia_by_ion_score(spectrum, aas, by_charge_state, scores.bseries_score, scores.yseries_score);
+      // Presence of b/y series score (use precomputed singly charged series from the library if available)
+      if (!compound.bseries.empty() || !compound.yseries.empty())
+      {
+        diascoring.dia_by_ion_score(spectrum, compound.bseries, compound.yseries, scores.bseries_score, scores.yseries_score);
+      }
+      else
+      {
+        OpenMS::AASequence aas;
+        int by_charge_state = 1; // for which charge states should we check b/y series
+        OpenSwathDataAccessHelper::convertPeptideToAASequence(compound, aas);
+        diascoring.dia_by_ion_score(spectrum, aas, by_charge_state, scores.bseries_score, scores.yseries_score);
+      }
     }
 
     if (ms1_map && ms1_map->getNrSpectra() > 0) 
@@ -254,7 +344,14 @@ namespace OpenMS
         precursor_charge = compound.getChargeState();
       }
 
-      if (compound.isPeptide())
+      if (compound.isPeptide() && !compound.precursor_isotopes.empty())
+      {
+        // precomputed isotope envelope from the library
+        diascoring.dia_ms1_isotope_scores(precursor_mz, ms1_spectrum,
+                                          precursor_charge, compound.precursor_isotopes,
+                                          scores.ms1_isotope_correlation, scores.ms1_isotope_overlap);
+      }
+      else if (compound.isPeptide())
       {
         diascoring.dia_ms1_isotope_scores(precursor_mz, ms1_spectrum,
                                           precursor_charge, scores.ms1_isotope_correlation,
@@ -499,7 +596,24 @@ namespace OpenMS
   OpenSwath::SpectrumPtr OpenSwathScoring::fetchSpectrumSwath(OpenSwath::SpectrumAccessPtr swath_map,
                                                               double RT, int nr_spectra_to_add, const double drift_lower, const double drift_upper)
   {
-    return getAddedSpectra_(swath_map, RT, nr_spectra_to_add, drift_lower, drift_upper);
+    if (!spectrum_cache_)
+    {
+      return getAddedSpectra_(swath_map, RT, nr_spectra_to_add, drift_lower, drift_upper);
+    }
+
+    SpectrumCache::Key key;
+    key.spectra.emplace_back(swath_map.get(), getClosestSpectrum_(swath_map, RT));
+    key.nr_spectra_to_add = nr_spectra_to_add;
+    key.drift_lower = drift_lower;
+    key.drift_upper = drift_upper;
+
+    OpenSwath::SpectrumPtr spectrum = spectrum_cache_->get(key);
+    if (!spectrum)
+    {
+      spectrum = getAddedSpectra_(swath_map, RT, nr_spectra_to_add, drift_lower, drift_upper);
+      spectrum_cache_->insert(key, spectrum, {swath_map});
+    }
+    return spectrum;
   }
 
   OpenSwath::SpectrumPtr OpenSwathScoring::fetchSpectrumSwath(std::vector<OpenSwath::SwathMap> swath_maps,
@@ -507,20 +621,39 @@ namespace OpenMS
   {
     if (swath_maps.size() == 1)
     {
-      return getAddedSpectra_(swath_maps[0].sptr, RT, nr_spectra_to_add, drift_lower, drift_upper);
+      return fetchSpectrumSwath(swath_maps[0].sptr, RT, nr_spectra_to_add, drift_lower, drift_upper);
     }
-    else
+
+    SpectrumCache::Key key;
+    std::vector<OpenSwath::SpectrumAccessPtr> maps;
+    if (spectrum_cache_)
     {
-      // multiple SWATH maps for a single precursor -> this is SONAR data
-      std::vector<OpenSwath::SpectrumPtr> all_spectra;
-      for (size_t i = 0; i < swath_maps.size(); ++i)
+      for (const auto& m : swath_maps)
       {
-        OpenSwath::SpectrumPtr spec = getAddedSpectra_(swath_maps[i].sptr, RT, nr_spectra_to_add, drift_lower, drift_upper);
-        all_spectra.push_back(spec);
+        key.spectra.emplace_back(m.sptr.get(), getClosestSpectrum_(m.sptr, RT));
+        maps.push_back(m.sptr);
       }
-      OpenSwath::SpectrumPtr spectrum_ = SpectrumAddition::addUpSpectra(all_spectra, spacing_for_spectra_resampling_, true);
-      return spectrum_;
+      key.nr_spectra_to_add = nr_spectra_to_add;
+      key.drift_lower = drift_lower;
+      key.drift_upper = drift_upper;
+
+      OpenSwath::SpectrumPtr spectrum = spectrum_cache_->get(key);
+      if (spectrum) return spectrum;
     }
+
+    // multiple SWATH maps for a single precursor -> this is SONAR data
+    std::vector<OpenSwath::SpectrumPtr> all_spectra;
+    for (size_t i = 0; i < swath_maps.size(); ++i)
+    {
+      OpenSwath::SpectrumPtr spec = getAddedSpectra_(swath_maps[i].sptr, RT, nr_spectra_to_add, drift_lower, drift_upper);
+      all_spectra.push_back(spec);
+    }
+    OpenSwath::SpectrumPtr spectrum_ = SpectrumAddition::addUpSpectra(all_spectra, spacing_for_spectra_resampling_, true);
+    if (spectrum_cache_)
+    {
+      spectrum_cache_->insert(key, spectrum_, maps);
+    }
+    return spectrum_;
   }
 
   OpenSwath::SpectrumPtr filterByDrift(const OpenSwath::SpectrumPtr input, const double drift_lower, const double drift_upper)
@@ -570,18 +703,29 @@ namespace OpenMS
     return output;
   }
 
+  /// Spectrum @p idx of @p swath_map, filtered by drift time if @p drift_upper > 0 (using the ion mobility index if available)
+  OpenSwath::SpectrumPtr getDriftFilteredSpectrum(const OpenSwath::SpectrumAccessPtr& swath_map, int idx,
+                                                  const double drift_lower, const double drift_upper)
+  {
+    if (drift_upper <= 0)
+    {
+      return swath_map->getSpectrumById(idx);
+    }
+    SpectrumAccessIMIndexed* indexed_map = dynamic_cast<SpectrumAccessIMIndexed*>(swath_map.get());
+    if (indexed_map != nullptr && indexed_map->hasIMIndex(idx))
+    {
+      return indexed_map->getSpectrumByIdInIMRange(idx, drift_lower, drift_upper);
+    }
+    return filterByDrift(swath_map->getSpectrumById(idx), drift_lower, drift_upper);
+  }
 
-  OpenSwath::SpectrumPtr OpenSwathScoring::getAddedSpectra_(OpenSwath::SpectrumAccessPtr swath_map,
-                                                            double RT, int nr_spectra_to_add, const double drift_lower, const double drift_upper)
+
+  int OpenSwathScoring::getClosestSpectrum_(const OpenSwath::SpectrumAccessPtr& swath_map, double RT)
   {
     std::vector<std::size_t> indices = swath_map->getSpectraByRT(RT, 0.0);
-    OpenSwath::SpectrumPtr added_spec(new OpenSwath::Spectrum);
-    added_spec->getDataArrays().push_back( OpenSwath::BinaryDataArrayPtr(new OpenSwath::BinaryDataArray) );
-    added_spec->getDataArrays().back()->description = "Ion Mobility";
-
-    if (indices.empty() )
+    if (indices.empty())
     {
-      return added_spec;
+      return -1;
     }
     int closest_idx = boost::numeric_cast<int>(indices[0]);
     if (indices[0] != 0 &&
@@ -590,38 +734,43 @@ namespace OpenMS
     {
       closest_idx--;
     }
+    return closest_idx;
+  }
+
+  OpenSwath::SpectrumPtr OpenSwathScoring::getAddedSpectra_(OpenSwath::SpectrumAccessPtr swath_map,
+                                                            double RT, int nr_spectra_to_add, const double drift_lower, const double drift_upper)
+  {
+    OpenSwath::SpectrumPtr added_spec(new OpenSwath::Spectrum);
+    added_spec->getDataArrays().push_back( OpenSwath::BinaryDataArrayPtr(new OpenSwath::BinaryDataArray) );
+    added_spec->getDataArrays().back()->description = "Ion Mobility";
+
+    int closest_idx = getClosestSpectrum_(swath_map, RT);
+    if (closest_idx < 0)
+    {
+      return added_spec;
+    }
 
     if (nr_spectra_to_add == 1)
     {
-      added_spec = swath_map->getSpectrumById(closest_idx);
-      if (drift_upper > 0) 
-      {
-        added_spec = filterByDrift(added_spec, drift_lower, drift_upper);
-      }
+      added_spec = getDriftFilteredSpectrum(swath_map, closest_idx, drift_lower, drift_upper);
     }
     else
     {
       std::vector<OpenSwath::SpectrumPtr> all_spectra;
-      // always add the spectrum 0, then add those right and left
-      all_spectra.push_back(swath_map->getSpectrumById(closest_idx));
+      // always add the spectrum 0, then add those right and left (all filtered by drift time before further processing)
+      all_spectra.push_back(getDriftFilteredSpectrum(swath_map, closest_idx, drift_lower, drift_upper));
       for (int i = 1; i <= nr_spectra_to_add / 2; i++) // cast to int is intended!
       {
         if (closest_idx - i >= 0)
         {
-          all_spectra.push_back(swath_map->getSpectrumById(closest_idx - i));
+          all_spectra.push_back(getDriftFilteredSpectrum(swath_map, closest_idx - i, drift_lower, drift_upper));
         }
         if (closest_idx + i < (int)swath_map->getNrSpectra())
         {
-          all_spectra.push_back(swath_map->getSpectrumById(closest_idx + i));
+          all_spectra.push_back(getDriftFilteredSpectrum(swath_map, closest_idx + i, drift_lower, drift_upper));
         }
       }
 
-      // Filter all spectra by drift time before further processing
-      if (drift_upper > 0) 
-      {
-        for (auto& s: all_spectra) s = filterByDrift(s, drift_lower, drift_upper);
-      }
-
       // add up all spectra
       if (spectra_addition_method_ == "simple")
       {
@@ -34,6 +34,14 @@
 
 #include <OpenMS/ANALYSIS/OPENSWATH/OpenSwathWorkflow.h>
 
+#include <OpenMS/FORMAT/DATAACCESS/NoopMSDataConsumer.h>
+#include <OpenMS/SYSTEM/StopWatch.h>
+
+#include <condition_variable>
+#include <exception>
+#include <memory>
+#include <mutex>
+
 // OpenSwathCalibrationWorkflow
 namespace OpenMS
 {
@@ -78,7 +86,11 @@ namespace OpenMS
     OPENMS_LOG_DEBUG << "performRTNormalization method starting" << std::endl;
     std::vector< OpenMS::MSChromatogram > irt_chromatograms;
     TransformationDescription trafo; // dummy
+    StopWatch sw;
+    sw.start();
     this->simpleExtractChromatograms_(swath_maps, irt_transitions, irt_chromatograms, trafo, cp_irt, sonar, load_into_memory);
+    sw.stop();
+    OPENMS_LOG_INFO << "Calibration timing: chromatogram extraction " << StopWatch::toString(sw.getClockTime()) << std::endl;
 
     // debug output of the iRT chromatograms
     if (irt_mzml_out.empty() && debug_level > 1)
@@ -144,41 +156,12 @@ namespace OpenMS
     }
 
     // 3. Pick input chromatograms to identify RT pairs from the input data
-    OpenSwath::LightTargetedExperiment transition_exp_used = targeted_exp;
-
-    // Change the feature finding parameters:
-    //  - no RT score (since we don't know the correct retention time)
-    //  - no RT window
-    //  - no elution model score
-    //  - no peak quality (use all peaks)
-    //  - if best peptides should be used, use peak quality
-    MRMFeatureFinderScoring featureFinder;
-    Param feature_finder_param(default_ffparam);
-    feature_finder_param.setValue("Scores:use_rt_score", "false");
-    feature_finder_param.setValue("Scores:use_elution_model_score", "false");
-    feature_finder_param.setValue("rt_extraction_window", -1.0);
-    feature_finder_param.setValue("stop_report_after_feature", 1);
-    feature_finder_param.setValue("TransitionGroupPicker:PeakPickerMRM:signal_to_noise", 1.0); // set to 1.0 in all cases
-    feature_finder_param.setValue("TransitionGroupPicker:compute_peak_quality", "false"); // no peak quality -> take all peaks!
-    if (estimateBestPeptides)
-    {
-      feature_finder_param.setValue("TransitionGroupPicker:compute_peak_quality", "true");
-      feature_finder_param.setValue("TransitionGroupPicker:minimal_quality", irt_detection_param.getValue("InitialQualityCutoff"));
-    }
-    featureFinder.setParameters(feature_finder_param);
-
-    FeatureMap featureFile; // for results
+    StopWatch sw;
+    sw.start();
     OpenMS::MRMFeatureFinderScoring::TransitionGroupMapType transition_group_map; // for results
-    std::vector<OpenSwath::SwathMap> empty_swath_maps;
-    TransformationDescription empty_trafo; // empty transformation
-
-    // Prepare the data with the chromatograms
-    boost::shared_ptr<PeakMap > xic_map(new PeakMap);
-    xic_map->setChromatograms(chromatograms);
-    OpenSwath::SpectrumAccessPtr chromatogram_ptr = OpenSwath::SpectrumAccessPtr(new OpenMS::SpectrumAccessOpenMS(xic_map));
-
-    featureFinder.setStrictFlag(false); // TODO remove this, it should be strict (e.g. all transitions need to be present for RT norm)
-    featureFinder.pickExperiment(chromatogram_ptr, featureFile, transition_exp_used, empty_trafo, empty_swath_maps, transition_group_map);
+    pickCalibrants_(targeted_exp, chromatograms, default_ffparam, irt_detection_param, transition_group_map);
+    sw.stop();
+    double time_picking = sw.getClockTime();
 
     // 4. Find most likely correct feature for each compound and add it to the
     // "pairs" vector by computing pairs of iRT and real RT.
@@ -190,18 +173,15 @@ namespace OpenMS
       estimateBestPeptides, irt_detection_param.getValue("OverallQualityCutoff"));
     OPENMS_LOG_DEBUG << "Extracted best features: " << best_features.size() << std::endl;
 
-    // Create pairs vector and store peaks
-    std::map<String, OpenMS::MRMFeatureFinderScoring::MRMTransitionGroupType *> trgrmap_allpeaks; // store all peaks above cutoff
+    // Create pairs vector
     for (std::map<std::string, double>::iterator it = best_features.begin(); it != best_features.end(); ++it)
     {
       pairs.push_back(std::make_pair(it->second, PeptideRTMap[it->first])); // pair<exp_rt, theor_rt>
-      if (transition_group_map.find(it->first) != transition_group_map.end())
-      {
-        trgrmap_allpeaks[ it->first ] = &transition_group_map[ it->first];
-      }
     }
 
     // 5. Perform the outlier detection
+    sw.reset();
+    sw.start();
     std::vector<std::pair<double, double> > pairs_corrected;
     String outlier_method = irt_detection_param.getValue("outlierMethod");
     if (outlier_method == "iter_residual" || outlier_method == "iter_jackknife")
@@ -253,14 +233,248 @@ namespace OpenMS
       throw Exception::IllegalArgument(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION,
         "There are less than 2 iRT normalization peptides, not enough for an RT correction.");
     }
+    sw.stop();
+    double time_outliers = sw.getClockTime();
+
+    // 7. + 8. Correct m/z and ion mobility deviations using the peptides
+    // that are part of the regression
+    sw.reset();
+    sw.start();
+    correctMassAndIonMobility_(transition_group_map, best_features, pairs_corrected, swath_maps, im_trafo, targeted_exp, calibration_param);
+    sw.stop();
+    double time_calibration = sw.getClockTime();
+
+    // 9. store RT transformation, using the selected model
+    TransformationDescription trafo_out;
+    trafo_out.setDataPoints(pairs_corrected);
+    Param model_params;
+    model_params.setValue("symmetric_regression", "false");
+    model_params.setValue("span", irt_detection_param.getValue("lowess:span"));
+    model_params.setValue("num_nodes", irt_detection_param.getValue("b_spline:num_nodes"));
+    String model_type = irt_detection_param.getValue("alignmentMethod");
+    sw.reset();
+    sw.start();
+    trafo_out.fitModel(model_type, model_params);
+    sw.stop();
+
+    OPENMS_LOG_INFO << "Calibration timing: feature finding " << StopWatch::toString(time_picking)
+      << ", outlier detection " << StopWatch::toString(time_outliers)
+      << ", m/z and ion mobility calibration " << StopWatch::toString(time_calibration)
+      << ", RT model fitting " << StopWatch::toString(sw.getClockTime()) << std::endl;
+
+    OPENMS_LOG_DEBUG << "Final RT mapping:" << std::endl;
+    for (Size i = 0; i < pairs_corrected.size(); i++)
+    {
+      OPENMS_LOG_DEBUG << pairs_corrected[i].first << " " <<  pairs_corrected[i].second << std::endl;
+    }
+    OPENMS_LOG_DEBUG << "End of doDataNormalization_ method" << std::endl;
+
+    this->endProgress();
+    return trafo_out;
+  }
+
+  bool OpenSwathCalibrationWorkflow::reuseCachedCalibration(
+    const OpenSwath::LightTargetedExperiment& irt_transitions,
+    std::vector< OpenSwath::SwathMap > & swath_maps,
+    const TransformationDescription& cached_trafo,
+    TransformationDescription& im_trafo,
+    double max_residual,
+    double min_coverage,
+    const Param& feature_finder_param,
+    const ChromExtractParams& cp_irt,
+    const Param& irt_detection_param,
+    const Param& calibration_param,
+    bool sonar,
+    bool load_into_memory)
+  {
+    OPENMS_LOG_DEBUG << "Start of reuseCachedCalibration method" << std::endl;
+    if (irt_transitions.getCompounds().empty())
+    {
+      return false;
+    }
+
+    // 1. Extract the chromatograms around the RT predicted by the cached calibration
+    StopWatch sw;
+    sw.start();
+    std::vector< OpenMS::MSChromatogram > irt_chromatograms;
+    this->simpleExtractChromatograms_(swath_maps, irt_transitions, irt_chromatograms, cached_trafo, cp_irt, sonar, load_into_memory);
+    sw.stop();
+    double time_extraction = sw.getClockTime();
+
+    // 2. Find the calibrants in these chromatograms
+    sw.reset();
+    sw.start();
+    OpenMS::MRMFeatureFinderScoring::TransitionGroupMapType transition_group_map;
+    pickCalibrants_(irt_transitions, irt_chromatograms, feature_finder_param, irt_detection_param, transition_group_map);
+    std::map<std::string, double> best_features = OpenSwathHelper::simpleFindBestFeature(transition_group_map,
+      irt_detection_param.getValue("estimateBestPeptides").toBool(), irt_detection_param.getValue("OverallQualityCutoff"));
+    sw.stop();
+    double time_picking = sw.getClockTime();
+
+    // 3. Compute the residuals of the cached calibration, only peptides within
+    // max_residual (in normalized RT) are retained
+    std::map<std::string, double> library_rt;
+    for (const auto& compound : irt_transitions.getCompounds())
+    {
+      library_rt[compound.id] = compound.rt;
+    }
+    std::vector<std::pair<double, double> > pairs_retained;
+    for (const auto& feature : best_features)
+    {
+      double normalized_rt = library_rt[feature.first];
+      if (fabs(cached_trafo.apply(feature.second) - normalized_rt) <= max_residual)
+      {
+        pairs_retained.push_back(std::make_pair(feature.second, normalized_rt));
+      }
+    }
+    OPENMS_LOG_INFO << "Cached calibration: " << pairs_retained.size() << " of " << irt_transitions.getCompounds().size()
+      << " calibrants within a residual of " << max_residual << std::endl;
+
+    if (pairs_retained.size() < 2 ||
+        pairs_retained.size() < min_coverage * irt_transitions.getCompounds().size())
+    {
+      OPENMS_LOG_INFO << "Cached calibration does not fit the data, will perform a full calibration" << std::endl;
+      return false;
+    }
+
+    // 4. Correct m/z and ion mobility deviations using the retained peptides
+    sw.reset();
+    sw.start();
+    correctMassAndIonMobility_(transition_group_map, best_features, pairs_retained, swath_maps, im_trafo, irt_transitions, calibration_param);
+    sw.stop();
+
+    OPENMS_LOG_INFO << "Calibration timing (cached): chromatogram extraction " << StopWatch::toString(time_extraction)
+      << ", feature finding " << StopWatch::toString(time_picking)
+      << ", m/z and ion mobility calibration " << StopWatch::toString(sw.getClockTime()) << std::endl;
+    OPENMS_LOG_DEBUG << "End of reuseCachedCalibration method" << std::endl;
+    return true;
+  }
+
+  void OpenSwathCalibrationWorkflow::pickCalibrants_(
+    const OpenSwath::LightTargetedExperiment& targeted_exp,
+    const std::vector< OpenMS::MSChromatogram >& chromatograms,
+    const Param& default_ffparam,
+    const Param& irt_detection_param,
+    OpenMS::MRMFeatureFinderScoring::TransitionGroupMapType& transition_group_map)
+  {
+    // Change the feature finding parameters:
+    //  - no RT score (since we don't know the correct retention time)
+    //  - no RT window
+    //  - no elution model score
+    //  - no peak quality (use all peaks)
+    //  - if best peptides should be used, use peak quality
+    Param feature_finder_param(default_ffparam);
+    feature_finder_param.setValue("Scores:use_rt_score", "false");
+    feature_finder_param.setValue("Scores:use_elution_model_score", "false");
+    feature_finder_param.setValue("rt_extraction_window", -1.0);
+    feature_finder_param.setValue("stop_report_after_feature", 1);
+    feature_finder_param.setValue("TransitionGroupPicker:PeakPickerMRM:signal_to_noise", 1.0); // set to 1.0 in all cases
+    feature_finder_param.setValue("TransitionGroupPicker:compute_peak_quality", "false"); // no peak quality -> take all peaks!
+    if (irt_detection_param.getValue("estimateBestPeptides").toBool())
+    {
+      feature_finder_param.setValue("TransitionGroupPicker:compute_peak_quality", "true");
+      feature_finder_param.setValue("TransitionGroupPicker:minimal_quality", irt_detection_param.getValue("InitialQualityCutoff"));
+    }
+
+    // The peptides are scored independently of each other: distribute them
+    // (with their transitions and chromatograms) over one group per thread
+    // and score the groups in parallel.
+    Size nr_groups = 1;
+#ifdef _OPENMP
+    if (!omp_in_parallel())
+    {
+      nr_groups = std::max(1, omp_get_max_threads());
+    }
+#endif
+    nr_groups = std::max<Size>(1, std::min(nr_groups, targeted_exp.getCompounds().size()));
+
+    std::vector< OpenSwath::LightTargetedExperiment > group_exp(nr_groups);
+    std::vector< boost::shared_ptr<PeakMap > > group_xics(nr_groups);
+    std::map<std::string, Size> compound_group;
+    for (Size i = 0; i < targeted_exp.getCompounds().size(); ++i)
+    {
+      group_exp[i % nr_groups].compounds.push_back(targeted_exp.getCompounds()[i]);
+      compound_group[targeted_exp.getCompounds()[i].id] = i % nr_groups;
+    }
+    // chromatograms may be present multiple times (overlapping SWATH
+    // windows), the last one is used
+    std::map<String, Size> chromatogram_map;
+    for (Size i = 0; i < chromatograms.size(); ++i)
+    {
+      chromatogram_map[chromatograms[i].getNativeID()] = i;
+    }
+    for (Size g = 0; g < nr_groups; ++g)
+    {
+      group_exp[g].proteins = targeted_exp.getProteins();
+      group_xics[g] = boost::shared_ptr<PeakMap >(new PeakMap);
+    }
+    for (const auto& tr : targeted_exp.getTransitions())
+    {
+      std::map<std::string, Size>::const_iterator g = compound_group.find(tr.getPeptideRef());
+      if (g == compound_group.end()) continue;
+      group_exp[g->second].transitions.push_back(tr);
+      std::map<String, Size>::const_iterator chrom = chromatogram_map.find(tr.getNativeID());
+      if (chrom != chromatogram_map.end())
+      {
+        group_xics[g->second]->addChromatogram(chromatograms[chrom->second]);
+      }
+    }
+
+    std::exception_ptr error;
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic, 1) if (nr_groups > 1)
+#endif
+    for (SignedSize g = 0; g < boost::numeric_cast<SignedSize>(nr_groups); ++g)
+    {
+      try
+      {
+        MRMFeatureFinderScoring featureFinder;
+        featureFinder.setParameters(feature_finder_param);
+        featureFinder.setStrictFlag(false); // TODO remove this, it should be strict (e.g. all transitions need to be present for RT norm)
+
+        FeatureMap featureFile; // for results
+        OpenMS::MRMFeatureFinderScoring::TransitionGroupMapType group_map; // for results
+        std::vector<OpenSwath::SwathMap> empty_swath_maps;
+        TransformationDescription empty_trafo; // empty transformation
+        OpenSwath::SpectrumAccessPtr chromatogram_ptr = OpenSwath::SpectrumAccessPtr(new OpenMS::SpectrumAccessOpenMS(group_xics[g]));
+        featureFinder.pickExperiment(chromatogram_ptr, featureFile, group_exp[g], empty_trafo, empty_swath_maps, group_map);
+
+#ifdef _OPENMP
+#pragma omp critical (osw_calibration_groups)
+#endif
+        transition_group_map.insert(std::make_move_iterator(group_map.begin()), std::make_move_iterator(group_map.end()));
+      }
+      catch (...)
+      {
+#ifdef _OPENMP
+#pragma omp critical (osw_calibration_groups)
+#endif
+        if (!error) error = std::current_exception();
+      }
+    }
+    if (error)
+    {
+      std::rethrow_exception(error);
+    }
+  }
 
-    // 7. Select the "correct" peaks for m/z correction (e.g. remove those not
+  void OpenSwathCalibrationWorkflow::correctMassAndIonMobility_(
+    OpenMS::MRMFeatureFinderScoring::TransitionGroupMapType& transition_group_map,
+    const std::map<std::string, double>& best_features,
+    const std::vector<std::pair<double, double> >& pairs_corrected,
+    std::vector< OpenSwath::SwathMap > & swath_maps,
+    TransformationDescription& im_trafo,
+    const OpenSwath::LightTargetedExperiment& targeted_exp,
+    const Param& calibration_param)
+  {
+    // Select the "correct" peaks for m/z correction (e.g. remove those not
     // part of the linear regression)
     std::map<String, OpenMS::MRMFeatureFinderScoring::MRMTransitionGroupType *> trgrmap_final; // store all peaks above cutoff
-    for (const auto& it : trgrmap_allpeaks)
+    for (const auto& best : best_features)
     {
-      if (it.second->getFeatures().empty() ) {continue;}
-      const MRMFeature& feat = it.second->getBestFeature();
+      auto it = transition_group_map.find(best.first);
+      if (it == transition_group_map.end() || it->second.getFeatures().empty()) {continue;}
+      const MRMFeature& feat = it->second.getBestFeature();
 
       // Check if the current feature is in the list of pairs used for the
       // linear RT regression (using other features may result in wrong
@@ -270,37 +484,17 @@ namespace OpenMS
       {
         if (fabs(feat.getRT() - pairs_corrected[pit].first ) < 1e-2)
         {
-          trgrmap_final[ it.first ] = it.second;
+          trgrmap_final[ it->first ] = &it->second;
           break;
         }
       }
     }
 
-    // 8. Correct m/z deviations using SwathMapMassCorrection
+    // Correct m/z deviations using SwathMapMassCorrection
     SwathMapMassCorrection mc;
     mc.setParameters(calibration_param);
     mc.correctMZ(trgrmap_final, swath_maps, targeted_exp);
     mc.correctIM(trgrmap_final, swath_maps, im_trafo, targeted_exp);
-
-    // 9. store RT transformation, using the selected model
-    TransformationDescription trafo_out;
-    trafo_out.setDataPoints(pairs_corrected);
-    Param model_params;
-    model_params.setValue("symmetric_regression", "false");
-    model_params.setValue("span", irt_detection_param.getValue("lowess:span"));
-    model_params.setValue("num_nodes", irt_detection_param.getValue("b_spline:num_nodes"));
-    String model_type = irt_detection_param.getValue("alignmentMethod");
-    trafo_out.fitModel(model_type, model_params);
-
-    OPENMS_LOG_DEBUG << "Final RT mapping:" << std::endl;
-    for (Size i = 0; i < pairs_corrected.size(); i++)
-    {
-      OPENMS_LOG_DEBUG << pairs_corrected[i].first << " " <<  pairs_corrected[i].second << std::endl;
-    }
-    OPENMS_LOG_DEBUG << "End of doDataNormalization_ method" << std::endl;
-
-    this->endProgress();
-    return trafo_out;
   }
 
   void OpenSwathCalibrationWorkflow::simpleExtractChromatograms_(
@@ -465,7 +659,6 @@ namespace OpenMS
 
     std::cout << "Will analyze " << transition_exp.transitions.size() << " transitions in total." << std::endl;
     int progress = 0;
-    this->startProgress(0, swath_maps.size(), "Extracting and scoring transitions");
 
     // (i) Obtain precursor chromatograms (MS1) if precursor extraction is enabled
     ChromExtractParams ms1_cp(cp_ms1);
@@ -481,6 +674,10 @@ namespace OpenMS
     }
 
     if (use_ms1_traces_) ms1_map_ = loadMS1Map(swath_maps, load_into_memory);
+    if (ms1_map_ != nullptr && load_into_memory && ms1_cp.im_extraction_window > 0)
+    {
+      ms1_map_ = boost::shared_ptr<SpectrumAccessIMIndexed>( new SpectrumAccessIMIndexed(ms1_map_) );
+    }
 
     // (ii) Precursor extraction only
     if (ms1_only)
@@ -538,206 +735,321 @@ namespace OpenMS
     }
 
     // (iii) Perform extraction and scoring of fragment ion chromatograms (MS2)
-    // We set dynamic scheduling such that the maps are worked on in the order
-    // in which they were given to the program / acquired. This gives much
-    // better load balancing than static allocation.
+    //
+    // Each (SWATH window, batch of compounds) pair is an independent task.
+    // All tasks are processed by a single team of threads which take them
+    // from a shared queue in the order in which the windows were given to the
+    // program / acquired (i.e. idle threads automatically help out with the
+    // batches of windows that are still being worked on). This balances the
+    // load without nested parallelism or a fixed split of the threads
+    // between windows and batches.
+
+    // Step 1: select which transitions to extract for each window
+    const SignedSize nr_maps = boost::numeric_cast<SignedSize>(swath_maps.size());
+    std::vector< OpenSwath::LightTargetedExperiment > window_transitions(nr_maps);
 #ifdef _OPENMP
-#ifdef MT_ENABLE_NESTED_OPENMP
-    int total_nr_threads = omp_get_max_threads(); // store total number of threads we are allowed to use
-    if (threads_outer_loop_ > -1)
-    {
-      std::cout << "Setting up nested loop with " << std::min(threads_outer_loop_, omp_get_max_threads()) << " threads out of "<< omp_get_max_threads() << std::endl;
-      omp_set_nested(1);
-      omp_set_dynamic(0);
-      omp_set_num_threads(std::min(threads_outer_loop_, omp_get_max_threads()) ); // use at most threads_outer_loop_ threads here
-    }
-    else
-    {
-      std::cout << "Use non-nested loop with " << total_nr_threads << " threads." << std::endl;
-    }
-#endif
 #pragma omp parallel for schedule(dynamic,1)
 #endif
-    for (SignedSize i = 0; i < boost::numeric_cast<SignedSize>(swath_maps.size()); ++i)
+    for (SignedSize i = 0; i < nr_maps; ++i)
     {
-      if (!swath_maps[i].ms1) // skip MS1
-      {
+      if (swath_maps[i].ms1) continue; // skip MS1
 
-        // Step 1: select which transitions to extract (proceed in batches)
-        OpenSwath::LightTargetedExperiment transition_exp_used_all;
-        if (!prm_)
-        {
-          // Step 1.1: select transitions matching the window
-          OpenSwathHelper::selectSwathTransitions(transition_exp, transition_exp_used_all,
-              cp.min_upper_edge_dist, swath_maps[i].lower, swath_maps[i].upper);
-        }
-        else
+      OpenSwath::LightTargetedExperiment& transition_exp_used_all = window_transitions[i];
+      if (!prm_)
+      {
+        // Step 1.1: select transitions matching the window
+        OpenSwathHelper::selectSwathTransitions(transition_exp, transition_exp_used_all,
+            cp.min_upper_edge_dist, swath_maps[i].lower, swath_maps[i].upper);
+      }
+      else
+      {
+        // Step 1.2: select transitions based on matching PRM window (best window)
+        std::set<std::string> matching_compounds;
+        for (Size k = 0; k < prm_map.size(); k++)
         {
-          // Step 1.2: select transitions based on matching PRM window (best window)
-          std::set<std::string> matching_compounds;
-          for (Size k = 0; k < prm_map.size(); k++)
+          if (prm_map[k] == i)
           {
-            if (prm_map[k] == i)
-            {
-               const OpenSwath::LightTransition& tr = transition_exp.transitions[k];
-               transition_exp_used_all.transitions.push_back(tr);
-               matching_compounds.insert(tr.getPeptideRef());
-            }
+             const OpenSwath::LightTransition& tr = transition_exp.transitions[k];
+             transition_exp_used_all.transitions.push_back(tr);
+             matching_compounds.insert(tr.getPeptideRef());
           }
+        }
 
-          std::set<std::string> matching_proteins;
-          for (Size i = 0; i < transition_exp.compounds.size(); i++)
+        std::set<std::string> matching_proteins;
+        for (Size i = 0; i < transition_exp.compounds.size(); i++)
+        {
+          if (matching_compounds.find(transition_exp.compounds[i].id) != matching_compounds.end())
           {
-            if (matching_compounds.find(transition_exp.compounds[i].id) != matching_compounds.end())
+            transition_exp_used_all.compounds.push_back( transition_exp.compounds[i] );
+            for (Size j = 0; j < transition_exp.compounds[i].protein_refs.size(); j++)
             {
-              transition_exp_used_all.compounds.push_back( transition_exp.compounds[i] );
-              for (Size j = 0; j < transition_exp.compounds[i].protein_refs.size(); j++)
-              {
-                matching_proteins.insert(transition_exp.compounds[i].protein_refs[j]);
-              }
+              matching_proteins.insert(transition_exp.compounds[i].protein_refs[j]);
             }
           }
-          for (Size i = 0; i < transition_exp.proteins.size(); i++)
+        }
+        for (Size i = 0; i < transition_exp.proteins.size(); i++)
+        {
+          if (matching_proteins.find(transition_exp.proteins[i].id) != matching_proteins.end())
           {
-            if (matching_proteins.find(transition_exp.proteins[i].id) != matching_proteins.end())
-            {
-              transition_exp_used_all.proteins.push_back( transition_exp.proteins[i] );
-            }
+            transition_exp_used_all.proteins.push_back( transition_exp.proteins[i] );
           }
         }
+      }
+    }
 
-        if (transition_exp_used_all.getTransitions().size() > 0) // skip if no transitions found
-        {
+    // Step 2: create one task per batch. If no batch size is given and there
+    // are fewer windows than threads, windows are split into batches so that
+    // all threads have work.
+    Size nr_threads = 1;
+#ifdef _OPENMP
+    nr_threads = omp_get_max_threads();
+#endif
+    Size nr_windows_used = 0;
+    for (SignedSize i = 0; i < nr_maps; ++i)
+    {
+      if (!window_transitions[i].getTransitions().empty()) ++nr_windows_used;
+    }
 
-          OpenSwath::SpectrumAccessPtr current_swath_map = swath_maps[i].sptr;
-          if (load_into_memory)
-          {
-            // This creates an InMemory object that keeps all data in memory
-            current_swath_map = boost::shared_ptr<SpectrumAccessOpenMSInMemory>( new SpectrumAccessOpenMSInMemory(*current_swath_map) );
-          }
+    struct ExtractionTask
+    {
+      Size window; ///< index of the SWATH map
+      Size window_rank; ///< index among the windows with transitions
+      Size batch; ///< index of the batch within the window
+      Size nr_batches; ///< number of batches of the window
+      int batch_size; ///< number of compounds per batch
+    };
+    std::vector<ExtractionTask> tasks;
+    std::vector<Size> batches_left(nr_maps, 0);
+    Size window_rank = 0;
+    for (SignedSize i = 0; i < nr_maps; ++i)
+    {
+      const Size nr_compounds = window_transitions[i].getCompounds().size();
+      if (window_transitions[i].getTransitions().empty() || nr_compounds == 0) continue; // skip if no transitions found
 
-          int batch_size;
-          if (batchSize <= 0 || batchSize >= (int)transition_exp_used_all.getCompounds().size())
-          {
-            batch_size = transition_exp_used_all.getCompounds().size();
-          }
-          else
-          {
-            batch_size = batchSize;
-          }
+      int batch_size;
+      if (batchSize <= 0 || batchSize >= (int)nr_compounds)
+      {
+        batch_size = nr_compounds;
+        if (batchSize <= 0 && nr_windows_used < nr_threads)
+        {
+          const Size nr_splits = (nr_threads + nr_windows_used - 1) / nr_windows_used;
+          batch_size = std::max(1, (int)((nr_compounds + nr_splits - 1) / nr_splits));
+        }
+      }
+      else
+      {
+        batch_size = batchSize;
+      }
 
-          SignedSize nr_batches = (transition_exp_used_all.getCompounds().size() / batch_size);
+      const Size nr_batches = (nr_compounds + batch_size - 1) / batch_size;
+      for (Size batch = 0; batch < nr_batches; ++batch)
+      {
+        tasks.push_back({(Size)i, window_rank, batch, nr_batches, batch_size});
+      }
+      batches_left[i] = nr_batches;
+      ++window_rank;
+    }
 
-#ifdef _OPENMP
-#ifdef MT_ENABLE_NESTED_OPENMP
-          // If we have a multiple of threads_outer_loop_ here, then use nested
-          // parallelization here. E.g. if we use 8 threads for the outer loop,
-          // but we have a total of 24 cores available, each of the 8 threads
-          // will then create a team of 3 threads to work on the batches
-          // individually.
-          //
-          // We should avoid oversubscribing the CPUs, therefore we use integer division.
-          // -- see https://docs.oracle.com/cd/E19059-01/stud.10/819-0501/2_nested.html
-          int outer_thread_nr = omp_get_thread_num();
-          omp_set_num_threads(std::max(1, total_nr_threads / threads_outer_loop_) );
-#pragma omp parallel for schedule(dynamic, 1)
-#endif
-#endif
-          for (SignedSize pep_idx = 0; pep_idx <= nr_batches; pep_idx++)
-          {
-            OpenSwath::SpectrumAccessPtr current_swath_map_inner = current_swath_map;
+    // At most threads_outer_loop_ windows are held open (e.g. in memory) at
+    // the same time; a new window is only started once an older one is done.
+    const Size max_open_windows = threads_outer_loop_ > 0 ? (Size)threads_outer_loop_ : std::numeric_limits<Size>::max();
+    std::cout << "Scheduling " << tasks.size() << " extraction tasks from " << nr_windows_used << " SWATH windows on "
+      << nr_threads << " threads";
+    if (threads_outer_loop_ > 0) std::cout << " (at most " << max_open_windows << " windows at once)";
+    std::cout << "." << std::endl;
+    this->startProgress(0, tasks.size(), "Extracting and scoring transitions");
+
+    // shared spectrum access per window (created by the first task of a window)
+    std::vector<OpenSwath::SpectrumAccessPtr> window_maps(nr_maps);
+    std::unique_ptr<std::once_flag[]> window_init(new std::once_flag[nr_maps]);
+
+    // results are written out in task order (deterministic output),
+    // independent of which task finishes first
+    struct ExtractionResult
+    {
+      std::vector< MSChromatogram > ms1_chromatograms;
+      std::vector< MSChromatogram > chromatograms;
+      FeatureMap features;
+      Size cache_hits = 0;
+      Size cache_misses = 0;
+    };
+    std::vector< std::unique_ptr<ExtractionResult> > results(tasks.size());
+    Size next_result = 0;
+    Size cache_hits = 0, cache_misses = 0;
+    const double spectrum_cache_size = (double)feature_finder_param.getValue("spectrum_cache_size");
+
+    std::mutex queue_mutex;
+    std::condition_variable queue_cv;
+    Size next_task = 0, nr_admitted = 0, nr_open = 0;
+    std::exception_ptr error;
 
 #ifdef _OPENMP
-#ifdef MT_ENABLE_NESTED_OPENMP
-            // To ensure multi-threading safe access to the individual spectra, we
-            // need to use a light clone of the spectrum access (if multiple threads
-            // share a single filestream and call seek on it, chaos will ensue).
-            if (total_nr_threads / threads_outer_loop_ > 1)
-            {
-              current_swath_map_inner = current_swath_map->lightClone();
-            }
-#endif
-#pragma omp critical (osw_write_stdout)
-#endif
-            {
-              std::cout << "Thread " <<
-#ifdef _OPENMP
-#ifdef MT_ENABLE_NESTED_OPENMP
-              outer_thread_nr << "_" << omp_get_thread_num() << " " <<
-#else
-              omp_get_thread_num() << "_0 " <<
-#endif
-#else
-              "0" << 
+#pragma omp parallel
 #endif
-              "will analyze " << transition_exp_used_all.getCompounds().size() <<  " compounds and "
-              << transition_exp_used_all.getTransitions().size() <<  " transitions "
-              "from SWATH " << i << " (batch " << pep_idx << " out of " << nr_batches << ")" << std::endl;
-            }
-
-            // Create the new, batch-size transition experiment
-            OpenSwath::LightTargetedExperiment transition_exp_used;
-            selectCompoundsForBatch_(transition_exp_used_all, transition_exp_used, batch_size, pep_idx);
+    while (true)
+    {
+      // Take the next task from the queue (waiting if its window cannot be opened yet)
+      Size t;
+      {
+        std::unique_lock<std::mutex> lock(queue_mutex);
+        if (next_task >= tasks.size() || error) break;
+        t = next_task++;
+        const Size rank = tasks[t].window_rank;
+        queue_cv.wait(lock, [&] { return error || rank < nr_admitted || (rank == nr_admitted && nr_open < max_open_windows); });
+        if (error) break;
+        if (rank == nr_admitted)
+        {
+          ++nr_admitted;
+          ++nr_open;
+        }
+      }
+      const ExtractionTask& task = tasks[t];
+      const Size i = task.window;
 
-            // Extract MS1 chromatograms for this batch
-            std::vector< MSChromatogram > ms1_chromatograms;
-            if (ms1_map_ != nullptr) 
+      try
+      {
+        std::call_once(window_init[i], [&]
+        {
+          window_maps[i] = swath_maps[i].sptr;
+          if (load_into_memory)
+          {
+            // This creates an InMemory object that keeps all data in memory
+            window_maps[i] = boost::shared_ptr<SpectrumAccessOpenMSInMemory>( new SpectrumAccessOpenMSInMemory(*swath_maps[i].sptr) );
+            if (cp.im_extraction_window > 0)
             {
-              OpenSwath::SpectrumAccessPtr threadsafe_ms1 = ms1_map_->lightClone();
-              MS1Extraction_(threadsafe_ms1, swath_maps, ms1_chromatograms, chromConsumer, ms1_cp,
-                  transition_exp_used, trafo_inverse, ms1_only, ms1_isotopes);
+              // Index the frames by ion mobility (extraction and drift time scoring query m/z x ion mobility boxes)
+              window_maps[i] = boost::shared_ptr<SpectrumAccessIMIndexed>( new SpectrumAccessIMIndexed(window_maps[i]) );
             }
+          }
+        });
 
-            // Step 2.1: extract these transitions
-            ChromatogramExtractor extractor;
-            std::vector< OpenSwath::ChromatogramPtr > chrom_list;
-            std::vector< ChromatogramExtractor::ExtractionCoordinates > coordinates;
+        // To ensure multi-threading safe access to the individual spectra, we
+        // need to use a light clone of the spectrum access (if multiple threads
+        // share a single filestream and call seek on it, chaos will ensue).
+        // The in-memory representation is read-only and can be shared.
+        OpenSwath::SpectrumAccessPtr current_swath_map = load_into_memory ? window_maps[i] : window_maps[i]->lightClone();
 
-            // Step 2.2: prepare the extraction coordinates and extract chromatograms
-            // chrom_list contains one entry for each fragment ion (transition) in transition_exp_used
-            prepareExtractionCoordinates_(chrom_list, coordinates, transition_exp_used, trafo_inverse, cp);
-            extractor.extractChromatograms(current_swath_map_inner, chrom_list, coordinates, cp.mz_extraction_window,
-                cp.ppm, cp.im_extraction_window, cp.extraction_function);
+        // Create the new, batch-size transition experiment
+        OpenSwath::LightTargetedExperiment transition_exp_used;
+        selectCompoundsForBatch_(window_transitions[i], transition_exp_used, task.batch_size, task.batch);
 
-            // Step 2.3: convert chromatograms back to OpenMS::MSChromatogram and write to output
-            PeakMap chrom_exp;
-            extractor.return_chromatogram(chrom_list, coordinates, transition_exp_used,  SpectrumSettings(), 
-                                          chrom_exp.getChromatograms(), false, cp.im_extraction_window);
+        std::unique_ptr<ExtractionResult> result(new ExtractionResult);
 
+        // Extract MS1 chromatograms for this batch (written out together with the MS2 chromatograms below)
+        if (ms1_map_ != nullptr)
+        {
+          NoopMSDataConsumer no_consumer;
+          OpenSwath::SpectrumAccessPtr threadsafe_ms1 = ms1_map_->lightClone();
+          MS1Extraction_(threadsafe_ms1, swath_maps, result->ms1_chromatograms, &no_consumer, ms1_cp,
+              transition_exp_used, trafo_inverse, ms1_only, ms1_isotopes);
+        }
 
-            // Step 3: score these extracted transitions
-            FeatureMap featureFile;
-            std::vector< OpenSwath::SwathMap > tmp = {swath_maps[i]};
-            tmp.back().sptr = current_swath_map_inner;
-            scoreAllChromatograms_(chrom_exp.getChromatograms(), ms1_chromatograms, tmp, transition_exp_used,
-                feature_finder_param, trafo, cp.rt_extraction_window, featureFile, tsv_writer, osw_writer, ms1_isotopes);
+        // Step 3.1: extract these transitions
+        ChromatogramExtractor extractor;
+        std::vector< OpenSwath::ChromatogramPtr > chrom_list;
+        std::vector< ChromatogramExtractor::ExtractionCoordinates > coordinates;
+
+        // Step 3.2: prepare the extraction coordinates and extract chromatograms
+        // chrom_list contains one entry for each fragment ion (transition) in transition_exp_used
+        prepareExtractionCoordinates_(chrom_list, coordinates, transition_exp_used, trafo_inverse, cp);
+        extractor.extractChromatograms(current_swath_map, chrom_list, coordinates, cp.mz_extraction_window,
+            cp.ppm, cp.im_extraction_window, cp.extraction_function);
+
+        // Step 3.3: convert chromatograms back to OpenMS::MSChromatogram
+        extractor.return_chromatogram(chrom_list, coordinates, transition_exp_used,  SpectrumSettings(),
+                                      result->chromatograms, false, cp.im_extraction_window);
+        chrom_list.clear();
+
+        // Step 4: score these extracted transitions
+        std::vector< OpenSwath::SwathMap > tmp = {swath_maps[i]};
+        tmp.back().sptr = current_swath_map;
+        OpenSwathScoring::SpectrumCachePtr spectrum_cache;
+        if (spectrum_cache_size > 0) spectrum_cache.reset(new OpenSwathScoring::SpectrumCache(spectrum_cache_size));
+        scoreAllChromatograms_(result->chromatograms, result->ms1_chromatograms, tmp, transition_exp_used,
+            feature_finder_param, trafo, cp.rt_extraction_window, result->features, tsv_writer, osw_writer, ms1_isotopes,
+            false, spectrum_cache);
+        if (spectrum_cache)
+        {
+          result->cache_hits = spectrum_cache->getHits();
+          result->cache_misses = spectrum_cache->getMisses();
+        }
 
-            // Step 4: write all chromatograms and features out into an output object / file
-            // (this needs to be done in a critical section since we only have one
-            // output file and one output map).
-            #pragma omp critical (osw_write_out)
+        // Step 5: write all chromatograms and features of all finished tasks
+        // out into an output object / file, in task order (this needs to be
+        // done in a critical section since we only have one output file and
+        // one output map). Exceptions may not leave the critical section and
+        // are rethrown after it.
+        std::exception_ptr write_error;
+#ifdef _OPENMP
+#pragma omp critical (osw_write_out)
+#endif
+        {
+          try
+          {
+            results[t] = std::move(result);
+            for (; next_result < tasks.size() && results[next_result] != nullptr; ++next_result)
             {
-              writeOutFeaturesAndChroms_(chrom_exp.getChromatograms(), featureFile, out_featureFile, store_features, chromConsumer);
+              ExtractionResult& r = *results[next_result];
+              const ExtractionTask& done = tasks[next_result];
+              std::cout << "Analyzed " << window_transitions[done.window].getCompounds().size() << " compounds and "
+                << window_transitions[done.window].getTransitions().size() << " transitions from SWATH " << done.window
+                << " (batch " << done.batch + 1 << " out of " << done.nr_batches << ")" << std::endl;
+              for (MSChromatogram& chrom : r.ms1_chromatograms)
+              {
+                if (!chrom.empty()) chromConsumer->consumeChromatogram(chrom);
+              }
+              writeOutFeaturesAndChroms_(r.chromatograms, r.features, out_featureFile, store_features, chromConsumer);
+              cache_hits += r.cache_hits;
+              cache_misses += r.cache_misses;
+              results[next_result].reset();
             }
           }
+          catch (...)
+          {
+            write_error = std::current_exception();
+          }
+        }
+        if (write_error)
+        {
+          std::rethrow_exception(write_error);
+        }
+      }
+      catch (...)
+      {
+        std::lock_guard<std::mutex> lock(queue_mutex);
+        if (!error) error = std::current_exception();
+        queue_cv.notify_all();
+        break;
+      }
 
-        } // continue 2 (no continue due to OpenMP)
-      } // continue 1 (no continue due to OpenMP)
-
-      #pragma omp critical (progress)
+      // release the window once all of its batches are done
+      {
+        std::lock_guard<std::mutex> lock(queue_mutex);
+        if (--batches_left[i] == 0)
+        {
+          window_maps[i].reset();
+          --nr_open;
+          queue_cv.notify_all();
+        }
+      }
+#ifdef _OPENMP
+#pragma omp critical (progress)
+#endif
       this->setProgress(++progress);
-
     }
     this->endProgress();
-    
-#ifdef _OPENMP
-#ifdef MT_ENABLE_NESTED_OPENMP
-    if (threads_outer_loop_ > -1)
+
+    if (error)
+    {
+      std::rethrow_exception(error);
+    }
+    osw_writer.flush(); // commit all queued rows
+
+    if (cache_hits + cache_misses > 0)
     {
-      omp_set_num_threads(total_nr_threads); // set number of available threads back to initial value
+      OPENMS_LOG_INFO << "Spectrum cache (DIA scoring): reused " << cache_hits << " of " << cache_hits + cache_misses
+        << " spectra (hit rate " << 100.0 * cache_hits / (cache_hits + cache_misses) << " %)." << std::endl;
     }
-#endif    
-#endif    
   }
 
   void OpenSwathWorkflow::writeOutFeaturesAndChroms_(
@@ -800,12 +1112,25 @@ namespace OpenMS
     {
       if (ms1_chromatograms[j].empty()) continue; // skip empty chromatograms
 
+      // exceptions may not leave the critical section and are rethrown after it
+      std::exception_ptr write_error;
 #ifdef _OPENMP
 #pragma omp critical (osw_write_out)
 #endif
       {
-        // write MS1 chromatograms to disk
-        chromConsumer->consumeChromatogram( ms1_chromatograms[j] );
+        try
+        {
+          // write MS1 chromatograms to disk
+          chromConsumer->consumeChromatogram( ms1_chromatograms[j] );
+        }
+        catch (...)
+        {
+          write_error = std::current_exception();
+        }
+      }
+      if (write_error)
+      {
+        std::rethrow_exception(write_error);
       }
     } // end of for coordinates
 
@@ -823,7 +1148,8 @@ namespace OpenMS
     OpenSwathTSVWriter & tsv_writer,
     OpenSwathOSWWriter & osw_writer,
     int nr_ms1_isotopes,
-    bool ms1only) const
+    bool ms1only,
+    OpenSwathScoring::SpectrumCachePtr spectrum_cache) const
   {
     TransformationDescription trafo_inv = trafo;
     trafo_inv.invert();
@@ -855,6 +1181,7 @@ namespace OpenMS
 
     featureFinder.setParameters(feature_finder_param);
     featureFinder.prepareProteinPeptideMaps_(transition_exp);
+    if (spectrum_cache) featureFinder.setSpectrumCache(spectrum_cache);
 
     // Map ms1 chromatogram id to sequence number
     std::map<String, int> ms1_chromatogram_map;
@@ -890,7 +1217,8 @@ namespace OpenMS
       assay_map[transition_exp.getTransitions()[i].getPeptideRef()].push_back(&transition_exp.getTransitions()[i]);
     }
 
-    std::vector<String> to_tsv_output, to_osw_output;
+    std::vector<String> to_tsv_output;
+    OpenSwathOSWWriter::OSWRows osw_rows;
     ///////////////////////////////////
     // Start of main function
     // Iterating over all the assays
@@ -984,7 +1312,7 @@ namespace OpenMS
       {
         const OpenSwath::LightCompound pep = transition_exp.getCompounds()[ assay_peptide_map[id] ];
         const TransitionType* transition = assay_it->second[detection_assay_it];
-        to_osw_output.push_back(osw_writer.prepareLine(pep, transition, output, id));
+        osw_writer.prepareRows(pep, transition, output, id, osw_rows);
       }
     }
 
@@ -999,15 +1327,11 @@ namespace OpenMS
       }
     }
 
-    // Only write at the very end since this is a step that needs a barrier
+    // Only write at the very end (rows are queued and written by a background
+    // thread, no critical section needed)
     if (osw_writer.isActive())
     {
-#ifdef _OPENMP
-#pragma omp critical (osw_write_tsv)
-#endif
-      {
-        osw_writer.writeLines(to_osw_output);
-      }
+      osw_writer.writeRows(osw_rows);
     }
   }
 
@@ -1133,6 +1457,7 @@ namespace OpenMS
       // the order in which they were given to the program / acquired. This
       // gives much better load balancing than static allocation.
       // TODO: this means that there is possibly some overlap between threads accessing sptr ... !!
+      std::exception_ptr write_error; // first error while writing output (rethrown after the loop)
 #ifdef _OPENMP
 #pragma omp parallel for schedule(dynamic, 1)
 #endif
@@ -1243,12 +1568,21 @@ namespace OpenMS
 
             // Step 4: write all chromatograms and features out into an output object / file
             // (this needs to be done in a critical section since we only have one
-            // output file and one output map).
+            // output file and one output map). Exceptions may not leave the
+            // critical section; once writing failed, no further output is written.
 #ifdef _OPENMP
 #pragma omp critical (osw_write_out)
 #endif
+            if (!write_error)
             {
-              writeOutFeaturesAndChroms_(chrom_exp.getChromatograms(), featureFile, out_featureFile, store_features, chromConsumer);
+              try
+              {
+                writeOutFeaturesAndChroms_(chrom_exp.getChromatograms(), featureFile, out_featureFile, store_features, chromConsumer);
+              }
+              catch (...)
+              {
+                write_error = std::current_exception();
+              }
             }
           }
         }
@@ -1258,6 +1592,12 @@ namespace OpenMS
         this->setProgress(++progress);
       }
       this->endProgress();
+
+      if (write_error)
+      {
+        std::rethrow_exception(write_error);
+      }
+      osw_writer.flush(); // commit all queued rows
     }
 
 
@@ -172,6 +172,32 @@ namespace OpenMS
     // idea 2: check the SONAR profile (e.g. in the dimension of) of the best scan (RT apex)
     double RT = imrmfeature->getRT();
 
+    // find closest scan for each SONAR map (by retention time), these are
+    // the same for all transitions (null if a map is skipped)
+    std::vector<OpenSwath::SpectrumPtr> sonar_spectra(swath_maps.size());
+    std::vector<bool> sonar_signal_exp(swath_maps.size(), false);
+    for (Size swath_idx = 0; swath_idx < swath_maps.size(); swath_idx++)
+    {
+      OpenSwath::SpectrumAccessPtr swath_map = swath_maps[swath_idx].sptr;
+
+      if (swath_maps[swath_idx].ms1) {continue;} // skip MS1
+      if (precursor_mz > swath_maps[swath_idx].lower && precursor_mz < swath_maps[swath_idx].upper)
+      {
+        sonar_signal_exp[swath_idx] = true;
+      }
+
+      std::vector<std::size_t> indices = swath_map->getSpectraByRT(RT, 0.0);
+      if (indices.empty() )  {continue;}
+      int closest_idx = boost::numeric_cast<int>(indices[0]);
+      if (indices[0] != 0 &&
+          std::fabs(swath_map->getSpectrumMetaById(boost::numeric_cast<int>(indices[0]) - 1).RT - RT) <
+          std::fabs(swath_map->getSpectrumMetaById(boost::numeric_cast<int>(indices[0])).RT - RT))
+      {
+        closest_idx--;
+      }
+      sonar_spectra[swath_idx] = swath_map->getSpectrumById(closest_idx);
+    }
+
     // Aggregate sonar profiles (for each transition)
     std::vector<std::vector<double> > sonar_profiles;
     std::vector<double> sn_score;
@@ -190,26 +216,9 @@ namespace OpenMS
       std::vector<bool> signal_exp;
       for (Size swath_idx = 0; swath_idx < swath_maps.size(); swath_idx++)
       {
-        OpenSwath::SpectrumAccessPtr swath_map = swath_maps[swath_idx].sptr;
-
-        bool expect_signal = false;
-        if (swath_maps[swath_idx].ms1) {continue;} // skip MS1
-        if (precursor_mz > swath_maps[swath_idx].lower && precursor_mz < swath_maps[swath_idx].upper)
-        {
-          expect_signal = true;
-        }
-
-        // find closest scan for current SONAR map (by retention time)
-        std::vector<std::size_t> indices = swath_map->getSpectraByRT(RT, 0.0);
-        if (indices.empty() )  {continue;}
-        int closest_idx = boost::numeric_cast<int>(indices[0]);
-        if (indices[0] != 0 &&
-            std::fabs(swath_map->getSpectrumMetaById(boost::numeric_cast<int>(indices[0]) - 1).RT - RT) <
-            std::fabs(swath_map->getSpectrumMetaById(boost::numeric_cast<int>(indices[0])).RT - RT))
-        {
-          closest_idx--;
-        }
-        OpenSwath::SpectrumPtr spectrum_ = swath_map->getSpectrumById(closest_idx);
+        const OpenSwath::SpectrumPtr& spectrum_ = sonar_spectra[swath_idx];
+        if (!spectrum_) {continue;} // skipped MS1 or empty map
+        bool expect_signal = sonar_signal_exp[swath_idx];
 
         // integrate intensity within that scan
         double left = transitions[k].getProductMZ();
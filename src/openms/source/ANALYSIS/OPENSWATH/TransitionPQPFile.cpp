@@ -34,6 +34,10 @@
 
 #include <OpenMS/ANALYSIS/OPENSWATH/TransitionPQPFile.h>
 
+#include <OpenMS/ANALYSIS/OPENSWATH/DIAHelper.h>
+#include <OpenMS/CHEMISTRY/ISOTOPEDISTRIBUTION/CoarseIsotopePatternGenerator.h>
+#include <OpenMS/CHEMISTRY/TheoreticalSpectrumGenerator.h>
+
 #include <sqlite3.h>
 #include <OpenMS/FORMAT/SqliteConnector.h>
 
@@ -62,6 +66,38 @@ namespace OpenMS
     return 0;
   }
 
+  // number of peaks stored in the precursor isotope envelope (monoisotopic peak and 9 isotopes,
+  // enough for any sensible setting of DIAScoring:dia_nr_isotopes)
+  static const Size PQP_NR_PRECURSOR_ISOTOPES = 10;
+
+  // serialize a list of values as semicolon-separated SQL text literal
+  static String joinValues_(const std::vector<double>& values)
+  {
+    std::stringstream ss;
+    ss.precision(11);
+    ss << "'";
+    for (Size i = 0; i < values.size(); ++i)
+    {
+      if (i > 0) ss << ";";
+      ss << values[i];
+    }
+    ss << "'";
+    return ss.str();
+  }
+
+  static void splitValues_(const String& field, std::vector<double>& values)
+  {
+    values.clear();
+    if (field.empty()) return;
+    std::vector<String> tmp;
+    field.split(';', tmp);
+    values.reserve(tmp.size());
+    for (const auto& v : tmp)
+    {
+      values.push_back(v.toDouble());
+    }
+  }
+
   void TransitionPQPFile::readPQPInput_(const char* filename, std::vector<TSVTransition>& transition_list, bool legacy_traml_id)
   {
     sqlite3 *db;
@@ -261,6 +297,58 @@ namespace OpenMS
     sqlite3_finalize(stmt);
   }
 
+  void TransitionPQPFile::readPQPTheoreticalValues_(const char* filename, OpenSwath::LightTargetedExperiment& targeted_exp, bool legacy_traml_id)
+  {
+    sqlite3 *db;
+    sqlite3_stmt * stmt;
+
+    std::string traml_id = "ID";
+    if (legacy_traml_id)
+    {
+      traml_id = "TRAML_ID";
+    }
+
+    // Open database
+    SqliteConnector conn(filename);
+    db = conn.getDB();
+
+    // older files do not contain precomputed values, these are computed on the fly during scoring
+    if (!SqliteConnector::columnExists(db, "PRECURSOR", "ISOTOPE_ENVELOPE") ||
+        !SqliteConnector::columnExists(db, "PRECURSOR", "BSERIES") ||
+        !SqliteConnector::columnExists(db, "PRECURSOR", "YSERIES"))
+    {
+      return;
+    }
+
+    std::map<std::string, Size> compound_map;
+    for (Size i = 0; i < targeted_exp.compounds.size(); ++i)
+    {
+      compound_map[targeted_exp.compounds[i].id] = i;
+    }
+
+    String select_sql = "SELECT " + traml_id + ", ISOTOPE_ENVELOPE, BSERIES, YSERIES FROM PRECURSOR;";
+    SqliteConnector::prepareStatement(db, &stmt, select_sql);
+    sqlite3_step(stmt);
+
+    while (sqlite3_column_type(stmt, 0) != SQLITE_NULL)
+    {
+      std::string group_id;
+      Sql::extractValue<std::string>(&group_id, stmt, 0);
+      auto c_it = compound_map.find(group_id);
+      if (c_it != compound_map.end())
+      {
+        OpenSwath::LightCompound& compound = targeted_exp.compounds[c_it->second];
+        String tmp_field;
+        if (Sql::extractValue<std::string>(&tmp_field, stmt, 1)) splitValues_(tmp_field, compound.precursor_isotopes);
+        if (Sql::extractValue<std::string>(&tmp_field, stmt, 2)) splitValues_(tmp_field, compound.bseries);
+        if (Sql::extractValue<std::string>(&tmp_field, stmt, 3)) splitValues_(tmp_field, compound.yseries);
+      }
+      sqlite3_step( stmt );
+    }
+
+    sqlite3_finalize(stmt);
+  }
+
   void TransitionPQPFile::writePQPOutput_(const char* filename, OpenMS::TargetedExperiment& targeted_exp)
   {
     // delete file if present
@@ -340,6 +428,9 @@ namespace OpenMS
       "LIBRARY_INTENSITY REAL NULL," \
       "LIBRARY_RT REAL NULL," \
       "LIBRARY_DRIFT_TIME REAL NULL," \
+      "ISOTOPE_ENVELOPE TEXT NULL," \
+      "BSERIES TEXT NULL," \
+      "YSERIES TEXT NULL," \
       "DECOY INT NOT NULL);" \
 
       // transition_precursor_mapping table
@@ -492,6 +583,13 @@ namespace OpenMS
     std::vector<std::pair<int, int> > peptide_protein_map;
     std::vector<std::pair<int, int> > peptide_gene_map;
 
+    // OpenSWATH: Precompute theoretical values used in DIA scoring (same settings as DIAScoring)
+    TheoreticalSpectrumGenerator generator;
+    Param generator_param = generator.getParameters();
+    generator_param.setValue("add_metainfo", "true");
+    generator.setParameters(generator_param);
+    CoarseIsotopePatternGenerator isotope_generator(PQP_NR_PRECURSOR_ISOTOPES);
+
     // OpenSWATH: Prepare peptide precursor inserts
     for (Size i = 0; i < targeted_exp.getPeptides().size(); i++)
     {
@@ -514,9 +612,25 @@ namespace OpenMS
       if (gene_map.find(gene_name) == gene_map.end()) gene_map[gene_name] = gene_map.size();
       peptide_gene_map.push_back(std::make_pair(peptide_set_index, gene_map[gene_name]));
 
+      // OpenSWATH: averagine isotope envelope of the precursor and b/y ion series (charge 1)
+      int precursor_charge = 1;
+      if (peptide.hasCharge() && peptide.getChargeState() != 0)
+      {
+        precursor_charge = peptide.getChargeState();
+      }
+      IsotopeDistribution isotope_dist = isotope_generator.estimateFromPeptideWeight(
+          std::fabs(precursor_mz_map[group_set_index] * precursor_charge));
+      std::vector<double> isotope_envelope;
+      for (const auto& peak : isotope_dist)
+      {
+        isotope_envelope.push_back(peak.getIntensity());
+      }
+      std::vector<double> bseries, yseries;
+      DIAHelpers::getBYSeries(TargetedExperimentHelper::getAASequence(peptide), bseries, yseries, &generator, 1);
+
       insert_precursor_sql <<
         "INSERT INTO PRECURSOR (ID, TRAML_ID, GROUP_LABEL, PRECURSOR_MZ, CHARGE, LIBRARY_INTENSITY, " <<
-        "LIBRARY_DRIFT_TIME, LIBRARY_RT, DECOY) VALUES (" <<
+        "LIBRARY_DRIFT_TIME, LIBRARY_RT, ISOTOPE_ENVELOPE, BSERIES, YSERIES, DECOY) VALUES (" <<
         group_set_index << ",'" << peptide.id << "','" <<
         peptide.getPeptideGroupLabel() << "'," <<
         precursor_mz_map[group_set_index] << "," <<
@@ -524,6 +638,9 @@ namespace OpenMS
         ",NULL," <<
         peptide.getDriftTime() << "," <<
         peptide.getRetentionTime() << "," <<
+        joinValues_(isotope_envelope) << "," <<
+        joinValues_(bseries) << "," <<
+        joinValues_(yseries) << "," <<
         precursor_decoy_map[group_set_index] << "); ";
 
       insert_precursor_peptide_mapping << "INSERT INTO PRECURSOR_PEPTIDE_MAPPING (PRECURSOR_ID, PEPTIDE_ID) VALUES (" <<
@@ -701,6 +818,7 @@ namespace OpenMS
     std::vector<TSVTransition> transition_list;
     readPQPInput_(filename, transition_list, legacy_traml_id);
     TSVToTargetedExperiment_(transition_list, targeted_exp);
+    readPQPTheoreticalValues_(filename, targeted_exp, legacy_traml_id);
   }
 
 }
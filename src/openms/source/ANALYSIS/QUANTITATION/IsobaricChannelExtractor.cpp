@@ -41,8 +41,14 @@
 #include <OpenMS/KERNEL/RangeUtils.h>
 #include <OpenMS/KERNEL/ConsensusFeature.h>
 #include <OpenMS/KERNEL/ConsensusMap.h>
+#include <OpenMS/KERNEL/OnDiscMSExperiment.h>
 #include <OpenMS/MATH/STATISTICS/StatisticFunctions.h>
 
+#include <exception>
+#include <limits>
+
+#include <boost/make_shared.hpp>
+
 // #define ISOBARIC_CHANNEL_EXTRACTOR_DEBUG
 // #undef ISOBARIC_CHANNEL_EXTRACTOR_DEBUG
 
@@ -54,6 +60,12 @@ namespace OpenMS
   // Also used for TMT_11PLEX
   double TMT_10AND11PLEX_CHANNEL_TOLERANCE = 0.003;
 
+  // Search window (in Th) around the expected reporter ion positions, also used for the m/z calibration stats. Fixed! Do not change!
+  const double QC_DIST_MZ = 0.5;
+
+  // Marks a missing scan (e.g. no MS1 scan before an MS2 scan)
+  const Size NO_SCAN = std::numeric_limits<Size>::max();
+
   /// small quality control class, holding temporary data for reporting
   struct ChannelQC
   {
@@ -68,47 +80,6 @@ namespace OpenMS
   };
 
 
-  IsobaricChannelExtractor::PuritySate_::PuritySate_(const PeakMap& targetExp) :
-    baseExperiment(targetExp)
-  {
-    // initialize precursorScan with end(), it will be updated later on
-    // from the calling method
-    precursorScan = baseExperiment.end();
-
-    // find the first ms1 scan in the experiment
-    followUpScan = baseExperiment.begin();
-    while (followUpScan != baseExperiment.end() && followUpScan->getMSLevel() != 1)
-    {
-      ++followUpScan;
-    }
-
-    // check if we found one
-    hasFollowUpScan = followUpScan != baseExperiment.end();
-  }
-
-
-  void IsobaricChannelExtractor::PuritySate_::advanceFollowUp(const double rt)
-  {
-    // advance follow up scan until we found a ms1 scan with a bigger RT
-    if (followUpScan != baseExperiment.end()) ++followUpScan;
-    while (followUpScan != baseExperiment.end())
-    {
-      if (followUpScan->getMSLevel() == 1 && followUpScan->getRT() > rt)
-      {
-        break;
-      }
-      ++followUpScan;
-    }
-
-    // check if we found one
-    hasFollowUpScan = followUpScan != baseExperiment.end();
-  }
-
-  bool IsobaricChannelExtractor::PuritySate_::followUpValid(const double rt)
-  {
-    return hasFollowUpScan ? rt < followUpScan->getRT() : true;
-  }
-
   IsobaricChannelExtractor::IsobaricChannelExtractor(const IsobaricQuantitationMethod* const quant_method) :
     DefaultParamHandler("IsobaricChannelExtractor"),
     quant_method_(quant_method),
@@ -241,28 +212,28 @@ namespace OpenMS
     return false;
   }
 
-  double IsobaricChannelExtractor::computeSingleScanPrecursorPurity_(const PeakMap::ConstIterator& ms2_spec, const PeakMap::SpectrumType& precursor_spec) const
+  double IsobaricChannelExtractor::computeSingleScanPrecursorPurity_(const MSSpectrum& ms2_spec, const MSSpectrum& precursor_spec) const
   {
 
     typedef PeakMap::SpectrumType::ConstIterator const_spec_iterator;
 
     // compute distance between isotopic peaks based on the precursor charge.
-    const double charge_dist = Constants::NEUTRON_MASS_U / static_cast<double>(ms2_spec->getPrecursors()[0].getCharge());
+    const double charge_dist = Constants::NEUTRON_MASS_U / static_cast<double>(ms2_spec.getPrecursors()[0].getCharge());
 
     // the actual boundary values
-    const double strict_lower_mz = ms2_spec->getPrecursors()[0].getMZ() - ms2_spec->getPrecursors()[0].getIsolationWindowLowerOffset();
-    const double strict_upper_mz = ms2_spec->getPrecursors()[0].getMZ() + ms2_spec->getPrecursors()[0].getIsolationWindowUpperOffset();
+    const double strict_lower_mz = ms2_spec.getPrecursors()[0].getMZ() - ms2_spec.getPrecursors()[0].getIsolationWindowLowerOffset();
+    const double strict_upper_mz = ms2_spec.getPrecursors()[0].getMZ() + ms2_spec.getPrecursors()[0].getIsolationWindowUpperOffset();
 
     const double fuzzy_lower_mz = strict_lower_mz - (strict_lower_mz * max_precursor_isotope_deviation_ / 1000000);
     const double fuzzy_upper_mz = strict_upper_mz + (strict_upper_mz * max_precursor_isotope_deviation_ / 1000000);
 
     // first find the actual precursor peak
-    Size precursor_peak_idx = precursor_spec.findNearest(ms2_spec->getPrecursors()[0].getMZ());
+    Size precursor_peak_idx = precursor_spec.findNearest(ms2_spec.getPrecursors()[0].getMZ());
     const Peak1D& precursor_peak = precursor_spec[precursor_peak_idx];
 
     // now we get ourselves some border iterators
     const_spec_iterator lower_bound = precursor_spec.MZBegin(fuzzy_lower_mz);
-    const_spec_iterator upper_bound = precursor_spec.MZEnd(ms2_spec->getPrecursors()[0].getMZ());
+    const_spec_iterator upper_bound = precursor_spec.MZEnd(ms2_spec.getPrecursors()[0].getMZ());
 
     Peak1D::IntensityType precursor_intensity = precursor_peak.getIntensity();
     Peak1D::IntensityType total_intensity = precursor_peak.getIntensity();
@@ -325,7 +296,7 @@ namespace OpenMS
     // try to find a match for our isotopic peak on the right
 
     // redefine bounds
-    lower_bound = precursor_spec.MZBegin(ms2_spec->getPrecursors()[0].getMZ());
+    lower_bound = precursor_spec.MZBegin(ms2_spec.getPrecursors()[0].getMZ());
     upper_bound = precursor_spec.MZEnd(fuzzy_upper_mz);
 
     expected_next_mz = precursor_peak.getMZ() + charge_dist;
@@ -416,32 +387,32 @@ namespace OpenMS
     return precursor_intensity / total_intensity;
   }
 
-  double IsobaricChannelExtractor::computePrecursorPurity_(const PeakMap::ConstIterator& ms2_spec, const PuritySate_& pState) const
+  double IsobaricChannelExtractor::computePrecursorPurity_(const MSSpectrum& ms2_spec, const MSSpectrum& precursor_spec, const MSSpectrum* follow_up_spec) const
   {
     // we cannot analyze precursors without a charge
-    if (ms2_spec->getPrecursors()[0].getCharge() == 0)
+    if (ms2_spec.getPrecursors()[0].getCharge() == 0)
     {
       return 1.0;
     }
     else
     {
 #ifdef ISOBARIC_CHANNEL_EXTRACTOR_DEBUG
-      std::cerr << "------------------ analyzing " << ms2_spec->getNativeID() << std::endl;
+      std::cerr << "------------------ analyzing " << ms2_spec.getNativeID() << std::endl;
 #endif
 
       // compute purity of preceding ms1 scan
-      double early_scan_purity = computeSingleScanPrecursorPurity_(ms2_spec, *(pState.precursorScan));
+      double early_scan_purity = computeSingleScanPrecursorPurity_(ms2_spec, precursor_spec);
 
-      if (pState.hasFollowUpScan && interpolate_precursor_purity_)
+      if (follow_up_spec != nullptr && interpolate_precursor_purity_)
       {
-        double late_scan_purity = computeSingleScanPrecursorPurity_(ms2_spec, *(pState.followUpScan));
+        double late_scan_purity = computeSingleScanPrecursorPurity_(ms2_spec, *follow_up_spec);
 
         // calculating the extrapolated, S2I value as a time weighted linear combination of the two scans
         // see: Savitski MM, Sweetman G, Askenazi M, Marto JA, Lang M, Zinn N, et al. (2011).
         // Analytical chemistry 83: 8959–67. http://www.ncbi.nlm.nih.gov/pubmed/22017476
         // std::fabs is applied to compensate for potentially negative RTs
-        return std::fabs(ms2_spec->getRT() - pState.precursorScan->getRT()) *
-               ((late_scan_purity - early_scan_purity) / std::fabs(pState.followUpScan->getRT() - pState.precursorScan->getRT()))
+        return std::fabs(ms2_spec.getRT() - precursor_spec.getRT()) *
+               ((late_scan_purity - early_scan_purity) / std::fabs(follow_up_spec->getRT() - precursor_spec.getRT()))
                + early_scan_purity;
       }
       else
@@ -451,24 +422,9 @@ namespace OpenMS
     }
   }
 
-  void IsobaricChannelExtractor::extractChannels(const PeakMap& ms_exp_data, ConsensusMap& consensus_map)
+  bool IsobaricChannelExtractor::selectQuantScans_(const PeakMap& exp_meta, std::vector<QuantScan_>& quant_scans) const
   {
-    if (ms_exp_data.empty())
-    {
-      OPENMS_LOG_WARN << "The given file does not contain any conventional peak data, but might"
-                  " contain chromatograms. This tool currently cannot handle them, sorry.\n";
-      throw Exception::MissingInformation(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, "Experiment has no scans!");
-    }
-
-    // check if RT is sorted (we rely on it)
-    if (!ms_exp_data.isSorted(false))
-    {
-      throw Exception::InvalidParameter(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, "Spectra are not sorted in RT! Please sort them first!");
-    }
-
-    // clear the output map
-    consensus_map.clear(false);
-    consensus_map.setExperimentType("labeled_MS2");
+    quant_scans.clear();
 
     // create predicate for spectrum checking
     OPENMS_LOG_INFO << "Selecting scans with activation mode: " << (selected_activation_ == "" ? "any" : selected_activation_) << std::endl;
@@ -478,7 +434,7 @@ namespace OpenMS
     // only the highest level will be used for quantification (e.g. MS3, if present)
     std::map<UInt, UInt> ms_level;
     std::map<String, int> activation_modes;
-    for (PeakMap::ConstIterator it = ms_exp_data.begin(); it != ms_exp_data.end(); ++it)
+    for (PeakMap::ConstIterator it = exp_meta.begin(); it != exp_meta.end(); ++it)
     {
       if (it->getMSLevel() == 1) continue; // never report MS1
       ++activation_modes[getActivationMethod_(*it)]; // count HCD, CID, ...
@@ -496,7 +452,7 @@ namespace OpenMS
         OPENMS_LOG_WARN << "  mode " << (it->first.empty() ? "<none>" : it->first) << ": " << it->second << " scans\n";
       }
       OPENMS_LOG_WARN << "Result will be empty!" << std::endl;
-      return;
+      return false;
     }
     OPENMS_LOG_INFO << "Filtering by MS/MS(/MS) and activation mode:\n";
     for (std::map<UInt, UInt>::const_iterator it = ms_level.begin(); it != ms_level.end(); ++it)
@@ -506,97 +462,232 @@ namespace OpenMS
     UInt quant_ms_level = ms_level.rbegin()->first;
     OPENMS_LOG_INFO << "Using MS-level " << quant_ms_level << " for quantification." << std::endl;
 
-    // now we have picked data
-    // --> assign peaks to channels
-    UInt64 element_index(0);
-
-    // remember the current precursor spectrum
-    PuritySate_ pState(ms_exp_data);
+    // remember the last MS1 spectrum as we assume it to be the precursor spectrum
+    Size precursor_scan = NO_SCAN;
+    // the following MS1 scan is the first one with a bigger RT (spectra are sorted by RT)
+    Size follow_up_scan = 0;
+    for (Size i = 0; i < exp_meta.size(); ++i)
+    {
+      const MSSpectrum& spec = exp_meta[i];
+      if (spec.getMSLevel() == 1)
+      {
+        precursor_scan = i;
+        continue;
+      }
+      if (spec.getMSLevel() != quant_ms_level) continue;
+      if (!(selected_activation_.empty() || isValidActivation(spec))) continue;
 
-    typedef std::map<String, ChannelQC > ChannelQCSet;
-    ChannelQCSet channel_mz_delta;
-    const double qc_dist_mz = 0.5; // fixed! Do not change!
+      while (follow_up_scan < exp_meta.size() &&
+             (exp_meta[follow_up_scan].getMSLevel() != 1 || !(exp_meta[follow_up_scan].getRT() > spec.getRT())))
+      {
+        ++follow_up_scan;
+      }
 
-    Size number_of_channels = quant_method_->getNumberOfChannels();
+      QuantScan_ quant_scan;
+      quant_scan.scan = i;
+      quant_scan.precursor_scan = precursor_scan;
+      quant_scan.follow_up_scan = (follow_up_scan < exp_meta.size()) ? follow_up_scan : NO_SCAN;
+      // without precursor information the scan cannot be used (this is reported later on)
+      quant_scan.valid_precursor = spec.getPrecursors().empty() || isValidPrecursor_(spec.getPrecursors()[0]);
+      quant_scan.ms2_scan = i;
+      if (spec.getMSLevel() == 3)
+      {
+        // we cannot use just the last MS2 but need to compare to the precursor info stored in the (potential MS3 spectrum)
+        PeakMap::ConstIterator ms2_it = exp_meta.getPrecursorSpectrum(exp_meta.begin() + i);
+        quant_scan.ms2_scan = (ms2_it == exp_meta.end()) ? NO_SCAN : Size(ms2_it - exp_meta.begin());
+      }
+      quant_scans.push_back(quant_scan);
+    }
+    return true;
+  }
 
-    PeakMap::ConstIterator it_last_MS2 = ms_exp_data.end(); // remember last MS2 spec, to get precursor in MS1 (also if quant is in MS3)
+  void IsobaricChannelExtractor::extractReporterIntensities_(const MSSpectrum& spec, ScanResult_& result) const
+  {
+    const Size number_of_channels = quant_method_->getNumberOfChannels();
+    result.intensities.assign(number_of_channels, 0.0);
+    result.mz_deltas.assign(number_of_channels, std::numeric_limits<double>::quiet_NaN());
+    result.signal_not_unique.assign(number_of_channels, false);
 
-    for (PeakMap::ConstIterator it = ms_exp_data.begin(); it != ms_exp_data.end(); ++it)
+    Size channel = 0;
+    for (IsobaricQuantitationMethod::IsobaricChannelList::const_iterator cl_it = quant_method_->getChannelInformation().begin();
+         cl_it != quant_method_->getChannelInformation().end();
+         ++cl_it, ++channel)
     {
-      // remember the last MS1 spectra as we assume it to be the precursor spectrum
-      if (it->getMSLevel() ==  1)
+      // as every evaluation requires time, we cache the MZEnd iterator
+      const PeakMap::SpectrumType::ConstIterator mz_end = spec.MZEnd(cl_it->center + QC_DIST_MZ);
+
+      // search for the non-zero signal closest to theoretical position
+      // & check for closest signal within reasonable distance (0.5 Da) -- might find neighbouring TMT channel, but that should not confuse anyone
+      int peak_count(0); // count peaks in user window -- should be only one, otherwise Window is too large
+      PeakMap::SpectrumType::ConstIterator idx_nearest(mz_end);
+      for (PeakMap::SpectrumType::ConstIterator mz_it = spec.MZBegin(cl_it->center - QC_DIST_MZ);
+            mz_it != mz_end;
+            ++mz_it)
       {
-        // remember potential precursor and continue
-        pState.precursorScan = it;
-        // reset last MS2 -- we expect to see a new one soon and the old one should not be used for the following MS3 (if any)
-        it_last_MS2 = ms_exp_data.end();
-        continue;
+        if (mz_it->getIntensity() == 0) continue; // ignore 0-intensity shoulder peaks -- could be detrimental when de-calibrated
+        double dist_mz = fabs(mz_it->getMZ() - cl_it->center);
+        if (dist_mz < reporter_mass_shift_) ++peak_count;
+        if (idx_nearest == mz_end // first peak
+            || ((dist_mz < fabs(idx_nearest->getMZ() - cl_it->center)))) // closer to best candidate
+        {
+          idx_nearest = mz_it;
+        }
+      }
+      if (idx_nearest != mz_end)
+      {
+        double mz_delta = cl_it->center - idx_nearest->getMZ();
+        // stats: we don't care what shift the user specified
+        result.mz_deltas[channel] = mz_delta;
+        result.signal_not_unique[channel] = (peak_count > 1);
+        // pass user threshold
+        if (std::fabs(mz_delta) < reporter_mass_shift_)
+        {
+          result.intensities[channel] = idx_nearest->getIntensity();
+        }
       }
 
-      if (it->getMSLevel() != quant_ms_level) continue;
-      if ((*it).empty()) continue; // skip empty spectra
-      if (!(selected_activation_.empty() || isValidActivation(*it))) continue;
-
-      // find following ms1 scan (needed for purity computation)
-      if (!pState.followUpValid(it->getRT()))
+      // discard contribution of this channel as it is below the required intensity threshold
+      if (result.intensities[channel] < min_reporter_intensity_)
       {
-        // advance iterator
-        pState.advanceFollowUp(it->getRT());
+        result.intensities[channel] = 0;
       }
+    }
+  }
 
-      // check precursor constraints
-      if (!isValidPrecursor_(it->getPrecursors()[0]))
+  void IsobaricChannelExtractor::extractQuantScans_(const std::vector<QuantScan_>& quant_scans, const std::function<SpectrumLoader_()>& make_loader, std::vector<ScanResult_>& results) const
+  {
+    results.assign(quant_scans.size(), ScanResult_());
+
+    // group the scans by precursor scan, so the MS1 spectra are only loaded once per group
+    std::vector<Size> group_starts;
+    for (Size i = 0; i < quant_scans.size(); ++i)
+    {
+      if (i == 0 || quant_scans[i].precursor_scan != quant_scans[i - 1].precursor_scan)
       {
-        OPENMS_LOG_DEBUG << "Skip spectrum " << it->getNativeID() << ": Precursor doesn't fulfill all constraints." << std::endl;
-        continue;
+        group_starts.push_back(i);
       }
+    }
+    group_starts.push_back(quant_scans.size());
 
-      // check precursor purity if we have a valid precursor ..
-      double precursor_purity = -1.0;
-      if (pState.precursorScan != ms_exp_data.end())
+    std::exception_ptr error;
+#ifdef _OPENMP
+#pragma omp parallel
+#endif
+    {
+      SpectrumLoader_ load;
+      MSSpectrum spec_buffer, precursor_buffer, follow_up_buffer;
+#ifdef _OPENMP
+#pragma omp for schedule(dynamic)
+#endif
+      for (SignedSize group = 0; group < SignedSize(group_starts.size()) - 1; ++group)
       {
-        precursor_purity = computePrecursorPurity_(it, pState);
-        // check if purity is high enough
-        if (precursor_purity < min_precursor_purity_)
+        try
         {
-          OPENMS_LOG_DEBUG << "Skip spectrum " << it->getNativeID() << ": Precursor purity is below the threshold. [purity = " << precursor_purity << "]" << std::endl;
-          continue;
+          if (!load) load = make_loader();
+          const MSSpectrum* precursor_spec = nullptr;
+          const MSSpectrum* follow_up_spec = nullptr;
+          Size follow_up_scan = NO_SCAN;
+          for (Size i = group_starts[group]; i < group_starts[group + 1]; ++i)
+          {
+            const QuantScan_& quant_scan = quant_scans[i];
+            ScanResult_& result = results[i];
+            const MSSpectrum& spec = load(quant_scan.scan, spec_buffer);
+            result.empty = spec.empty();
+            if (result.empty || !quant_scan.valid_precursor) continue;
+
+            // check precursor purity if we have a valid precursor ..
+            if (quant_scan.precursor_scan != NO_SCAN && !spec.getPrecursors().empty())
+            {
+              if (precursor_spec == nullptr)
+              {
+                precursor_spec = &load(quant_scan.precursor_scan, precursor_buffer);
+              }
+              if (interpolate_precursor_purity_ && quant_scan.follow_up_scan != follow_up_scan)
+              {
+                follow_up_scan = quant_scan.follow_up_scan;
+                follow_up_spec = (follow_up_scan == NO_SCAN) ? nullptr : &load(follow_up_scan, follow_up_buffer);
+              }
+              result.precursor_purity = computePrecursorPurity_(spec, *precursor_spec, follow_up_spec);
+              // the scan will be skipped, no need to extract the reporter ions
+              if (result.precursor_purity < min_precursor_purity_) continue;
+            }
+
+            extractReporterIntensities_(spec, result);
+          }
+        }
+        catch (...)
+        {
+#ifdef _OPENMP
+#pragma omp critical (IsobaricChannelExtractor_error)
+#endif
+          if (!error) error = std::current_exception();
         }
       }
-      else
+    }
+    if (error) std::rethrow_exception(error);
+  }
+
+  void IsobaricChannelExtractor::fillConsensusMap_(const PeakMap& exp_meta, const std::vector<QuantScan_>& quant_scans, const std::vector<ScanResult_>& results, ConsensusMap& consensus_map) const
+  {
+    // now we have picked data
+    // --> assign peaks to channels
+    UInt64 element_index(0);
+
+    typedef std::map<String, ChannelQC > ChannelQCSet;
+    ChannelQCSet channel_mz_delta;
+
+    Size number_of_channels = quant_method_->getNumberOfChannels();
+
+    for (Size i = 0; i < quant_scans.size(); ++i)
+    {
+      const QuantScan_& quant_scan = quant_scans[i];
+      const ScanResult_& result = results[i];
+      const MSSpectrum& spec = exp_meta[quant_scan.scan];
+
+      if (result.empty) continue; // skip empty spectra
+
+      // check precursor constraints
+      if (!quant_scan.valid_precursor)
       {
-        OPENMS_LOG_INFO << "No precursor available for spectrum: " << it->getNativeID() << std::endl;
+        OPENMS_LOG_DEBUG << "Skip spectrum " << spec.getNativeID() << ": Precursor doesn't fulfill all constraints." << std::endl;
+        continue;
       }
 
-      if (it->getMSLevel() == 3)
+      // check if purity is high enough
+      if (quant_scan.precursor_scan != NO_SCAN)
       {
-        // we cannot save just the last MS2 but need to compare to the precursor info stored in the (potential MS3 spectrum)
-        it_last_MS2 = ms_exp_data.getPrecursorSpectrum(it);
-
-        if (it_last_MS2 == ms_exp_data.end())
-        { // this only happens if an MS3 spec does not have a preceding MS2
-          throw Exception::MissingInformation(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, String("No MS2 precursor information given for MS3 scan native ID ") + it->getNativeID() + " with RT " + String(it->getRT()));
+        if (result.precursor_purity < min_precursor_purity_)
+        {
+          OPENMS_LOG_DEBUG << "Skip spectrum " << spec.getNativeID() << ": Precursor purity is below the threshold. [purity = " << result.precursor_purity << "]" << std::endl;
+          continue;
         }
       }
       else
       {
-        it_last_MS2 = it;
+        OPENMS_LOG_INFO << "No precursor available for spectrum: " << spec.getNativeID() << std::endl;
+      }
+
+      if (quant_scan.ms2_scan == NO_SCAN)
+      { // this only happens if an MS3 spec does not have a preceding MS2
+        throw Exception::MissingInformation(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, String("No MS2 precursor information given for MS3 scan native ID ") + spec.getNativeID() + " with RT " + String(spec.getRT()));
       }
+      // remember last MS2 spec, to get precursor in MS1 (also if quant is in MS3)
+      const MSSpectrum& last_ms2 = exp_meta[quant_scan.ms2_scan];
 
       // check if MS1 precursor info is available
-      if (it_last_MS2->getPrecursors().empty())
+      if (last_ms2.getPrecursors().empty())
       {
-        throw Exception::MissingInformation(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, String("No precursor information given for scan native ID ") + it->getNativeID() + " with RT " + String(it->getRT()));
+        throw Exception::MissingInformation(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, String("No precursor information given for scan native ID ") + spec.getNativeID() + " with RT " + String(spec.getRT()));
       }
 
       // store RT of MS2 scan and MZ of MS1 precursor ion as centroid of ConsensusFeature
       ConsensusFeature cf;
       cf.setUniqueId();
-      cf.setRT(it_last_MS2->getRT());
-      cf.setMZ(it_last_MS2->getPrecursors()[0].getMZ());
+      cf.setRT(last_ms2.getRT());
+      cf.setMZ(last_ms2.getPrecursors()[0].getMZ());
 
       Peak2D channel_value;
-      channel_value.setRT(it->getRT());
+      channel_value.setRT(spec.getRT());
       // for each each channel
       UInt64 map_index = 0;
       Peak2D::IntensityType overall_intensity = 0;
@@ -607,46 +698,12 @@ namespace OpenMS
       {
         // set mz-position of channel
         channel_value.setMZ(cl_it->center);
-        // reset intensity
-        channel_value.setIntensity(0);
-
-        // as every evaluation requires time, we cache the MZEnd iterator
-        const PeakMap::SpectrumType::ConstIterator mz_end = it->MZEnd(cl_it->center + qc_dist_mz);
-
-        // search for the non-zero signal closest to theoretical position
-        // & check for closest signal within reasonable distance (0.5 Da) -- might find neighbouring TMT channel, but that should not confuse anyone
-        int peak_count(0); // count peaks in user window -- should be only one, otherwise Window is too large
-        PeakMap::SpectrumType::ConstIterator idx_nearest(mz_end);
-        for (PeakMap::SpectrumType::ConstIterator mz_it = it->MZBegin(cl_it->center - qc_dist_mz);
-              mz_it != mz_end;
-              ++mz_it)
-        {
-          if (mz_it->getIntensity() == 0) continue; // ignore 0-intensity shoulder peaks -- could be detrimental when de-calibrated
-          double dist_mz = fabs(mz_it->getMZ() - cl_it->center);
-          if (dist_mz < reporter_mass_shift_) ++peak_count;
-          if (idx_nearest == mz_end // first peak
-              || ((dist_mz < fabs(idx_nearest->getMZ() - cl_it->center)))) // closer to best candidate
-          {
-            idx_nearest = mz_it;
-          }
-        }
-        if (idx_nearest != mz_end)
-        {
-          double mz_delta = cl_it->center - idx_nearest->getMZ();
-          // stats: we don't care what shift the user specified
-          channel_mz_delta[cl_it->name].mz_deltas.push_back(mz_delta);
-          if (peak_count > 1) ++channel_mz_delta[cl_it->name].signal_not_unique;
-          // pass user threshold
-          if (std::fabs(mz_delta) < reporter_mass_shift_)
-          {
-            channel_value.setIntensity(idx_nearest->getIntensity());
-          }
-        }
+        channel_value.setIntensity(result.intensities[map_index]);
 
-        // discard contribution of this channel as it is below the required intensity threshold
-        if (channel_value.getIntensity() < min_reporter_intensity_)
+        if (!std::isnan(result.mz_deltas[map_index]))
         {
-          channel_value.setIntensity(0);
+          channel_mz_delta[cl_it->name].mz_deltas.push_back(result.mz_deltas[map_index]);
+          if (result.signal_not_unique[map_index]) ++channel_mz_delta[cl_it->name].signal_not_unique;
         }
 
         overall_intensity += channel_value.getIntensity();
@@ -667,26 +724,26 @@ namespace OpenMS
         cf.setMetaValue("all_empty", String("true"));
       }
       // add purity information if we could compute it
-      if (precursor_purity > 0.0)
+      if (result.precursor_purity > 0.0)
       {
-        cf.setMetaValue("precursor_purity", precursor_purity);
+        cf.setMetaValue("precursor_purity", result.precursor_purity);
       }
 
       // embed the id of the scan from which the quantitative information was extracted
-      cf.setMetaValue("scan_id", it->getNativeID());
+      cf.setMetaValue("scan_id", spec.getNativeID());
       // ...as well as additional meta information
-      cf.setMetaValue("precursor_intensity", it->getPrecursors()[0].getIntensity());
+      cf.setMetaValue("precursor_intensity", spec.getPrecursors()[0].getIntensity());
 
-      cf.setCharge(it->getPrecursors()[0].getCharge());
+      cf.setCharge(spec.getPrecursors()[0].getCharge());
       cf.setIntensity(overall_intensity);
       consensus_map.push_back(cf);
 
       // the tandem-scan in the order they appear in the experiment
       ++element_index;
-    } // ! Experiment iterator
+    } // ! quantitation scans
 
     // print stats about m/z calibration / presence of signal
-    OPENMS_LOG_INFO << "Calibration stats: Median distance of observed reporter ions m/z to expected position (up to " << qc_dist_mz << " Th):\n";
+    OPENMS_LOG_INFO << "Calibration stats: Median distance of observed reporter ions m/z to expected position (up to " << QC_DIST_MZ << " Th):\n";
     bool impurities_found(false);
     for (IsobaricQuantitationMethod::IsobaricChannelList::const_iterator cl_it = quant_method_->getChannelInformation().begin();
       cl_it != quant_method_->getChannelInformation().end();
@@ -728,7 +785,84 @@ namespace OpenMS
     registerChannelsInOutputMap_(consensus_map);
   }
 
-  void IsobaricChannelExtractor::registerChannelsInOutputMap_(ConsensusMap& consensus_map)
+  void IsobaricChannelExtractor::extractChannels(const PeakMap& ms_exp_data, ConsensusMap& consensus_map)
+  {
+    if (ms_exp_data.empty())
+    {
+      OPENMS_LOG_WARN << "The given file does not contain any conventional peak data, but might"
+                  " contain chromatograms. This tool currently cannot handle them, sorry.\n";
+      throw Exception::MissingInformation(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, "Experiment has no scans!");
+    }
+
+    // check if RT is sorted (we rely on it)
+    if (!ms_exp_data.isSorted(false))
+    {
+      throw Exception::InvalidParameter(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, "Spectra are not sorted in RT! Please sort them first!");
+    }
+
+    // clear the output map
+    consensus_map.clear(false);
+    consensus_map.setExperimentType("labeled_MS2");
+
+    std::vector<QuantScan_> quant_scans;
+    if (!selectQuantScans_(ms_exp_data, quant_scans)) return;
+
+    // all spectra are in memory already
+    auto make_loader = [&ms_exp_data]() -> SpectrumLoader_
+    {
+      return [&ms_exp_data](Size index, MSSpectrum&) -> const MSSpectrum& { return ms_exp_data[index]; };
+    };
+    std::vector<ScanResult_> results;
+    extractQuantScans_(quant_scans, make_loader, results);
+
+    fillConsensusMap_(ms_exp_data, quant_scans, results, consensus_map);
+  }
+
+  void IsobaricChannelExtractor::extractChannels(const OnDiscMSExperiment& ms_exp_data, ConsensusMap& consensus_map)
+  {
+    boost::shared_ptr<const PeakMap> exp_meta = ms_exp_data.getMetaData();
+    if (!exp_meta)
+    {
+      throw Exception::MissingInformation(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, "The meta data of the experiment is required (the file was opened without it).");
+    }
+    if (exp_meta->empty())
+    {
+      OPENMS_LOG_WARN << "The given file does not contain any conventional peak data, but might"
+                  " contain chromatograms. This tool currently cannot handle them, sorry.\n";
+      throw Exception::MissingInformation(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, "Experiment has no scans!");
+    }
+
+    // check if RT is sorted (we rely on it)
+    if (!exp_meta->isSorted(false))
+    {
+      throw Exception::InvalidParameter(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, "Spectra are not sorted in RT! Please sort them first!");
+    }
+
+    // clear the output map
+    consensus_map.clear(false);
+    consensus_map.setExperimentType("labeled_MS2");
+
+    std::vector<QuantScan_> quant_scans;
+    if (!selectQuantScans_(*exp_meta, quant_scans)) return;
+
+    // spectra are decoded on demand, each thread reads through its own copy
+    // (i.e. its own file stream)
+    auto make_loader = [&ms_exp_data]() -> SpectrumLoader_
+    {
+      boost::shared_ptr<OnDiscMSExperiment> thread_exp = boost::make_shared<OnDiscMSExperiment>(ms_exp_data);
+      return [thread_exp](Size index, MSSpectrum& buffer) -> const MSSpectrum&
+      {
+        buffer = thread_exp->getSpectrum(index);
+        return buffer;
+      };
+    };
+    std::vector<ScanResult_> results;
+    extractQuantScans_(quant_scans, make_loader, results);
+
+    fillConsensusMap_(*exp_meta, quant_scans, results, consensus_map);
+  }
+
+  void IsobaricChannelExtractor::registerChannelsInOutputMap_(ConsensusMap& consensus_map) const
   {
     // register the individual channels in the output consensus map
     Int index = 0;
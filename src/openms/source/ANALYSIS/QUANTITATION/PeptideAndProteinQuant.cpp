@@ -41,6 +41,28 @@ using namespace std;
 namespace OpenMS
 {
 
+  namespace
+  {
+    // pointers to the values of a map, so they can be processed in parallel
+    template <typename MapType>
+    vector<typename MapType::mapped_type*> getValuePointers(MapType& map)
+    {
+      vector<typename MapType::mapped_type*> values;
+      values.reserve(map.size());
+      for (auto& entry : map)
+      {
+        values.push_back(&entry.second);
+      }
+      return values;
+    }
+
+    // number of columns needed to index abundances by sample ID (IDs come from the experimental design)
+    Size getNumberOfSampleColumns(const PeptideAndProteinQuant::SampleAbundances& abundances)
+    {
+      return abundances.empty() ? 0 : Size(abundances.rbegin()->first + 1);
+    }
+  }
+
   PeptideAndProteinQuant::PeptideAndProteinQuant() :
     DefaultParamHandler("PeptideAndProteinQuant"), stats_(), pep_quant_(),
     prot_quant_()
@@ -193,10 +215,18 @@ namespace OpenMS
     }
 
     //////////////////////////////////////////////////////
-    // second, perform the actual peptide quantification:
-    for (auto & pep_q : pep_quant_)
+    // second, perform the actual peptide quantification (peptides are
+    // independent of each other, so this is done in parallel):
+    const bool best_charge_and_fraction = param_.getValue("best_charge_and_fraction") == "true";
+    vector<PeptideData*> pep_data = getValuePointers(pep_quant_);
+    Size quant_peptides = 0;
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic, 100) reduction(+: quant_peptides)
+#endif
+    for (SignedSize i = 0; i < SignedSize(pep_data.size()); ++i)
     {
-      if (param_.getValue("best_charge_and_fraction") == "true")
+      PeptideData& data = *pep_data[i];
+      if (best_charge_and_fraction)
       { // quantify according to the best charge state only:
 
         // determine which fraction and charge state yields the maximum number of abundances 
@@ -204,21 +234,21 @@ namespace OpenMS
         std::pair<size_t, size_t> best_fraction_and_charge;
 
         // return false: only identified, not quantified
-        if (!getBest_(pep_q.second.abundances, best_fraction_and_charge)) 
+        if (!getBest_(data.abundances, best_fraction_and_charge)) 
         { 
           continue;
         }
         
         // quantify according to the best fraction and charge state only:
-        for (auto & sa : pep_q.second.abundances[best_fraction_and_charge.first][best_fraction_and_charge.second])
+        for (auto & sa : data.abundances[best_fraction_and_charge.first][best_fraction_and_charge.second])
         {
-          pep_q.second.total_abundances[sa.first] = sa.second;
+          data.total_abundances[sa.first] = sa.second;
         }
       }
       else
       { // sum up sample abundances over all fractions and charge states:
 
-        for (auto & fa : pep_q.second.abundances)  // for all fractions 
+        for (auto & fa : data.abundances)  // for all fractions 
         {
           for (auto & ca : fa.second) // for all charge states
           {  
@@ -226,15 +256,16 @@ namespace OpenMS
             {
               const UInt64 & sample_id = sa.first;
               const double & sample_abundance = sa.second;
-              pep_q.second.total_abundances[sample_id] += sample_abundance;
+              data.total_abundances[sample_id] += sample_abundance;
             }
           }
         }
       }
 
       // count quantified peptide
-      if (!pep_q.second.total_abundances.empty()) { stats_.quant_peptides++; }
+      if (!data.total_abundances.empty()) { quant_peptides++; }
     }
+    stats_.quant_peptides += quant_peptides;
 
     //////////////////////////////////////////////////////
     // normalize (optional):
@@ -252,56 +283,78 @@ namespace OpenMS
     // depending on earlier options, these include:
     // - all charges or only the best charge state
     // - all fractions (if multiple fractions are analyzed)
-    map<UInt64, DoubleList> abundances; // all peptide abundances by sample
-    for (auto & pq : pep_quant_)
+    vector<PeptideData*> pep_data = getValuePointers(pep_quant_);
+    Size n_columns = 0;
+    for (const PeptideData* data : pep_data)
+    {
+      n_columns = max(n_columns, getNumberOfSampleColumns(data->total_abundances));
+    }
+    // all peptide abundances by sample (indexed by sample ID):
+    vector<DoubleList> abundances(n_columns);
+    for (const PeptideData* data : pep_data)
     {
       // maybe TODO: treat missing abundance values as zero
-      for (auto & sa : pq.second.total_abundances)
+      for (auto & sa : data->total_abundances)
       {
         abundances[sa.first].push_back(sa.second);
       }
     }
-    if (abundances.size() <= 1) { return; }
+    vector<Size> samples; // samples with abundances
+    for (Size sample = 0; sample < abundances.size(); ++sample)
+    {
+      if (!abundances[sample].empty()) samples.push_back(sample);
+    }
+    if (samples.size() <= 1) { return; }
 
     /////////////////////////////////////////////////////
     // compute scale factors on the sample level:
-    SampleAbundances medians; // median abundance by sample
-    for (auto & ab : abundances)
+    DoubleList all_medians(samples.size()); // median abundance by sample
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic, 1)
+#endif
+    for (SignedSize i = 0; i < SignedSize(samples.size()); ++i)
     {
-      medians[ab.first] = Math::median(ab.second.begin(), ab.second.end());
+      DoubleList& values = abundances[samples[i]];
+      all_medians[i] = Math::median(values.begin(), values.end());
+      DoubleList().swap(values); // not needed anymore
     }
 
-    DoubleList all_medians;
-    for (auto & sa : medians)
+    DoubleList sorted_medians = all_medians;
+    double overall_median = Math::median(sorted_medians.begin(),
+                                         sorted_medians.end());
+    // samples without total abundances get no scale factor (i.e. zero):
+    vector<double> scale_factors(abundances.size(), 0.0);
+    for (Size i = 0; i < samples.size(); ++i)
     {
-      all_medians.push_back(sa.second);
+      scale_factors[samples[i]] = overall_median / all_medians[i];
     }
-    double overall_median = Math::median(all_medians.begin(),
-                                         all_medians.end());
-    SampleAbundances scale_factors;
-    for (auto & med : medians)
+    auto getScaleFactor = [&scale_factors](UInt64 sample)
     {
-      scale_factors[med.first] = overall_median / med.second;
-    }
+      return (sample < scale_factors.size()) ? scale_factors[sample] : 0.0;
+    };
 
     /////////////////////////////////////////////////////
     // scale all abundance values:
-    for (auto & pep_q : pep_quant_)
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic, 100)
+#endif
+    for (SignedSize i = 0; i < SignedSize(pep_data.size()); ++i)
     {
+      PeptideData& data = *pep_data[i];
       // scale total abundances
-      for (auto & sta : pep_q.second.total_abundances)
+      for (auto & sta : data.total_abundances)
       {
-        sta.second *= scale_factors[sta.first];
+        sta.second *= getScaleFactor(sta.first);
       }
 
       // scale individual abundances
-      for (auto & fa : pep_q.second.abundances) // for all fractions
+      for (auto & fa : data.abundances) // for all fractions
       {
         for (auto & ca : fa.second) // for all charge states
         {
           for (auto & sa : ca.second) // loop over abundances
           {
-            sa.second *= scale_factors[sa.first];
+            sa.second *= getScaleFactor(sa.first);
           }
         }
       }
@@ -393,11 +446,26 @@ namespace OpenMS
     bool include_all = param_.getValue("include_all") == "true";
     bool fix_peptides = param_.getValue("consensus:fix_peptides") == "true";
 
-    for (auto & prot_q : prot_quant_)
+    // proteins are independent of each other, so they are processed in parallel:
+    vector<ProteinData*> prot_data = getValuePointers(prot_quant_);
+    Size n_columns = 0; // peptide abundances are collected by sample ID
+    for (const ProteinData* data : prot_data)
     {
-      if ((top > 0) && (prot_q.second.abundances.size() < top))
+      for (auto const & ab : data->abundances)
       {
-        stats_.too_few_peptides++;
+        n_columns = max(n_columns, getNumberOfSampleColumns(ab.second));
+      }
+    }
+    Size too_few_peptides = 0, quant_proteins = 0;
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic, 10) reduction(+: too_few_peptides, quant_proteins)
+#endif
+    for (SignedSize i = 0; i < SignedSize(prot_data.size()); ++i)
+    {
+      ProteinData& data = *prot_data[i];
+      if ((top > 0) && (data.abundances.size() < top))
+      {
+        too_few_peptides++;
         if (!include_all) { continue; } // not enough proteotypic peptides
       }
 
@@ -405,7 +473,7 @@ namespace OpenMS
       if (fix_peptides && (top == 0))
       {
         // consider all peptides that occur in every sample:
-        for (auto const & ab : prot_q.second.abundances)
+        for (auto const & ab : data.abundances)
         {
           if (ab.second.size() == stats_.n_samples)
           {
@@ -414,61 +482,64 @@ namespace OpenMS
         }
       }
       else if (fix_peptides && (top > 0) &&
-               (prot_q.second.abundances.size() > top))
+               (data.abundances.size() > top))
       {
-        orderBest_(prot_q.second.abundances, peptides);
+        orderBest_(data.abundances, peptides);
         peptides.resize(top);
       }
       else
       {
         // consider all peptides of the protein:
-        for (auto const & ab : prot_q.second.abundances)
+        for (auto const & ab : data.abundances)
         {
           peptides.push_back(ab.first);
         }
       }
 
-      map<UInt64, DoubleList> abundances; // all peptide abundances by sample
+      vector<DoubleList> abundances(n_columns); // all peptide abundances by sample
 
       // consider only the selected peptides for quantification:
       for (auto & pep : peptides)
       {       
-        for (auto & sa : prot_q.second.abundances[pep])
+        for (auto & sa : data.abundances[pep])
         {
           abundances[sa.first].push_back(sa.second);
         }
       }
 
-      for (auto & ab : abundances)
+      for (Size sample = 0; sample < abundances.size(); ++sample)
       {
+        DoubleList& values = abundances[sample];
+        if (values.empty()) continue; // no peptides in this sample
+
         // check if the protein has enough peptides in this sample
-        if (!include_all && (top > 0) && (ab.second.size() < top))
+        if (!include_all && (top > 0) && (values.size() < top))
         {
           continue;
         }
 
         // if we have more than "top", reduce to the top ones
-        if ((top > 0) && (ab.second.size() > top))
+        if ((top > 0) && (values.size() > top))
         {
-          // sort descending:
-          sort(ab.second.begin(), ab.second.end(), greater<double>());
-          ab.second.resize(top); // remove all but best "top" values
+          // move the best "top" values to the front (descending):
+          partial_sort(values.begin(), values.begin() + top, values.end(), greater<double>());
+          values.resize(top); // remove all but best "top" values
         }
 
         double result;
         if (average == "median")
         {
-          result = Math::median(ab.second.begin(), ab.second.end());
+          result = Math::median(values.begin(), values.end());
         }
         else if (average == "mean")
         {
-          result = Math::mean(ab.second.begin(), ab.second.end());
+          result = Math::mean(values.begin(), values.end());
         }
         else if (average == "weighted_mean")
         {
           double sum_intensities = 0;
           double sum_intensities_squared = 0;
-          for (auto const & in : ab.second)
+          for (auto const & in : values)
           {
             sum_intensities += in;
             sum_intensities_squared += in * in;
@@ -477,21 +548,23 @@ namespace OpenMS
         }
         else // "sum"
         {
-          result = Math::sum(ab.second.begin(), ab.second.end());
+          result = Math::sum(values.begin(), values.end());
         }
-        prot_q.second.total_abundances[ab.first] = result;
+        data.total_abundances.emplace_hint(data.total_abundances.end(), sample, result);
       }
 
       // update statistics:
-      if (prot_q.second.total_abundances.empty()) 
+      if (data.total_abundances.empty()) 
       { 
-        stats_.too_few_peptides++; 
+        too_few_peptides++; 
       }
       else 
       {
-        stats_.quant_proteins++;
+        quant_proteins++;
       }
     }
+    stats_.too_few_peptides += too_few_peptides;
+    stats_.quant_proteins += quant_proteins;
   }
 
 
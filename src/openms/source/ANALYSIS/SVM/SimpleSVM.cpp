@@ -37,6 +37,9 @@
 #include <OpenMS/CONCEPT/ProgressLogger.h>
 #include <OpenMS/FORMAT/SVOutStream.h>
 
+#include <boost/random/mersenne_twister.hpp>
+#include <boost/random/uniform_int_distribution.hpp>
+
 using namespace OpenMS;
 using namespace std;
 
@@ -370,6 +373,73 @@ pair<double, double> SimpleSVM::chooseBestParameters_() const
 }
 
 
+vector<Size> SimpleSVM::partitionData_() const
+{
+  // stratified partitioning (like in LIBSVM's "svm_cross_validation"), but
+  // with a fixed seed so that results are reproducible:
+  map<double, vector<Size> > by_class;
+  for (Size i = 0; i < Size(data_.l); ++i)
+  {
+    by_class[data_.y[i]].push_back(i);
+  }
+  vector<Size> partitions(data_.l);
+  boost::mt19937 rng(0);
+  Size counter = 0;
+  for (map<double, vector<Size> >::iterator it = by_class.begin();
+       it != by_class.end(); ++it)
+  {
+    for (Size i = it->second.size(); i > 1; --i)
+    {
+      boost::random::uniform_int_distribution<Size> dist(0, i - 1);
+      swap(it->second[i - 1], it->second[dist(rng)]);
+    }
+    for (vector<Size>::iterator obs_it = it->second.begin();
+         obs_it != it->second.end(); ++obs_it, ++counter)
+    {
+      partitions[*obs_it] = counter % n_parts_;
+    }
+  }
+  return partitions;
+}
+
+
+Size SimpleSVM::crossValidatePartition_(const struct svm_parameter& params,
+                                        const vector<Size>& partitions,
+                                        Size part) const
+{
+  vector<struct svm_node*> train_x;
+  vector<double> train_y;
+  vector<Size> test_indexes;
+  for (Size i = 0; i < Size(data_.l); ++i)
+  {
+    if (partitions[i] == part)
+    {
+      test_indexes.push_back(i);
+    }
+    else
+    {
+      train_x.push_back(data_.x[i]);
+      train_y.push_back(data_.y[i]);
+    }
+  }
+  if (test_indexes.empty() || train_x.empty()) return 0;
+
+  struct svm_problem train_data;
+  train_data.l = train_x.size();
+  train_data.x = &(train_x[0]);
+  train_data.y = &(train_y[0]);
+  struct svm_model* model = svm_train(&train_data, &params);
+  Size n_correct = 0;
+  for (vector<Size>::iterator it = test_indexes.begin();
+       it != test_indexes.end(); ++it)
+  {
+    if (svm_predict(model, data_.x[*it]) == data_.y[*it]) n_correct++;
+  }
+  svm_free_and_destroy_model(&model);
+  return n_correct;
+}
+
+
 void SimpleSVM::optimizeParameters_()
 {
   log2_C_ = param_.getValue("log2_C");
@@ -384,37 +454,55 @@ void SimpleSVM::optimizeParameters_()
 
   OPENMS_LOG_INFO << "Running cross-validation to find optimal SVM parameters..." 
            << endl;
+  vector<Size> partitions = partitionData_();
+  // all combinations of parameters and partitions are evaluated independently
+  // (in parallel), results are collected per combination:
+  Size n_combinations = log2_gamma_.size() * log2_C_.size();
+  vector<Size> n_correct(n_combinations * n_parts_, 0);
   Size prog_counter = 0;
   ProgressLogger prog_log;
-  prog_log.startProgress(1, log2_gamma_.size() * log2_C_.size(),
+  prog_log.startProgress(1, n_combinations * n_parts_,
                          "testing SVM parameters");
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic, 1)
+#endif
+  for (SignedSize i = 0; i < SignedSize(n_correct.size()); ++i)
+  {
+    // vary "C"s fastest (same order as in "performance_"):
+    Size combination = i / n_parts_;
+    Size g_index = combination / log2_C_.size();
+    Size c_index = combination % log2_C_.size();
+    struct svm_parameter params = svm_params_;
+    params.gamma = pow(2.0, log2_gamma_[g_index]);
+    params.C = pow(2.0, log2_C_[c_index]);
+    n_correct[i] = crossValidatePartition_(params, partitions, i % n_parts_);
+#ifdef _OPENMP
+#pragma omp critical (SimpleSVM_progress)
+#endif
+    prog_log.setProgress(++prog_counter);
+  }
+  prog_log.endProgress();
+
   // classification performance for different parameter pairs:
-  performance_.resize(log2_gamma_.size());
-  // vary "C"s in inner loop to keep results for all "C"s in one vector:
+  performance_.assign(log2_gamma_.size(), vector<double>(log2_C_.size()));
   for (Size g_index = 0; g_index < log2_gamma_.size(); ++g_index)
   {
-    svm_params_.gamma = pow(2.0, log2_gamma_[g_index]);
-    performance_[g_index].resize(log2_C_.size());
     for (Size c_index = 0; c_index < log2_C_.size(); ++c_index)
     {
-      svm_params_.C = pow(2.0, log2_C_[c_index]);
-      vector<double> targets(data_.l);
-      svm_cross_validation(&data_, &svm_params_, n_parts_, &(targets[0]));
-      Size n_correct = 0;
-      for (Size i = 0; i < Size(data_.l); ++i)
+      Size offset = (g_index * log2_C_.size() + c_index) * n_parts_;
+      Size correct = 0;
+      for (Size part = 0; part < n_parts_; ++part)
       {
-        if (targets[i] == data_.y[i]) n_correct++;
+        correct += n_correct[offset + part];
       }
-      double ratio = n_correct / double(data_.l);
+      double ratio = correct / double(data_.l);
       performance_[g_index][c_index] = ratio;
-      prog_log.setProgress(++prog_counter);
       OPENMS_LOG_DEBUG << "Performance (log2_C = " << log2_C_[c_index] 
                 << ", log2_gamma = " << log2_gamma_[g_index] << "): " 
-                << n_correct << " correct (" << float(ratio * 100.0) << "%)"
+                << correct << " correct (" << float(ratio * 100.0) << "%)"
                 << endl;
     }
   }
-  prog_log.endProgress();
 
   pair<double, double> best_params = chooseBestParameters_();
   OPENMS_LOG_INFO << "Best SVM parameters: log2_C = " << best_params.first
@@ -40,6 +40,8 @@
 #include <OpenMS/CONCEPT/Constants.h>
 #include <OpenMS/DATASTRUCTURES/ListUtilsIO.h>
 
+#include <limits>
+
 #ifdef _OPENMP
 #include <omp.h>
 #endif
@@ -57,10 +59,18 @@ namespace OpenMS
     // initialize empty vector for the results
     vector<OPXLDataStructs::XLPrecursor> mass_to_candidates;
 
+    if (peptides.empty() || spectrum_precursors.empty())
+    {
+      return mass_to_candidates;
+    }
+
     double max_precursor = spectrum_precursors[spectrum_precursors.size()-1];
 
     Size peptides_size = peptides.size();
 
+    // number of alpha peptides processed together by one thread in the cross-link enumeration
+    const Size alpha_block_size = 1024;
+
     // compute a very conservative total upper bound, based on the heaviest possible linear peptide
     // can be used instead of peptides.end() in all cases for this precursor mass
     vector<OPXLDataStructs::AASeqWithMass>::const_iterator conservative_upper_bound = upper_bound(peptides.cbegin(), peptides.cend(), max_precursor, OPXLDataStructs::AASeqWithMassComparator());
@@ -74,7 +84,7 @@ namespace OpenMS
     vector<OPXLDataStructs::AASeqWithMass>::const_iterator first_mono = peptides.cbegin();
     vector<OPXLDataStructs::AASeqWithMass>::const_iterator last_mono = peptides.cbegin();
 
-    vector<OPXLDataStructs::AASeqWithMass>::const_iterator last_alpha = peptides.cbegin();
+    vector<OPXLDataStructs::AASeqWithMass>::const_iterator last_beta_bound = peptides.cbegin();
 
     for (Size pm = 0; pm < spectrum_precursors.size(); ++pm)
     {
@@ -92,17 +102,17 @@ namespace OpenMS
 
       // ################################ Enumerate Loop-Links #################
       // The largest peptides given a fixed precursor mass are possible with loop links
+      // (only the few peptides within the tolerance window are visited, so this is not worth parallelizing)
       double min_peptide_mass = precursor_mass - cross_link_mass - allowed_error;
       double max_peptide_mass = precursor_mass - cross_link_mass + allowed_error;
 
       first_loop = lower_bound(first_loop, conservative_upper_bound, min_peptide_mass, OPXLDataStructs::AASeqWithMassComparator());
       last_loop = upper_bound(last_loop, conservative_upper_bound, max_peptide_mass, OPXLDataStructs::AASeqWithMassComparator());
 
-      int first_index = first_loop - peptides.cbegin();
-      int last_index = last_loop - peptides.cbegin();
+      Size first_index = first_loop - peptides.cbegin();
+      Size last_index = last_loop - peptides.cbegin();
 
-#pragma omp parallel for
-      for (int p1 = first_index; p1 < last_index; ++p1)
+      for (Size p1 = first_index; p1 < last_index; ++p1)
       {
         const String& seq_first = peptides[p1].unmodified_seq;
         // test if this peptide could have loop-links: one cross-link with both sides attached to the same peptide
@@ -140,13 +150,10 @@ namespace OpenMS
          precursor.alpha_seq = seq_first;
          precursor.beta_seq = "";
 
-#pragma omp critical (mass_to_candidates_access)
-         {
-           mass_to_candidates.push_back(precursor);
-           precursor_correction_positions.push_back(pm);
-         }
+         mass_to_candidates.push_back(precursor);
+         precursor_correction_positions.push_back(pm);
         }
-      } // end of parallel loop over loop-link candidates
+      } // end of loop over loop-link candidates
 
       // ################################ Enumerate Mono-Links #################
       for (Size i = 0; i < cross_link_mass_mono_link.size(); i++)
@@ -164,8 +171,7 @@ namespace OpenMS
         first_index = first_mono - peptides.cbegin();
         last_index = last_mono - peptides.cbegin();
 
-#pragma omp parallel for
-        for (int p1 = first_index; p1 < last_index; ++p1)
+        for (Size p1 = first_index; p1 < last_index; ++p1)
         {
           // Monoisotopic weight of the peptide + cross-linker
           double cross_linked_peptide_mass = peptides[p1].peptide_mass + mono_link_mass;
@@ -178,11 +184,8 @@ namespace OpenMS
           precursor.alpha_seq = peptides[p1].unmodified_seq;
           precursor.beta_seq = "";
 
-#pragma omp critical (mass_to_candidates_access)
-         {
-           mass_to_candidates.push_back(precursor);
-           precursor_correction_positions.push_back(pm);
-         }
+          mass_to_candidates.push_back(precursor);
+          precursor_correction_positions.push_back(pm);
         } // end of loop over candidates for a specific mono-link mass
       } // end of loop over mono-link masses
 
@@ -191,52 +194,146 @@ namespace OpenMS
       // because we have to fit in two peptides this time
       // maximal mass: difference between precursor mass and the smallest peptide + cross-linker
       max_peptide_mass = precursor_mass - cross_link_mass - peptides[0].peptide_mass + allowed_error;
-      last_alpha = upper_bound(last_alpha, conservative_upper_bound, max_peptide_mass, OPXLDataStructs::AASeqWithMassComparator());
-      int last_alpha_index = last_alpha - peptides.cbegin();
+      last_beta_bound = upper_bound(last_beta_bound, conservative_upper_bound, max_peptide_mass, OPXLDataStructs::AASeqWithMassComparator());
 
-#pragma omp parallel for
-      for (int p1 = 0; p1 < last_alpha_index; ++p1)
-      {
-        // Constrain search for beta
-        double min_peptide_mass_beta = precursor_mass - cross_link_mass - peptides[p1].peptide_mass - allowed_error;
-        double max_peptide_mass_beta = precursor_mass - cross_link_mass - peptides[p1].peptide_mass + allowed_error;
+      // beta is never lighter than alpha (beta_index >= alpha_index),
+      // so the alpha peptide can take at most half of the remaining mass
+      double max_alpha_mass = (precursor_mass - cross_link_mass + allowed_error) / 2.0;
+      vector<OPXLDataStructs::AASeqWithMass>::const_iterator last_alpha = upper_bound(peptides.cbegin(), last_beta_bound, max_alpha_mass, OPXLDataStructs::AASeqWithMassComparator());
+      Size last_alpha_index = last_alpha - peptides.cbegin();
 
-        // the last_alpha upper bound is also a conservative upper bound here
-        vector<OPXLDataStructs::AASeqWithMass>::const_iterator first_beta = lower_bound(peptides.cbegin()+p1, last_alpha, min_peptide_mass_beta, OPXLDataStructs::AASeqWithMassComparator());
-        vector<OPXLDataStructs::AASeqWithMass>::const_iterator last_beta = upper_bound(peptides.cbegin()+p1, last_alpha, max_peptide_mass_beta, OPXLDataStructs::AASeqWithMassComparator());
+      // the alphas are processed in blocks, the candidates of each block are collected separately
+      // and appended in block order, so the result does not depend on the number of threads
+      Size n_blocks = (last_alpha_index + alpha_block_size - 1) / alpha_block_size;
+      vector< vector<OPXLDataStructs::XLPrecursor> > block_candidates(n_blocks);
 
-        if (first_beta == last_beta)
-        {
-          continue;
-        }
+#pragma omp parallel for schedule(dynamic, 1)
+      for (SignedSize block = 0; block < static_cast<SignedSize>(n_blocks); ++block)
+      {
+        Size block_start = block * alpha_block_size;
+        Size block_end = std::min(block_start + alpha_block_size, last_alpha_index);
 
-        Size first_beta_index = first_beta - peptides.begin();
-        Size last_beta_index = last_beta - peptides.begin();
+        // with increasing alpha mass the window of matching beta masses moves towards lighter peptides,
+        // so the end of the window for the previous alpha bounds the search for the next one
+        vector<OPXLDataStructs::AASeqWithMass>::const_iterator beta_end = last_beta_bound;
 
-        for (Size p2 = first_beta_index; p2 < last_beta_index; ++p2)
+        for (Size p1 = block_start; p1 < block_end; ++p1)
         {
-          // Monoisotopic weight of the first peptide + the second peptide + cross-linker
-          double cross_linked_pair_mass = peptides[p1].peptide_mass + peptides[p2].peptide_mass + cross_link_mass;
+          // Constrain search for beta
+          double min_peptide_mass_beta = precursor_mass - cross_link_mass - peptides[p1].peptide_mass - allowed_error;
+          double max_peptide_mass_beta = precursor_mass - cross_link_mass - peptides[p1].peptide_mass + allowed_error;
 
-          // this time both peptides have valid indices
-          OPXLDataStructs::XLPrecursor precursor;
-          precursor.precursor_mass = cross_linked_pair_mass;
-          precursor.alpha_index = p1;
-          precursor.beta_index = p2;
-          precursor.alpha_seq = peptides[p1].unmodified_seq;
-          precursor.beta_seq = peptides[p2].unmodified_seq;
+          vector<OPXLDataStructs::AASeqWithMass>::const_iterator alpha_it = peptides.cbegin() + p1;
+          if (beta_end < alpha_it)
+          {
+            break; // no beta left for this and all heavier alphas
+          }
+          beta_end = upper_bound(alpha_it, beta_end, max_peptide_mass_beta, OPXLDataStructs::AASeqWithMassComparator());
+          vector<OPXLDataStructs::AASeqWithMass>::const_iterator first_beta = lower_bound(alpha_it, beta_end, min_peptide_mass_beta, OPXLDataStructs::AASeqWithMassComparator());
 
-#pragma omp critical (mass_to_candidates_access)
-         {
-           mass_to_candidates.push_back(precursor);
-           precursor_correction_positions.push_back(pm);
-         }
-        } // end of loop over betas
-      } // end of parallel loop over alphas
+          for (vector<OPXLDataStructs::AASeqWithMass>::const_iterator beta_it = first_beta; beta_it != beta_end; ++beta_it)
+          {
+            // Monoisotopic weight of the first peptide + the second peptide + cross-linker
+            double cross_linked_pair_mass = peptides[p1].peptide_mass + beta_it->peptide_mass + cross_link_mass;
+
+            // this time both peptides have valid indices
+            OPXLDataStructs::XLPrecursor precursor;
+            precursor.precursor_mass = cross_linked_pair_mass;
+            precursor.alpha_index = p1;
+            precursor.beta_index = beta_it - peptides.cbegin();
+            precursor.alpha_seq = peptides[p1].unmodified_seq;
+            precursor.beta_seq = beta_it->unmodified_seq;
+
+            block_candidates[block].push_back(precursor);
+          } // end of loop over betas
+        }
+      } // end of parallel loop over alpha blocks
+
+      for (vector<OPXLDataStructs::XLPrecursor>& candidates : block_candidates)
+      {
+        mass_to_candidates.insert(mass_to_candidates.end(), candidates.begin(), candidates.end());
+        precursor_correction_positions.insert(precursor_correction_positions.end(), candidates.size(), static_cast<int>(pm));
+      }
     } // end of loop over precursor masses
     return mass_to_candidates;
   }
 
+  OPXLDataStructs::LinearFragmentLadders OPXLHelper::computeLinearFragmentLadders(const vector<OPXLDataStructs::AASeqWithMass>& peptides, const SimpleTSGXLMS& spec_gen, int charge)
+  {
+    OPXLDataStructs::LinearFragmentLadders result;
+    result.ladders.resize(peptides.size());
+    result.peptide_index.reserve(peptides.size());
+
+#pragma omp parallel for schedule(guided)
+    for (SignedSize p = 0; p < static_cast<SignedSize>(peptides.size()); ++p)
+    {
+      AASequence peptide = peptides[p].peptide_seq;
+      if (peptide.empty())
+      {
+        continue;
+      }
+      Size n = peptide.size();
+
+      // all prefix ions (cross-link behind the last residue) and all suffix ions (cross-link at the first residue)
+      vector< SimpleTSGXLMS::SimplePeak > prefix_ions;
+      vector< SimpleTSGXLMS::SimplePeak > suffix_ions;
+      spec_gen.getLinearIonSpectrum(prefix_ions, peptide, n, charge, n);
+      spec_gen.getLinearIonSpectrum(suffix_ions, peptide, 0, charge, 0);
+
+      vector< float >& ladder = result.ladders[p];
+      ladder.reserve(prefix_ions.size() + suffix_ions.size());
+      for (const SimpleTSGXLMS::SimplePeak& peak : prefix_ions)
+      {
+        ladder.push_back(static_cast<float>(peak.mz));
+      }
+      for (const SimpleTSGXLMS::SimplePeak& peak : suffix_ions)
+      {
+        ladder.push_back(static_cast<float>(peak.mz));
+      }
+      std::sort(ladder.begin(), ladder.end());
+    }
+
+    for (Size p = 0; p < peptides.size(); ++p)
+    {
+      result.peptide_index[&(peptides[p].peptide_seq)] = p;
+    }
+    return result;
+  }
+
+  bool OPXLHelper::hasLinearFragmentMatches(const vector< float >& ladder, const PeakSpectrum& exp_spectrum, Size min_matches, double fragment_mass_tolerance, bool fragment_mass_tolerance_unit_ppm)
+  {
+    if (min_matches == 0)
+    {
+      return true;
+    }
+
+    Size matches(0);
+    Size e(0);
+    const Size n_e(exp_spectrum.size());
+    for (float ion_mz : ladder)
+    {
+      const double theo_mz = ion_mz;
+      // widen the tolerance by the rounding error of the single precision m/z, so no match of the exact m/z is missed
+      const double max_dist_dalton = (fragment_mass_tolerance_unit_ppm ? theo_mz * fragment_mass_tolerance * 1e-6 : fragment_mass_tolerance)
+                                     + theo_mz * std::numeric_limits<float>::epsilon();
+
+      // the lower end of the tolerance window increases with the ion m/z, so the experimental peaks can be traversed once
+      while (e < n_e && exp_spectrum[e].getMZ() < theo_mz - max_dist_dalton)
+      {
+        ++e;
+      }
+      if (e == n_e)
+      {
+        break;
+      }
+      if (exp_spectrum[e].getMZ() <= theo_mz + max_dist_dalton && ++matches >= min_matches)
+      {
+        return true;
+      }
+    }
+    return false;
+  }
+
   std::vector<OPXLDataStructs::AASeqWithMass> OPXLHelper::digestDatabase(
     vector<FASTAFile::FASTAEntry> fasta_db,
     EnzymaticDigestion digestor,
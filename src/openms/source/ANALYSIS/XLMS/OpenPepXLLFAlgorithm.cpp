@@ -393,6 +393,9 @@ using namespace OpenMS;
     vector<OPXLDataStructs::AASeqWithMass> filtered_peptide_masses;
     filtered_peptide_masses.assign(peptide_masses.begin(), last);
 
+    // linear fragment ion ladders of all peptides, shared by all spectra and threads to quickly reject candidates
+    OPXLDataStructs::LinearFragmentLadders linear_ladders = OPXLHelper::computeLinearFragmentLadders(filtered_peptide_masses, specGen_mainscore, 2);
+
     // iterate over all spectra
     progresslogger.startProgress(0, 1, "Matching to theoretical spectra and scoring...");
 
@@ -452,6 +455,16 @@ using namespace OpenMS;
         {
           link_pos_B = cross_link_candidate.cross_link_position.second;
         }
+
+        // the precomputed ladders give an upper bound for the number of linear fragment matches (see below),
+        // reject candidates that can not reach the minimal number of matches before generating any theoretical spectra
+        if (!cross_link_candidate.alpha ||
+            !OPXLHelper::hasLinearFragmentMatches(linear_ladders.getLadder(cross_link_candidate.alpha), spectrum, 2, fragment_mass_tolerance_, fragment_mass_tolerance_unit_ppm_) ||
+            (type_is_cross_link && !OPXLHelper::hasLinearFragmentMatches(linear_ladders.getLadder(cross_link_candidate.beta), spectrum, 2, fragment_mass_tolerance_, fragment_mass_tolerance_unit_ppm_)))
+        {
+          continue;
+        }
+
         AASequence alpha;
         AASequence beta;
         if (cross_link_candidate.alpha) { alpha = *cross_link_candidate.alpha; }
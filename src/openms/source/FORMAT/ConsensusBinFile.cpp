@@ -0,0 +1,388 @@
+// --------------------------------------------------------------------------
+//                   OpenMS -- Open-Source Mass Spectrometry
+// --------------------------------------------------------------------------
+// Copyright The OpenMS Team -- Eberhard Karls University Tuebingen,
+// ETH Zurich, and Freie Universitaet Berlin 2002-2020.
+//
+// This software is released under a three-clause BSD license:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of any author or any participating institution
+//    may be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+// For a full list of authors, refer to the file AUTHORS.
+// --------------------------------------------------------------------------
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL ANY OF THE AUTHORS OR THE CONTRIBUTING
+// INSTITUTIONS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// --------------------------------------------------------------------------
+// $Maintainer: agent $
+// $Authors: agent $
+// --------------------------------------------------------------------------
+
+
+#include <OpenMS/FORMAT/ConsensusBinFile.h>
+
+#include <OpenMS/FORMAT/HANDLERS/ColumnarMapHandler.h>
+#include <OpenMS/FORMAT/IdBinFile.h>
+
+using namespace std;
+
+namespace OpenMS
+{
+  using Internal::ColumnarBinaryReader;
+  using Internal::ColumnarBinaryWriter;
+  using Internal::ColumnarMapHandler;
+  using Internal::ColumnarMetaInfoReader;
+  using Internal::ColumnarMetaInfoWriter;
+
+  const char* const ConsensusBinFile::CONTENT_TAG = "consBin";
+
+  ConsensusBinFile::ConsensusBinFile() :
+    ProgressLogger()
+  {
+  }
+
+  ConsensusBinFile::~ConsensusBinFile()
+  {
+  }
+
+  FeatureFileOptions& ConsensusBinFile::getOptions()
+  {
+    return options_;
+  }
+
+  const FeatureFileOptions& ConsensusBinFile::getOptions() const
+  {
+    return options_;
+  }
+
+  void ConsensusBinFile::setOptions(const FeatureFileOptions& options)
+  {
+    options_ = options;
+  }
+
+  void ConsensusBinFile::store(const String& filename, const ConsensusMap& consensus_map)
+  {
+    ColumnarBinaryWriter writer(filename, CONTENT_TAG);
+
+    startProgress(0, 3, "storing consensusBin file");
+    ColumnarMapHandler::writeMapInfo(writer, consensus_map, consensus_map, consensus_map, consensus_map.getDataProcessing());
+    writer.addStringColumn("map.experiment_type", vector<String>(1, consensus_map.getExperimentType()));
+
+    // column headers
+    {
+      vector<UInt64> index, size, unique_id;
+      vector<String> filename, label;
+      ColumnarMetaInfoWriter column_meta;
+      for (const auto& header : consensus_map.getColumnHeaders())
+      {
+        column_meta.add(index.size(), header.second);
+        index.push_back(header.first);
+        filename.push_back(header.second.filename);
+        label.push_back(header.second.label);
+        size.push_back(header.second.size);
+        unique_id.push_back(header.second.unique_id);
+      }
+      writer.addColumn("column.index", index);
+      writer.addStringColumn("column.filename", filename);
+      writer.addStringColumn("column.label", label);
+      writer.addColumn("column.size", size);
+      writer.addColumn("column.unique_id", unique_id);
+      column_meta.write(writer, "column");
+    }
+    setProgress(1);
+
+    // consensus features with handles and ratios
+    const Size n = consensus_map.size();
+    vector<UInt64> handle_offsets(1, 0), ratio_offsets(1, 0), peptide_offsets(1, 0);
+    vector<UInt64> handle_map_index, handle_unique_id;
+    vector<double> handle_rt, handle_mz;
+    vector<float> handle_intensity, handle_width;
+    vector<Int32> handle_charge;
+    vector<double> ratio_value;
+    vector<String> ratio_denominator, ratio_numerator, ratio_description;
+    vector<UInt64> description_offsets(1, 0);
+    vector<PeptideIdentification> peptides;
+    ColumnarMetaInfoWriter consensus_meta;
+    vector<const BaseFeature*> features;
+    features.reserve(n);
+    for (Size i = 0; i < n; ++i)
+    {
+      const ConsensusFeature& feature = consensus_map[i];
+      features.push_back(&feature);
+      for (const FeatureHandle& handle : feature.getFeatures())
+      {
+        handle_map_index.push_back(handle.getMapIndex());
+        handle_unique_id.push_back(handle.getUniqueId());
+        handle_rt.push_back(handle.getRT());
+        handle_mz.push_back(handle.getMZ());
+        handle_intensity.push_back(handle.getIntensity());
+        handle_charge.push_back(handle.getCharge());
+        handle_width.push_back(handle.getWidth());
+      }
+      handle_offsets.push_back(handle_rt.size());
+      for (const ConsensusFeature::Ratio& ratio : feature.getRatios())
+      {
+        ratio_value.push_back(ratio.ratio_value_);
+        ratio_denominator.push_back(ratio.denominator_ref_);
+        ratio_numerator.push_back(ratio.numerator_ref_);
+        ratio_description.insert(ratio_description.end(), ratio.description_.begin(), ratio.description_.end());
+        description_offsets.push_back(ratio_description.size());
+      }
+      ratio_offsets.push_back(ratio_value.size());
+      peptides.insert(peptides.end(), feature.getPeptideIdentifications().begin(), feature.getPeptideIdentifications().end());
+      peptide_offsets.push_back(peptides.size());
+      consensus_meta.add(i, feature);
+    }
+
+    ColumnarMapHandler::writeBaseFeatures(writer, "consensus", features);
+    writer.addColumn("consensus.handle_offset", handle_offsets);
+    writer.addColumn("consensus.ratio_offset", ratio_offsets);
+    writer.addColumn("consensus.peptide_offset", peptide_offsets);
+    consensus_meta.write(writer, "consensus");
+    writer.addColumn("handle.map_index", handle_map_index);
+    writer.addColumn("handle.unique_id", handle_unique_id);
+    writer.addColumn("handle.rt", handle_rt);
+    writer.addColumn("handle.mz", handle_mz);
+    writer.addColumn("handle.intensity", handle_intensity);
+    writer.addColumn("handle.charge", handle_charge);
+    writer.addColumn("handle.width", handle_width);
+    writer.addColumn("ratio.value", ratio_value);
+    writer.addStringColumn("ratio.denominator", ratio_denominator);
+    writer.addStringColumn("ratio.numerator", ratio_numerator);
+    writer.addColumn("ratio.description_offset", description_offsets);
+    writer.addStringColumn("ratio.description", ratio_description);
+    setProgress(2);
+
+    // peptide identifications of consensus features, followed by the unassigned ones
+    peptides.insert(peptides.end(), consensus_map.getUnassignedPeptideIdentifications().begin(), consensus_map.getUnassignedPeptideIdentifications().end());
+    IdBinFile().store(writer, consensus_map.getProteinIdentifications(), peptides);
+
+    writer.close();
+    endProgress();
+  }
+
+  void ConsensusBinFile::open(const String& filename)
+  {
+    reader_.open(filename, CONTENT_TAG);
+  }
+
+  void ConsensusBinFile::load(const String& filename, ConsensusMap& consensus_map)
+  {
+    open(filename);
+
+    consensus_map.clear(true);
+    consensus_map.setLoadedFileType(filename);
+    consensus_map.setLoadedFilePath(filename);
+
+    ColumnarMapHandler::readMapInfo(reader_, consensus_map, consensus_map, consensus_map, consensus_map.getDataProcessing());
+    consensus_map.setExperimentType(reader_.getStringColumn("map.experiment_type")[0]);
+
+    // column headers
+    {
+      ColumnarBinaryReader::ColumnView<UInt64> index = reader_.getColumn<UInt64>("column.index");
+      ColumnarBinaryReader::StringColumnView filename_column = reader_.getStringColumn("column.filename");
+      ColumnarBinaryReader::StringColumnView label = reader_.getStringColumn("column.label");
+      ColumnarBinaryReader::ColumnView<UInt64> size = reader_.getColumn<UInt64>("column.size");
+      ColumnarBinaryReader::ColumnView<UInt64> unique_id = reader_.getColumn<UInt64>("column.unique_id");
+      ConsensusMap::ColumnHeaders& headers = consensus_map.getColumnHeaders();
+      vector<ConsensusMap::ColumnHeader*> header_ptrs;
+      for (Size i = 0; i < index.size(); ++i)
+      {
+        ConsensusMap::ColumnHeader& header = headers[index[i]];
+        header.filename = filename_column[i];
+        header.label = label[i];
+        header.size = size[i];
+        header.unique_id = unique_id[i];
+        header_ptrs.push_back(&header);
+      }
+      ColumnarMetaInfoReader::read(reader_, "column", [&header_ptrs](UInt64 row) -> MetaInfoInterface*
+      {
+        return header_ptrs[row];
+      });
+    }
+
+    IdBinFile ids;
+    ids.open(reader_);
+    ids.getProteinIdentifications(consensus_map.getProteinIdentifications());
+
+    ColumnarBinaryReader::ColumnView<UInt64> peptide_offsets = reader_.getColumn<UInt64>("consensus.peptide_offset");
+    const Size n = peptide_offsets.size() - 1;
+    if (options_.getLoadPeptideIdentifications())
+    {
+      ids.getPeptideIdentifications(peptide_offsets[n], ids.getNrOfPeptideIdentifications(), consensus_map.getUnassignedPeptideIdentifications());
+    }
+
+    if (options_.getMetadataOnly())
+    {
+      consensus_map.updateRanges();
+      return;
+    }
+
+    startProgress(0, n, "loading consensusBin file");
+
+    ColumnarMapHandler::BaseFeatureColumns columns(reader_, "consensus");
+    ColumnarBinaryReader::ColumnView<UInt64> handle_offsets = reader_.getColumn<UInt64>("consensus.handle_offset");
+    ColumnarBinaryReader::ColumnView<UInt64> ratio_offsets = reader_.getColumn<UInt64>("consensus.ratio_offset");
+    ColumnarBinaryReader::ColumnView<UInt64> handle_map_index = reader_.getColumn<UInt64>("handle.map_index");
+    ColumnarBinaryReader::ColumnView<UInt64> handle_unique_id = reader_.getColumn<UInt64>("handle.unique_id");
+    ColumnarBinaryReader::ColumnView<double> handle_rt = reader_.getColumn<double>("handle.rt");
+    ColumnarBinaryReader::ColumnView<double> handle_mz = reader_.getColumn<double>("handle.mz");
+    ColumnarBinaryReader::ColumnView<float> handle_intensity = reader_.getColumn<float>("handle.intensity");
+    ColumnarBinaryReader::ColumnView<Int32> handle_charge = reader_.getColumn<Int32>("handle.charge");
+    ColumnarBinaryReader::ColumnView<float> handle_width = reader_.getColumn<float>("handle.width");
+    ColumnarBinaryReader::ColumnView<double> ratio_value = reader_.getColumn<double>("ratio.value");
+    ColumnarBinaryReader::StringColumnView ratio_denominator = reader_.getStringColumn("ratio.denominator");
+    ColumnarBinaryReader::StringColumnView ratio_numerator = reader_.getStringColumn("ratio.numerator");
+    ColumnarBinaryReader::ColumnView<UInt64> description_offsets = reader_.getColumn<UInt64>("ratio.description_offset");
+    ColumnarBinaryReader::StringColumnView ratio_description = reader_.getStringColumn("ratio.description");
+
+    // select consensus features based on the coordinate columns only
+    vector<UInt64> selected;
+    selected.reserve(n);
+    for (UInt64 row = 0; row < n; ++row)
+    {
+      if (columns.passesFilter(row, options_)) selected.push_back(row);
+    }
+
+    // peptide identifications of the selected features (as one block)
+    vector<PeptideIdentification> peptides;
+    UInt64 first_peptide = 0;
+    if (options_.getLoadPeptideIdentifications() && !selected.empty())
+    {
+      first_peptide = peptide_offsets[selected.front()];
+      ids.getPeptideIdentifications(first_peptide, peptide_offsets[selected.back() + 1], peptides);
+    }
+
+    consensus_map.resize(selected.size());
+    for (Size i = 0; i < selected.size(); ++i)
+    {
+      const UInt64 row = selected[i];
+      ConsensusFeature& feature = consensus_map[i];
+      columns.fill(row, feature);
+      for (UInt64 h = handle_offsets[row]; h < handle_offsets[row + 1]; ++h)
+      {
+        FeatureHandle handle;
+        handle.setMapIndex(handle_map_index[h]);
+        handle.setUniqueId(handle_unique_id[h]);
+        handle.setRT(handle_rt[h]);
+        handle.setMZ(handle_mz[h]);
+        handle.setIntensity(handle_intensity[h]);
+        handle.setCharge(handle_charge[h]);
+        handle.setWidth(handle_width[h]);
+        feature.insert(handle);
+      }
+      for (UInt64 r = ratio_offsets[row]; r < ratio_offsets[row + 1]; ++r)
+      {
+        ConsensusFeature::Ratio ratio;
+        ratio.ratio_value_ = ratio_value[r];
+        ratio.denominator_ref_ = ratio_denominator[r];
+        ratio.numerator_ref_ = ratio_numerator[r];
+        for (UInt64 d = description_offsets[r]; d < description_offsets[r + 1]; ++d)
+        {
+          ratio.description_.push_back(ratio_description[d]);
+        }
+        feature.addRatio(ratio);
+      }
+      if (options_.getLoadPeptideIdentifications())
+      {
+        feature.getPeptideIdentifications().assign(peptides.begin() + (peptide_offsets[row] - first_peptide),
+                                                   peptides.begin() + (peptide_offsets[row + 1] - first_peptide));
+      }
+      setProgress(i);
+    }
+
+    // meta values
+    ColumnarMetaInfoReader consensus_meta(reader_, "consensus");
+    if (selected.size() == n)
+    {
+      for (Size i = 0; i < consensus_meta.size(); ++i)
+      {
+        consensus_map[consensus_meta.row(i)].setMetaValue(consensus_meta.key(i), consensus_meta.value(i));
+      }
+    }
+    else
+    {
+      for (Size i = 0; i < selected.size(); ++i)
+      {
+        for (Size m : consensus_meta.findRows(selected[i], selected[i] + 1))
+        {
+          consensus_map[i].setMetaValue(consensus_meta.key(m), consensus_meta.value(m));
+        }
+      }
+    }
+    endProgress();
+
+    consensus_map.updateRanges();
+  }
+
+  void ConsensusBinFile::checkOpen_() const
+  {
+    if (!reader_.isOpen())
+    {
+      throw Exception::IllegalArgument(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, "No consensusBin file opened. Call open() first.");
+    }
+  }
+
+  Size ConsensusBinFile::size() const
+  {
+    checkOpen_();
+    return reader_.getColumnSize("consensus.rt");
+  }
+
+  vector<double> ConsensusBinFile::getRTs() const
+  {
+    checkOpen_();
+    return reader_.getColumnOrEmpty<double>("consensus.rt");
+  }
+
+  vector<double> ConsensusBinFile::getMZs() const
+  {
+    checkOpen_();
+    return reader_.getColumnOrEmpty<double>("consensus.mz");
+  }
+
+  vector<float> ConsensusBinFile::getIntensities() const
+  {
+    checkOpen_();
+    return reader_.getColumnOrEmpty<float>("consensus.intensity");
+  }
+
+  vector<float> ConsensusBinFile::getQualities() const
+  {
+    checkOpen_();
+    return reader_.getColumnOrEmpty<float>("consensus.quality");
+  }
+
+  vector<UInt64> ConsensusBinFile::getHandleOffsets() const
+  {
+    checkOpen_();
+    return reader_.getColumnOrEmpty<UInt64>("consensus.handle_offset");
+  }
+
+  vector<UInt64> ConsensusBinFile::getHandleMapIndices() const
+  {
+    checkOpen_();
+    return reader_.getColumnOrEmpty<UInt64>("handle.map_index");
+  }
+
+  vector<float> ConsensusBinFile::getHandleIntensities() const
+  {
+    checkOpen_();
+    return reader_.getColumnOrEmpty<float>("handle.intensity");
+  }
+
+} // namespace OpenMS
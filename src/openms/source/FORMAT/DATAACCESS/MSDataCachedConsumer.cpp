@@ -41,13 +41,14 @@
 
 namespace OpenMS
 {
-  MSDataCachedConsumer::MSDataCachedConsumer(const String& filename, bool clearData) :
+  MSDataCachedConsumer::MSDataCachedConsumer(const String& filename, bool clearData, bool compress) :
     ofs_(filename.c_str(), std::ios::binary),
     clearData_(clearData),
     spectra_written_(0),
     chromatograms_written_(0)
   {
-    int file_identifier = CACHED_MZML_FILE_IDENTIFIER;
+    setCompression(compress);
+    int file_identifier = compress ? CACHED_MZML_FILE_IDENTIFIER_COMPRESSED : CACHED_MZML_FILE_IDENTIFIER;
     ofs_.write((char*)&file_identifier, sizeof(file_identifier));
   }
 
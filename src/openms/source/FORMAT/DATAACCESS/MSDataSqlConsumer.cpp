@@ -65,6 +65,11 @@ namespace OpenMS
     delete handler_;
   }
 
+  void MSDataSqlConsumer::setByteShuffle(bool byte_shuffle)
+  {
+    handler_->setByteShuffle(byte_shuffle);
+  }
+
   void MSDataSqlConsumer::flush()
   {
     if (!spectra_.empty() ) 
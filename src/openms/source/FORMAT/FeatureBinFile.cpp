@@ -0,0 +1,356 @@
+// --------------------------------------------------------------------------
+//                   OpenMS -- Open-Source Mass Spectrometry
+// --------------------------------------------------------------------------
+// Copyright The OpenMS Team -- Eberhard Karls University Tuebingen,
+// ETH Zurich, and Freie Universitaet Berlin 2002-2020.
+//
+// This software is released under a three-clause BSD license:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of any author or any participating institution
+//    may be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+// For a full list of authors, refer to the file AUTHORS.
+// --------------------------------------------------------------------------
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL ANY OF THE AUTHORS OR THE CONTRIBUTING
+// INSTITUTIONS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// --------------------------------------------------------------------------
+// $Maintainer: agent $
+// $Authors: agent $
+// --------------------------------------------------------------------------
+
+
+#include <OpenMS/FORMAT/FeatureBinFile.h>
+
+#include <OpenMS/FORMAT/HANDLERS/ColumnarMapHandler.h>
+#include <OpenMS/FORMAT/IdBinFile.h>
+
+#include <functional>
+
+using namespace std;
+
+namespace OpenMS
+{
+  using Internal::ColumnarBinaryReader;
+  using Internal::ColumnarBinaryWriter;
+  using Internal::ColumnarMapHandler;
+  using Internal::ColumnarMetaInfoReader;
+  using Internal::ColumnarMetaInfoWriter;
+
+  const char* const FeatureBinFile::CONTENT_TAG = "featBin";
+
+  FeatureBinFile::FeatureBinFile() :
+    ProgressLogger()
+  {
+  }
+
+  FeatureBinFile::~FeatureBinFile()
+  {
+  }
+
+  FeatureFileOptions& FeatureBinFile::getOptions()
+  {
+    return options_;
+  }
+
+  const FeatureFileOptions& FeatureBinFile::getOptions() const
+  {
+    return options_;
+  }
+
+  void FeatureBinFile::setOptions(const FeatureFileOptions& options)
+  {
+    options_ = options;
+  }
+
+  void FeatureBinFile::store(const String& filename, const FeatureMap& feature_map)
+  {
+    ColumnarBinaryWriter writer(filename, CONTENT_TAG);
+
+    startProgress(0, 3, "storing featureBin file");
+    ColumnarMapHandler::writeMapInfo(writer, feature_map, feature_map, feature_map, feature_map.getDataProcessing());
+
+    // flatten the feature tree (subordinates follow their parent)
+    vector<const Feature*> features;
+    vector<UInt64> subtree_end;
+    function<void(const Feature&)> flatten = [&](const Feature& feature)
+    {
+      const Size row = features.size();
+      features.push_back(&feature);
+      subtree_end.push_back(0);
+      for (const Feature& sub : feature.getSubordinates())
+      {
+        flatten(sub);
+      }
+      subtree_end[row] = features.size();
+    };
+    for (const Feature& feature : feature_map)
+    {
+      flatten(feature);
+    }
+
+    const Size n = features.size();
+    vector<float> quality_rt(n), quality_mz(n);
+    vector<UInt64> hull_offsets(1, 0), point_offsets(1, 0), peptide_offsets(1, 0);
+    vector<double> hull_rt, hull_mz;
+    vector<PeptideIdentification> peptides;
+    ColumnarMetaInfoWriter feature_meta;
+    for (Size i = 0; i < n; ++i)
+    {
+      const Feature& feature = *features[i];
+      quality_rt[i] = feature.getQuality(0);
+      quality_mz[i] = feature.getQuality(1);
+      for (const ConvexHull2D& hull : feature.getConvexHulls())
+      {
+        for (const ConvexHull2D::PointType& point : hull.getHullPoints())
+        {
+          hull_rt.push_back(point[0]);
+          hull_mz.push_back(point[1]);
+        }
+        point_offsets.push_back(hull_rt.size());
+      }
+      hull_offsets.push_back(point_offsets.size() - 1);
+      peptides.insert(peptides.end(), feature.getPeptideIdentifications().begin(), feature.getPeptideIdentifications().end());
+      peptide_offsets.push_back(peptides.size());
+      feature_meta.add(i, feature);
+    }
+    setProgress(1);
+
+    ColumnarMapHandler::writeBaseFeatures(writer, "feature", vector<const BaseFeature*>(features.begin(), features.end()));
+    writer.addColumn("feature.quality_rt", quality_rt);
+    writer.addColumn("feature.quality_mz", quality_mz);
+    writer.addColumn("feature.subtree_end", subtree_end);
+    writer.addColumn("feature.hull_offset", hull_offsets);
+    writer.addColumn("feature.peptide_offset", peptide_offsets);
+    feature_meta.write(writer, "feature");
+    writer.addColumn("hull.point_offset", point_offsets);
+    writer.addColumn("hull.rt", hull_rt);
+    writer.addColumn("hull.mz", hull_mz);
+    setProgress(2);
+
+    // peptide identifications of features, followed by the unassigned ones
+    peptides.insert(peptides.end(), feature_map.getUnassignedPeptideIdentifications().begin(), feature_map.getUnassignedPeptideIdentifications().end());
+    IdBinFile().store(writer, feature_map.getProteinIdentifications(), peptides);
+
+    writer.close();
+    endProgress();
+  }
+
+  void FeatureBinFile::open(const String& filename)
+  {
+    reader_.open(filename, CONTENT_TAG);
+
+    ColumnarBinaryReader::ColumnView<UInt64> subtree_end = reader_.getColumn<UInt64>("feature.subtree_end");
+    top_level_.clear();
+    for (UInt64 row = 0; row < subtree_end.size(); row = subtree_end[row])
+    {
+      top_level_.push_back(row);
+    }
+  }
+
+  Size FeatureBinFile::loadSize(const String& filename)
+  {
+    open(filename);
+    return size();
+  }
+
+  void FeatureBinFile::load(const String& filename, FeatureMap& feature_map)
+  {
+    open(filename);
+
+    feature_map.clear(true);
+    feature_map.setLoadedFileType(filename);
+    feature_map.setLoadedFilePath(filename);
+
+    ColumnarMapHandler::readMapInfo(reader_, feature_map, feature_map, feature_map, feature_map.getDataProcessing());
+
+    IdBinFile ids;
+    ids.open(reader_);
+    ids.getProteinIdentifications(feature_map.getProteinIdentifications());
+
+    ColumnarBinaryReader::ColumnView<UInt64> peptide_offsets = reader_.getColumn<UInt64>("feature.peptide_offset");
+    const Size n_rows = peptide_offsets.size() - 1;
+    if (options_.getLoadPeptideIdentifications())
+    {
+      ids.getPeptideIdentifications(peptide_offsets[n_rows], ids.getNrOfPeptideIdentifications(), feature_map.getUnassignedPeptideIdentifications());
+    }
+
+    if (options_.getMetadataOnly())
+    {
+      feature_map.updateRanges();
+      return;
+    }
+
+    startProgress(0, top_level_.size(), "loading featureBin file");
+
+    ColumnarMapHandler::BaseFeatureColumns columns(reader_, "feature");
+    ColumnarBinaryReader::ColumnView<float> quality_rt = reader_.getColumn<float>("feature.quality_rt");
+    ColumnarBinaryReader::ColumnView<float> quality_mz = reader_.getColumn<float>("feature.quality_mz");
+    ColumnarBinaryReader::ColumnView<UInt64> subtree_end = reader_.getColumn<UInt64>("feature.subtree_end");
+    ColumnarBinaryReader::ColumnView<UInt64> hull_offsets = reader_.getColumn<UInt64>("feature.hull_offset");
+    ColumnarBinaryReader::ColumnView<UInt64> point_offsets = reader_.getColumn<UInt64>("hull.point_offset");
+    ColumnarBinaryReader::ColumnView<double> hull_rt = reader_.getColumn<double>("hull.rt");
+    ColumnarBinaryReader::ColumnView<double> hull_mz = reader_.getColumn<double>("hull.mz");
+
+    // select features based on the coordinate columns only (as in featureXML, the ranges also apply to subordinates)
+    vector<UInt64> selected;
+    selected.reserve(top_level_.size());
+    for (UInt64 row : top_level_)
+    {
+      if (columns.passesFilter(row, options_)) selected.push_back(row);
+    }
+    const bool complete = (selected.size() == top_level_.size());
+
+    // peptide identifications of the selected features (as one block)
+    vector<PeptideIdentification> peptides;
+    UInt64 first_peptide = 0;
+    if (options_.getLoadPeptideIdentifications() && !selected.empty())
+    {
+      first_peptide = peptide_offsets[selected.front()];
+      ids.getPeptideIdentifications(first_peptide, peptide_offsets[subtree_end[selected.back()]], peptides);
+    }
+
+    function<void(UInt64, Feature&)> build = [&](UInt64 row, Feature& feature)
+    {
+      columns.fill(row, feature);
+      feature.setQuality(0, quality_rt[row]);
+      feature.setQuality(1, quality_mz[row]);
+      if (options_.getLoadConvexHull())
+      {
+        for (UInt64 h = hull_offsets[row]; h < hull_offsets[row + 1]; ++h)
+        {
+          ConvexHull2D::PointArrayType points;
+          points.reserve(point_offsets[h + 1] - point_offsets[h]);
+          for (UInt64 p = point_offsets[h]; p < point_offsets[h + 1]; ++p)
+          {
+            points.push_back(ConvexHull2D::PointType(hull_rt[p], hull_mz[p]));
+          }
+          ConvexHull2D hull;
+          hull.setHullPoints(points);
+          feature.getConvexHulls().push_back(hull);
+        }
+      }
+      if (options_.getLoadPeptideIdentifications())
+      {
+        feature.getPeptideIdentifications().assign(peptides.begin() + (peptide_offsets[row] - first_peptide),
+                                                   peptides.begin() + (peptide_offsets[row + 1] - first_peptide));
+      }
+      if (options_.getLoadSubordinates())
+      {
+        for (UInt64 child = row + 1; child < subtree_end[row]; child = subtree_end[child])
+        {
+          if (!columns.passesFilter(child, options_)) continue;
+          feature.getSubordinates().push_back(Feature());
+          build(child, feature.getSubordinates().back());
+        }
+      }
+    };
+
+    feature_map.resize(selected.size());
+    for (Size i = 0; i < selected.size(); ++i)
+    {
+      build(selected[i], feature_map[i]);
+      setProgress(i);
+    }
+
+    // meta values (the feature tree does not change anymore)
+    vector<Feature*> row_to_feature(n_rows, nullptr);
+    function<void(UInt64, Feature&)> assign = [&](UInt64 row, Feature& feature)
+    {
+      row_to_feature[row] = &feature;
+      UInt64 child = row + 1;
+      for (Feature& sub : feature.getSubordinates())
+      {
+        while (!columns.passesFilter(child, options_)) child = subtree_end[child];
+        assign(child, sub);
+        child = subtree_end[child];
+      }
+    };
+    for (Size i = 0; i < selected.size(); ++i)
+    {
+      assign(selected[i], feature_map[i]);
+    }
+    ColumnarMetaInfoReader feature_meta(reader_, "feature");
+    if (complete)
+    {
+      for (Size i = 0; i < feature_meta.size(); ++i)
+      {
+        Feature* feature = row_to_feature[feature_meta.row(i)];
+        if (feature != nullptr) feature->setMetaValue(feature_meta.key(i), feature_meta.value(i));
+      }
+    }
+    else
+    {
+      for (UInt64 row : selected)
+      {
+        for (Size i : feature_meta.findRows(row, subtree_end[row]))
+        {
+          Feature* feature = row_to_feature[feature_meta.row(i)];
+          if (feature != nullptr) feature->setMetaValue(feature_meta.key(i), feature_meta.value(i));
+        }
+      }
+    }
+    endProgress();
+
+    feature_map.updateRanges();
+  }
+
+  void FeatureBinFile::checkOpen_() const
+  {
+    if (!reader_.isOpen())
+    {
+      throw Exception::IllegalArgument(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, "No featureBin file opened. Call open() first.");
+    }
+  }
+
+  Size FeatureBinFile::size() const
+  {
+    checkOpen_();
+    return top_level_.size();
+  }
+
+  vector<double> FeatureBinFile::getRTs() const
+  {
+    return getTopLevelColumn_<double>("feature.rt");
+  }
+
+  vector<double> FeatureBinFile::getMZs() const
+  {
+    return getTopLevelColumn_<double>("feature.mz");
+  }
+
+  vector<float> FeatureBinFile::getIntensities() const
+  {
+    return getTopLevelColumn_<float>("feature.intensity");
+  }
+
+  vector<float> FeatureBinFile::getQualities() const
+  {
+    return getTopLevelColumn_<float>("feature.quality");
+  }
+
+  vector<Int> FeatureBinFile::getCharges() const
+  {
+    vector<Int32> charges = getTopLevelColumn_<Int32>("feature.charge");
+    return vector<Int>(charges.begin(), charges.end());
+  }
+
+  vector<UInt64> FeatureBinFile::getUniqueIds() const
+  {
+    return getTopLevelColumn_<UInt64>("feature.unique_id");
+  }
+
+} // namespace OpenMS
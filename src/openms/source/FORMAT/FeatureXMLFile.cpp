@@ -362,6 +362,8 @@ namespace OpenMS
       ++disable_parsing_;
     else if ((!options_.getLoadConvexHull()) && tag == "convexhull")
       ++disable_parsing_;
+    else if ((!options_.getLoadPeptideIdentifications()) && (tag == "PeptideIdentification" || tag == "UnassignedPeptideIdentification"))
+      ++disable_parsing_;
 
     if (disable_parsing_)
       return;
@@ -798,7 +800,8 @@ namespace OpenMS
     // handle skipping of whole sections
     // IMPORTANT: check parent tags first (i.e. tags higher in the tree), since otherwise sections might be enabled/disabled too early/late
     if (((!options_.getLoadSubordinates()) && tag == "subordinate")
-       || ((!options_.getLoadConvexHull()) && tag == "convexhull"))
+       || ((!options_.getLoadConvexHull()) && tag == "convexhull")
+       || ((!options_.getLoadPeptideIdentifications()) && (tag == "PeptideIdentification" || tag == "UnassignedPeptideIdentification")))
     {
       --disable_parsing_;
       return; // even if disable_parsing is false now, we still exit (since this endelement() should be ignored)
@@ -38,7 +38,12 @@
 #include <OpenMS/FORMAT/DTA2DFile.h>
 #include <OpenMS/FORMAT/MzXMLFile.h>
 #include <OpenMS/FORMAT/MzMLFile.h>
+#include <OpenMS/FORMAT/ConsensusBinFile.h>
+#include <OpenMS/FORMAT/FeatureBinFile.h>
 #include <OpenMS/FORMAT/FeatureXMLFile.h>
+#include <OpenMS/FORMAT/IdBinFile.h>
+#include <OpenMS/FORMAT/IdXMLFile.h>
+#include <OpenMS/FORMAT/MzIdentMLFile.h>
 #include <OpenMS/FORMAT/MzDataFile.h>
 #include <OpenMS/FORMAT/MascotGenericFile.h>
 #include <OpenMS/FORMAT/MS2File.h>
@@ -129,6 +134,20 @@ namespace OpenMS
 
   FileTypes::Type FileHandler::getTypeByContent(const String& filename)
   {
+    // binary formats with a file magic
+    if (Internal::ColumnarBinaryFormat::hasContentTag(filename, IdBinFile::CONTENT_TAG))
+    {
+      return FileTypes::IDBIN;
+    }
+    if (Internal::ColumnarBinaryFormat::hasContentTag(filename, FeatureBinFile::CONTENT_TAG))
+    {
+      return FileTypes::FEATUREBIN;
+    }
+    if (Internal::ColumnarBinaryFormat::hasContentTag(filename, ConsensusBinFile::CONTENT_TAG))
+    {
+      return FileTypes::CONSENSUSBIN;
+    }
+
     String first_line;
     String two_five;
     String all_simple;
@@ -515,6 +534,10 @@ if (first_line.hasSubstring("File	First Scan	Last Scan	Num of Scans	Charge	Monoi
     {
       FeatureXMLFile().load(filename, map);
     }
+    else if (type == FileTypes::FEATUREBIN)
+    {
+      FeatureBinFile().load(filename, map);
+    }
     else if (type == FileTypes::TSV)
     {
       MsInspectFile().load(filename, map);
@@ -535,6 +558,65 @@ if (first_line.hasSubstring("File	First Scan	Last Scan	Num of Scans	Charge	Monoi
     return true;
   }
 
+  bool FileHandler::loadIdentifications(const String& filename, std::vector<ProteinIdentification>& protein_ids, std::vector<PeptideIdentification>& peptide_ids, FileTypes::Type force_type)
+  {
+    //determine file type
+    FileTypes::Type type;
+    if (force_type != FileTypes::UNKNOWN)
+    {
+      type = force_type;
+    }
+    else
+    {
+      try
+      {
+        type = getType(filename);
+      }
+      catch ( Exception::FileNotFound& )
+      {
+        return false;
+      }
+    }
+
+    //load right file
+    if (type == FileTypes::IDXML)
+    {
+      IdXMLFile().load(filename, protein_ids, peptide_ids);
+    }
+    else if (type == FileTypes::IDBIN)
+    {
+      IdBinFile().load(filename, protein_ids, peptide_ids);
+    }
+    else if (type == FileTypes::MZIDENTML)
+    {
+      MzIdentMLFile().load(filename, protein_ids, peptide_ids);
+    }
+    else
+    {
+      return false;
+    }
+
+    return true;
+  }
+
+  void FileHandler::storeIdentifications(const String& filename, const std::vector<ProteinIdentification>& protein_ids, const std::vector<PeptideIdentification>& peptide_ids)
+  {
+    switch (getTypeByFileName(filename))
+    {
+    case FileTypes::IDBIN:
+      IdBinFile().store(filename, protein_ids, peptide_ids);
+      break;
+
+    case FileTypes::MZIDENTML:
+      MzIdentMLFile().store(filename, protein_ids, peptide_ids);
+      break;
+
+    default:
+      IdXMLFile().store(filename, protein_ids, peptide_ids);
+      break;
+    }
+  }
+
   bool FileHandler::loadExperiment(const String& filename, PeakMap& exp, FileTypes::Type force_type, ProgressLogger::LogType log, const bool rewrite_source_file, const bool compute_hash)
   {
     // setting the flag for hash recomputation only works if source file entries are rewritten
@@ -144,6 +144,9 @@ namespace OpenMS
     targetMap[FileTypes::JSON] = "json";
     targetMap[FileTypes::RAW] = "raw";
     targetMap[FileTypes::EXE] = "exe";
+    targetMap[FileTypes::IDBIN] = "idBin";
+    targetMap[FileTypes::FEATUREBIN] = "featureBin";
+    targetMap[FileTypes::CONSENSUSBIN] = "consensusBin";
 
     return targetMap;
   }
@@ -36,13 +36,28 @@
 
 #include <OpenMS/KERNEL/MSExperiment.h>
 #include <OpenMS/FORMAT/MzMLFile.h>
+#include <OpenMS/FORMAT/ZlibCompression.h>
 
 namespace OpenMS
 {
 namespace Internal
 {
 
-  CachedMzMLHandler::CachedMzMLHandler()
+  namespace
+  {
+    // Set in the "number of extra arrays" field of spectra and chromatograms
+    // whose main data arrays are stored as a compressed block
+    const Size COMPRESSED_BLOCK_FLAG = Size(1) << (8 * sizeof(Size) - 1);
+
+    bool isCachedFileIdentifier(int file_identifier)
+    {
+      return file_identifier == CACHED_MZML_FILE_IDENTIFIER ||
+             file_identifier == CACHED_MZML_FILE_IDENTIFIER_COMPRESSED;
+    }
+  }
+
+  CachedMzMLHandler::CachedMzMLHandler() :
+    compress_(false)
   {
   }
 
@@ -57,16 +72,27 @@ namespace Internal
 
     spectra_index_ = rhs.spectra_index_;
     chrom_index_ = rhs.chrom_index_;
+    compress_ = rhs.compress_;
 
     return *this;
   }
 
+  void CachedMzMLHandler::setCompression(bool compress)
+  {
+    compress_ = compress;
+  }
+
+  bool CachedMzMLHandler::getCompression() const
+  {
+    return compress_;
+  }
+
   void CachedMzMLHandler::writeMemdump(const MapType& exp, const String& out) const
   {
     std::ofstream ofs(out.c_str(), std::ios::binary);
     Size exp_size = exp.size();
     Size chrom_size = exp.getChromatograms().size();
-    int file_identifier = CACHED_MZML_FILE_IDENTIFIER;
+    int file_identifier = compress_ ? CACHED_MZML_FILE_IDENTIFIER_COMPRESSED : CACHED_MZML_FILE_IDENTIFIER;
     ofs.write((char*)&file_identifier, sizeof(file_identifier));
 
     startProgress(0, exp.size() + exp.getChromatograms().size(), "storing binary data");
@@ -101,7 +127,7 @@ namespace Internal
 
     int file_identifier;
     ifs.read((char*)&file_identifier, sizeof(file_identifier));
-    if (file_identifier != CACHED_MZML_FILE_IDENTIFIER)
+    if (!isCachedFileIdentifier(file_identifier))
     {
       throw Exception::ParseError(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, 
         "File might not be a cached mzML file (wrong file magic number). Aborting!", filename);
@@ -166,7 +192,7 @@ namespace Internal
     int chrom_offset = 0;
 
     ifs.read((char*)&file_identifier, sizeof(file_identifier));
-    if (file_identifier != CACHED_MZML_FILE_IDENTIFIER)
+    if (!isCachedFileIdentifier(file_identifier))
     {
       throw Exception::ParseError(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, 
           "File might not be a cached mzML file (wrong file magic number). Aborting!", filename);
@@ -193,7 +219,18 @@ namespace Internal
       spectra_index_.push_back(ifs.tellg());
       ifs.read((char*)&spec_size, sizeof(spec_size));
       ifs.read((char*)&float_arr, sizeof(float_arr));
-      ifs.seekg(extra_offset + (sizeof(DatumSingleton)) * 2 * (spec_size), ifs.cur);
+      if (float_arr & COMPRESSED_BLOCK_FLAG)
+      {
+        Size block_size;
+        float_arr &= ~COMPRESSED_BLOCK_FLAG;
+        ifs.seekg(extra_offset, ifs.cur);
+        ifs.read((char*)&block_size, sizeof(block_size));
+        ifs.seekg(block_size, ifs.cur);
+      }
+      else
+      {
+        ifs.seekg(extra_offset + (sizeof(DatumSingleton)) * 2 * (spec_size), ifs.cur);
+      }
 
       // Read the extra data arrays
       for (Size k = 0; k < float_arr; k++)
@@ -215,7 +252,18 @@ namespace Internal
       chrom_index_.push_back(ifs.tellg());
       ifs.read((char*)&ch_size, sizeof(ch_size));
       ifs.read((char*)&float_arr, sizeof(float_arr));
-      ifs.seekg(chrom_offset + (sizeof(DatumSingleton)) * 2 * (ch_size), ifs.cur);
+      if (float_arr & COMPRESSED_BLOCK_FLAG)
+      {
+        Size block_size;
+        float_arr &= ~COMPRESSED_BLOCK_FLAG;
+        ifs.seekg(chrom_offset, ifs.cur);
+        ifs.read((char*)&block_size, sizeof(block_size));
+        ifs.seekg(block_size, ifs.cur);
+      }
+      else
+      {
+        ifs.seekg(chrom_offset + (sizeof(DatumSingleton)) * 2 * (ch_size), ifs.cur);
+      }
 
       // Read the extra data arrays
       for (Size k = 0; k < float_arr; k++)
@@ -344,18 +392,41 @@ namespace Internal
   {
     OPENMS_PRECONDITION(data.size() == 2, "Input data needs to have 2 slots.")
 
-    data[0]->data.resize(data_size);
-    data[1]->data.resize(data_size);
+    if (nr_float_arrays & COMPRESSED_BLOCK_FLAG)
+    {
+      // both arrays are stored in a single compressed block
+      Size block_size = 0;
+      ifs.read((char*) &block_size, sizeof(block_size));
+      std::string block(block_size, '\0');
+      if (block_size > 0) ifs.read(&block[0], block_size);
 
-    if (data_size > 0)
+      std::string buffer;
+      Datavector block_data;
+      ZlibCompression::uncompressShuffled(block.data(), block.size(), buffer, block_data);
+      if (block_data.size() != 2 * data_size)
+      {
+        throw Exception::ParseError(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION,
+          "Read an invalid compressed data block, something is wrong here. Aborting.", "filestream");
+      }
+      data[0]->data.assign(block_data.begin(), block_data.begin() + data_size);
+      data[1]->data.assign(block_data.begin() + data_size, block_data.end());
+    }
+    else
     {
-      ifs.read((char*) &(data[0]->data)[0], data_size * sizeof(DatumSingleton));
-      ifs.read((char*) &(data[1]->data)[0], data_size * sizeof(DatumSingleton));
+      data[0]->data.resize(data_size);
+      data[1]->data.resize(data_size);
+
+      if (data_size > 0)
+      {
+        ifs.read((char*) &(data[0]->data)[0], data_size * sizeof(DatumSingleton));
+        ifs.read((char*) &(data[1]->data)[0], data_size * sizeof(DatumSingleton));
+      }
     }
-    if (nr_float_arrays == 0) return;
+    const Size nr_extra_arrays = nr_float_arrays & ~COMPRESSED_BLOCK_FLAG;
+    if (nr_extra_arrays == 0) return;
 
     char* buffer = new(std::nothrow) char[1024];
-    for (Size k = 0; k < nr_float_arrays; k++)
+    for (Size k = 0; k < nr_extra_arrays; k++)
     {
       data.push_back(OpenSwath::BinaryDataArrayPtr(new OpenSwath::BinaryDataArray));
       Size len, len_name;
@@ -455,6 +526,7 @@ namespace Internal
     Size exp_size = spectrum.size();
     ofs.write((char*)&exp_size, sizeof(exp_size));
     Size arr_s = spectrum.getFloatDataArrays().size() + spectrum.getIntegerDataArrays().size();
+    if (compress_ && !spectrum.empty()) arr_s |= COMPRESSED_BLOCK_FLAG;
     ofs.write((char*)&arr_s, sizeof(arr_s));
     IntType int_field_ = spectrum.getMSLevel();
     ofs.write((char*)&int_field_, sizeof(int_field_));
@@ -478,8 +550,7 @@ namespace Internal
       int_data.push_back(static_cast<double>(spectrum[j].getIntensity()));
     }
 
-    ofs.write((char*)&mz_data.front(), mz_data.size() * sizeof(mz_data.front()));
-    ofs.write((char*)&int_data.front(), int_data.size() * sizeof(int_data.front()));
+    writeData_(mz_data, int_data, ofs);
 
     Datavector tmp;
     for (const auto& fda : spectrum.getFloatDataArrays() )
@@ -510,11 +581,32 @@ namespace Internal
     }
   }
 
+  void CachedMzMLHandler::writeData_(const Datavector& data1, const Datavector& data2, std::ofstream& ofs) const
+  {
+    if (!compress_)
+    {
+      ofs.write((char*)&data1.front(), data1.size() * sizeof(data1.front()));
+      ofs.write((char*)&data2.front(), data2.size() * sizeof(data2.front()));
+      return;
+    }
+
+    Datavector block_data;
+    block_data.reserve(data1.size() + data2.size());
+    block_data.insert(block_data.end(), data1.begin(), data1.end());
+    block_data.insert(block_data.end(), data2.begin(), data2.end());
+    std::string block;
+    ZlibCompression::compressShuffled(block_data, block);
+    Size block_size = block.size();
+    ofs.write((char*)&block_size, sizeof(block_size));
+    ofs.write(block.data(), block_size);
+  }
+
   void CachedMzMLHandler::writeChromatogram_(const ChromatogramType& chromatogram, std::ofstream& ofs) const
   {
     Size exp_size = chromatogram.size();
     ofs.write((char*)&exp_size, sizeof(exp_size));
     Size arr_s = chromatogram.getFloatDataArrays().size() + chromatogram.getIntegerDataArrays().size();
+    if (compress_ && !chromatogram.empty()) arr_s |= COMPRESSED_BLOCK_FLAG;
     ofs.write((char*)&arr_s, sizeof(arr_s));
 
     // Catch empty chromatogram: we do not write any data and since the "size" we
@@ -533,8 +625,7 @@ namespace Internal
       rt_data.push_back(chromatogram[j].getRT());
       int_data.push_back(chromatogram[j].getIntensity());
     }
-    ofs.write((char*)&rt_data.front(), rt_data.size() * sizeof(rt_data.front()));
-    ofs.write((char*)&int_data.front(), int_data.size() * sizeof(int_data.front()));
+    writeData_(rt_data, int_data, ofs);
 
     Datavector tmp;
     for (const auto& fda : chromatogram.getFloatDataArrays() )
@@ -0,0 +1,579 @@
+// --------------------------------------------------------------------------
+//                   OpenMS -- Open-Source Mass Spectrometry
+// --------------------------------------------------------------------------
+// Copyright The OpenMS Team -- Eberhard Karls University Tuebingen,
+// ETH Zurich, and Freie Universitaet Berlin 2002-2020.
+//
+// This software is released under a three-clause BSD license:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of any author or any participating institution
+//    may be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+// For a full list of authors, refer to the file AUTHORS.
+// --------------------------------------------------------------------------
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL ANY OF THE AUTHORS OR THE CONTRIBUTING
+// INSTITUTIONS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// --------------------------------------------------------------------------
+// $Maintainer: agent $
+// $Authors: agent $
+// --------------------------------------------------------------------------
+
+#include <OpenMS/FORMAT/HANDLERS/ColumnarBinaryHandler.h>
+
+#include <OpenMS/SYSTEM/File.h>
+
+#include <algorithm>
+#include <cstring>
+
+namespace OpenMS
+{
+namespace Internal
+{
+
+  namespace
+  {
+    const UInt32 ENDIANNESS_MARKER = 0x01020304;
+
+    void writeTag(std::ofstream& ofs, const String& tag)
+    {
+      char buffer[ColumnarBinaryFormat::TAG_LENGTH] = {0};
+      std::memcpy(buffer, tag.c_str(), std::min(tag.size(), ColumnarBinaryFormat::TAG_LENGTH));
+      ofs.write(buffer, ColumnarBinaryFormat::TAG_LENGTH);
+    }
+
+    bool tagMatches(const char* data, const String& tag)
+    {
+      char buffer[ColumnarBinaryFormat::TAG_LENGTH] = {0};
+      std::memcpy(buffer, tag.c_str(), std::min(tag.size(), ColumnarBinaryFormat::TAG_LENGTH));
+      return std::memcmp(buffer, data, ColumnarBinaryFormat::TAG_LENGTH) == 0;
+    }
+  }
+
+  const char ColumnarBinaryFormat::MAGIC[ColumnarBinaryFormat::TAG_LENGTH + 1] = "OMSCOLB1";
+
+  bool ColumnarBinaryFormat::hasContentTag(const String& filename, const String& content_tag)
+  {
+    std::ifstream ifs(filename.c_str(), std::ios::binary);
+    char buffer[2 * TAG_LENGTH];
+    ifs.read(buffer, 2 * TAG_LENGTH);
+    if (ifs.gcount() != static_cast<std::streamsize>(2 * TAG_LENGTH)) return false;
+    return std::memcmp(buffer, MAGIC, TAG_LENGTH) == 0 && tagMatches(buffer + TAG_LENGTH, content_tag);
+  }
+
+  ColumnarBinaryWriter::ColumnarBinaryWriter(const String& filename, const String& content_tag) :
+    filename_(filename),
+    ofs_(filename.c_str(), std::ios::binary | std::ios::trunc),
+    closed_(false)
+  {
+    if (!ofs_)
+    {
+      throw Exception::UnableToCreateFile(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, filename);
+    }
+    ofs_.write(ColumnarBinaryFormat::MAGIC, ColumnarBinaryFormat::TAG_LENGTH);
+    writeTag(ofs_, content_tag);
+    UInt32 version = ColumnarBinaryFormat::VERSION;
+    ofs_.write(reinterpret_cast<const char*>(&ENDIANNESS_MARKER), sizeof(ENDIANNESS_MARKER));
+    ofs_.write(reinterpret_cast<const char*>(&version), sizeof(version));
+    UInt64 table_offset = 0; // patched in close()
+    ofs_.write(reinterpret_cast<const char*>(&table_offset), sizeof(table_offset));
+  }
+
+  ColumnarBinaryWriter::~ColumnarBinaryWriter()
+  {
+    if (!closed_)
+    {
+      try
+      {
+        close();
+      }
+      catch (...)
+      {
+        // destructors must not throw
+      }
+    }
+  }
+
+  void ColumnarBinaryWriter::align_()
+  {
+    static const char zeros[8] = {0};
+    std::streamoff pos = ofs_.tellp();
+    if (pos % 8 != 0)
+    {
+      ofs_.write(zeros, 8 - pos % 8);
+    }
+  }
+
+  void ColumnarBinaryWriter::writeSection_(const String& name, ColumnarBinaryFormat::ColumnType type, Size size, const char* data, Size bytes)
+  {
+    if (closed_)
+    {
+      throw Exception::IllegalArgument(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, "Cannot add column '" + name + "' to closed file " + filename_);
+    }
+    align_();
+    Entry_ e;
+    e.name = name;
+    e.type = static_cast<std::uint8_t>(type);
+    e.size = size;
+    e.offset = static_cast<UInt64>(ofs_.tellp());
+    e.bytes = bytes;
+    if (bytes > 0)
+    {
+      ofs_.write(data, bytes);
+    }
+    entries_.push_back(e);
+  }
+
+  void ColumnarBinaryWriter::addStringColumn(const String& name, const std::vector<String>& values)
+  {
+    // layout: offsets (size + 1 entries, relative to the start of the character data), characters
+    std::vector<UInt64> offsets;
+    offsets.reserve(values.size() + 1);
+    UInt64 total = 0;
+    offsets.push_back(total);
+    for (const String& s : values)
+    {
+      total += s.size();
+      offsets.push_back(total);
+    }
+
+    if (closed_)
+    {
+      throw Exception::IllegalArgument(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, "Cannot add column '" + name + "' to closed file " + filename_);
+    }
+    align_();
+    Entry_ e;
+    e.name = name;
+    e.type = static_cast<std::uint8_t>(ColumnarBinaryFormat::STRING);
+    e.size = values.size();
+    e.offset = static_cast<UInt64>(ofs_.tellp());
+    e.bytes = offsets.size() * sizeof(UInt64) + total;
+    ofs_.write(reinterpret_cast<const char*>(offsets.data()), offsets.size() * sizeof(UInt64));
+    for (const String& s : values)
+    {
+      ofs_.write(s.c_str(), s.size());
+    }
+    entries_.push_back(e);
+  }
+
+  void ColumnarBinaryWriter::close()
+  {
+    if (closed_) return;
+    align_();
+    UInt64 table_offset = static_cast<UInt64>(ofs_.tellp());
+    UInt64 n_entries = entries_.size();
+    ofs_.write(reinterpret_cast<const char*>(&n_entries), sizeof(n_entries));
+    for (const Entry_& e : entries_)
+    {
+      UInt32 name_length = static_cast<UInt32>(e.name.size());
+      ofs_.write(reinterpret_cast<const char*>(&name_length), sizeof(name_length));
+      ofs_.write(e.name.c_str(), name_length);
+      ofs_.write(reinterpret_cast<const char*>(&e.type), sizeof(e.type));
+      ofs_.write(reinterpret_cast<const char*>(&e.size), sizeof(e.size));
+      ofs_.write(reinterpret_cast<const char*>(&e.offset), sizeof(e.offset));
+      ofs_.write(reinterpret_cast<const char*>(&e.bytes), sizeof(e.bytes));
+    }
+    // patch the table offset in the header
+    ofs_.seekp(2 * ColumnarBinaryFormat::TAG_LENGTH + 2 * sizeof(UInt32));
+    ofs_.write(reinterpret_cast<const char*>(&table_offset), sizeof(table_offset));
+    ofs_.close();
+    closed_ = true;
+    if (ofs_.fail())
+    {
+      throw Exception::UnableToCreateFile(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, filename_, "Error while writing columnar binary file.");
+    }
+  }
+
+  String ColumnarBinaryReader::StringColumnView::operator[](Size i) const
+  {
+    return String(std::string(chars + offsets[i], chars + offsets[i + 1]));
+  }
+
+  std::vector<String> ColumnarBinaryReader::StringColumnView::toVector() const
+  {
+    std::vector<String> result;
+    result.reserve(length);
+    for (Size i = 0; i < length; ++i)
+    {
+      result.push_back((*this)[i]);
+    }
+    return result;
+  }
+
+  ColumnarBinaryReader::ColumnarBinaryReader()
+  {
+  }
+
+  ColumnarBinaryReader::ColumnarBinaryReader(const String& filename, const String& content_tag)
+  {
+    open(filename, content_tag);
+  }
+
+  bool ColumnarBinaryReader::isOpen() const
+  {
+    return file_.is_open();
+  }
+
+  void ColumnarBinaryReader::open(const String& filename, const String& content_tag)
+  {
+    if (!File::exists(filename))
+    {
+      throw Exception::FileNotFound(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, filename);
+    }
+    if (file_.is_open()) file_.close();
+    entries_.clear();
+    filename_ = filename;
+
+    try
+    {
+      file_.open(filename);
+    }
+    catch (std::exception& e)
+    {
+      throw Exception::ParseError(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, filename, String("Unable to map file into memory: ") + e.what());
+    }
+
+    const char* data = file_.data();
+    const Size file_size = file_.size();
+    if (file_size < ColumnarBinaryFormat::HEADER_SIZE ||
+        std::memcmp(data, ColumnarBinaryFormat::MAGIC, ColumnarBinaryFormat::TAG_LENGTH) != 0 ||
+        !tagMatches(data + ColumnarBinaryFormat::TAG_LENGTH, content_tag))
+    {
+      throw Exception::ParseError(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, filename,
+        "File is not a binary '" + content_tag + "' file (wrong file magic number). Aborting!");
+    }
+
+    Size pos = 2 * ColumnarBinaryFormat::TAG_LENGTH;
+    UInt32 marker, version;
+    UInt64 table_offset;
+    std::memcpy(&marker, data + pos, sizeof(marker)); pos += sizeof(marker);
+    std::memcpy(&version, data + pos, sizeof(version)); pos += sizeof(version);
+    std::memcpy(&table_offset, data + pos, sizeof(table_offset));
+    if (marker != ENDIANNESS_MARKER)
+    {
+      throw Exception::ParseError(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, filename, "File was written with a different byte order. Aborting!");
+    }
+    if (version > ColumnarBinaryFormat::VERSION)
+    {
+      throw Exception::ParseError(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, filename, "Unsupported format version " + String(version) + ". Aborting!");
+    }
+    if (table_offset == 0 || table_offset + sizeof(UInt64) > file_size)
+    {
+      throw Exception::ParseError(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, filename, "Section table missing, the file is probably truncated. Aborting!");
+    }
+
+    // parse section table
+    pos = table_offset;
+    UInt64 n_entries;
+    std::memcpy(&n_entries, data + pos, sizeof(n_entries)); pos += sizeof(n_entries);
+    const Size fixed_entry_size = sizeof(std::uint8_t) + 3 * sizeof(UInt64);
+    for (UInt64 i = 0; i < n_entries; ++i)
+    {
+      UInt32 name_length;
+      if (pos + sizeof(name_length) > file_size)
+      {
+        throw Exception::ParseError(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, filename, "Corrupt section table. Aborting!");
+      }
+      std::memcpy(&name_length, data + pos, sizeof(name_length)); pos += sizeof(name_length);
+      if (pos + name_length + fixed_entry_size > file_size)
+      {
+        throw Exception::ParseError(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, filename, "Corrupt section table. Aborting!");
+      }
+      std::string name(data + pos, name_length); pos += name_length;
+      Entry_ e;
+      std::memcpy(&e.type, data + pos, sizeof(e.type)); pos += sizeof(e.type);
+      std::memcpy(&e.size, data + pos, sizeof(e.size)); pos += sizeof(e.size);
+      std::memcpy(&e.offset, data + pos, sizeof(e.offset)); pos += sizeof(e.offset);
+      std::memcpy(&e.bytes, data + pos, sizeof(e.bytes)); pos += sizeof(e.bytes);
+      if (e.offset + e.bytes > table_offset || e.type >= ColumnarBinaryFormat::SIZE_OF_COLUMNTYPE)
+      {
+        throw Exception::ParseError(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, filename, "Corrupt section '" + name + "'. Aborting!");
+      }
+      entries_[name] = e;
+    }
+  }
+
+  bool ColumnarBinaryReader::hasColumn(const String& name) const
+  {
+    return entries_.find(name) != entries_.end();
+  }
+
+  Size ColumnarBinaryReader::getColumnSize(const String& name) const
+  {
+    auto it = entries_.find(name);
+    return it == entries_.end() ? 0 : it->second.size;
+  }
+
+  const ColumnarBinaryReader::Entry_& ColumnarBinaryReader::findEntry_(const String& name, ColumnarBinaryFormat::ColumnType type) const
+  {
+    auto it = entries_.find(name);
+    if (it == entries_.end())
+    {
+      throw Exception::ElementNotFound(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, name);
+    }
+    if (it->second.type != type)
+    {
+      throw Exception::ParseError(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, filename_,
+        "Column '" + name + "' has type " + String(Int(it->second.type)) + " but " + String(Int(type)) + " was requested.");
+    }
+    return it->second;
+  }
+
+  ColumnarBinaryReader::StringColumnView ColumnarBinaryReader::getStringColumn(const String& name) const
+  {
+    const Entry_& e = findEntry_(name, ColumnarBinaryFormat::STRING);
+    StringColumnView view;
+    view.offsets = reinterpret_cast<const UInt64*>(file_.data() + e.offset);
+    view.chars = file_.data() + e.offset + (e.size + 1) * sizeof(UInt64);
+    view.length = e.size;
+    return view;
+  }
+
+  std::vector<String> ColumnarBinaryReader::getColumnNames() const
+  {
+    std::vector<String> names;
+    for (const auto& e : entries_)
+    {
+      names.push_back(e.first);
+    }
+    std::sort(names.begin(), names.end());
+    return names;
+  }
+
+  UInt32 ColumnarStringPool::index(const String& s)
+  {
+    auto it = index_.find(s);
+    if (it != index_.end()) return it->second;
+    UInt32 idx = static_cast<UInt32>(strings_.size());
+    strings_.push_back(s);
+    index_.emplace(s, idx);
+    return idx;
+  }
+
+  const std::vector<String>& ColumnarStringPool::strings() const
+  {
+    return strings_;
+  }
+
+  Size ColumnarStringPool::size() const
+  {
+    return strings_.size();
+  }
+
+  void ColumnarMetaInfoWriter::add(UInt64 row, const MetaInfoInterface& meta)
+  {
+    if (meta.isMetaEmpty()) return;
+    std::vector<String> keys;
+    meta.getKeys(keys);
+    for (const String& k : keys)
+    {
+      Entry_ e;
+      e.row = row;
+      e.key = keys_.index(k);
+      e.value = meta.getMetaValue(k);
+      entries_.push_back(std::move(e));
+    }
+  }
+
+  void ColumnarMetaInfoWriter::write(ColumnarBinaryWriter& writer, const String& prefix)
+  {
+    // group values by key, keep row order within a key
+    std::stable_sort(entries_.begin(), entries_.end(),
+      [](const Entry_& a, const Entry_& b) { return a.key < b.key; });
+
+    const Size n = entries_.size();
+    std::vector<UInt64> rows(n), sizes(n, 0);
+    std::vector<UInt32> key_idx(n);
+    std::vector<std::uint8_t> types(n);
+    std::vector<Int64> ints(n, 0), list_ints;
+    std::vector<double> doubles(n, 0.0), list_doubles;
+    ColumnarStringPool strings;
+
+    for (Size i = 0; i < n; ++i)
+    {
+      const Entry_& e = entries_[i];
+      const DataValue& v = e.value;
+      rows[i] = e.row;
+      key_idx[i] = e.key;
+      types[i] = static_cast<std::uint8_t>(v.valueType());
+      switch (v.valueType())
+      {
+        case DataValue::STRING_VALUE:
+          ints[i] = strings.index(v.toString());
+          break;
+        case DataValue::INT_VALUE:
+          ints[i] = static_cast<Int64>(v);
+          break;
+        case DataValue::DOUBLE_VALUE:
+          doubles[i] = static_cast<double>(v);
+          break;
+        case DataValue::STRING_LIST:
+        {
+          StringList l = v.toStringList();
+          sizes[i] = l.size();
+          for (const String& s : l) list_ints.push_back(strings.index(s));
+          break;
+        }
+        case DataValue::INT_LIST:
+        {
+          IntList l = v.toIntList();
+          sizes[i] = l.size();
+          list_ints.insert(list_ints.end(), l.begin(), l.end());
+          break;
+        }
+        case DataValue::DOUBLE_LIST:
+        {
+          DoubleList l = v.toDoubleList();
+          sizes[i] = l.size();
+          list_doubles.insert(list_doubles.end(), l.begin(), l.end());
+          break;
+        }
+        default:
+          break;
+      }
+    }
+
+    writer.addStringColumn(prefix + ".meta.keys", keys_.strings());
+    writer.addColumn(prefix + ".meta.row", rows);
+    writer.addColumn(prefix + ".meta.key", key_idx);
+    writer.addColumn(prefix + ".meta.type", types);
+    writer.addColumn(prefix + ".meta.int", ints);
+    writer.addColumn(prefix + ".meta.double", doubles);
+    writer.addColumn(prefix + ".meta.size", sizes);
+    writer.addStringColumn(prefix + ".meta.strings", strings.strings());
+    writer.addColumn(prefix + ".meta.list_int", list_ints);
+    writer.addColumn(prefix + ".meta.list_double", list_doubles);
+
+    entries_.clear();
+    keys_ = ColumnarStringPool();
+  }
+
+  ColumnarMetaInfoReader::ColumnarMetaInfoReader(const ColumnarBinaryReader& reader, const String& prefix)
+  {
+    if (!reader.hasColumn(prefix + ".meta.row")) return;
+
+    keys_ = reader.getStringColumn(prefix + ".meta.keys").toVector();
+    rows_ = reader.getColumn<UInt64>(prefix + ".meta.row");
+    key_idx_ = reader.getColumn<UInt32>(prefix + ".meta.key");
+    types_ = reader.getColumn<std::uint8_t>(prefix + ".meta.type");
+    ints_ = reader.getColumn<Int64>(prefix + ".meta.int");
+    doubles_ = reader.getColumn<double>(prefix + ".meta.double");
+    sizes_ = reader.getColumn<UInt64>(prefix + ".meta.size");
+    strings_ = reader.getStringColumn(prefix + ".meta.strings");
+    list_ints_ = reader.getColumn<Int64>(prefix + ".meta.list_int");
+    list_doubles_ = reader.getColumn<double>(prefix + ".meta.list_double");
+
+    // compute start positions of list values (int and string lists share one column)
+    list_start_.resize(rows_.size(), 0);
+    UInt64 int_pos = 0, double_pos = 0;
+    for (Size i = 0; i < rows_.size(); ++i)
+    {
+      if (types_[i] == DataValue::DOUBLE_LIST)
+      {
+        list_start_[i] = double_pos;
+        double_pos += sizes_[i];
+      }
+      else if (types_[i] == DataValue::INT_LIST || types_[i] == DataValue::STRING_LIST)
+      {
+        list_start_[i] = int_pos;
+        int_pos += sizes_[i];
+      }
+    }
+  }
+
+  Size ColumnarMetaInfoReader::size() const
+  {
+    return rows_.size();
+  }
+
+  UInt64 ColumnarMetaInfoReader::row(Size i) const
+  {
+    return rows_[i];
+  }
+
+  const String& ColumnarMetaInfoReader::key(Size i) const
+  {
+    return keys_[key_idx_[i]];
+  }
+
+  DataValue ColumnarMetaInfoReader::value(Size i) const
+  {
+    const UInt64 start = list_start_[i];
+    switch (types_[i])
+    {
+      case DataValue::STRING_VALUE:
+        return DataValue(strings_[ints_[i]]);
+      case DataValue::INT_VALUE:
+        return DataValue(ints_[i]);
+      case DataValue::DOUBLE_VALUE:
+        return DataValue(doubles_[i]);
+      case DataValue::STRING_LIST:
+      {
+        StringList l;
+        l.reserve(sizes_[i]);
+        for (UInt64 k = start; k < start + sizes_[i]; ++k) l.push_back(strings_[list_ints_[k]]);
+        return DataValue(l);
+      }
+      case DataValue::INT_LIST:
+      {
+        IntList l;
+        l.reserve(sizes_[i]);
+        for (UInt64 k = start; k < start + sizes_[i]; ++k) l.push_back(static_cast<Int>(list_ints_[k]));
+        return DataValue(l);
+      }
+      case DataValue::DOUBLE_LIST:
+        return DataValue(DoubleList(list_doubles_.begin() + start, list_doubles_.begin() + start + sizes_[i]));
+      default:
+        return DataValue();
+    }
+  }
+
+  std::vector<std::pair<UInt64, DataValue> > ColumnarMetaInfoReader::getColumn(const String& key) const
+  {
+    std::vector<std::pair<UInt64, DataValue> > result;
+    auto key_it = std::find(keys_.begin(), keys_.end(), key);
+    if (key_it == keys_.end()) return result;
+    const UInt32 k = static_cast<UInt32>(key_it - keys_.begin());
+
+    // values are sorted by key
+    const UInt32* first = std::lower_bound(key_idx_.begin(), key_idx_.end(), k);
+    const UInt32* last = std::upper_bound(first, key_idx_.end(), k);
+    for (const UInt32* it = first; it != last; ++it)
+    {
+      Size i = it - key_idx_.begin();
+      result.emplace_back(rows_[i], value(i));
+    }
+    return result;
+  }
+
+  std::vector<Size> ColumnarMetaInfoReader::findRows(UInt64 first, UInt64 last) const
+  {
+    if (by_row_.size() != rows_.size())
+    {
+      by_row_.resize(rows_.size());
+      for (Size i = 0; i < by_row_.size(); ++i) by_row_[i] = i;
+      std::stable_sort(by_row_.begin(), by_row_.end(),
+        [this](Size a, Size b) { return rows_[a] < rows_[b]; });
+    }
+    auto lo = std::lower_bound(by_row_.begin(), by_row_.end(), first,
+      [this](Size i, UInt64 row) { return rows_[i] < row; });
+    auto hi = std::lower_bound(lo, by_row_.end(), last,
+      [this](Size i, UInt64 row) { return rows_[i] < row; });
+    return std::vector<Size>(lo, hi);
+  }
+
+} // namespace Internal
+} // namespace OpenMS
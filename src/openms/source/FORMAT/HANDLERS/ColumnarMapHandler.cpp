@@ -0,0 +1,177 @@
+// --------------------------------------------------------------------------
+//                   OpenMS -- Open-Source Mass Spectrometry
+// --------------------------------------------------------------------------
+// Copyright The OpenMS Team -- Eberhard Karls University Tuebingen,
+// ETH Zurich, and Freie Universitaet Berlin 2002-2020.
+//
+// This software is released under a three-clause BSD license:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of any author or any participating institution
+//    may be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+// For a full list of authors, refer to the file AUTHORS.
+// --------------------------------------------------------------------------
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL ANY OF THE AUTHORS OR THE CONTRIBUTING
+// INSTITUTIONS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// --------------------------------------------------------------------------
+// $Maintainer: agent $
+// $Authors: agent $
+// --------------------------------------------------------------------------
+
+
+#include <OpenMS/FORMAT/HANDLERS/ColumnarMapHandler.h>
+
+using namespace std;
+
+namespace OpenMS
+{
+  namespace Internal
+  {
+    ColumnarMapHandler::BaseFeatureColumns::BaseFeatureColumns(const ColumnarBinaryReader& reader, const String& prefix) :
+      rt(reader.getColumn<double>(prefix + ".rt")),
+      mz(reader.getColumn<double>(prefix + ".mz")),
+      intensity(reader.getColumn<float>(prefix + ".intensity")),
+      quality(reader.getColumn<float>(prefix + ".quality")),
+      charge(reader.getColumn<Int32>(prefix + ".charge")),
+      width(reader.getColumn<float>(prefix + ".width")),
+      unique_id(reader.getColumn<UInt64>(prefix + ".unique_id"))
+    {
+    }
+
+    Size ColumnarMapHandler::BaseFeatureColumns::size() const
+    {
+      return rt.size();
+    }
+
+    void ColumnarMapHandler::BaseFeatureColumns::fill(Size index, BaseFeature& feature) const
+    {
+      feature.setRT(rt[index]);
+      feature.setMZ(mz[index]);
+      feature.setIntensity(intensity[index]);
+      feature.setQuality(quality[index]);
+      feature.setCharge(charge[index]);
+      feature.setWidth(width[index]);
+      feature.setUniqueId(unique_id[index]);
+    }
+
+    bool ColumnarMapHandler::BaseFeatureColumns::passesFilter(Size index, const FeatureFileOptions& options) const
+    {
+      return (!options.hasRTRange() || options.getRTRange().encloses(rt[index]))
+             && (!options.hasMZRange() || options.getMZRange().encloses(mz[index]))
+             && (!options.hasIntensityRange() || options.getIntensityRange().encloses(intensity[index]));
+    }
+
+    void ColumnarMapHandler::writeMapInfo(ColumnarBinaryWriter& writer, const UniqueIdInterface& unique_id, const DocumentIdentifier& document, const MetaInfoInterface& meta, const vector<DataProcessing>& data_processing)
+    {
+      writer.addColumn("map.unique_id", vector<UInt64>(1, unique_id.getUniqueId()));
+      writer.addStringColumn("map.identifier", vector<String>(1, document.getIdentifier()));
+      ColumnarMetaInfoWriter map_meta;
+      map_meta.add(0, meta);
+      map_meta.write(writer, "map");
+
+      vector<String> software, version, completion_time;
+      vector<UInt64> action_offsets(1, 0);
+      vector<std::uint8_t> actions;
+      ColumnarMetaInfoWriter dp_meta;
+      for (Size i = 0; i < data_processing.size(); ++i)
+      {
+        const DataProcessing& dp = data_processing[i];
+        software.push_back(dp.getSoftware().getName());
+        version.push_back(dp.getSoftware().getVersion());
+        completion_time.push_back(dp.getCompletionTime().isValid() ? dp.getCompletionTime().get() : String());
+        for (DataProcessing::ProcessingAction action : dp.getProcessingActions())
+        {
+          actions.push_back(static_cast<std::uint8_t>(action));
+        }
+        action_offsets.push_back(actions.size());
+        dp_meta.add(i, dp);
+      }
+      writer.addStringColumn("data_processing.software", software);
+      writer.addStringColumn("data_processing.version", version);
+      writer.addStringColumn("data_processing.completion_time", completion_time);
+      writer.addColumn("data_processing.action_offset", action_offsets);
+      writer.addColumn("data_processing.action", actions);
+      dp_meta.write(writer, "data_processing");
+    }
+
+    void ColumnarMapHandler::readMapInfo(const ColumnarBinaryReader& reader, UniqueIdInterface& unique_id, DocumentIdentifier& document, MetaInfoInterface& meta, vector<DataProcessing>& data_processing)
+    {
+      unique_id.setUniqueId(reader.getColumn<UInt64>("map.unique_id")[0]);
+      document.setIdentifier(reader.getStringColumn("map.identifier")[0]);
+      ColumnarMetaInfoReader::read(reader, "map", [&meta](UInt64) -> MetaInfoInterface*
+      {
+        return &meta;
+      });
+
+      ColumnarBinaryReader::StringColumnView software = reader.getStringColumn("data_processing.software");
+      ColumnarBinaryReader::StringColumnView version = reader.getStringColumn("data_processing.version");
+      ColumnarBinaryReader::StringColumnView completion_time = reader.getStringColumn("data_processing.completion_time");
+      ColumnarBinaryReader::ColumnView<UInt64> action_offsets = reader.getColumn<UInt64>("data_processing.action_offset");
+      ColumnarBinaryReader::ColumnView<std::uint8_t> actions = reader.getColumn<std::uint8_t>("data_processing.action");
+
+      data_processing.assign(software.size(), DataProcessing());
+      for (Size i = 0; i < software.size(); ++i)
+      {
+        DataProcessing& dp = data_processing[i];
+        dp.getSoftware().setName(software[i]);
+        dp.getSoftware().setVersion(version[i]);
+        String time = completion_time[i];
+        if (!time.empty())
+        {
+          DateTime date_time;
+          date_time.set(time);
+          dp.setCompletionTime(date_time);
+        }
+        for (UInt64 a = action_offsets[i]; a < action_offsets[i + 1]; ++a)
+        {
+          dp.getProcessingActions().insert(static_cast<DataProcessing::ProcessingAction>(actions[a]));
+        }
+      }
+      ColumnarMetaInfoReader::read(reader, "data_processing", [&data_processing](UInt64 row) -> MetaInfoInterface*
+      {
+        return &data_processing[row];
+      });
+    }
+
+    void ColumnarMapHandler::writeBaseFeatures(ColumnarBinaryWriter& writer, const String& prefix, const vector<const BaseFeature*>& features)
+    {
+      const Size n = features.size();
+      vector<double> rt(n), mz(n);
+      vector<float> intensity(n), quality(n), width(n);
+      vector<Int32> charge(n);
+      vector<UInt64> unique_id(n);
+      for (Size i = 0; i < n; ++i)
+      {
+        const BaseFeature& f = *features[i];
+        rt[i] = f.getRT();
+        mz[i] = f.getMZ();
+        intensity[i] = f.getIntensity();
+        quality[i] = f.getQuality();
+        charge[i] = f.getCharge();
+        width[i] = f.getWidth();
+        unique_id[i] = f.getUniqueId();
+      }
+      writer.addColumn(prefix + ".rt", rt);
+      writer.addColumn(prefix + ".mz", mz);
+      writer.addColumn(prefix + ".intensity", intensity);
+      writer.addColumn(prefix + ".quality", quality);
+      writer.addColumn(prefix + ".charge", charge);
+      writer.addColumn(prefix + ".width", width);
+      writer.addColumn(prefix + ".unique_id", unique_id);
+    }
+  }
+}
@@ -54,7 +54,10 @@
 #include <omp.h>
 #endif
 
+#include <algorithm>
 #include <cmath>
+#include <cstring>
+#include <exception>
 
 namespace OpenMS
 {
@@ -83,6 +86,51 @@ namespace OpenMS
       return tmp;
     }
 
+    /// A binary data array of a spectrum / chromatogram as read from the DATA table
+    struct DataRow_
+    {
+      Size container; ///< index of the spectrum / chromatogram
+      int compression; ///< compression as stored in the DATA table
+      Size kind; ///< 0 = m/z (spectra) or retention time (chromatograms), 1 = intensity
+      std::string blob; ///< compressed data
+      std::vector<double> data; ///< decoded data
+    };
+
+    /*
+     * @brief Decodes a compressed data array from an sqMass file
+     *
+     * @param compression The compression (1 = zlib, 5 = np-linear + zlib, 6 = np-slof + zlib, 8 = byte-shuffle + zlib)
+     * @param blob The compressed data
+     * @param buffer Buffer for the uncompressed data (reused between calls)
+     * @param data The decoded data
+     *
+     */
+    void decodeDataRow_(int compression, const std::string& blob, std::string& buffer, std::vector<double>& data)
+    {
+      if (compression == 8)
+      {
+        OpenMS::ZlibCompression::uncompressShuffled(blob.data(), blob.size(), buffer, data);
+        return;
+      }
+
+      OpenMS::ZlibCompression::uncompressString(blob.data(), blob.size(), buffer);
+      if (compression == 1)
+      {
+        if (buffer.size() % sizeof(double) != 0)
+        {
+          throw Exception::ConversionError(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, "Bad BufferCount?");
+        }
+        data.resize(buffer.size() / sizeof(double));
+        if (!data.empty()) memcpy(&data[0], buffer.data(), buffer.size());
+      }
+      else
+      {
+        MSNumpressCoder::NumpressConfig config;
+        config.setCompression(compression == 5 ? "linear" : "slof");
+        MSNumpressCoder().decodeNPRaw(buffer, data, config);
+      }
+    }
+
     /*
      *
      * This function populates a set of empty data containers (MSSpectrum or
@@ -99,145 +147,202 @@ namespace OpenMS
      * It is designed to work with containers of type MSSpectrum and
      * MSChromatogram to provide a single function for both use-cases.
      *
+     * The rows are fetched on the calling thread (SQLite statements cannot be
+     * shared between threads) and collected in chunks of compressed data. Each
+     * chunk is then decompressed and decoded in parallel and the completed
+     * containers are filled in parallel, before the next chunk is fetched.
+     * Thus, memory usage is bounded by the chunk size plus the decoded data.
+     *
      */
     template<class ContainerT>
     void populateContainer_sub_(sqlite3_stmt *stmt, std::vector<ContainerT>& containers)
     {
+      // limits of a chunk of compressed data fetched before decoding
+      const Size max_chunk_bytes = 64 * 1024 * 1024;
+      const Size max_chunk_rows = 4096;
+
       // perform first step
       sqlite3_step(stmt);
 
-      std::vector<int> cont_data; cont_data.resize(containers.size());
+      // decoded data arrays (m/z or rt and intensity) per container, kept
+      // until both arrays of a container are available
+      std::vector<std::vector<double> > arrays(2 * containers.size());
+      std::vector<int> cont_data(2 * containers.size(), 0);
       std::map<Size,Size> sql_container_map;
-      while (sqlite3_column_type( stmt, 0 ) != SQLITE_NULL)
+      std::vector<DataRow_> chunk;
+      Size chunk_bytes = 0;
+      bool done = false;
+      while (!done)
       {
-        Size id_orig = sqlite3_column_int( stmt, 0 );
-
-        // map the sql table id to the index in the "containers" vector
-        if (sql_container_map.find(id_orig) == sql_container_map.end())
+        // 1. fetch a chunk of rows (single-threaded)
+        chunk.clear();
+        chunk_bytes = 0;
+        while (chunk.size() < max_chunk_rows && chunk_bytes < max_chunk_bytes)
         {
-          Size tmp = sql_container_map.size();
-          sql_container_map[id_orig] = tmp;
-        }
-        Size curr_id = sql_container_map[id_orig];
+          if (sqlite3_column_type( stmt, 0 ) == SQLITE_NULL)
+          {
+            done = true;
+            break;
+          }
 
-        const unsigned char * native_id_ = sqlite3_column_text(stmt, 1);
-        std::string native_id(reinterpret_cast<const char*>(native_id_), sqlite3_column_bytes(stmt, 1));
+          Size id_orig = sqlite3_column_int( stmt, 0 );
 
-        if (curr_id >= containers.size())
-        {
-          throw Exception::IllegalArgument(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION,
-              "Data for non-existent spectrum / chromatogram found");
-        }
-        if (native_id != containers[curr_id].getNativeID())
-        {
-          throw Exception::IllegalArgument(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, 
-              String("Native id for spectrum / chromatogram doesnt match: ") + native_id + " != " +  containers[curr_id].getNativeID() );
-        }
+          // map the sql table id to the index in the "containers" vector
+          if (sql_container_map.find(id_orig) == sql_container_map.end())
+          {
+            Size tmp = sql_container_map.size();
+            sql_container_map[id_orig] = tmp;
+          }
+          Size curr_id = sql_container_map[id_orig];
 
-        int compression = sqlite3_column_int( stmt, 2 );
-        int data_type = sqlite3_column_int( stmt, 3 );
+          const unsigned char * native_id_ = sqlite3_column_text(stmt, 1);
+          std::string native_id(reinterpret_cast<const char*>(native_id_), sqlite3_column_bytes(stmt, 1));
 
-        const void * raw_text = sqlite3_column_blob(stmt, 4);
-        size_t blob_bytes = sqlite3_column_bytes(stmt, 4);
+          if (curr_id >= containers.size())
+          {
+            throw Exception::IllegalArgument(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION,
+                "Data for non-existent spectrum / chromatogram found");
+          }
+          if (native_id != containers[curr_id].getNativeID())
+          {
+            throw Exception::IllegalArgument(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, 
+                String("Native id for spectrum / chromatogram doesnt match: ") + native_id + " != " +  containers[curr_id].getNativeID() );
+          }
 
-        // data_type is one of 0 = mz, 1 = int, 2 = rt
-        // compression is one of 0 = no, 1 = zlib, 2 = np-linear, 3 = np-slof, 4 = np-pic, 5 = np-linear + zlib, 6 = np-slof + zlib, 7 = np-pic + zlib
-        std::vector<double> data;
-        if (compression == 1)
-        {
-          std::string uncompressed;
-          OpenMS::ZlibCompression::uncompressString(raw_text, blob_bytes, uncompressed);
+          int compression = sqlite3_column_int( stmt, 2 );
+          int data_type = sqlite3_column_int( stmt, 3 );
 
-          void* byte_buffer = reinterpret_cast<void *>(&uncompressed[0]);
-          Size buffer_size = uncompressed.size();
-          const double* float_buffer = reinterpret_cast<const double *>(byte_buffer);
-          if (buffer_size % sizeof(double) != 0)
+          // data_type is one of 0 = mz, 1 = int, 2 = rt
+          // compression is one of 0 = no, 1 = zlib, 2 = np-linear, 3 = np-slof, 4 = np-pic, 5 = np-linear + zlib, 6 = np-slof + zlib, 7 = np-pic + zlib, 8 = byte-shuffle + zlib
+          if (compression != 1 && compression != 5 && compression != 6 && compression != 8)
           {
-            throw Exception::ConversionError(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, "Bad BufferCount?");
+            throw Exception::IllegalArgument(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, 
+                "Compression not supported");
           }
-          Size float_count = buffer_size / sizeof(double);
-          // copy values
-          data.assign(float_buffer, float_buffer + float_count);
-        }
-        else if (compression == 5)
-        {
-          std::string uncompressed;
-          OpenMS::ZlibCompression::uncompressString(raw_text, blob_bytes, uncompressed);
-          MSNumpressCoder::NumpressConfig config;
-          config.setCompression("linear");
-          MSNumpressCoder().decodeNPRaw(uncompressed, data, config);
-        }
-        else if (compression == 6)
-        {
-          std::string uncompressed;
-          OpenMS::ZlibCompression::uncompressString(raw_text, blob_bytes, uncompressed);
-          MSNumpressCoder::NumpressConfig config;
-          config.setCompression("slof");
-          MSNumpressCoder().decodeNPRaw(uncompressed, data, config);
-        }
-        else
-        {
-          throw Exception::IllegalArgument(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, 
-              "Compression not supported");
-        }
 
-        if (data_type == 1)
-        {
-          // intensity
-          if (containers[curr_id].empty()) containers[curr_id].resize(data.size());
-          std::vector< double >::iterator data_it = data.begin();
-          for (auto it = containers[curr_id].begin(); it != containers[curr_id].end(); ++it, ++data_it)
+          Size kind(0);
+          if (data_type == 1)
           {
-            it->setIntensity(*data_it);
+            // intensity
+            kind = 1;
           }
-          cont_data[curr_id] += 1;
-        }
-        else if (data_type == 0)
-        {
-          // mz (should only occur in spectra)
-          if (boost::is_same<ContainerT, MSChromatogram>::value) 
+          else if (data_type == 0)
           {
-            throw Exception::IllegalArgument(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, 
-                "Found m/z data type for chromatogram (instead of retention time)");
+            // mz (should only occur in spectra)
+            if (boost::is_same<ContainerT, MSChromatogram>::value) 
+            {
+              throw Exception::IllegalArgument(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, 
+                  "Found m/z data type for chromatogram (instead of retention time)");
+            }
           }
-
-          if (containers[curr_id].empty()) containers[curr_id].resize(data.size());
-          std::vector< double >::iterator data_it = data.begin();
-          for (auto it = containers[curr_id].begin(); it != containers[curr_id].end(); ++it, ++data_it)
+          else if (data_type == 2)
           {
-            it->setMZ(*data_it);
+            // rt (should only occur in chromatograms)
+            if (boost::is_same<ContainerT, MSSpectrum >::value) 
+            {
+              throw Exception::IllegalArgument(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, 
+                  "Found retention time data type for spectrum (instead of m/z)");
+            }
           }
-          cont_data[curr_id] += 1;
-        }
-        else if (data_type == 2)
-        {
-          // rt (should only occur in chromatograms)
-          if (boost::is_same<ContainerT, MSSpectrum >::value) 
+          else
           {
             throw Exception::IllegalArgument(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, 
-                "Found retention time data type for spectrum (instead of m/z)");
+                "Found data type other than RT/Intensity for spectra");
           }
-          if (containers[curr_id].empty()) containers[curr_id].resize(data.size());
-          std::vector< double >::iterator data_it = data.begin();
-          for (auto it = containers[curr_id].begin(); it != containers[curr_id].end(); ++it, ++data_it)
+
+          // copy the blob, it is only valid until the next step
+          const char * raw_text = reinterpret_cast<const char*>(sqlite3_column_blob(stmt, 4));
+          size_t blob_bytes = sqlite3_column_bytes(stmt, 4);
+
+          chunk.push_back(DataRow_());
+          DataRow_& row = chunk.back();
+          row.container = curr_id;
+          row.compression = compression;
+          row.kind = kind;
+          row.blob.assign(raw_text, blob_bytes);
+          chunk_bytes += blob_bytes;
+
+          sqlite3_step( stmt );
+        }
+
+        // 2. decompress and decode the chunk (multi-threaded)
+        std::exception_ptr decode_error;
+#ifdef _OPENMP
+#pragma omp parallel
+#endif
+        {
+          std::string buffer; // reused by all rows of a thread
+#ifdef _OPENMP
+#pragma omp for schedule(dynamic, 16)
+#endif
+          for (SignedSize k = 0; k < (SignedSize)chunk.size(); k++)
           {
-            it->setMZ(*data_it);
+            try
+            {
+              decodeDataRow_(chunk[k].compression, chunk[k].blob, buffer, chunk[k].data);
+              std::string().swap(chunk[k].blob);
+            }
+            catch (...)
+            {
+#ifdef _OPENMP
+#pragma omp critical (MzMLSqliteHandler_decode_error)
+#endif
+              if (!decode_error) decode_error = std::current_exception();
+            }
           }
-          cont_data[curr_id] += 1;
         }
-        else
+        if (decode_error) std::rethrow_exception(decode_error);
+
+        // 3. collect the containers for which both arrays are available
+        //    (in order of the rows, the last array of a kind wins)
+        std::vector<Size> completed;
+        for (DataRow_& row : chunk)
         {
-          throw Exception::IllegalArgument(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, 
-              "Found data type other than RT/Intensity for spectra");
+          Size slot = 2 * row.container + row.kind;
+          arrays[slot].swap(row.data);
+          cont_data[slot] += 1;
         }
+        for (const DataRow_& row : chunk)
+        {
+          Size c = row.container;
+          if (cont_data[2 * c] > 0 && cont_data[2 * c + 1] > 0 && containers[c].empty() &&
+              (completed.empty() || completed.back() != c))
+          {
+            if (arrays[2 * c].size() != arrays[2 * c + 1].size())
+            {
+              throw Exception::IllegalArgument(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION,
+                  String("Spectrum/Chromatogram ") + c + " has data arrays of different length.");
+            }
+            completed.push_back(c);
+          }
+        }
+        std::sort(completed.begin(), completed.end());
+        completed.erase(std::unique(completed.begin(), completed.end()), completed.end());
 
-        sqlite3_step( stmt );
+        // 4. fill the completed containers (multi-threaded)
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic, 16)
+#endif
+        for (SignedSize k = 0; k < (SignedSize)completed.size(); k++)
+        {
+          Size c = completed[k];
+          std::vector<double>& pos = arrays[2 * c];
+          std::vector<double>& intens = arrays[2 * c + 1];
+          containers[c].resize(pos.size());
+          for (Size i = 0; i < pos.size(); ++i)
+          {
+            containers[c][i].setMZ(pos[i]);
+            containers[c][i].setIntensity(intens[i]);
+          }
+          std::vector<double>().swap(pos);
+          std::vector<double>().swap(intens);
+        }
       }
 
       // ensure that all spectra/chromatograms have their data: we expect two data arrays per container (int and mz/rt)
-      for (Size k = 0; k < cont_data.size(); k++)
+      for (Size k = 0; k < containers.size(); k++)
       {
-        if (cont_data[k] < 2)
+        if (cont_data[2 * k] == 0 || cont_data[2 * k + 1] == 0)
         {
           throw Exception::IllegalArgument(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION,
               String("Spectrum/Chromatogram ") + k + " does not have 2 data arrays.");
@@ -255,7 +360,8 @@ namespace OpenMS
       run_id_(0),
       use_lossy_compression_(true),
       linear_abs_mass_acc_(0.0001), // set the desired mass accuracy = 1ppm at 100 m/z
-      write_full_meta_(true)
+      write_full_meta_(true),
+      use_byte_shuffle_(false)
     {
     }
 
@@ -391,6 +497,38 @@ namespace OpenMS
       populateChromatogramsWithData_(conn.getDB(), exp, indices);
     }
 
+    void MzMLSqliteHandler::readSpectrumRange(std::vector<MSSpectrum> & exp, Size first, Size last, bool meta_only) const
+    {
+      exp.clear();
+      if (first >= last)
+      {
+        return;
+      }
+      std::vector<int> indices;
+      indices.reserve(last - first);
+      for (Size k = first; k < last; ++k)
+      {
+        indices.push_back((int)k);
+      }
+      readSpectra(exp, indices, meta_only);
+    }
+
+    void MzMLSqliteHandler::readChromatogramRange(std::vector<MSChromatogram> & exp, Size first, Size last, bool meta_only) const
+    {
+      exp.clear();
+      if (first >= last)
+      {
+        return;
+      }
+      std::vector<int> indices;
+      indices.reserve(last - first);
+      for (Size k = first; k < last; ++k)
+      {
+        indices.push_back((int)k);
+      }
+      readChromatograms(exp, indices, meta_only);
+    }
+
     Size MzMLSqliteHandler::getNrSpectra() const
     {
       SqliteConnector conn(filename_);
@@ -791,7 +929,7 @@ namespace OpenMS
       char const *create_sql =
 
         // data table
-        //  - compression is one of 0 = no, 1 = zlib, 2 = np-linear, 3 = np-slof, 4 = np-pic, 5 = np-linear + zlib, 6 = np-slof + zlib, 7 = np-pic + zlib
+        //  - compression is one of 0 = no, 1 = zlib, 2 = np-linear, 3 = np-slof, 4 = np-pic, 5 = np-linear + zlib, 6 = np-slof + zlib, 7 = np-pic + zlib, 8 = byte-shuffle + zlib
         //  - data_type is one of 0 = mz, 1 = int, 2 = rt
         //  - data contains the raw (blob) data for a single data array
         "CREATE TABLE DATA(" \
@@ -916,6 +1054,10 @@ namespace OpenMS
       npconfig_int.numpressErrorTolerance = -1.0; // skip check, faster
       npconfig_int.setCompression("slof");
 
+      // lossless compression: 1 = zlib, 8 = byte-shuffle + zlib
+
+      const int lossless_compression = use_byte_shuffle_ ? 8 : 1;
+
       String prepare_statement = "INSERT INTO DATA (SPECTRUM_ID, DATA_TYPE, COMPRESSION, DATA) VALUES ";
       std::vector<String> data;
       int sql_it = 1;
@@ -946,6 +1088,11 @@ namespace OpenMS
             OpenMS::ZlibCompression::compressString(uncompressed_str, encoded_string);
             encoded_strings_mz[k] = encoded_string;
           }
+          else if (use_byte_shuffle_)
+          {
+            OpenMS::ZlibCompression::compressShuffled(data_to_encode, encoded_string);
+            encoded_strings_mz[k] = encoded_string;
+          }
           else
           {
             std::string str_data = std::string((const char*) (&data_to_encode[0]), data_to_encode.size() * sizeof(double));
@@ -971,6 +1118,11 @@ namespace OpenMS
             OpenMS::ZlibCompression::compressString(uncompressed_str, encoded_string);
             encoded_strings_int[k] = encoded_string;
           }
+          else if (use_byte_shuffle_)
+          {
+            OpenMS::ZlibCompression::compressShuffled(data_to_encode, encoded_string);
+            encoded_strings_int[k] = encoded_string;
+          }
           else
           {
             std::string str_data = std::string((const char*) (&data_to_encode[0]), data_to_encode.size() * sizeof(double));
@@ -1053,7 +1205,7 @@ namespace OpenMS
         }
 
         //  data_type is one of 0 = mz, 1 = int, 2 = rt
-        //  compression is one of 0 = no, 1 = zlib, 2 = np-linear, 3 = np-slof, 4 = np-pic, 5 = np-linear + zlib, 6 = np-slof + zlib, 7 = np-pic + zlib
+        //  compression is one of 0 = no, 1 = zlib, 2 = np-linear, 3 = np-slof, 4 = np-pic, 5 = np-linear + zlib, 6 = np-slof + zlib, 7 = np-pic + zlib, 8 = byte-shuffle + zlib
 
         // encode mz data (zlib or np-linear + zlib)
         {
@@ -1064,7 +1216,7 @@ namespace OpenMS
           }
           else
           {
-            prepare_statement += String("(") + spec_id_ + ", 0, 1, ?" + sql_it++ + " ),";
+            prepare_statement += String("(") + spec_id_ + ", 0, " + lossless_compression + ", ?" + sql_it++ + " ),";
           }
         }
 
@@ -1077,7 +1229,7 @@ namespace OpenMS
           }
           else
           {
-            prepare_statement += String("(") + spec_id_ + ", 1, 1, ?" + sql_it++ + " ),";
+            prepare_statement += String("(") + spec_id_ + ", 1, " + lossless_compression + ", ?" + sql_it++ + " ),";
           }
         }
         spec_id_++;
@@ -1139,6 +1291,10 @@ namespace OpenMS
       npconfig_int.numpressErrorTolerance = -1.0; // skip check, faster
       npconfig_int.setCompression("slof");
 
+      // lossless compression: 1 = zlib, 8 = byte-shuffle + zlib
+
+      const int lossless_compression = use_byte_shuffle_ ? 8 : 1;
+
       String prepare_statement = "INSERT INTO DATA (CHROMATOGRAM_ID, DATA_TYPE, COMPRESSION, DATA) VALUES ";
       int sql_it = 1;
 
@@ -1168,6 +1324,11 @@ namespace OpenMS
             OpenMS::ZlibCompression::compressString(uncompressed_str, encoded_string);
             encoded_strings_rt[k] = encoded_string;
           }
+          else if (use_byte_shuffle_)
+          {
+            OpenMS::ZlibCompression::compressShuffled(data_to_encode, encoded_string);
+            encoded_strings_rt[k] = encoded_string;
+          }
           else
           {
             std::string str_data = std::string((const char*) (&data_to_encode[0]), data_to_encode.size() * sizeof(double));
@@ -1193,6 +1354,11 @@ namespace OpenMS
             OpenMS::ZlibCompression::compressString(uncompressed_str, encoded_string);
             encoded_strings_int[k] = encoded_string;
           }
+          else if (use_byte_shuffle_)
+          {
+            OpenMS::ZlibCompression::compressShuffled(data_to_encode, encoded_string);
+            encoded_strings_int[k] = encoded_string;
+          }
           else
           {
             std::string str_data = std::string((const char*) (&data_to_encode[0]), data_to_encode.size() * sizeof(double));
@@ -1246,7 +1412,7 @@ namespace OpenMS
           "," << prod.getIsolationWindowLowerOffset() << "," << prod.getIsolationWindowUpperOffset() << "); ";
 
         //  data_type is one of 0 = mz, 1 = int, 2 = rt
-        //  compression is one of 0 = no, 1 = zlib, 2 = np-linear, 3 = np-slof, 4 = np-pic, 5 = np-linear + zlib, 6 = np-slof + zlib, 7 = np-pic + zlib
+        //  compression is one of 0 = no, 1 = zlib, 2 = np-linear, 3 = np-slof, 4 = np-pic, 5 = np-linear + zlib, 6 = np-slof + zlib, 7 = np-pic + zlib, 8 = byte-shuffle + zlib
 
         // encode retention time data (zlib or np-linear + zlib)
         {
@@ -1257,7 +1423,7 @@ namespace OpenMS
           }
           else
           {
-            prepare_statement += String("(") + chrom_id_ + ", 2, 1, ?" + sql_it++ + " ),";
+            prepare_statement += String("(") + chrom_id_ + ", 2, " + lossless_compression + ", ?" + sql_it++ + " ),";
           }
         }
 
@@ -1270,7 +1436,7 @@ namespace OpenMS
           }
           else
           {
-            prepare_statement += String("(") + chrom_id_ + ", 1, 1, ?" + sql_it++ + " ),";
+            prepare_statement += String("(") + chrom_id_ + ", 1, " + lossless_compression + ", ?" + sql_it++ + " ),";
           }
         }
         chrom_id_++;
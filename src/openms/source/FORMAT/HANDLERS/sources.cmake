@@ -5,6 +5,8 @@ set(directory source/FORMAT/HANDLERS)
 set(sources_list
   AcqusHandler.cpp
   CachedMzMLHandler.cpp
+  ColumnarBinaryHandler.cpp
+  ColumnarMapHandler.cpp
   FidHandler.cpp
   IndexedMzMLDecoder.cpp
   IndexedMzMLHandler.cpp
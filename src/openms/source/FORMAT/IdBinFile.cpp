@@ -0,0 +1,750 @@
+// --------------------------------------------------------------------------
+//                   OpenMS -- Open-Source Mass Spectrometry
+// --------------------------------------------------------------------------
+// Copyright The OpenMS Team -- Eberhard Karls University Tuebingen,
+// ETH Zurich, and Freie Universitaet Berlin 2002-2020.
+//
+// This software is released under a three-clause BSD license:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of any author or any participating institution
+//    may be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+// For a full list of authors, refer to the file AUTHORS.
+// --------------------------------------------------------------------------
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL ANY OF THE AUTHORS OR THE CONTRIBUTING
+// INSTITUTIONS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// --------------------------------------------------------------------------
+// $Maintainer: agent $
+// $Authors: agent $
+// --------------------------------------------------------------------------
+
+#include <OpenMS/FORMAT/IdBinFile.h>
+
+#include <OpenMS/CHEMISTRY/ProteaseDB.h>
+
+#include <unordered_map>
+
+using namespace std;
+
+namespace OpenMS
+{
+  using Internal::ColumnarBinaryReader;
+  using Internal::ColumnarBinaryWriter;
+  using Internal::ColumnarMetaInfoReader;
+  using Internal::ColumnarMetaInfoWriter;
+  using Internal::ColumnarStringPool;
+
+  const char* const IdBinFile::CONTENT_TAG = "idBin";
+
+  namespace
+  {
+    /// Writes a list of string lists as offset column + pooled index column
+    void addStringLists(ColumnarBinaryWriter& writer, const String& name, const vector<vector<String> >& lists, ColumnarStringPool& pool)
+    {
+      vector<UInt64> offsets(1, 0);
+      vector<UInt32> values;
+      for (const vector<String>& l : lists)
+      {
+        for (const String& s : l) values.push_back(pool.index(s));
+        offsets.push_back(values.size());
+      }
+      writer.addColumn(name + "_offset", offsets);
+      writer.addColumn(name, values);
+    }
+
+    /// Counterpart of addStringLists
+    vector<String> getStringList(const ColumnarBinaryReader& reader, const String& name, Size index, const vector<String>& pool)
+    {
+      ColumnarBinaryReader::ColumnView<UInt64> offsets = reader.getColumn<UInt64>(name + "_offset");
+      ColumnarBinaryReader::ColumnView<UInt32> values = reader.getColumn<UInt32>(name);
+      vector<String> result;
+      for (UInt64 k = offsets[index]; k < offsets[index + 1]; ++k)
+      {
+        result.push_back(pool[values[k]]);
+      }
+      return result;
+    }
+
+    /// Writes protein groups (indistinguishable proteins or groups) of all runs
+    void addProteinGroups(ColumnarBinaryWriter& writer, const String& prefix, const vector<const vector<ProteinIdentification::ProteinGroup>*>& groups_per_run, ColumnarStringPool& pool)
+    {
+      vector<UInt64> run_offsets(1, 0);
+      vector<double> probabilities;
+      vector<vector<String> > accessions;
+      for (const vector<ProteinIdentification::ProteinGroup>* groups : groups_per_run)
+      {
+        for (const ProteinIdentification::ProteinGroup& group : *groups)
+        {
+          probabilities.push_back(group.probability);
+          accessions.push_back(group.accessions);
+        }
+        run_offsets.push_back(probabilities.size());
+      }
+      writer.addColumn("run." + prefix + "_offset", run_offsets);
+      writer.addColumn(prefix + ".probability", probabilities);
+      addStringLists(writer, prefix + ".accession", accessions, pool);
+    }
+
+    /// Counterpart of addProteinGroups
+    vector<ProteinIdentification::ProteinGroup> getProteinGroups(const ColumnarBinaryReader& reader, const String& prefix, Size run, const vector<String>& pool)
+    {
+      vector<ProteinIdentification::ProteinGroup> groups;
+      ColumnarBinaryReader::ColumnView<UInt64> run_offsets = reader.getColumn<UInt64>("run." + prefix + "_offset");
+      ColumnarBinaryReader::ColumnView<double> probabilities = reader.getColumn<double>(prefix + ".probability");
+      for (UInt64 g = run_offsets[run]; g < run_offsets[run + 1]; ++g)
+      {
+        ProteinIdentification::ProteinGroup group;
+        group.probability = probabilities[g];
+        group.accessions = getStringList(reader, prefix + ".accession", g, pool);
+        groups.push_back(group);
+      }
+      return groups;
+    }
+  }
+
+  IdBinFile::IdBinFile() :
+    ProgressLogger()
+  {
+  }
+
+  IdBinFile::~IdBinFile()
+  {
+  }
+
+  void IdBinFile::store(const String& filename, const vector<ProteinIdentification>& protein_ids, const vector<PeptideIdentification>& peptide_ids)
+  {
+    ColumnarBinaryWriter writer(filename, CONTENT_TAG);
+    store(writer, protein_ids, peptide_ids);
+    writer.close();
+  }
+
+  void IdBinFile::store(ColumnarBinaryWriter& writer, const vector<ProteinIdentification>& protein_ids, const vector<PeptideIdentification>& peptide_ids)
+  {
+    ColumnarStringPool pool;
+
+    startProgress(0, protein_ids.size() + peptide_ids.size(), "storing idBin file");
+
+    // protein identification runs
+    {
+      const Size n_runs = protein_ids.size();
+      vector<String> identifier, engine, engine_version, date, score_type, db, db_version, taxonomy, charges, enzyme;
+      vector<std::uint8_t> higher_better, mass_type, fragment_ppm, precursor_ppm;
+      vector<double> threshold, fragment_tol, precursor_tol;
+      vector<UInt32> missed_cleavages;
+      vector<vector<String> > fixed_mods, variable_mods;
+      vector<const vector<ProteinIdentification::ProteinGroup>*> groups, indistinguishable;
+      ColumnarMetaInfoWriter run_meta, sp_meta, prot_meta;
+
+      vector<UInt64> hit_offsets(1, 0);
+      vector<UInt32> accession;
+      vector<String> sequence;
+      vector<double> score, coverage;
+      vector<UInt32> rank;
+
+      for (Size i = 0; i < n_runs; ++i)
+      {
+        const ProteinIdentification& run = protein_ids[i];
+        const ProteinIdentification::SearchParameters& sp = run.getSearchParameters();
+        identifier.push_back(run.getIdentifier());
+        engine.push_back(run.getSearchEngine());
+        engine_version.push_back(run.getSearchEngineVersion());
+        date.push_back(run.getDateTime().isValid() ? run.getDateTime().get() : String());
+        score_type.push_back(run.getScoreType());
+        higher_better.push_back(run.isHigherScoreBetter());
+        threshold.push_back(run.getSignificanceThreshold());
+        db.push_back(sp.db);
+        db_version.push_back(sp.db_version);
+        taxonomy.push_back(sp.taxonomy);
+        charges.push_back(sp.charges);
+        enzyme.push_back(sp.digestion_enzyme.getName());
+        mass_type.push_back(static_cast<std::uint8_t>(sp.mass_type));
+        missed_cleavages.push_back(sp.missed_cleavages);
+        fragment_tol.push_back(sp.fragment_mass_tolerance);
+        fragment_ppm.push_back(sp.fragment_mass_tolerance_ppm);
+        precursor_tol.push_back(sp.precursor_mass_tolerance);
+        precursor_ppm.push_back(sp.precursor_mass_tolerance_ppm);
+        fixed_mods.push_back(sp.fixed_modifications);
+        variable_mods.push_back(sp.variable_modifications);
+        groups.push_back(&run.getProteinGroups());
+        indistinguishable.push_back(&run.getIndistinguishableProteins());
+        run_meta.add(i, run);
+        sp_meta.add(i, sp);
+
+        for (const ProteinHit& hit : run.getHits())
+        {
+          prot_meta.add(accession.size(), hit);
+          accession.push_back(pool.index(hit.getAccession()));
+          sequence.push_back(hit.getSequence());
+          score.push_back(hit.getScore());
+          coverage.push_back(hit.getCoverage());
+          rank.push_back(hit.getRank());
+        }
+        hit_offsets.push_back(accession.size());
+        setProgress(i);
+      }
+
+      writer.addStringColumn("run.identifier", identifier);
+      writer.addStringColumn("run.search_engine", engine);
+      writer.addStringColumn("run.search_engine_version", engine_version);
+      writer.addStringColumn("run.date", date);
+      writer.addStringColumn("run.score_type", score_type);
+      writer.addColumn("run.higher_better", higher_better);
+      writer.addColumn("run.significance_threshold", threshold);
+      writer.addStringColumn("run.db", db);
+      writer.addStringColumn("run.db_version", db_version);
+      writer.addStringColumn("run.taxonomy", taxonomy);
+      writer.addStringColumn("run.charges", charges);
+      writer.addStringColumn("run.enzyme", enzyme);
+      writer.addColumn("run.mass_type", mass_type);
+      writer.addColumn("run.missed_cleavages", missed_cleavages);
+      writer.addColumn("run.fragment_tolerance", fragment_tol);
+      writer.addColumn("run.fragment_tolerance_ppm", fragment_ppm);
+      writer.addColumn("run.precursor_tolerance", precursor_tol);
+      writer.addColumn("run.precursor_tolerance_ppm", precursor_ppm);
+      addStringLists(writer, "run.fixed_modifications", fixed_mods, pool);
+      addStringLists(writer, "run.variable_modifications", variable_mods, pool);
+      addProteinGroups(writer, "group", groups, pool);
+      addProteinGroups(writer, "indistinguishable", indistinguishable, pool);
+      run_meta.write(writer, "run");
+      sp_meta.write(writer, "search_parameters");
+
+      writer.addColumn("run.hit_offset", hit_offsets);
+      writer.addColumn("protein.accession", accession);
+      writer.addStringColumn("protein.sequence", sequence);
+      writer.addColumn("protein.score", score);
+      writer.addColumn("protein.coverage", coverage);
+      writer.addColumn("protein.rank", rank);
+      prot_meta.write(writer, "protein");
+    }
+
+    // peptide identifications
+    {
+      const Size n_peps = peptide_ids.size();
+      vector<double> rt(n_peps), mz(n_peps), threshold(n_peps);
+      vector<UInt32> identifier(n_peps), score_type(n_peps), base_name(n_peps);
+      vector<std::uint8_t> higher_better(n_peps);
+      vector<UInt64> hit_offsets(1, 0);
+      ColumnarMetaInfoWriter pep_meta, hit_meta;
+
+      ColumnarStringPool sequences;
+      vector<UInt32> hit_sequence, hit_rank;
+      vector<double> hit_score;
+      vector<Int32> hit_charge;
+      vector<UInt64> evidence_offsets(1, 0), annotation_offsets(1, 0), analysis_offsets(1, 0);
+
+      vector<UInt32> ev_accession;
+      vector<Int32> ev_start, ev_end;
+      vector<std::int8_t> ev_before, ev_after;
+
+      vector<double> ann_mz, ann_intensity;
+      vector<Int32> ann_charge;
+      vector<UInt32> ann_text;
+
+      vector<UInt32> ar_score_type;
+      vector<std::uint8_t> ar_higher_better;
+      vector<double> ar_main_score;
+      vector<UInt64> sub_score_offsets(1, 0);
+      vector<UInt32> sub_score_name;
+      vector<double> sub_score_value;
+
+      for (Size i = 0; i < n_peps; ++i)
+      {
+        const PeptideIdentification& pep = peptide_ids[i];
+        rt[i] = pep.getRT();
+        mz[i] = pep.getMZ();
+        threshold[i] = pep.getSignificanceThreshold();
+        identifier[i] = pool.index(pep.getIdentifier());
+        score_type[i] = pool.index(pep.getScoreType());
+        base_name[i] = pool.index(pep.getBaseName());
+        higher_better[i] = pep.isHigherScoreBetter();
+        pep_meta.add(i, pep);
+
+        for (const PeptideHit& hit : pep.getHits())
+        {
+          hit_meta.add(hit_sequence.size(), hit);
+          hit_sequence.push_back(sequences.index(hit.getSequence().toString()));
+          hit_score.push_back(hit.getScore());
+          hit_rank.push_back(hit.getRank());
+          hit_charge.push_back(hit.getCharge());
+
+          for (const PeptideEvidence& ev : hit.getPeptideEvidences())
+          {
+            ev_accession.push_back(pool.index(ev.getProteinAccession()));
+            ev_start.push_back(ev.getStart());
+            ev_end.push_back(ev.getEnd());
+            ev_before.push_back(ev.getAABefore());
+            ev_after.push_back(ev.getAAAfter());
+          }
+          evidence_offsets.push_back(ev_accession.size());
+
+          for (const PeptideHit::PeakAnnotation& ann : hit.getPeakAnnotations())
+          {
+            ann_mz.push_back(ann.mz);
+            ann_intensity.push_back(ann.intensity);
+            ann_charge.push_back(ann.charge);
+            ann_text.push_back(pool.index(ann.annotation));
+          }
+          annotation_offsets.push_back(ann_mz.size());
+
+          for (const PeptideHit::PepXMLAnalysisResult& ar : hit.getAnalysisResults())
+          {
+            ar_score_type.push_back(pool.index(ar.score_type));
+            ar_higher_better.push_back(ar.higher_is_better);
+            ar_main_score.push_back(ar.main_score);
+            for (const auto& sub : ar.sub_scores)
+            {
+              sub_score_name.push_back(pool.index(sub.first));
+              sub_score_value.push_back(sub.second);
+            }
+            sub_score_offsets.push_back(sub_score_name.size());
+          }
+          analysis_offsets.push_back(ar_main_score.size());
+        }
+        hit_offsets.push_back(hit_sequence.size());
+        setProgress(protein_ids.size() + i);
+      }
+
+      writer.addColumn("peptide.rt", rt);
+      writer.addColumn("peptide.mz", mz);
+      writer.addColumn("peptide.significance_threshold", threshold);
+      writer.addColumn("peptide.identifier", identifier);
+      writer.addColumn("peptide.score_type", score_type);
+      writer.addColumn("peptide.base_name", base_name);
+      writer.addColumn("peptide.higher_better", higher_better);
+      writer.addColumn("peptide.hit_offset", hit_offsets);
+      pep_meta.write(writer, "peptide");
+
+      writer.addStringColumn("sequences", sequences.strings());
+      writer.addColumn("hit.sequence", hit_sequence);
+      writer.addColumn("hit.score", hit_score);
+      writer.addColumn("hit.rank", hit_rank);
+      writer.addColumn("hit.charge", hit_charge);
+      writer.addColumn("hit.evidence_offset", evidence_offsets);
+      writer.addColumn("hit.annotation_offset", annotation_offsets);
+      writer.addColumn("hit.analysis_offset", analysis_offsets);
+      hit_meta.write(writer, "hit");
+
+      writer.addColumn("evidence.accession", ev_accession);
+      writer.addColumn("evidence.start", ev_start);
+      writer.addColumn("evidence.end", ev_end);
+      writer.addColumn("evidence.aa_before", ev_before);
+      writer.addColumn("evidence.aa_after", ev_after);
+
+      writer.addColumn("annotation.mz", ann_mz);
+      writer.addColumn("annotation.intensity", ann_intensity);
+      writer.addColumn("annotation.charge", ann_charge);
+      writer.addColumn("annotation.text", ann_text);
+
+      writer.addColumn("analysis.score_type", ar_score_type);
+      writer.addColumn("analysis.higher_better", ar_higher_better);
+      writer.addColumn("analysis.main_score", ar_main_score);
+      writer.addColumn("analysis.sub_score_offset", sub_score_offsets);
+      writer.addColumn("sub_score.name", sub_score_name);
+      writer.addColumn("sub_score.value", sub_score_value);
+    }
+
+    writer.addStringColumn("pool", pool.strings());
+    endProgress();
+  }
+
+  void IdBinFile::open(const String& filename)
+  {
+    ColumnarBinaryReader reader(filename, CONTENT_TAG);
+    open(reader);
+  }
+
+  void IdBinFile::open(const ColumnarBinaryReader& reader)
+  {
+    reader_ = reader;
+    pool_ = reader_.getStringColumn("pool").toVector();
+    pep_meta_ = std::make_shared<ColumnarMetaInfoReader>(reader_, "peptide");
+    hit_meta_ = std::make_shared<ColumnarMetaInfoReader>(reader_, "hit");
+  }
+
+  void IdBinFile::load(const String& filename, vector<ProteinIdentification>& protein_ids, vector<PeptideIdentification>& peptide_ids)
+  {
+    open(filename);
+
+    protein_ids.clear();
+    peptide_ids.clear();
+
+    startProgress(0, 2, "loading idBin file");
+    getProteinIdentifications(protein_ids);
+    setProgress(1);
+    readPeptideIdentifications_(0, getNrOfPeptideIdentifications(), peptide_ids);
+    endProgress();
+  }
+
+  void IdBinFile::checkOpen_() const
+  {
+    if (!reader_.isOpen())
+    {
+      throw Exception::IllegalArgument(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, "No idBin file opened. Call open() first.");
+    }
+  }
+
+  Size IdBinFile::getNrOfPeptideIdentifications() const
+  {
+    checkOpen_();
+    return reader_.getColumnSize("peptide.rt");
+  }
+
+  Size IdBinFile::getNrOfPeptideHits() const
+  {
+    checkOpen_();
+    return reader_.getColumnSize("hit.score");
+  }
+
+  vector<double> IdBinFile::getRTs() const
+  {
+    checkOpen_();
+    return reader_.getColumnOrEmpty<double>("peptide.rt");
+  }
+
+  vector<double> IdBinFile::getMZs() const
+  {
+    checkOpen_();
+    return reader_.getColumnOrEmpty<double>("peptide.mz");
+  }
+
+  vector<UInt64> IdBinFile::getHitOffsets() const
+  {
+    checkOpen_();
+    return reader_.getColumnOrEmpty<UInt64>("peptide.hit_offset");
+  }
+
+  vector<double> IdBinFile::getHitScores() const
+  {
+    checkOpen_();
+    return reader_.getColumnOrEmpty<double>("hit.score");
+  }
+
+  vector<Int> IdBinFile::getHitCharges() const
+  {
+    checkOpen_();
+    ColumnarBinaryReader::ColumnView<Int32> charges = reader_.getColumn<Int32>("hit.charge");
+    return vector<Int>(charges.begin(), charges.end());
+  }
+
+  vector<String> IdBinFile::getHitSequences() const
+  {
+    checkOpen_();
+    ColumnarBinaryReader::StringColumnView sequences = reader_.getStringColumn("sequences");
+    ColumnarBinaryReader::ColumnView<UInt32> hit_sequence = reader_.getColumn<UInt32>("hit.sequence");
+    vector<String> pool = sequences.toVector();
+    vector<String> result;
+    result.reserve(hit_sequence.size());
+    for (UInt32 s : hit_sequence)
+    {
+      result.push_back(pool[s]);
+    }
+    return result;
+  }
+
+  vector<pair<UInt64, DataValue> > IdBinFile::getHitMetaValues(const String& name) const
+  {
+    checkOpen_();
+    return hit_meta_->getColumn(name);
+  }
+
+  void IdBinFile::getProteinIdentifications(vector<ProteinIdentification>& protein_ids) const
+  {
+    checkOpen_();
+    const vector<String>& pool = pool_;
+
+    ColumnarBinaryReader::StringColumnView identifier = reader_.getStringColumn("run.identifier");
+    ColumnarBinaryReader::StringColumnView engine = reader_.getStringColumn("run.search_engine");
+    ColumnarBinaryReader::StringColumnView engine_version = reader_.getStringColumn("run.search_engine_version");
+    ColumnarBinaryReader::StringColumnView date = reader_.getStringColumn("run.date");
+    ColumnarBinaryReader::StringColumnView score_type = reader_.getStringColumn("run.score_type");
+    ColumnarBinaryReader::ColumnView<std::uint8_t> higher_better = reader_.getColumn<std::uint8_t>("run.higher_better");
+    ColumnarBinaryReader::ColumnView<double> threshold = reader_.getColumn<double>("run.significance_threshold");
+    ColumnarBinaryReader::StringColumnView db = reader_.getStringColumn("run.db");
+    ColumnarBinaryReader::StringColumnView db_version = reader_.getStringColumn("run.db_version");
+    ColumnarBinaryReader::StringColumnView taxonomy = reader_.getStringColumn("run.taxonomy");
+    ColumnarBinaryReader::StringColumnView charges = reader_.getStringColumn("run.charges");
+    ColumnarBinaryReader::StringColumnView enzyme = reader_.getStringColumn("run.enzyme");
+    ColumnarBinaryReader::ColumnView<std::uint8_t> mass_type = reader_.getColumn<std::uint8_t>("run.mass_type");
+    ColumnarBinaryReader::ColumnView<UInt32> missed_cleavages = reader_.getColumn<UInt32>("run.missed_cleavages");
+    ColumnarBinaryReader::ColumnView<double> fragment_tol = reader_.getColumn<double>("run.fragment_tolerance");
+    ColumnarBinaryReader::ColumnView<std::uint8_t> fragment_ppm = reader_.getColumn<std::uint8_t>("run.fragment_tolerance_ppm");
+    ColumnarBinaryReader::ColumnView<double> precursor_tol = reader_.getColumn<double>("run.precursor_tolerance");
+    ColumnarBinaryReader::ColumnView<std::uint8_t> precursor_ppm = reader_.getColumn<std::uint8_t>("run.precursor_tolerance_ppm");
+
+    ColumnarBinaryReader::ColumnView<UInt64> hit_offsets = reader_.getColumn<UInt64>("run.hit_offset");
+    ColumnarBinaryReader::ColumnView<UInt32> accession = reader_.getColumn<UInt32>("protein.accession");
+    ColumnarBinaryReader::StringColumnView sequence = reader_.getStringColumn("protein.sequence");
+    ColumnarBinaryReader::ColumnView<double> score = reader_.getColumn<double>("protein.score");
+    ColumnarBinaryReader::ColumnView<double> coverage = reader_.getColumn<double>("protein.coverage");
+    ColumnarBinaryReader::ColumnView<UInt32> rank = reader_.getColumn<UInt32>("protein.rank");
+
+    const Size n_runs = identifier.size();
+    protein_ids.assign(n_runs, ProteinIdentification());
+    for (Size i = 0; i < n_runs; ++i)
+    {
+      ProteinIdentification& run = protein_ids[i];
+      run.setIdentifier(identifier[i]);
+      run.setSearchEngine(engine[i]);
+      run.setSearchEngineVersion(engine_version[i]);
+      String date_string = date[i];
+      if (!date_string.empty())
+      {
+        DateTime date_time;
+        date_time.set(date_string);
+        run.setDateTime(date_time);
+      }
+      run.setScoreType(score_type[i]);
+      run.setHigherScoreBetter(higher_better[i] != 0);
+      run.setSignificanceThreshold(threshold[i]);
+
+      ProteinIdentification::SearchParameters sp;
+      sp.db = db[i];
+      sp.db_version = db_version[i];
+      sp.taxonomy = taxonomy[i];
+      sp.charges = charges[i];
+      String enzyme_name = enzyme[i];
+      if (ProteaseDB::getInstance()->hasEnzyme(enzyme_name))
+      {
+        sp.digestion_enzyme = *(ProteaseDB::getInstance()->getEnzyme(enzyme_name));
+      }
+      sp.mass_type = static_cast<ProteinIdentification::PeakMassType>(mass_type[i]);
+      sp.missed_cleavages = missed_cleavages[i];
+      sp.fragment_mass_tolerance = fragment_tol[i];
+      sp.fragment_mass_tolerance_ppm = fragment_ppm[i] != 0;
+      sp.precursor_mass_tolerance = precursor_tol[i];
+      sp.precursor_mass_tolerance_ppm = precursor_ppm[i] != 0;
+      sp.fixed_modifications = getStringList(reader_, "run.fixed_modifications", i, pool);
+      sp.variable_modifications = getStringList(reader_, "run.variable_modifications", i, pool);
+      run.setSearchParameters(std::move(sp));
+
+      run.getProteinGroups() = getProteinGroups(reader_, "group", i, pool);
+      run.getIndistinguishableProteins() = getProteinGroups(reader_, "indistinguishable", i, pool);
+
+      vector<ProteinHit>& hits = run.getHits();
+      hits.reserve(hit_offsets[i + 1] - hit_offsets[i]);
+      for (UInt64 h = hit_offsets[i]; h < hit_offsets[i + 1]; ++h)
+      {
+        ProteinHit hit(score[h], rank[h], pool[accession[h]], sequence[h]);
+        hit.setCoverage(coverage[h]);
+        hits.push_back(std::move(hit));
+      }
+    }
+
+    ColumnarMetaInfoReader::read(reader_, "run", [&protein_ids](UInt64 row) -> MetaInfoInterface*
+    {
+      return &protein_ids[row];
+    });
+    ColumnarMetaInfoReader::read(reader_, "search_parameters", [&protein_ids](UInt64 row) -> MetaInfoInterface*
+    {
+      return &protein_ids[row].getSearchParameters();
+    });
+
+    // map global protein hit index to (run, hit)
+    vector<ProteinHit*> hit_ptrs;
+    hit_ptrs.reserve(accession.size());
+    for (ProteinIdentification& run : protein_ids)
+    {
+      for (ProteinHit& hit : run.getHits()) hit_ptrs.push_back(&hit);
+    }
+    ColumnarMetaInfoReader::read(reader_, "protein", [&hit_ptrs](UInt64 row) -> MetaInfoInterface*
+    {
+      return hit_ptrs[row];
+    });
+  }
+
+  PeptideIdentification IdBinFile::getPeptideIdentification(Size index) const
+  {
+    checkOpen_();
+    if (index >= getNrOfPeptideIdentifications())
+    {
+      throw Exception::IndexOverflow(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, index, getNrOfPeptideIdentifications());
+    }
+    vector<PeptideIdentification> result;
+    readPeptideIdentifications_(index, index + 1, result);
+    return result[0];
+  }
+
+  void IdBinFile::getPeptideIdentifications(Size first, Size last, vector<PeptideIdentification>& peptide_ids) const
+  {
+    checkOpen_();
+    const Size n_peps = getNrOfPeptideIdentifications();
+    if (first > last || last > n_peps)
+    {
+      throw Exception::IndexOverflow(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, last, n_peps);
+    }
+    readPeptideIdentifications_(first, last, peptide_ids);
+  }
+
+  void IdBinFile::readPeptideIdentifications_(Size first, Size last, vector<PeptideIdentification>& peptide_ids) const
+  {
+    checkOpen_();
+    const vector<String>& pool = pool_;
+    ColumnarBinaryReader::StringColumnView sequences = reader_.getStringColumn("sequences");
+
+    ColumnarBinaryReader::ColumnView<double> rt = reader_.getColumn<double>("peptide.rt");
+    ColumnarBinaryReader::ColumnView<double> mz = reader_.getColumn<double>("peptide.mz");
+    ColumnarBinaryReader::ColumnView<double> threshold = reader_.getColumn<double>("peptide.significance_threshold");
+    ColumnarBinaryReader::ColumnView<UInt32> identifier = reader_.getColumn<UInt32>("peptide.identifier");
+    ColumnarBinaryReader::ColumnView<UInt32> score_type = reader_.getColumn<UInt32>("peptide.score_type");
+    ColumnarBinaryReader::ColumnView<UInt32> base_name = reader_.getColumn<UInt32>("peptide.base_name");
+    ColumnarBinaryReader::ColumnView<std::uint8_t> higher_better = reader_.getColumn<std::uint8_t>("peptide.higher_better");
+    ColumnarBinaryReader::ColumnView<UInt64> hit_offsets = reader_.getColumn<UInt64>("peptide.hit_offset");
+
+    ColumnarBinaryReader::ColumnView<UInt32> hit_sequence = reader_.getColumn<UInt32>("hit.sequence");
+    ColumnarBinaryReader::ColumnView<double> hit_score = reader_.getColumn<double>("hit.score");
+    ColumnarBinaryReader::ColumnView<UInt32> hit_rank = reader_.getColumn<UInt32>("hit.rank");
+    ColumnarBinaryReader::ColumnView<Int32> hit_charge = reader_.getColumn<Int32>("hit.charge");
+    ColumnarBinaryReader::ColumnView<UInt64> evidence_offsets = reader_.getColumn<UInt64>("hit.evidence_offset");
+    ColumnarBinaryReader::ColumnView<UInt64> annotation_offsets = reader_.getColumn<UInt64>("hit.annotation_offset");
+
+    ColumnarBinaryReader::ColumnView<UInt32> ev_accession = reader_.getColumn<UInt32>("evidence.accession");
+    ColumnarBinaryReader::ColumnView<Int32> ev_start = reader_.getColumn<Int32>("evidence.start");
+    ColumnarBinaryReader::ColumnView<Int32> ev_end = reader_.getColumn<Int32>("evidence.end");
+    ColumnarBinaryReader::ColumnView<std::int8_t> ev_before = reader_.getColumn<std::int8_t>("evidence.aa_before");
+    ColumnarBinaryReader::ColumnView<std::int8_t> ev_after = reader_.getColumn<std::int8_t>("evidence.aa_after");
+
+    ColumnarBinaryReader::ColumnView<double> ann_mz = reader_.getColumn<double>("annotation.mz");
+    ColumnarBinaryReader::ColumnView<double> ann_intensity = reader_.getColumn<double>("annotation.intensity");
+    ColumnarBinaryReader::ColumnView<Int32> ann_charge = reader_.getColumn<Int32>("annotation.charge");
+    ColumnarBinaryReader::ColumnView<UInt32> ann_text = reader_.getColumn<UInt32>("annotation.text");
+
+    // PepXML analysis results (not present in files written by older versions)
+    const bool has_analysis = reader_.hasColumn("hit.analysis_offset");
+    ColumnarBinaryReader::ColumnView<UInt64> analysis_offsets, sub_score_offsets;
+    ColumnarBinaryReader::ColumnView<UInt32> ar_score_type, sub_score_name;
+    ColumnarBinaryReader::ColumnView<std::uint8_t> ar_higher_better;
+    ColumnarBinaryReader::ColumnView<double> ar_main_score, sub_score_value;
+    if (has_analysis)
+    {
+      analysis_offsets = reader_.getColumn<UInt64>("hit.analysis_offset");
+      ar_score_type = reader_.getColumn<UInt32>("analysis.score_type");
+      ar_higher_better = reader_.getColumn<std::uint8_t>("analysis.higher_better");
+      ar_main_score = reader_.getColumn<double>("analysis.main_score");
+      sub_score_offsets = reader_.getColumn<UInt64>("analysis.sub_score_offset");
+      sub_score_name = reader_.getColumn<UInt32>("sub_score.name");
+      sub_score_value = reader_.getColumn<double>("sub_score.value");
+    }
+
+    // parse every distinct sequence only once
+    unordered_map<UInt32, AASequence> parsed_sequences;
+
+    peptide_ids.assign(last - first, PeptideIdentification());
+    for (Size i = first; i < last; ++i)
+    {
+      PeptideIdentification& pep = peptide_ids[i - first];
+      pep.setRT(rt[i]);
+      pep.setMZ(mz[i]);
+      pep.setSignificanceThreshold(threshold[i]);
+      pep.setIdentifier(pool[identifier[i]]);
+      pep.setScoreType(pool[score_type[i]]);
+      pep.setBaseName(pool[base_name[i]]);
+      pep.setHigherScoreBetter(higher_better[i] != 0);
+
+      vector<PeptideHit>& hits = pep.getHits();
+      hits.resize(hit_offsets[i + 1] - hit_offsets[i]);
+      for (UInt64 h = hit_offsets[i]; h < hit_offsets[i + 1]; ++h)
+      {
+        PeptideHit& hit = hits[h - hit_offsets[i]];
+        auto seq_it = parsed_sequences.find(hit_sequence[h]);
+        if (seq_it == parsed_sequences.end())
+        {
+          seq_it = parsed_sequences.emplace(hit_sequence[h], AASequence::fromString(sequences[hit_sequence[h]])).first;
+        }
+        hit.setSequence(seq_it->second);
+        hit.setScore(hit_score[h]);
+        hit.setRank(hit_rank[h]);
+        hit.setCharge(hit_charge[h]);
+
+        vector<PeptideEvidence> evidences;
+        evidences.reserve(evidence_offsets[h + 1] - evidence_offsets[h]);
+        for (UInt64 e = evidence_offsets[h]; e < evidence_offsets[h + 1]; ++e)
+        {
+          evidences.emplace_back(pool[ev_accession[e]], ev_start[e], ev_end[e], ev_before[e], ev_after[e]);
+        }
+        hit.setPeptideEvidences(std::move(evidences));
+
+        if (annotation_offsets[h + 1] > annotation_offsets[h])
+        {
+          vector<PeptideHit::PeakAnnotation> annotations;
+          for (UInt64 a = annotation_offsets[h]; a < annotation_offsets[h + 1]; ++a)
+          {
+            PeptideHit::PeakAnnotation ann;
+            ann.mz = ann_mz[a];
+            ann.intensity = ann_intensity[a];
+            ann.charge = ann_charge[a];
+            ann.annotation = pool[ann_text[a]];
+            annotations.push_back(ann);
+          }
+          hit.setPeakAnnotations(annotations);
+        }
+
+        if (has_analysis && (analysis_offsets[h + 1] > analysis_offsets[h]))
+        {
+          vector<PeptideHit::PepXMLAnalysisResult> analysis_results;
+          for (UInt64 a = analysis_offsets[h]; a < analysis_offsets[h + 1]; ++a)
+          {
+            PeptideHit::PepXMLAnalysisResult ar;
+            ar.score_type = pool[ar_score_type[a]];
+            ar.higher_is_better = (ar_higher_better[a] != 0);
+            ar.main_score = ar_main_score[a];
+            for (UInt64 sub = sub_score_offsets[a]; sub < sub_score_offsets[a + 1]; ++sub)
+            {
+              ar.sub_scores[pool[sub_score_name[sub]]] = sub_score_value[sub];
+            }
+            analysis_results.push_back(ar);
+          }
+          hit.setAnalysisResults(analysis_results);
+        }
+      }
+    }
+
+    // meta values of peptide identifications and hits
+    const UInt64 first_hit = hit_offsets[first];
+    const UInt64 last_hit = hit_offsets[last];
+    vector<PeptideHit*> hit_ptrs;
+    hit_ptrs.reserve(last_hit - first_hit);
+    for (PeptideIdentification& pep : peptide_ids)
+    {
+      for (PeptideHit& hit : pep.getHits()) hit_ptrs.push_back(&hit);
+    }
+
+    const bool complete = (first == 0 && last == rt.size());
+    if (complete)
+    {
+      for (Size i = 0; i < pep_meta_->size(); ++i)
+      {
+        peptide_ids[pep_meta_->row(i)].setMetaValue(pep_meta_->key(i), pep_meta_->value(i));
+      }
+      for (Size i = 0; i < hit_meta_->size(); ++i)
+      {
+        hit_ptrs[hit_meta_->row(i)]->setMetaValue(hit_meta_->key(i), hit_meta_->value(i));
+      }
+    }
+    else
+    {
+      for (Size i : pep_meta_->findRows(first, last))
+      {
+        peptide_ids[pep_meta_->row(i) - first].setMetaValue(pep_meta_->key(i), pep_meta_->value(i));
+      }
+      for (Size i : hit_meta_->findRows(first_hit, last_hit))
+      {
+        hit_ptrs[hit_meta_->row(i) - first_hit]->setMetaValue(hit_meta_->key(i), hit_meta_->value(i));
+      }
+    }
+  }
+
+} // namespace OpenMS
@@ -76,15 +76,8 @@ namespace OpenMS
     QByteArray base64_uncompressed;
     Base64::decodeSingleString(in, base64_uncompressed, zlib_compression);
 
-    // Create a temporary string (*not* null-terminated) to hold the data
-    std::string tmpstring(base64_uncompressed.constData(), base64_uncompressed.size());
-    decodeNPRaw(tmpstring, out, config);
-
-    // NOTE: it is possible (and likely faster) to call directly the const
-    // unsigned char * function but this would make it necessary to deal with
-    // reinterpret_cast ugliness here ... 
-    //
-    // decodeNP_internal_(reinterpret_cast<const unsigned char*>(base64_uncompressed.constData()), base64_uncompressed.size(), out, config);
+    // decode directly from the byte array (which is *not* null-terminated)
+    decodeNPInternal_(reinterpret_cast<const unsigned char*>(base64_uncompressed.constData()), base64_uncompressed.size(), out, config);
   }
 
   void MSNumpressCoder::encodeNPRaw(const std::vector<double>& in, String& result, const NumpressConfig & config)
@@ -289,63 +282,57 @@ namespace OpenMS
     decodeNPInternal_(reinterpret_cast<const unsigned char*>(in.c_str()), in.size(), out, config);
   }
 
-  void MSNumpressCoder::decodeNPInternal_(const unsigned char* in, size_t in_size, std::vector<double>& out, const NumpressConfig & config)
+  Size MSNumpressCoder::decodedSizeBound(size_t in_size, const NumpressConfig & config)
   {
-    out.clear();
-    if (in_size == 0) return;
+    switch (config.np_compression)
+    {
+    case LINEAR:
+    case PIC:
+      // at least one half byte per value
+      return in_size * 2;
+
+    case SLOF:
+      // two bytes per value (plus 8 bytes fixed point)
+      return in_size / 2;
+
+    default:
+      return 0;
+    }
+  }
 
-    size_t byteCount = in_size;
+  Size MSNumpressCoder::decodeNPRaw(const unsigned char* in, size_t in_size, double* out, const NumpressConfig & config)
+  {
+    if (in_size == 0) return 0;
 
 #ifdef NUMPRESS_DEBUG
-    std::cout << "decodeNPInternal_: array input with length " << in_size << std::endl;
+    std::cout << "decodeNPRaw: array input with length " << in_size << std::endl;
     for (int i = 0; i < in_size; i++)
     {
       std::cout << "array[" << i << "] : " << (int)in[i] << std::endl;
     }
 #endif
 
+    size_t count = 0;
     try
     {
-      size_t initialSize;
-
       switch (config.np_compression)
       {
       case LINEAR:
-      {
-        initialSize = byteCount * 2;
-        if (out.size() < initialSize) { out.resize(initialSize); }
-        size_t count = numpress::MSNumpress::decodeLinear(in, byteCount, &out[0]);
-        out.resize(count);
+        count = numpress::MSNumpress::decodeLinear(in, in_size, out);
         break;
-      }
 
       case PIC:
-      {
-        initialSize = byteCount * 2;
-        if (out.size() < initialSize) { out.resize(initialSize); }
-        size_t count = numpress::MSNumpress::decodePic(in, byteCount, &out[0]);
-        out.resize(count);
+        count = numpress::MSNumpress::decodePic(in, in_size, out);
         break;
-      }
 
       case SLOF:
-      {
-        initialSize = byteCount / 2;
-        if (out.size() < initialSize) { out.resize(initialSize); }
-        size_t count = numpress::MSNumpress::decodeSlof(in, byteCount, &out[0]);
-        out.resize(count);
+        count = numpress::MSNumpress::decodeSlof(in, in_size, out);
         break;
-      }
 
       case NONE:
-      {
-        return;
-      }
-
       default:
         break;
       }
-
     }
     catch (...)
     {
@@ -353,14 +340,23 @@ namespace OpenMS
     }
 
 #ifdef NUMPRESS_DEBUG
-    std::cout << "decodeNPInternal_: output size " << out.size() << std::endl;
-    for (int i = 0; i < out.size(); i++)
+    std::cout << "decodeNPRaw: output size " << count << std::endl;
+    for (int i = 0; i < count; i++)
     {
       std::cout << "array[" << i << "] : " << out[i] << std::endl;
     }
 #endif
 
+    return count;
+  }
+
+  void MSNumpressCoder::decodeNPInternal_(const unsigned char* in, size_t in_size, std::vector<double>& out, const NumpressConfig & config)
+  {
+    out.clear();
+    if (in_size == 0 || config.np_compression == NONE) return;
 
+    out.resize(decodedSizeBound(in_size, config));
+    out.resize(decodeNPRaw(in, in_size, out.data(), config));
   }
 
 } //namespace OpenMS
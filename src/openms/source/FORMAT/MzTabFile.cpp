@@ -39,6 +39,12 @@
 
 #include <boost/regex.hpp>
 
+#include <fstream>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
 using namespace std;
 
 // TODO fix all the shadowed "String s"
@@ -48,6 +54,62 @@ using namespace std;
 namespace OpenMS
 {
 
+  struct MzTabFile::StoreStream_
+  {
+    /// Output file
+    std::ofstream os;
+    /// Meta data (needed for the section headers)
+    MzTabMetaData meta_data;
+    /// Number of the section currently written (0: none, 1: protein, ..., 7: OSM)
+    Size section = 0;
+    /// Number of lines written so far
+    Size line = 0;
+    /// Empty and comment lines to re-insert at their original positions (sorted)
+    std::vector<Size> empty_rows;
+    std::map<Size, String> comment_rows;
+
+    /// Writes a line (same line ending handling as TextFile::store), preceded by pending empty or comment lines
+    void writeLine(const String& s)
+    {
+      while (true)
+      {
+        if (!empty_rows.empty() && std::binary_search(empty_rows.begin(), empty_rows.end(), line)) // current line was originally an empty line
+        {
+          os << "\n";
+        }
+        else if (!comment_rows.empty() && comment_rows.find(line) != comment_rows.end()) // current line was originally a comment line
+        {
+          writeRaw(comment_rows[line]);
+        }
+        else
+        {
+          break;
+        }
+        ++line;
+      }
+      writeRaw(s);
+      ++line;
+    }
+
+    /// Writes a single line, terminated by a newline
+    void writeRaw(const String& s)
+    {
+      if (s.hasSuffix("\r\n"))
+      {
+        os.write(s.c_str(), s.size() - 2);
+        os << "\n";
+      }
+      else if (s.hasSuffix("\n"))
+      {
+        os << s;
+      }
+      else
+      {
+        os << s << "\n";
+      }
+    }
+  };
+
   MzTabFile::MzTabFile():
   store_protein_reliability_(false),
   store_peptide_reliability_(false),
@@ -70,6 +132,10 @@ namespace OpenMS
 
   MzTabFile::~MzTabFile()
   {
+    if (stream_)
+    {
+      closeStoreStream_(*stream_);
+    }
   }
 
   std::pair<int, int> MzTabFile::extractIndexPairsFromBrackets_(const String & s)
@@ -2843,206 +2909,257 @@ namespace OpenMS
     }
   }
 
-  void MzTabFile::store(const String& filename, const MzTab& mz_tab) const
+  String MzTabFile::generateMzTabSectionHeader_(const MzTabProteinSectionRows& rows, const MzTabMetaData& meta_data, const vector<String>& optional_columns) const
   {
-    if (!(FileHandler::hasValidExtension(filename, FileTypes::MZTAB) || FileHandler::hasValidExtension(filename, FileTypes::TSV)))
+    Size n_best_search_engine_score = meta_data.protein_search_engine_score.size();
+    return generateMzTabProteinHeader_(rows[0], n_best_search_engine_score, optional_columns);
+  }
+
+  String MzTabFile::generateMzTabSectionHeader_(const MzTabPeptideSectionRows& rows, const MzTabMetaData& meta_data, const vector<String>& optional_columns) const
+  {
+    Size assays = rows[0].peptide_abundance_assay.size();
+    Size study_variables = rows[0].peptide_abundance_study_variable.size();
+    Size search_ms_runs = 0;
+    if (meta_data.mz_tab_mode.toCellString() == "Complete")
     {
-      throw Exception::UnableToCreateFile(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, filename, "invalid file extension, expected '"
-      + FileTypes::typeToName(FileTypes::MZTAB) + "' or '" + FileTypes::typeToName(FileTypes::TSV) + "'");
+      // all ms_runs mandatory
+      search_ms_runs = meta_data.ms_run.size();
+    }
+    else // only report all scores if user provided at least one
+    {
+      bool has_ms_run_level_scores = std::any_of(rows.begin(), rows.end(),
+        [](const MzTabPeptideSectionRow& row) { return !row.search_engine_score_ms_run.empty(); });
+      if (has_ms_run_level_scores) { search_ms_runs = meta_data.ms_run.size(); }
     }
+    Size n_search_engine_score = rows[0].search_engine_score_ms_run.size();
+    Size n_best_search_engine_score = rows[0].best_search_engine_score.size();
 
-    StringList out;
-    generateMzTabMetaDataSection_(mz_tab.getMetaData(), out);
-    bool complete = (mz_tab.getMetaData().mz_tab_mode.toCellString() == "Complete");
-    Size ms_runs = mz_tab.getMetaData().ms_run.size();
+    return generateMzTabPeptideHeader_(search_ms_runs, n_best_search_engine_score, n_search_engine_score, assays, study_variables, optional_columns);
+  }
 
-    const MzTabProteinSectionRows& protein_section = mz_tab.getProteinSectionRows();
-    const MzTabPeptideSectionRows& peptide_section = mz_tab.getPeptideSectionRows();
-    const MzTabPSMSectionRows& psm_section = mz_tab.getPSMSectionRows();
-    const MzTabSmallMoleculeSectionRows& smallmolecule_section = mz_tab.getSmallMoleculeSectionRows();
+  String MzTabFile::generateMzTabSectionHeader_(const MzTabPSMSectionRows& /* rows */, const MzTabMetaData& meta_data, const vector<String>& optional_columns) const
+  {
+    Size n_search_engine_scores = meta_data.psm_search_engine_score.size();
 
-    if (!protein_section.empty())
+    if (n_search_engine_scores == 0)
     {
-      Size n_best_search_engine_score = mz_tab.getMetaData().protein_search_engine_score.size();
+      // TODO warn
+    }
+    return generateMzTabPSMHeader_(n_search_engine_scores, optional_columns);
+  }
 
-      // add header
-      out.push_back(generateMzTabProteinHeader_(protein_section[0], n_best_search_engine_score, mz_tab.getProteinOptionalColumnNames()));
+  String MzTabFile::generateMzTabSectionHeader_(const MzTabSmallMoleculeSectionRows& rows, const MzTabMetaData& meta_data, const vector<String>& optional_columns) const
+  {
+    Size assays = rows[0].smallmolecule_abundance_assay.size();
+    Size study_variables = rows[0].smallmolecule_abundance_study_variable.size();
+    Size n_search_engine_score = rows[0].search_engine_score_ms_run.size();
+    Size n_best_search_engine_score = meta_data.smallmolecule_search_engine_score.size();
+    return generateMzTabSmallMoleculeHeader_(meta_data.ms_run.size(), n_best_search_engine_score, n_search_engine_score, assays, study_variables, optional_columns);
+  }
 
-      // add section
-      generateMzTabSection_(protein_section, mz_tab.getProteinOptionalColumnNames(), out);
+  String MzTabFile::generateMzTabSectionHeader_(const MzTabNucleicAcidSectionRows& rows, const MzTabMetaData& meta_data, const vector<String>& optional_columns) const
+  {
+    Size search_ms_runs = 0;
+    if (meta_data.mz_tab_mode.toCellString() == "Complete")
+    {
+      // all ms_runs mandatory
+      search_ms_runs = meta_data.ms_run.size();
     }
-
-    if (!peptide_section.empty())
+    else // only report all scores if user provided at least one
     {
-      Size assays = peptide_section[0].peptide_abundance_assay.size();
-      Size study_variables = peptide_section[0].peptide_abundance_study_variable.size();
-      Size search_ms_runs = 0;
-      if (complete)
-      {
-        // all ms_runs mandatory
-        search_ms_runs = ms_runs;
-      }
-      else // only report all scores if user provided at least one
-      {
-        const MzTabPeptideSectionRows psr = mz_tab.getPeptideSectionRows();
-        bool has_ms_run_level_scores = false;
-        for (Size i = 0; i != psr.size(); ++i)
-        {
-          if (!psr[i].search_engine_score_ms_run.empty())
-          {
-            has_ms_run_level_scores = true;
-          }
-        }
+      bool has_ms_run_level_scores = std::any_of(rows.begin(), rows.end(),
+        [](const MzTabNucleicAcidSectionRow& row) { return !row.search_engine_score_ms_run.empty(); });
+      if (has_ms_run_level_scores) { search_ms_runs = meta_data.ms_run.size(); }
+    }
+    Size n_search_engine_score = rows[0].search_engine_score_ms_run.size();
+    Size n_best_search_engine_score = meta_data.nucleic_acid_search_engine_score.size();
 
-        if (has_ms_run_level_scores) { search_ms_runs = ms_runs; }
-      }
-      Size n_search_engine_score = peptide_section[0].search_engine_score_ms_run.size();
-      Size n_best_search_engine_score = peptide_section[0].best_search_engine_score.size();
+    return generateMzTabNucleicAcidHeader_(search_ms_runs, n_search_engine_score, n_best_search_engine_score, optional_columns);
+  }
 
-      out.push_back(generateMzTabPeptideHeader_(search_ms_runs, n_best_search_engine_score, n_search_engine_score, assays, study_variables, mz_tab.getPeptideOptionalColumnNames()));
-      generateMzTabSection_(mz_tab.getPeptideSectionRows(), mz_tab.getPeptideOptionalColumnNames(), out);
+  String MzTabFile::generateMzTabSectionHeader_(const MzTabOligonucleotideSectionRows& rows, const MzTabMetaData& meta_data, const vector<String>& optional_columns) const
+  {
+    Size search_ms_runs = 0;
+    if (meta_data.mz_tab_mode.toCellString() == "Complete")
+    {
+      // all ms_runs mandatory
+      search_ms_runs = meta_data.ms_run.size();
     }
-
-    if (!psm_section.empty())
+    else // only report all scores if user provided at least one
     {
-      Size n_search_engine_scores = mz_tab.getMetaData().psm_search_engine_score.size();
-
-      if (n_search_engine_scores == 0)
-      {
-        // TODO warn
-      }
-      out.push_back(generateMzTabPSMHeader_(n_search_engine_scores, mz_tab.getPSMOptionalColumnNames()));
-      generateMzTabSection_(mz_tab.getPSMSectionRows(), mz_tab.getPSMOptionalColumnNames(), out);
+      bool has_ms_run_level_scores = std::any_of(rows.begin(), rows.end(),
+        [](const MzTabOligonucleotideSectionRow& row) { return !row.search_engine_score_ms_run.empty(); });
+      if (has_ms_run_level_scores) { search_ms_runs = meta_data.ms_run.size(); }
     }
+    Size n_search_engine_score = rows[0].search_engine_score_ms_run.size();
+    Size n_best_search_engine_score = meta_data.oligonucleotide_search_engine_score.size();
+    return generateMzTabOligonucleotideHeader_(search_ms_runs, n_best_search_engine_score, n_search_engine_score, optional_columns);
+  }
+
+  String MzTabFile::generateMzTabSectionHeader_(const MzTabOSMSectionRows& /* rows */, const MzTabMetaData& meta_data, const vector<String>& optional_columns) const
+  {
+    Size n_search_engine_scores = meta_data.osm_search_engine_score.size();
 
-    if (!smallmolecule_section.empty())
+    if (n_search_engine_scores == 0)
     {
-      Size assays = smallmolecule_section[0].smallmolecule_abundance_assay.size();
-      Size study_variables = smallmolecule_section[0].smallmolecule_abundance_study_variable.size();
-      Size n_search_engine_score = smallmolecule_section[0].search_engine_score_ms_run.size();
-      Size n_best_search_engine_score = mz_tab.getMetaData().smallmolecule_search_engine_score.size();
-      out.push_back(generateMzTabSmallMoleculeHeader_(ms_runs, n_best_search_engine_score, n_search_engine_score, assays, study_variables, mz_tab.getSmallMoleculeOptionalColumnNames()));
-      generateMzTabSection_(smallmolecule_section, mz_tab.getSmallMoleculeOptionalColumnNames(), out);
+      // TODO warn
     }
+    return generateMzTabOSMHeader_(n_search_engine_scores, optional_columns);
+  }
 
-    const MzTabNucleicAcidSectionRows& nucleic_acid_section = mz_tab.getNucleicAcidSectionRows();
-    const MzTabOligonucleotideSectionRows& oligonucleotide_section = mz_tab.getOligonucleotideSectionRows();
-    const MzTabOSMSectionRows& osm_section = mz_tab.getOSMSectionRows();
+  void MzTabFile::openStoreStream_(StoreStream_& stream, const String& filename, const MzTabMetaData& meta_data) const
+  {
+    if (!(FileHandler::hasValidExtension(filename, FileTypes::MZTAB) || FileHandler::hasValidExtension(filename, FileTypes::TSV)))
+    {
+      throw Exception::UnableToCreateFile(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, filename, "invalid file extension, expected '"
+      + FileTypes::typeToName(FileTypes::MZTAB) + "' or '" + FileTypes::typeToName(FileTypes::TSV) + "'");
+    }
 
-    if (!nucleic_acid_section.empty())
+    // stream not opened in binary mode, thus "\n" will be evaluated platform dependent (e.g. resolve to \r\n on Windows)
+    stream.os.open(filename.c_str(), ofstream::out);
+    if (!stream.os)
     {
-      Size search_ms_runs = 0;
-      if (complete)
-      {
-        // all ms_runs mandatory
-        search_ms_runs = ms_runs;
-      }
-      else // only report all scores if user provided at least one
-      {
-        bool has_ms_run_level_scores = false;
-        for (Size i = 0; i != nucleic_acid_section.size(); ++i)
-        {
-          if (!nucleic_acid_section[i].search_engine_score_ms_run.empty())
-          {
-            has_ms_run_level_scores = true;
-          }
-        }
+      throw Exception::UnableToCreateFile(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, filename);
+    }
+    stream.meta_data = meta_data;
 
-        if (has_ms_run_level_scores)
-        {
-          search_ms_runs = ms_runs;
-        }
-      }
-      Size n_search_engine_score = nucleic_acid_section[0].search_engine_score_ms_run.size();
-      Size n_best_search_engine_score = mz_tab.getMetaData().nucleic_acid_search_engine_score.size();
+    StringList out;
+    generateMzTabMetaDataSection_(meta_data, out);
+    for (const String& s : out)
+    {
+      stream.writeLine(s);
+    }
+  }
 
-      // add header
-      out.push_back(generateMzTabNucleicAcidHeader_(search_ms_runs, n_search_engine_score, n_best_search_engine_score, mz_tab.getNucleicAcidOptionalColumnNames()));
+  template <typename SectionRows>
+  void MzTabFile::writeMzTabSection_(StoreStream_& stream, Size section, const SectionRows& rows, const vector<String>& optional_columns) const
+  {
+    if (rows.empty()) return;
 
-      // add section
-      generateMzTabSection_(nucleic_acid_section, mz_tab.getNucleicAcidOptionalColumnNames(), out);
+    if (section < stream.section)
+    {
+      throw Exception::IllegalArgument(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, "mzTab sections have to be stored in order (protein, peptide, PSM, small molecule, nucleic acid, oligonucleotide, OSM).");
+    }
+    if (section != stream.section)
+    {
+      if (stream.section != 0) stream.writeLine("\n"); // terminate previous section
+      stream.section = section;
+      stream.writeLine(generateMzTabSectionHeader_(rows, stream.meta_data, optional_columns));
     }
 
-    if (!oligonucleotide_section.empty())
+    // format blocks of rows in parallel, then write them in order
+    Size block_size = 1024;
+#ifdef _OPENMP
+    block_size *= omp_get_max_threads();
+#endif
+    std::vector<String> block(std::min(block_size, rows.size()));
+    for (Size first = 0; first < rows.size(); first += block_size)
     {
-      Size search_ms_runs = 0;
-      if (complete)
+      const Size n = std::min(block_size, rows.size() - first);
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic, 64)
+#endif
+      for (SignedSize i = 0; i < (SignedSize)n; ++i)
       {
-        // all ms_runs mandatory
-        search_ms_runs = ms_runs;
+        block[i] = generateMzTabSectionRow_(rows[first + i], optional_columns);
       }
-      else // only report all scores if user provided at least one
+      for (Size i = 0; i < n; ++i)
       {
-        bool has_ms_run_level_scores = false;
-        for (Size i = 0; i != oligonucleotide_section.size(); ++i)
-        {
-          if (!oligonucleotide_section[i].search_engine_score_ms_run.empty())
-          {
-            has_ms_run_level_scores = true;
-          }
-        }
-
-        if (has_ms_run_level_scores)
-        {
-          search_ms_runs = ms_runs;
-        }
+        stream.writeLine(block[i]);
       }
-      Size n_search_engine_score = oligonucleotide_section[0].search_engine_score_ms_run.size();
-      Size n_best_search_engine_score = mz_tab.getMetaData().oligonucleotide_search_engine_score.size();
-      out.push_back(generateMzTabOligonucleotideHeader_(search_ms_runs, n_best_search_engine_score, n_search_engine_score, mz_tab.getOligonucleotideOptionalColumnNames()));
-      generateMzTabSection_(mz_tab.getOligonucleotideSectionRows(), mz_tab.getOligonucleotideOptionalColumnNames(), out);
     }
-
-    if (!osm_section.empty())
-    {
-      Size n_search_engine_scores = mz_tab.getMetaData().osm_search_engine_score.size();
-
-      if (n_search_engine_scores == 0)
-      {
-        // TODO warn
-      }
-      out.push_back(generateMzTabOSMHeader_(n_search_engine_scores, mz_tab.getOSMOptionalColumnNames()));
-      generateMzTabSection_(mz_tab.getOSMSectionRows(), mz_tab.getOSMOptionalColumnNames(), out);
   }
 
-    // insert comments (might provide critical cues for human reader) and empty lines
-  Size line = 0;
-  vector<Size> empty_rows = mz_tab.getEmptyRows();
-  map<Size, String> comment_rows = mz_tab.getCommentRows();
+  void MzTabFile::closeStoreStream_(StoreStream_& stream) const
+  {
+    if (stream.section != 0) stream.writeLine("\n"); // terminate last section
+    stream.os.close();
+  }
 
-  if (empty_rows.empty() && comment_rows.empty())
+  MzTabFile::StoreStream_& MzTabFile::getStoreStream_()
   {
-    TextFile tmp_out;
-    for (TextFile::ConstIterator it = out.begin(); it != out.end(); ++it)
+    if (!stream_)
     {
-      tmp_out.addLine(*it);
+      throw Exception::IllegalArgument(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, "No file open for storing. Call beginStore() first.");
     }
-    tmp_out.store(filename);
+    return *stream_;
+  }
+
+  void MzTabFile::store(const String& filename, const MzTab& mz_tab) const
+  {
+    StoreStream_ stream;
+    stream.empty_rows = mz_tab.getEmptyRows();
+    std::sort(stream.empty_rows.begin(), stream.empty_rows.end());
+    stream.comment_rows = mz_tab.getCommentRows();
+
+    openStoreStream_(stream, filename, mz_tab.getMetaData());
+    writeMzTabSection_(stream, 1, mz_tab.getProteinSectionRows(), mz_tab.getProteinOptionalColumnNames());
+    writeMzTabSection_(stream, 2, mz_tab.getPeptideSectionRows(), mz_tab.getPeptideOptionalColumnNames());
+    writeMzTabSection_(stream, 3, mz_tab.getPSMSectionRows(), mz_tab.getPSMOptionalColumnNames());
+    writeMzTabSection_(stream, 4, mz_tab.getSmallMoleculeSectionRows(), mz_tab.getSmallMoleculeOptionalColumnNames());
+    writeMzTabSection_(stream, 5, mz_tab.getNucleicAcidSectionRows(), mz_tab.getNucleicAcidOptionalColumnNames());
+    writeMzTabSection_(stream, 6, mz_tab.getOligonucleotideSectionRows(), mz_tab.getOligonucleotideOptionalColumnNames());
+    writeMzTabSection_(stream, 7, mz_tab.getOSMSectionRows(), mz_tab.getOSMOptionalColumnNames());
+    closeStoreStream_(stream);
   }
-  else
+
+  void MzTabFile::beginStore(const String& filename, const MzTabMetaData& meta_data)
   {
-    TextFile tmp_out;
-    for (TextFile::ConstIterator it = out.begin(); it != out.end(); )
+    if (stream_)
     {
-      if (std::binary_search(empty_rows.begin(), empty_rows.end(), line))  // check if current line was originally an empty line
-      {
-        tmp_out.addLine("\n");
-        ++line;
-      }
-      else if (comment_rows.find(line) != comment_rows.end()) // check if current line was originally a comment line
-      {
-        tmp_out.addLine(comment_rows[line]);
-        ++line;
-      }
-      else   // no empty line, no comment => add row
-      {
-        tmp_out.addLine(*it);
-        ++line;
-        ++it;
-      }
+      closeStoreStream_(*stream_);
+    }
+    stream_.reset(new StoreStream_());
+    try
+    {
+      openStoreStream_(*stream_, filename, meta_data);
+    }
+    catch (...)
+    {
+      stream_.reset();
+      throw;
     }
-    tmp_out.store(filename);
   }
+
+  void MzTabFile::storeRows(const MzTabProteinSectionRows& rows, const vector<String>& optional_columns)
+  {
+    writeMzTabSection_(getStoreStream_(), 1, rows, optional_columns);
+  }
+
+  void MzTabFile::storeRows(const MzTabPeptideSectionRows& rows, const vector<String>& optional_columns)
+  {
+    writeMzTabSection_(getStoreStream_(), 2, rows, optional_columns);
+  }
+
+  void MzTabFile::storeRows(const MzTabPSMSectionRows& rows, const vector<String>& optional_columns)
+  {
+    writeMzTabSection_(getStoreStream_(), 3, rows, optional_columns);
+  }
+
+  void MzTabFile::storeRows(const MzTabSmallMoleculeSectionRows& rows, const vector<String>& optional_columns)
+  {
+    writeMzTabSection_(getStoreStream_(), 4, rows, optional_columns);
+  }
+
+  void MzTabFile::storeRows(const MzTabNucleicAcidSectionRows& rows, const vector<String>& optional_columns)
+  {
+    writeMzTabSection_(getStoreStream_(), 5, rows, optional_columns);
+  }
+
+  void MzTabFile::storeRows(const MzTabOligonucleotideSectionRows& rows, const vector<String>& optional_columns)
+  {
+    writeMzTabSection_(getStoreStream_(), 6, rows, optional_columns);
+  }
+
+  void MzTabFile::storeRows(const MzTabOSMSectionRows& rows, const vector<String>& optional_columns)
+  {
+    writeMzTabSection_(getStoreStream_(), 7, rows, optional_columns);
+  }
+
+  void MzTabFile::endStore()
+  {
+    closeStoreStream_(getStoreStream_());
+    stream_.reset();
   }
 
 }
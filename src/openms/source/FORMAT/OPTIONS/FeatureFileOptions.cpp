@@ -41,6 +41,7 @@ namespace OpenMS
   FeatureFileOptions::FeatureFileOptions() :
     loadConvexhull_(true),
     loadSubordinates_(true),
+    loadPeptideIdentifications_(true),
     metadata_only_(false),
     has_rt_range_(false),
     has_mz_range_(false),
@@ -73,6 +74,16 @@ namespace OpenMS
     return loadSubordinates_;
   }
 
+  void FeatureFileOptions::setLoadPeptideIdentifications(bool load)
+  {
+    loadPeptideIdentifications_ = load;
+  }
+
+  bool FeatureFileOptions::getLoadPeptideIdentifications() const
+  {
+    return loadPeptideIdentifications_;
+  }
+
   void FeatureFileOptions::setMetadataOnly(bool only)
   {
     metadata_only_ = only;
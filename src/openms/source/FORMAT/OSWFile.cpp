@@ -240,42 +240,57 @@ namespace OpenMS
                       "PEP DOUBLE NOT NULL);";
       }
 
-      std::vector<std::string> insert_sqls;
+      // Write to Sqlite database using a single prepared statement (no SQL text per row)
+      const bool transition_level = (osw_level == "transition");
+      String insert_sql = "INSERT INTO " + table + (transition_level ?
+        " (FEATURE_ID, TRANSITION_ID, SCORE, QVALUE, PEP) VALUES (?, ?, ?, ?, ?);" :
+        " (FEATURE_ID, SCORE, QVALUE, PEP) VALUES (?, ?, ?, ?);");
+
+      SqliteConnector conn(in_osw);
+      sqlite3* db = conn.getDB();
+      conn.executeStatement(create_sql);
+      conn.executeStatement("BEGIN TRANSACTION");
+
+      sqlite3_stmt* stmt;
+      conn.prepareStatement(&stmt, insert_sql);
       for (auto const &feat : features)
       {
-        std::stringstream insert_sql;
-        if (osw_level == "transition") {
-          std::vector<OpenMS::String> ids;
+        // identifiers are bound as text (converted to integers by the column affinity)
+        std::vector<OpenMS::String> ids;
+        if (transition_level)
+        {
+          // transition-level ids are "<feature id>_<transition id>"
           OpenMS::String(feat.first).split("_", ids);
-          insert_sql << "INSERT INTO " << table;
-          insert_sql << " (FEATURE_ID, TRANSITION_ID, SCORE, QVALUE, PEP) VALUES (";
-          insert_sql <<  ids[0] << ",";
-          insert_sql <<  ids[1] << ",";
-          insert_sql <<  feat.second[0] << ",";
-          insert_sql <<  feat.second[1] << ",";
-          insert_sql <<  feat.second[2] << "); ";
+          if (ids.size() != 2)
+          {
+            sqlite3_finalize(stmt);
+            throw Exception::ParseError(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, feat.first,
+              "Transition-level id does not consist of a feature id and a transition id separated by '_'.");
+          }
         }
         else
         {
-          insert_sql << "INSERT INTO " << table;
-          insert_sql << " (FEATURE_ID, SCORE, QVALUE, PEP) VALUES (";
-          insert_sql <<  feat.first << ",";
-          insert_sql <<  feat.second[0] << ",";
-          insert_sql <<  feat.second[1] << ",";
-          insert_sql <<  feat.second[2] << "); ";
+          ids.push_back(feat.first);
+        }
+        int pos = 1;
+        for (const auto& id : ids)
+        {
+          sqlite3_bind_text(stmt, pos++, id.c_str(), (int)id.size(), SQLITE_STATIC);
+        }
+        for (Size k = 0; k < 3; ++k)
+        {
+          sqlite3_bind_double(stmt, pos++, feat.second[k]);
         }
 
-        insert_sqls.push_back(insert_sql.str());
-      }
-
-      // Write to Sqlite database
-      SqliteConnector conn(in_osw);
-      conn.executeStatement(create_sql);
-      conn.executeStatement("BEGIN TRANSACTION");
-      for (size_t i = 0; i < insert_sqls.size(); i++)
-      {
-        conn.executeStatement(insert_sqls[i]);
+        if (sqlite3_step(stmt) != SQLITE_DONE)
+        {
+          String error = sqlite3_errmsg(db);
+          sqlite3_finalize(stmt);
+          throw Exception::IllegalArgument(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, error);
+        }
+        sqlite3_reset(stmt);
       }
+      sqlite3_finalize(stmt);
       conn.executeStatement("END TRANSACTION");
     }
 
@@ -54,6 +54,7 @@ namespace OpenMS
   {
     OpenMS::Internal::MzMLSqliteHandler sql_mass(filename);
     sql_mass.setConfig(config_.write_full_meta, config_.use_lossy_numpress, config_.linear_fp_mass_acc);
+    sql_mass.setByteShuffle(config_.use_byte_shuffle);
     sql_mass.createTables();
     sql_mass.writeExperiment(map);
   }
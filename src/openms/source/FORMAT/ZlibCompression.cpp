@@ -36,6 +36,8 @@
 
 #include <zlib.h>
 
+#include <algorithm>
+
 using namespace std;
 
 namespace OpenMS
@@ -80,15 +82,84 @@ namespace OpenMS
 
   void ZlibCompression::uncompressString(const void * tt, size_t blob_bytes, std::string& uncompressed)
   {
-    // take a leap of faith and assume the input is valid
-    QByteArray compressed_data = QByteArray::fromRawData((const char*)tt, blob_bytes);
-    QByteArray raw_data;
+    // inflate directly into the output string (no intermediate QByteArray
+    // copies), reusing its capacity if it is called repeatedly
+    uncompressed.resize(std::max(uncompressed.capacity(), 4 * blob_bytes + 64));
+
+    z_stream strm;
+    strm.zalloc = Z_NULL;
+    strm.zfree = Z_NULL;
+    strm.opaque = Z_NULL;
+    strm.next_in = reinterpret_cast<Bytef*>(const_cast<void*>(tt));
+    strm.avail_in = (uInt) blob_bytes;
+    if (inflateInit(&strm) != Z_OK)
+    {
+      throw Exception::ConversionError(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, "Decompression error?");
+    }
+
+    int zlib_error;
+    do
+    {
+      if (strm.total_out == uncompressed.size())
+      {
+        uncompressed.resize(2 * uncompressed.size());
+      }
+      strm.next_out = reinterpret_cast<Bytef*>(&uncompressed[strm.total_out]);
+      strm.avail_out = (uInt) (uncompressed.size() - strm.total_out);
+      zlib_error = inflate(&strm, Z_NO_FLUSH);
+    } while (zlib_error == Z_OK);
+
+    size_t total_out = strm.total_out;
+    inflateEnd(&strm);
+    if (zlib_error != Z_STREAM_END)
+    {
+      if (zlib_error == Z_MEM_ERROR)
+      {
+        throw Exception::OutOfMemory(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, uncompressed.size());
+      }
+      uncompressed.clear();
+      throw Exception::ConversionError(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, "Decompression error?");
+    }
+    uncompressed.resize(total_out);
+  }
+
+  void ZlibCompression::compressShuffled(const std::vector<double>& data, std::string& compressed_data)
+  {
+    const Size n = data.size();
+    const Size width = sizeof(double);
+    std::string shuffled(n * width, '\0');
+    const char* in = reinterpret_cast<const char*>(data.data());
+    for (Size b = 0; b < width; ++b)
+    {
+      char* out = &shuffled[0] + b * n;
+      for (Size i = 0; i < n; ++i)
+      {
+        out[i] = in[i * width + b];
+      }
+    }
+    compressString(shuffled, compressed_data);
+  }
 
-    ZlibCompression::uncompressString(compressed_data, raw_data);
+  void ZlibCompression::uncompressShuffled(const void * compressed_data, size_t nr_bytes, std::string& buffer, std::vector<double>& data)
+  {
+    uncompressString(compressed_data, nr_bytes, buffer);
 
-    // Note that we may have zero bytes in the string, so we cannot use QString
-    uncompressed.clear();
-    uncompressed = std::string(raw_data.data(), raw_data.size());
+    const Size width = sizeof(double);
+    if (buffer.size() % width != 0)
+    {
+      throw Exception::ConversionError(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, "Bad BufferCount?");
+    }
+    const Size n = buffer.size() / width;
+    data.resize(n);
+    char* out = reinterpret_cast<char*>(data.data());
+    for (Size b = 0; b < width; ++b)
+    {
+      const char* in = buffer.data() + b * n;
+      for (Size i = 0; i < n; ++i)
+      {
+        out[i * width + b] = in[i];
+      }
+    }
   }
 
   void ZlibCompression::uncompressString(const QByteArray& compressed_data, QByteArray& raw_data)
@@ -12,6 +12,7 @@ CachedMzML.cpp
 ChromeleonFile.cpp
 CompressedInputSource.cpp
 CVMappingFile.cpp
+ConsensusBinFile.cpp
 ConsensusXMLFile.cpp
 ControlledVocabulary.cpp
 CsvFile.cpp
@@ -20,6 +21,7 @@ DTAFile.cpp
 EDTAFile.cpp
 ExperimentalDesignFile.cpp
 FASTAFile.cpp
+FeatureBinFile.cpp
 FeatureXMLFile.cpp
 FileHandler.cpp
 FileTypes.cpp
@@ -27,6 +29,7 @@ GzipIfstream.cpp
 GzipInputStream.cpp
 HDF5Connector.cpp
 IBSpectraFile.cpp
+IdBinFile.cpp
 IdXMLFile.cpp
 IndexedMzMLFileLoader.cpp
 InspectInfile.cpp
@@ -33,6 +33,7 @@
 #include <algorithm>  // for min() and max() in VS2013
 #include <climits>
 #include <cmath>
+#include <cstdint>
 #include <iostream>
 #include <OpenMS/MATH/MISC/MSNumpress.h>
 
@@ -89,67 +90,6 @@ static double decodeFixedPoint(
 
 /////////////////////////////////////////////////////////////
 
-/**
- * Encodes the int x as a number of halfbytes in res. 
- * res_length is incremented by the number of halfbytes, 
- * which will be 1 <= n <= 9
- *
- * see header file for a detailed description of the algorithm.
- */
-static void encodeInt(
-		const unsigned int x,
-		unsigned char* res,
-		size_t *res_length	
-) {
-    // get the bit pattern of a signed int x_inp
-	unsigned int m;
-	unsigned char i, l; // numbers between 0 and 9
-
-    unsigned int mask = 0xf0000000;
-    unsigned int init = x & mask;
-
-	if (init == 0) {
-		l = 8;
-		for (i=0; i<8; i++) {
-			m = mask >> (4*i);
-			if ((x & m) != 0) {
-				l = i;
-				break;
-			}
-		}
-		res[0] = l;
-		for (i=l; i<8; i++) {
-			res[1+i-l] = static_cast<unsigned char>( x >> (4*(i-l)) );
-		}
-		*res_length += 1+8-l;
-
-	} else if (init == mask) {
-		l = 7;
-		for (i=0; i<8; i++) {
-			m = mask >> (4*i);
-			if ((x & m) != m) {
-				l = i;
-				break;
-			}
-		}
-		res[0] = l + 8;
-		for (i=l; i<8; i++) {
-			res[1+i-l] = static_cast<unsigned char>( x >> (4*(i-l)) );
-		}
-		*res_length += 1+8-l;
-
-	} else {
-		res[0] = 0;
-		for (i=0; i<8; i++) {
-			res[1+i] = static_cast<unsigned char>( x >> (4*i) );
-		}
-		*res_length += 9;
-
-	}
-}
-
-
-
 /**
  * Decodes an int from the half bytes in bp. Lossless reverse of encodeInt 
  */
@@ -209,6 +149,117 @@ static void decodeInt(
 
 
 
+/**
+ * Reads the 8 bytes starting at data into a 64 bit word, with the half bytes
+ * in stream order starting from the least significant bits (i.e. the high
+ * half byte of data[0] ends up in the lowest 4 bits).
+ */
+static inline uint64_t loadHalfBytes(
+		const unsigned char *data
+) {
+	uint64_t w = 0;
+	for (int i=0; i<8; i++) {
+		w |= static_cast<uint64_t>(data[i]) << (8*i);
+	}
+	return ((w >> 4) & 0x0F0F0F0F0F0F0F0FULL) | ((w & 0x0F0F0F0F0F0F0F0FULL) << 4);
+}
+
+
+/**
+ * Same as decodeInt, but extracts the head and all half bytes of the int
+ * from a single 64 bit word instead of half byte by half byte. Falls back to
+ * decodeInt close to the end of the data. Gives identical results.
+ */
+static inline void decodeIntFast(
+		const unsigned char *data,
+		size_t *di,
+		size_t max_di,
+		size_t *half,
+		unsigned int *res
+) {
+	if (*di + 8 > max_di) {
+		decodeInt(data, di, max_di, half, res);
+		return;
+	}
+
+	// an int takes at most 9 half bytes, plus an offset of one half byte
+	uint64_t w = loadHalfBytes(&data[*di]) >> (4 * (*half));
+	unsigned int head = static_cast<unsigned int>(w & 0xf);
+	unsigned int n = (head <= 8) ? head : head - 8;
+	unsigned int k = 8 - n; // number of half bytes stored
+	unsigned int x = static_cast<unsigned int>(
+			(w >> 4) & ((static_cast<uint64_t>(1) << (4*k)) - 1)
+		);
+	if (head > 8) { // leading ones
+		x |= static_cast<unsigned int>(0xFFFFFFFFULL << (4*k));
+	}
+	*res = x;
+
+	size_t pos = 2 * (*di) + (*half) + 1 + k;
+	*di = pos / 2;
+	*half = pos % 2;
+}
+
+
+/**
+ * Encodes the int x as a number of halfbytes (1 <= n <= 9), which are
+ * appended to the half byte stream in acc (holding acc_count half bytes, in
+ * stream order starting from the least significant bits). All completed
+ * bytes are written to result and ri is incremented accordingly.
+ *
+ * see header file for a detailed description of the algorithm.
+ */
+static inline void encodeInt(
+		const unsigned int x,
+		unsigned char *result,
+		size_t *ri,
+		uint64_t *acc,
+		size_t *acc_count
+) {
+	unsigned int m;
+	unsigned int i, l;
+	unsigned int mask = 0xf0000000;
+	unsigned int init = x & mask;
+	uint64_t code;
+
+	if (init == 0) {
+		l = 8;
+		for (i=0; i<8; i++) {
+			m = mask >> (4*i);
+			if ((x & m) != 0) {
+				l = i;
+				break;
+			}
+		}
+		code = l;
+	} else if (init == mask) {
+		l = 7;
+		for (i=0; i<8; i++) {
+			m = mask >> (4*i);
+			if ((x & m) != m) {
+				l = i;
+				break;
+			}
+		}
+		code = l + 8;
+	} else {
+		l = 0;
+		code = 0;
+	}
+	// head half byte followed by the 8-l low half bytes of x
+	code |= (static_cast<uint64_t>(x) & ((static_cast<uint64_t>(1) << (4*(8-l))) - 1)) << 4;
+
+	*acc |= code << (4 * (*acc_count));
+	*acc_count += 1+8-l;
+	while (*acc_count >= 2) {
+		result[(*ri)++] = static_cast<unsigned char>(((*acc & 0xf) << 4) | ((*acc >> 4) & 0xf));
+		*acc >>= 8;
+		*acc_count -= 2;
+	}
+}
+
+
+
 /////////////////////////////////////////////////////////////
 
 double optimalLinearFixedPointMass(
@@ -276,9 +327,8 @@ size_t encodeLinear(
 ) {
 	long long ints[3];
 	size_t i, ri;
-	unsigned char halfBytes[10];
+	uint64_t halfBytes;
 	size_t halfByteCount;
-	size_t hbi;
 	long long extrapol;
 	int diff;
 
@@ -300,6 +350,7 @@ size_t encodeLinear(
 		result[12+i] = (ints[2] >> (i*8)) & 0xff;
 	}
 
+	halfBytes = 0;
 	halfByteCount = 0;
 	ri = 16;
 
@@ -324,34 +375,14 @@ size_t encodeLinear(
 		//printf("%lu %lu %lu,   extrapol: %ld    diff: %d \n", ints[0], ints[1], ints[2], extrapol, diff);
 		encodeInt(
 				static_cast<unsigned int>(diff), 
-				&halfBytes[halfByteCount], 
+				result,
+				&ri,
+				&halfBytes, 
 				&halfByteCount
 			);
-		/*
-		printf("%d (%d):  ", diff, (int)halfByteCount);
-		for (size_t j=0; j<halfByteCount; j++) {
-			printf("%x ", halfBytes[j] & 0xf);
-		}
-		printf("\n");
-		*/
-		
-		
-		for (hbi=1; hbi < halfByteCount; hbi+=2) {
-			result[ri] = static_cast<unsigned char>(
-					(halfBytes[hbi-1] << 4) | (halfBytes[hbi] & 0xf)
-				);
-			//printf("%x \n", result[ri]);
-			ri++;
-		}
-		if (halfByteCount % 2 != 0) {
-			halfBytes[0] = halfBytes[halfByteCount-1];
-			halfByteCount = 1;
-		} else {
-			halfByteCount = 0;
-		}
 	}
 	if (halfByteCount == 1) {
-		result[ri] = static_cast<unsigned char>(halfBytes[0] << 4);
+		result[ri] = static_cast<unsigned char>((halfBytes & 0xf) << 4);
 		ri++;
 	}
 	return ri;
@@ -421,7 +452,7 @@ size_t decodeLinear(
 		
 		ints[0] = ints[1];
 		ints[1] = ints[2];
-		decodeInt(data, &di, dataSize, &half, &buff);
+		decodeIntFast(data, &di, dataSize, &half, &buff);
 		diff = static_cast<int>(buff);
 
 		extrapol = ints[1] + (ints[1] - ints[0]);
@@ -573,12 +604,12 @@ size_t encodePic(
 ) {
 	size_t i, ri;
 	unsigned int x;
-	unsigned char halfBytes[10];
+	uint64_t halfBytes;
 	size_t halfByteCount;
-	size_t hbi;
 
 	//printf("Encoding %d doubles\n", (int)dataSize);
 
+	halfBytes = 0;
 	halfByteCount = 0;
 	ri = 0;
 
@@ -590,24 +621,10 @@ size_t encodePic(
 		}
 		x = static_cast<unsigned int>(data[i] + 0.5);
 		//printf("%d %d %d,   extrapol: %d    diff: %d \n", ints[0], ints[1], ints[2], extrapol, diff);
-		encodeInt(x, &halfBytes[halfByteCount], &halfByteCount);
-		
-		for (hbi=1; hbi < halfByteCount; hbi+=2) {
-			result[ri] = static_cast<unsigned char>(
-					(halfBytes[hbi-1] << 4) | (halfBytes[hbi] & 0xf)
-				);
-			//printf("%x \n", result[ri]);
-			ri++;
-		}
-		if (halfByteCount % 2 != 0) {
-			halfBytes[0] = halfBytes[halfByteCount-1];
-			halfByteCount = 1;
-		} else {
-			halfByteCount = 0;
-		}
+		encodeInt(x, result, &ri, &halfBytes, &halfByteCount);
 	}
 	if (halfByteCount == 1) {
-		result[ri] = static_cast<unsigned char>(halfBytes[0] << 4);
+		result[ri] = static_cast<unsigned char>((halfBytes & 0xf) << 4);
 		ri++;
 	}
 	return ri;
@@ -638,7 +655,7 @@ size_t decodePic(
 			}
 		}
 		
-		decodeInt(&data[0], &di, dataSize, &half, &x);
+		decodeIntFast(&data[0], &di, dataSize, &half, &x);
 		
 		//printf("%7d %7d %7d %7d %7d\n", ri, di, half, dataSize, count);
 		
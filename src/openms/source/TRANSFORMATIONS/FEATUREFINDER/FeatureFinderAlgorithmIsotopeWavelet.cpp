@@ -36,6 +36,10 @@
 
 #include <OpenMS/TRANSFORMATIONS/FEATUREFINDER/IsotopeWaveletTransform.h>
 
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
 namespace OpenMS
 {
   FeatureFinderAlgorithmIsotopeWavelet::FeatureFinderAlgorithmIsotopeWavelet()
@@ -178,74 +182,109 @@ namespace OpenMS
     this->ff_->startProgress(0, 2 * this->map_->size() * max_charge_, "analyzing spectra");
 
     IsotopeWaveletTransform<PeakType>* iwt = new IsotopeWaveletTransform<PeakType>(min_mz, max_mz, max_charge_, max_size, hr_data_, intensity_type_);
-    for (UInt i = 0; i < this->map_->size(); ++i)
-    {
-      const MSSpectrum& c_ref((*this->map_)[i]);
 
-#ifdef OPENMS_DEBUG_ISOTOPE_WAVELET
-      std::cout << ::std::fixed << ::std::setprecision(6) << "Spectrum " << i + 1 << " (" << (*this->map_)[i].getRT() << ") of " << this->map_->size() << " ... ";
-      std::cout.flush();
+    //The spectra are processed in blocks of one spectrum per thread. The transforms (of all charge states) of a block are computed
+    //in parallel, each thread using its own IsotopeWaveletTransform (initializeScan() sets up scan-specific parameters of the
+    //transform). The charge recognition and the update of the boxes depend on the preceding scans and are hence carried out
+    //sequentially afterwards. Keeping the blocks small bounds the memory needed for the (high resolution) spectra of a block.
+#ifdef _OPENMP
+    const UInt block_size = std::max(1, omp_get_max_threads());
+#else
+    const UInt block_size = 1;
 #endif
+    for (UInt block_begin = 0; block_begin < this->map_->size(); block_begin += block_size)
+    {
+      UInt block_end = std::min(block_begin + block_size, (UInt) this->map_->size());
+
+      //HighRes data only: one zero-interpolated spectrum for each spectrum of the block, shared by all charge states
+      std::vector<MSSpectrum> refs(hr_data_ ? block_end - block_begin : 0);
+      //one entry for each spectrum of the block and each charge state (in this order)
+      std::vector<MSSpectrum> transforms((block_end - block_begin) * max_charge_);
 
-      if (c_ref.size() <= 1)                 //unable to do transform anything
+#ifdef _OPENMP
+#pragma omp parallel
+#endif
       {
-#ifdef OPENMS_DEBUG_ISOTOPE_WAVELET
-        std::cout << "scan empty or consisting of a single data point. Skipping." << std::endl;
+        IsotopeWaveletTransform<PeakType> local_iwt(min_mz, max_mz, max_charge_, max_size, hr_data_, intensity_type_);
+
+        if (hr_data_)
+        {
+#ifdef _OPENMP
+#pragma omp for schedule(dynamic, 1)
 #endif
-        this->ff_->setProgress(progress_counter_ += 2);
-        continue;
-      }
+          for (SignedSize j = 0; j < (SignedSize) refs.size(); ++j)
+          {
+            if ((*this->map_)[block_begin + j].size() <= 1) //unable to do transform anything
+            {
+              continue;
+            }
+            MSSpectrum* new_spec = createHRData(block_begin + j);
+            refs[j] = *new_spec;
+            delete (new_spec); new_spec = nullptr;
+          }
+          //(implicit barrier: all spectra of the block are interpolated before the transforms start)
+        }
 
-      if (!hr_data_)                   //LowRes data
-      {
-        iwt->initializeScan((*this->map_)[i]);
-        for (UInt c = 0; c < max_charge_; ++c)
+#ifdef _OPENMP
+#pragma omp for schedule(dynamic, 1)
+#endif
+        for (SignedSize k = 0; k < (SignedSize) transforms.size(); ++k)
         {
-          MSSpectrum c_trans(c_ref);
+          UInt i = block_begin + k / max_charge_, c = k % max_charge_;
+          const MSSpectrum& c_ref((*this->map_)[i]);
 
-          iwt->getTransform(c_trans, c_ref, c);
+          if (c_ref.size() <= 1) //unable to do transform anything
+          {
+            continue;
+          }
 
-#ifdef OPENMS_DEBUG_ISOTOPE_WAVELET
-          std::stringstream stream;
-          stream << "cpu_lowres_" << c_ref.getRT() << "_" << c + 1 << ".trans\0";
-          std::ofstream ofile(stream.str().c_str());
-          for (UInt k = 0; k < c_ref.size(); ++k)
+          if (!hr_data_) //LowRes data
           {
-            ofile << ::std::setprecision(8) << std::fixed << c_trans[k].getMZ() << "\t" << c_trans[k].getIntensity() << "\t" << c_ref[k].getIntensity() << std::endl;
+            local_iwt.initializeScan(c_ref);
+            transforms[k] = c_ref;
+            local_iwt.getTransform(transforms[k], c_ref, c);
           }
-          ofile.close();
-#endif
+          else //HighRes data
+          {
+            const MSSpectrum& ref(refs[i - block_begin]);
+            local_iwt.initializeScan(ref, c);
+            transforms[k] = ref;
+            local_iwt.getTransformHighRes(transforms[k], ref, c);
+          }
+        }
+      }
+
+      for (UInt i = block_begin; i < block_end; ++i)
+      {
+        const MSSpectrum& c_ref((*this->map_)[i]);
 
 #ifdef OPENMS_DEBUG_ISOTOPE_WAVELET
-          std::cout << "transform O.K. ... "; std::cout.flush();
+        std::cout << ::std::fixed << ::std::setprecision(6) << "Spectrum " << i + 1 << " (" << (*this->map_)[i].getRT() << ") of " << this->map_->size() << " ... ";
+        std::cout.flush();
 #endif
-          this->ff_->setProgress(++progress_counter_);
-
-          iwt->identifyCharge(c_trans, c_ref, i, c, intensity_threshold_, check_PPMs_);
 
+        if (c_ref.size() <= 1)                 //unable to do transform anything
+        {
 #ifdef OPENMS_DEBUG_ISOTOPE_WAVELET
-          std::cout << "charge recognition O.K. ... "; std::cout.flush();
+          std::cout << "scan empty or consisting of a single data point. Skipping." << std::endl;
 #endif
-          this->ff_->setProgress(++progress_counter_);
+          this->ff_->setProgress(progress_counter_ += 2);
+          continue;
         }
-      }
-      else                   //HighRes data
-      {
+
         for (UInt c = 0; c < max_charge_; ++c)
         {
-          MSSpectrum* new_spec = createHRData(i);
-          iwt->initializeScan(*new_spec, c);
-          MSSpectrum c_trans(*new_spec);
-
-          iwt->getTransformHighRes(c_trans, *new_spec, c);
+          Size k = (i - block_begin) * max_charge_ + c;
+          const MSSpectrum& c_trans(transforms[k]);
+          const MSSpectrum& ref(hr_data_ ? refs[i - block_begin] : c_ref);
 
 #ifdef OPENMS_DEBUG_ISOTOPE_WAVELET
           std::stringstream stream;
-          stream << "cpu_highres_" << new_spec->getRT() << "_" << c + 1 << ".trans\0";
+          stream << (hr_data_ ? "cpu_highres_" : "cpu_lowres_") << ref.getRT() << "_" << c + 1 << ".trans\0";
           std::ofstream ofile(stream.str().c_str());
-          for (UInt k = 0; k < new_spec->size(); ++k)
+          for (UInt j = 0; j < ref.size(); ++j)
           {
-            ofile << ::std::setprecision(8) << std::fixed << c_trans[k].getMZ() << "\t" << c_trans[k].getIntensity() << "\t" << (*new_spec)[k].getIntensity() << std::endl;
+            ofile << ::std::setprecision(8) << std::fixed << c_trans[j].getMZ() << "\t" << c_trans[j].getIntensity() << "\t" << ref[j].getIntensity() << std::endl;
           }
           ofile.close();
 #endif
@@ -255,24 +294,21 @@ namespace OpenMS
 #endif
           this->ff_->setProgress(++progress_counter_);
 
-          iwt->identifyCharge(c_trans, *new_spec, i, c, intensity_threshold_, check_PPMs_);
+          iwt->identifyCharge(c_trans, ref, i, c, intensity_threshold_, check_PPMs_);
 
 #ifdef OPENMS_DEBUG_ISOTOPE_WAVELET
           std::cout << "charge recognition O.K. ... "; std::cout.flush();
 #endif
           this->ff_->setProgress(++progress_counter_);
-
-          delete (new_spec); new_spec = nullptr;
         }
-      }
 
-
-      iwt->updateBoxStates(*this->map_, i, RT_interleave_, real_RT_votes_cutoff_);
+        iwt->updateBoxStates(*this->map_, i, RT_interleave_, real_RT_votes_cutoff_);
 #ifdef OPENMS_DEBUG_ISOTOPE_WAVELET
-      std::cout << "updated box states." << std::endl;
+        std::cout << "updated box states." << std::endl;
 #endif
 
-      std::cout.flush();
+        std::cout.flush();
+      }
     }
 
     this->ff_->endProgress();
@@ -39,6 +39,7 @@
 #include <OpenMS/TRANSFORMATIONS/FEATUREFINDER/TraceFitter.h>
 
 #include <OpenMS/ANALYSIS/OPENSWATH/ChromatogramExtractor.h>
+#include <OpenMS/ANALYSIS/OPENSWATH/DATAACCESS/DataAccessHelper.h>
 #include <OpenMS/ANALYSIS/OPENSWATH/DATAACCESS/SimpleOpenMSSpectraAccessFactory.h>
 #include <OpenMS/ANALYSIS/SVM/SimpleSVM.h>
 #include <OpenMS/ANALYSIS/MAPMATCHING/MapAlignmentAlgorithmIdentification.h>
@@ -52,6 +53,7 @@
 #include <numeric>
 #include <fstream>
 #include <algorithm>
+#include <exception>
 
 #ifdef _OPENMP
 #include <omp.h>
@@ -350,7 +352,7 @@ namespace OpenMS
     {
       // Warning: this step is pretty inefficient, since it does the whole library generation twice
       // Really use for debug only
-      createAssayLibrary_(peptide_map_.begin(), peptide_map_.end(), ref_rt_map);
+      createAssayLibrary_(peptide_map_.begin(), peptide_map_.end(), ref_rt_map, library_, isotope_probs_);
       cout << "Writing debug.traml file." << endl;
       TraMLFile().store("debug.traml", library_);
       ref_rt_map.clear();
@@ -361,37 +363,100 @@ namespace OpenMS
     // run feature detection
     //-------------------------------------------------------------
     OPENMS_LOG_DEBUG << "Extracting chromatograms..." << endl;
-    for (auto& chunk : chunks)
+    // suppress status output from OpenSWATH, unless in debug mode:
+    if (debug_level_ < 1) OpenMS_Log_info.remove(cout);
+    // the assays of a batch are generated by the thread that processes it and
+    // freed after the extraction (only the assays of the running batches are
+    // in memory); results are collected per batch and merged in batch order
+    // below, so the output does not depend on the number of threads:
+    vector<FeatureMap> batch_features(chunks.size());
+    vector<PeptideRefRTMap> batch_ref_rt_maps(chunks.size());
+    vector<map<String, double> > batch_isotope_probs(chunks.size());
+    std::exception_ptr error;
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic, 1)
+#endif
+    for (SignedSize i = 0; i < SignedSize(chunks.size()); ++i)
     {
-      createAssayLibrary_(chunk.first, chunk.second, ref_rt_map);
-
-      ChromatogramExtractor extractor;
-      // extractor.setLogType(ProgressLogger::NONE);
+      try
       {
-        vector<OpenSwath::ChromatogramPtr> chrom_temp;
-        vector<ChromatogramExtractor::ExtractionCoordinates> coords;
-        // take entries in library_ and put to chrom_temp and coords
-        extractor.prepare_coordinates(chrom_temp, coords, library_,
-                                      numeric_limits<double>::quiet_NaN(), false);
-
-
-        extractor.extractChromatograms(spec_temp, chrom_temp, coords, mz_window_,
-                                       mz_window_ppm_, "tophat");
-        extractor.return_chromatogram(chrom_temp, coords, library_, (*shared)[0],
-                                      chrom_data_.getChromatograms(), false);
+        // the batches cover disjoint sets of peptides, so they can be processed independently:
+        TargetedExperiment batch_assays;
+        createAssayLibrary_(chunks[i].first, chunks[i].second, batch_ref_rt_maps[i],
+                            batch_assays, batch_isotope_probs[i]);
+        OpenSwath::LightTargetedExperiment batch_library;
+        OpenSwathDataAccessHelper::convertTargetedExp(batch_assays, batch_library);
+
+        ChromatogramExtractor extractor;
+#ifdef _OPENMP
+        if (omp_get_num_threads() > 1) extractor.setLogType(ProgressLogger::NONE);
+#endif
+        boost::shared_ptr<PeakMap> chrom_data = boost::make_shared<PeakMap>();
+        {
+          vector<OpenSwath::ChromatogramPtr> chrom_temp;
+          vector<ChromatogramExtractor::ExtractionCoordinates> coords;
+          // take entries in the batch library and put to chrom_temp and coords
+          extractor.prepare_coordinates(chrom_temp, coords, batch_assays,
+                                        numeric_limits<double>::quiet_NaN(), false);
+
+          extractor.extractChromatograms(spec_temp->lightClone(), chrom_temp,
+                                         coords, mz_window_, mz_window_ppm_,
+                                         "tophat");
+          extractor.return_chromatogram(chrom_temp, coords, batch_assays,
+                                        (*shared)[0],
+                                        chrom_data->getChromatograms(), false);
+        }
+        batch_assays.clear(true); // not needed anymore
+
+        OPENMS_LOG_DEBUG << "Extracted " << chrom_data->getNrChromatograms()
+                         << " chromatogram(s)." << endl;
+
+        OPENMS_LOG_DEBUG << "Detecting chromatographic peaks..." << endl;
+        // each batch gets its own feature finder (it keeps per-run state):
+        MRMFeatureFinderScoring feat_finder;
+        feat_finder.setParameters(feat_finder_.getParameters());
+        feat_finder.setLogType(ProgressLogger::NONE);
+        feat_finder.setStrictFlag(false);
+        OpenSwath::SwathMap swath_map;
+        swath_map.sptr = spec_temp->lightClone();
+        MRMFeatureFinderScoring::TransitionGroupMapType transition_group_map;
+        feat_finder.pickExperiment(
+          SimpleOpenMSSpectraFactory::getSpectrumAccessOpenMSPtr(chrom_data),
+          batch_features[i], batch_library, TransformationDescription(),
+          vector<OpenSwath::SwathMap>(1, swath_map), transition_group_map);
       }
+      catch (...)
+      {
+#ifdef _OPENMP
+#pragma omp critical (FeatureFinderIdentificationAlgorithm_error)
+#endif
+        if (!error) error = std::current_exception();
+      }
+    }
+    if (debug_level_ < 1) OpenMS_Log_info.insert(cout); // revert logging change
+    if (error) std::rethrow_exception(error);
 
-      OPENMS_LOG_DEBUG << "Extracted " << chrom_data_.getNrChromatograms()
-                       << " chromatogram(s)." << endl;
+    for (Size i = 0; i < chunks.size(); ++i)
+    {
+      ref_rt_map.insert(batch_ref_rt_maps[i].begin(), batch_ref_rt_maps[i].end());
+      isotope_probs_.insert(batch_isotope_probs[i].begin(), batch_isotope_probs[i].end());
+    }
+    batch_ref_rt_maps.clear();
+    batch_isotope_probs.clear();
 
-      OPENMS_LOG_DEBUG << "Detecting chromatographic peaks..." << endl;
-      // suppress status output from OpenSWATH, unless in debug mode:
-      if (debug_level_ < 1) OpenMS_Log_info.remove(cout);
-      feat_finder_.pickExperiment(chrom_data_, features, library_,
-                                  TransformationDescription(), ms_data_);
-      if (debug_level_ < 1) OpenMS_Log_info.insert(cout); // revert logging change
-      chrom_data_.clear(true);
-      library_.clear(true);
+    for (FeatureMap& batch : batch_features)
+    {
+      for (Feature& feature : batch)
+      {
+        // IDs were assigned in a thread-dependent order, renew them:
+        feature.applyMemberFunction(&UniqueIdInterface::setUniqueId);
+        features.push_back(feature);
+      }
+      features.getProteinIdentifications().insert(
+        features.getProteinIdentifications().end(),
+        batch.getProteinIdentifications().begin(),
+        batch.getProteinIdentifications().end());
+      batch.clear(true);
     }
 
     OPENMS_LOG_INFO << "Found " << features.size() << " feature candidates in total."
@@ -604,7 +669,8 @@ namespace OpenMS
 
   }
 
-  void FeatureFinderIdentificationAlgorithm::createAssayLibrary_(const PeptideMap::iterator& begin, const PeptideMap::iterator& end, PeptideRefRTMap& ref_rt_map)
+  void FeatureFinderIdentificationAlgorithm::createAssayLibrary_(const PeptideMap::iterator& begin, const PeptideMap::iterator& end, PeptideRefRTMap& ref_rt_map,
+    TargetedExperiment& library, std::map<String, double>& isotope_probs) const
   {
     std::set<String> protein_accessions;
 
@@ -705,8 +771,8 @@ namespace OpenMS
               peptide.rts.clear();
               addPeptideRT_(peptide, reg_it->start);
               addPeptideRT_(peptide, reg_it->end);
-              library_.addPeptide(peptide);
-              generateTransitions_(peptide.id, mz, charge, iso_dist);
+              library.addPeptide(peptide);
+              generateTransitions_(peptide.id, mz, charge, iso_dist, library, isotope_probs);
             }
             internal_ids.insert(reg_it->ids[charge].first.begin(),
                                 reg_it->ids[charge].first.end());
@@ -758,8 +824,8 @@ namespace OpenMS
               peptide.rts.clear();
               addPeptideRT_(peptide, reg_it->start);
               addPeptideRT_(peptide, reg_it->end);
-              library_.addPeptide(peptide);
-              generateTransitions_(peptide.id, mz, charge, iso_dist);
+              library.addPeptide(peptide);
+              generateTransitions_(peptide.id, mz, charge, iso_dist, library, isotope_probs);
             }
             internal_ids.insert(reg_it->ids[charge].first.begin(),
                                 reg_it->ids[charge].first.end());
@@ -774,7 +840,7 @@ namespace OpenMS
     {
       TargetedExperiment::Protein protein;
       protein.id = acc;
-      library_.addProtein(protein);
+      library.addProtein(protein);
     }
   }
 
@@ -858,7 +924,9 @@ namespace OpenMS
     const String& peptide_id, 
     double mz, 
     Int charge,
-    const IsotopeDistribution& iso_dist)
+    const IsotopeDistribution& iso_dist,
+    TargetedExperiment& library,
+    std::map<String, double>& isotope_probs) const
   {
     // go through different isotopes:
     Size counter = 0;
@@ -876,8 +944,8 @@ namespace OpenMS
       transition.setLibraryIntensity(iso_it->getIntensity());
       transition.setMetaValue("annotation", annotation);
       transition.setPeptideRef(peptide_id);
-      library_.addTransition(transition);
-      isotope_probs_[transition_name] = iso_it->getIntensity();
+      library.addTransition(transition);
+      isotope_probs[transition_name] = iso_it->getIntensity();
     }
   }
 
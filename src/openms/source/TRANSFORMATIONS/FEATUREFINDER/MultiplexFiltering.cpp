@@ -86,6 +86,7 @@ namespace OpenMS
       std::vector<int> blacklist_spectrum(it_rt.size(), -1);
       blacklist_.push_back(blacklist_spectrum);
     }
+    blacklist_changes_.resize(exp_centroided_.getNrSpectra());
     
   }
   
@@ -123,6 +124,9 @@ namespace OpenMS
       exp_centroided_mapping_.push_back(mapping_spectrum);
     }
     exp_centroided_white_.updateRanges();
+
+    // The white experiment reflects the current blacklist. Keep track of changes from here on.
+    blacklist_changes_.assign(exp_centroided_.size(), std::vector<double>());
   }
   
   int MultiplexFiltering::checkForSignificantPeak_(double mz, double mz_tolerance, MSExperiment::ConstIterator& it_rt, double intensity_first_peak) const
@@ -323,6 +327,45 @@ namespace OpenMS
     return true;
   }
   
+  bool MultiplexFiltering::blacklistChanged_(double mz, const MSExperiment::ConstIterator& it_rt_begin, const MSExperiment::ConstIterator& it_rt_band_begin, const MSExperiment::ConstIterator& it_rt_band_end, const MultiplexIsotopicPeakPattern& pattern) const
+  {
+    // determine absolute m/z tolerance in Th (as in filterPeakPositions_())
+    double mz_tolerance;
+    if (mz_tolerance_unit_in_ppm_)
+    {
+      mz_tolerance = mz * mz_tolerance_ * 1e-6;
+    }
+    else
+    {
+      mz_tolerance = mz_tolerance_;
+    }
+    
+    // m/z range covered by the pattern (including the primary peak itself)
+    // Satellites lie within the m/z tolerance of their expected position. We allow for twice that margin.
+    double mz_min = mz;
+    double mz_max = mz;
+    for (size_t i = 0; i < pattern.getMZShiftCount(); ++i)
+    {
+      mz_min = std::min(mz_min, mz + pattern.getMZShiftAt(i));
+      mz_max = std::max(mz_max, mz + pattern.getMZShiftAt(i));
+    }
+    mz_min -= 2 * mz_tolerance;
+    mz_max += 2 * mz_tolerance;
+    
+    // loop over spectra in RT band
+    for (MSExperiment::ConstIterator it_rt = it_rt_band_begin; it_rt < it_rt_band_end; ++it_rt)
+    {
+      const std::vector<double>& changes = blacklist_changes_[it_rt - it_rt_begin];
+      std::vector<double>::const_iterator it_change = std::lower_bound(changes.begin(), changes.end(), mz_min);
+      if ((it_change != changes.end()) && (*it_change <= mz_max))
+      {
+        return true;
+      }
+    }
+    
+    return false;
+  }
+  
   void MultiplexFiltering::blacklistPeak_(const MultiplexFilteredPeak& peak, unsigned pattern_idx)
   {
     // determine absolute m/z tolerance in Th
@@ -392,6 +435,11 @@ namespace OpenMS
         {
           // blacklist entries: -1 = white, any isotope pattern index (it.first) = black
           blacklist_[it_rt - exp_centroided_.begin()][idx_mz] = it.first;
+          
+          // keep track of the change
+          std::vector<double>& changes = blacklist_changes_[it_rt - exp_centroided_.begin()];
+          double mz_blacklisted = (*it_rt)[idx_mz].getMZ();
+          changes.insert(std::lower_bound(changes.begin(), changes.end(), mz_blacklisted), mz_blacklisted);
         }
       }
       
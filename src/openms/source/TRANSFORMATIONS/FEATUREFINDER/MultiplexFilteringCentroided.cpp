@@ -65,6 +65,22 @@ namespace OpenMS
     unsigned int start = clock();
 #endif
 
+    // apply all filters to a single peak of the white experiment
+    auto filterPeak = [this](const MSSpectrum::ConstIterator& it_mz, const MSExperiment::ConstIterator& it_rt_band_begin, const MSExperiment::ConstIterator& it_rt_band_end, const MultiplexIsotopicPeakPattern& pattern, MultiplexFilteredPeak& peak)
+    {
+      if (!(filterPeakPositions_(it_mz, exp_centroided_white_.begin(), it_rt_band_begin, it_rt_band_end, pattern, peak)))
+      {
+        return false;
+      }
+      
+      if (!(filterAveragineModel_(pattern, peak)))
+      {
+        return false;
+      }
+      
+      return filterPeptideCorrelation_(pattern, peak);
+    };
+
     // loop over all patterns
     for (unsigned pattern_idx = 0; pattern_idx < patterns_.size(); ++pattern_idx)
     {
@@ -76,8 +92,36 @@ namespace OpenMS
   
       // update white experiment
       updateWhiteMSExperiment_();
-  
-      // filter (white) experiment
+      
+      // First, filter all peaks of the (white) experiment in parallel against the current blacklist.
+      // The peaks which pass all filters are stored per spectrum, together with their m/z index.
+      std::vector<std::vector<std::pair<size_t, MultiplexFilteredPeak> > > candidates(exp_centroided_white_.size());
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic)
+#endif
+      for (SignedSize idx_rt = 0; idx_rt < (SignedSize) exp_centroided_white_.size(); ++idx_rt)
+      {
+        const MSSpectrum& spectrum = exp_centroided_white_[idx_rt];
+        double rt = spectrum.getRT();
+        
+        MSExperiment::ConstIterator it_rt_band_begin = exp_centroided_white_.RTBegin(rt - rt_band_/2);
+        MSExperiment::ConstIterator it_rt_band_end = exp_centroided_white_.RTEnd(rt + rt_band_/2);
+        
+        // loop over m/z
+        for (MSSpectrum::ConstIterator it_mz = spectrum.begin(); it_mz != spectrum.end(); ++it_mz)
+        {
+          size_t idx_mz = it_mz - spectrum.begin();
+          MultiplexFilteredPeak peak(it_mz->getMZ(), rt, exp_centroided_mapping_[idx_rt].at(idx_mz), idx_rt);
+          
+          if (filterPeak(it_mz, it_rt_band_begin, it_rt_band_end, pattern, peak))
+          {
+            candidates[idx_rt].push_back(std::make_pair(idx_mz, peak));
+          }
+        }
+      }
+      
+      // Second, accept and blacklist the peaks in their original order. The blacklisting of a peak may change the
+      // filter result of subsequent peaks close by. These peaks are filtered again against the updated blacklist.
       // loop over spectra
       for (const auto &it_rt : exp_centroided_white_)
       {
@@ -95,33 +139,43 @@ namespace OpenMS
         MSExperiment::ConstIterator it_rt_band_begin = exp_centroided_white_.RTBegin(rt - rt_band_/2);
         MSExperiment::ConstIterator it_rt_band_end = exp_centroided_white_.RTEnd(rt + rt_band_/2);
         
+        std::vector<std::pair<size_t, MultiplexFilteredPeak> >::const_iterator it_candidate = candidates[idx_rt].begin();
+        
         // loop over m/z
         for (MSSpectrum::ConstIterator it_mz = it_rt.begin(); it_mz != it_rt.end(); ++it_mz)
         {
           double mz = it_mz->getMZ();
-          MultiplexFilteredPeak peak(mz, rt, exp_centroided_mapping_[idx_rt][it_mz - it_rt.begin()], idx_rt);
+          size_t idx_mz = it_mz - it_rt.begin();
+          bool is_candidate = (it_candidate != candidates[idx_rt].end()) && (it_candidate->first == idx_mz);
           
-          if (!(filterPeakPositions_(it_mz, exp_centroided_white_.begin(), it_rt_band_begin, it_rt_band_end, pattern, peak)))
+          if (blacklistChanged_(mz, exp_centroided_white_.begin(), it_rt_band_begin, it_rt_band_end, pattern))
           {
-            continue;
+            MultiplexFilteredPeak peak(mz, rt, exp_centroided_mapping_[idx_rt][idx_mz], idx_rt);
+            
+            if (filterPeak(it_mz, it_rt_band_begin, it_rt_band_end, pattern, peak))
+            {
+              /**
+               * All filters passed.
+               */
+              
+              result.addPeak(peak);
+              blacklistPeak_(peak, pattern_idx);
+            }
           }
-          
-          if (!(filterAveragineModel_(pattern, peak)))
+          else if (is_candidate)
           {
-            continue;
+            /**
+             * All filters passed.
+             */
+            
+            result.addPeak(it_candidate->second);
+            blacklistPeak_(it_candidate->second, pattern_idx);
           }
-
-          if (!(filterPeptideCorrelation_(pattern, peak)))
+          
+          if (is_candidate)
           {
-            continue;
+            ++it_candidate;
           }
-          
-          /**
-           * All filters passed.
-           */
-
-          result.addPeak(peak);
-          blacklistPeak_(peak, pattern_idx);
         }
       }
       
@@ -137,6 +137,82 @@ namespace OpenMS
       navigators.push_back(nav);
     }
     
+    // apply all filters to a single peak of the white experiment
+    // (The navigators are passed explicitly since they are not thread-safe.)
+    auto filterPeak = [this](const MSSpectrum::ConstIterator& it_mz, const MSExperiment::ConstIterator& it_rt_picked_band_begin, const MSExperiment::ConstIterator& it_rt_picked_band_end, const MultiplexIsotopicPeakPattern& pattern, std::vector<SplineInterpolatedPeaks::Navigator>& navigators, MultiplexFilteredPeak& peak)
+    {
+      if (!(filterPeakPositions_(it_mz, exp_centroided_white_.begin(), it_rt_picked_band_begin, it_rt_picked_band_end, pattern, peak)))
+      {
+        return false;
+      }
+      
+      size_t idx_rt = peak.getRTidx();
+      size_t mz_idx = peak.getMZidx();
+      double peak_min = boundaries_[idx_rt][mz_idx].mz_min;
+      double peak_max = boundaries_[idx_rt][mz_idx].mz_max;
+      
+      //double rt_peak = peak.getRT();
+      double mz_peak = peak.getMZ();
+
+      std::multimap<size_t, MultiplexSatelliteCentroided > satellites = peak.getSatellites();
+      
+      // Arrangement of peaks looks promising. Now scan through the spline fitted profile data around the peak i.e. from peak boundary to peak boundary.
+      for (double mz_profile = peak_min; mz_profile < peak_max; mz_profile = navigators[idx_rt].getNextPos(mz_profile))
+      {
+        // determine m/z shift relative to the centroided peak at which the profile data will be sampled
+        double mz_shift = mz_profile - mz_peak;
+
+        std::multimap<size_t, MultiplexSatelliteProfile > satellites_profile;
+
+        // construct the set of spline-interpolated satellites for this specific mz_profile
+        for (const auto &satellite_it : satellites)
+        {
+          // find indices of the peak
+          size_t rt_idx = (satellite_it.second).getRTidx();
+          size_t mz_idx = (satellite_it.second).getMZidx();
+          
+          // find peak itself
+          MSExperiment::ConstIterator it_rt = exp_centroided_.begin();
+          std::advance(it_rt, rt_idx);
+          MSSpectrum::ConstIterator it_mz = it_rt->begin();
+          std::advance(it_mz, mz_idx);
+          
+          double rt_satellite = it_rt->getRT();
+          double mz_satellite = it_mz->getMZ();
+          
+          // determine m/z and corresponding intensity
+          double mz = mz_satellite + mz_shift;
+          double intensity = navigators[rt_idx].eval(mz);
+          
+          satellites_profile.insert(std::make_pair(satellite_it.first, MultiplexSatelliteProfile(rt_satellite, mz, intensity)));
+        }
+        
+        if (!(filterAveragineModel_(pattern, peak, satellites_profile)))
+        {
+          continue;
+        }
+        
+        if (!(filterPeptideCorrelation_(pattern, satellites_profile)))
+        {
+          continue;
+        }
+        
+        /**
+         * All filters passed.
+         */
+        
+        // add the satellite data points to the peak
+        for (const auto &it : satellites_profile)
+        {
+          peak.addSatelliteProfile(it.second, it.first);
+        }
+        
+      }
+      
+      // If some satellite data points passed all filters, we can add the peak to the filter result.
+      return (peak.sizeProfile() > 0);
+    };
+    
     // loop over all patterns
     for (unsigned pattern_idx = 0; pattern_idx < patterns_.size(); ++pattern_idx)
     {
@@ -149,6 +225,49 @@ namespace OpenMS
       // update white experiment
       updateWhiteMSExperiment_();
       
+      // First, filter all peaks of the (white) experiment in parallel against the current blacklist.
+      // The peaks which pass all filters are stored per spectrum, together with their m/z index.
+      std::vector<std::vector<std::pair<size_t, MultiplexFilteredPeak> > > candidates(exp_centroided_white_.size());
+#ifdef _OPENMP
+#pragma omp parallel
+#endif
+      {
+        // thread-local copy of the navigators
+        std::vector<SplineInterpolatedPeaks::Navigator> navigators_thread(navigators);
+        
+#ifdef _OPENMP
+#pragma omp for schedule(dynamic)
+#endif
+        for (SignedSize idx_rt = 0; idx_rt < (SignedSize) exp_centroided_white_.size(); ++idx_rt)
+        {
+          const MSSpectrum& spectrum = exp_centroided_white_[idx_rt];
+          double rt = spectrum.getRT();
+          
+          // skip empty spectra
+          if (spectrum.size() == 0 || boundaries_[idx_rt].size() == 0 || exp_spline_profile_[idx_rt].size() == 0)
+          {
+            continue;
+          }
+          
+          MSExperiment::ConstIterator it_rt_picked_band_begin = exp_centroided_white_.RTBegin(rt - rt_band_/2);
+          MSExperiment::ConstIterator it_rt_picked_band_end = exp_centroided_white_.RTEnd(rt + rt_band_/2);
+          
+          // loop over mz
+          for (MSSpectrum::ConstIterator it_mz = spectrum.begin(); it_mz != spectrum.end(); ++it_mz)
+          {
+            size_t idx_mz = it_mz - spectrum.begin();
+            MultiplexFilteredPeak peak(it_mz->getMZ(), rt, exp_centroided_mapping_[idx_rt].at(idx_mz), idx_rt);
+            
+            if (filterPeak(it_mz, it_rt_picked_band_begin, it_rt_picked_band_end, pattern, navigators_thread, peak))
+            {
+              candidates[idx_rt].push_back(std::make_pair(idx_mz, peak));
+            }
+          }
+        }
+      }
+      
+      // Second, accept and blacklist the peaks in their original order. The blacklisting of a peak may change the
+      // filter result of subsequent peaks close by. These peaks are filtered again against the updated blacklist.
       // loop over spectra
       // loop simultaneously over RT in the spline interpolated profile and (white) centroided experiment (including peak boundaries)
       for (const auto &it_rt : exp_centroided_white_)
@@ -169,86 +288,35 @@ namespace OpenMS
         MSExperiment::ConstIterator it_rt_picked_band_begin = exp_centroided_white_.RTBegin(rt - rt_band_/2);
         MSExperiment::ConstIterator it_rt_picked_band_end = exp_centroided_white_.RTEnd(rt + rt_band_/2);
         
+        std::vector<std::pair<size_t, MultiplexFilteredPeak> >::const_iterator it_candidate = candidates[idx_rt].begin();
+        
         // loop over mz
         for (MSSpectrum::ConstIterator it_mz = it_rt.begin(); it_mz != it_rt.end(); ++it_mz)
         {
           double mz = it_mz->getMZ();
-          MultiplexFilteredPeak peak(mz, rt, exp_centroided_mapping_[idx_rt][it_mz - it_rt.begin()], idx_rt);
-          
-          if (!(filterPeakPositions_(it_mz, exp_centroided_white_.begin(), it_rt_picked_band_begin, it_rt_picked_band_end, pattern, peak)))
-          {
-            continue;
-          }
-          
-          size_t mz_idx = exp_centroided_mapping_[idx_rt][it_mz - it_rt.begin()];
-          double peak_min = boundaries_[idx_rt][mz_idx].mz_min;
-          double peak_max = boundaries_[idx_rt][mz_idx].mz_max;
-          
-          //double rt_peak = peak.getRT();
-          double mz_peak = peak.getMZ();
-
-          std::multimap<size_t, MultiplexSatelliteCentroided > satellites = peak.getSatellites();
+          size_t idx_mz = it_mz - it_rt.begin();
+          bool is_candidate = (it_candidate != candidates[idx_rt].end()) && (it_candidate->first == idx_mz);
           
-          // Arrangement of peaks looks promising. Now scan through the spline fitted profile data around the peak i.e. from peak boundary to peak boundary.
-          for (double mz_profile = peak_min; mz_profile < peak_max; mz_profile = navigators[idx_rt].getNextPos(mz_profile))
+          if (blacklistChanged_(mz, exp_centroided_white_.begin(), it_rt_picked_band_begin, it_rt_picked_band_end, pattern))
           {
-            // determine m/z shift relative to the centroided peak at which the profile data will be sampled
-            double mz_shift = mz_profile - mz_peak;
-
-            std::multimap<size_t, MultiplexSatelliteProfile > satellites_profile;
-
-            // construct the set of spline-interpolated satellites for this specific mz_profile
-            for (const auto &satellite_it : satellites)
-            {
-              // find indices of the peak
-              size_t rt_idx = (satellite_it.second).getRTidx();
-              size_t mz_idx = (satellite_it.second).getMZidx();
-              
-              // find peak itself
-              MSExperiment::ConstIterator it_rt = exp_centroided_.begin();
-              std::advance(it_rt, rt_idx);
-              MSSpectrum::ConstIterator it_mz = it_rt->begin();
-              std::advance(it_mz, mz_idx);
-              
-              double rt_satellite = it_rt->getRT();
-              double mz_satellite = it_mz->getMZ();
-              
-              // determine m/z and corresponding intensity
-              double mz = mz_satellite + mz_shift;
-              double intensity = navigators[rt_idx].eval(mz);
-              
-              satellites_profile.insert(std::make_pair(satellite_it.first, MultiplexSatelliteProfile(rt_satellite, mz, intensity)));
-            }
+            MultiplexFilteredPeak peak(mz, rt, exp_centroided_mapping_[idx_rt][idx_mz], idx_rt);
             
-            if (!(filterAveragineModel_(pattern, peak, satellites_profile)))
+            if (filterPeak(it_mz, it_rt_picked_band_begin, it_rt_picked_band_end, pattern, navigators, peak))
             {
-              continue;
+              result.addPeak(peak);
+              blacklistPeak_(peak, pattern_idx);
             }
-            
-            if (!(filterPeptideCorrelation_(pattern, satellites_profile)))
-            {
-              continue;
-            }
-            
-            /**
-             * All filters passed.
-             */
-            
-            // add the satellite data points to the peak
-            for (const auto &it : satellites_profile)
-            {
-              peak.addSatelliteProfile(it.second, it.first);
-            }
-            
           }
-          
-          // If some satellite data points passed all filters, we can add the peak to the filter result.
-          if (peak.sizeProfile() > 0)
+          else if (is_candidate)
           {
-            result.addPeak(peak);
-            blacklistPeak_(peak, pattern_idx);
+            result.addPeak(it_candidate->second);
+            blacklistPeak_(it_candidate->second, pattern_idx);
           }
           
+          if (is_candidate)
+          {
+            ++it_candidate;
+          }
         }
         
       }
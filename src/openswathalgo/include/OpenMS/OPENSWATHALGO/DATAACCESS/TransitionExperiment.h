@@ -169,6 +169,11 @@ public:
     std::string sum_formula;
     std::string compound_name;
 
+    // optional precomputed theoretical values (e.g. from a PQP library), empty if not available
+    std::vector<double> precursor_isotopes; // relative intensities of the precursor isotope envelope (monoisotopic first)
+    std::vector<double> bseries; // singly charged b ion m/z
+    std::vector<double> yseries; // singly charged y ion m/z
+
     // By convention, if there is no (metabolic) compound name, it is a peptide 
     bool isPeptide() const
     {
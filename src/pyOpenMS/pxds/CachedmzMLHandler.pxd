@@ -1,3 +1,4 @@
+from libcpp cimport bool
 from MSExperiment  cimport *
 from MSSpectrum  cimport *
 from ChromatogramPeak cimport *
@@ -17,6 +18,9 @@ cdef extern from "<OpenMS/FORMAT/HANDLERS/CachedMzMLHandler.h>" namespace "OpenM
         CachedMzMLHandler() nogil except +
         CachedMzMLHandler(CachedMzMLHandler) nogil except +
 
+        void setCompression(bool compress) nogil except +
+        bool getCompression() nogil except +
+
         void writeMemdump(MSExperiment exp, String out) nogil except +
         void writeMetadata(MSExperiment exp, String out_meta) nogil except +
 
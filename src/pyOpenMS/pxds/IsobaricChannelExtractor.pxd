@@ -6,6 +6,7 @@ from TMTSixPlexQuantitationMethod cimport *
 from TMTTenPlexQuantitationMethod cimport *
 from DefaultParamHandler cimport *
 from MSExperiment cimport *
+from OnDiscMSExperiment cimport *
 from ConsensusMap cimport *
 
 cdef extern from "<OpenMS/ANALYSIS/QUANTITATION/IsobaricChannelExtractor.h>" namespace "OpenMS":
@@ -23,4 +24,5 @@ cdef extern from "<OpenMS/ANALYSIS/QUANTITATION/IsobaricChannelExtractor.h>" nam
         IsobaricChannelExtractor(TMTTenPlexQuantitationMethod *quant_method) nogil except +
 
         void extractChannels(MSExperiment & ms_exp_data, ConsensusMap & consensus_map) nogil except +
+        void extractChannels(OnDiscMSExperiment & ms_exp_data, ConsensusMap & consensus_map) nogil except +
 
@@ -58,6 +58,9 @@ cdef extern from "<OpenMS/OPENSWATHALGO/DATAACCESS/TransitionExperiment.h>" name
         libcpp_string id
         libcpp_string sum_formula
         libcpp_string compound_name
+        libcpp_vector[double] precursor_isotopes
+        libcpp_vector[double] bseries
+        libcpp_vector[double] yseries
 
         libcpp_vector[LightModification] modifications
 
@@ -8,6 +8,7 @@ cdef extern from "<OpenMS/FORMAT/DATAACCESS/MSDataCachedConsumer.h>" namespace "
 
         MSDataCachedConsumer(String filename) nogil except +
         MSDataCachedConsumer(String filename, bool clear) nogil except +
+        MSDataCachedConsumer(String filename, bool clear, bool compress) nogil except +
         MSDataCachedConsumer(MSDataCachedConsumer) nogil except + #wrap-ignore
 
         void consumeSpectrum(MSSpectrum & s) nogil except +
@@ -23,4 +23,5 @@ cdef extern from "<OpenMS/FORMAT/SqMassFile.h>" namespace "OpenMS::SqMassFile":
         bool write_full_meta
         bool use_lossy_numpress
         double linear_fp_mass_acc
+        bool use_byte_shuffle
 
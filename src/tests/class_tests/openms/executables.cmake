@@ -168,6 +168,7 @@ set(format_executables_list
   ChromeleonFile_test
   CVMappingFile_test
   CompressedInputSource_test
+  ConsensusBinFile_test
   ConsensusXMLFile_test
   ControlledVocabulary_test
   CsvFile_test
@@ -177,12 +178,14 @@ set(format_executables_list
   ExperimentalDesignFile_test
   FASTAFile_test
   FeatureFileOptions_test
+  FeatureBinFile_test
   FeatureXMLFile_test
   FileHandler_test
   FileTypes_test
   GzipIfstream_test
   GzipInputStream_test
   IBSpectraFile_test
+  IdBinFile_test
   IdXMLFile_test
   IndexedMzMLDecoder_test
   IndexedMzMLFile_test
@@ -208,6 +211,7 @@ set(format_executables_list
   MzIdentMLValidator_test
   MzMLFile_test
   MzMLSpectrumDecoder_test
+  ColumnarBinaryHandler_test
   MzMLSqliteHandler_test
   MzMLSqliteSwathHandler_test
   MzMLValidator_test
@@ -259,6 +263,7 @@ set(format_executables_list
   MSDataChainingConsumer_test
   MSDataStoringConsumer_test
   MSDataAggregatingConsumer_test
+  SpectrumAccessIMIndexed_test
   SpectrumAccessQuadMZTransforming_test
   SpectrumAccessSqMass_test
   SiriusFragmentAnnotation_test
@@ -651,6 +656,7 @@ if(NOT DISABLE_OPENSWATH)
     OpenSwathHelper_test
     OpenSwathScoring_test
     OpenSwathScores_test
+    OpenSwathOSWWriter_test
     PeakIntegrator_test
     PeakPickerMRM_test
     MRMTransitionGroupPicker_test
@@ -397,6 +397,82 @@ START_SECTION([EXTRA]inline bool isAmbiguous(const AAString& s))
 }
 END_SECTION
 
+START_SECTION([AhoCorasickPrefilter] void init(const AhoCorasickAmbiguous::PeptideDB& pep_db, const int aaa_max, const int mm_max))
+{
+  AhoCorasickPrefilter filter;
+  TEST_EQUAL(filter.isActive(), false)
+  setDB(ListUtils::create<String>("PEPTIDE,KEEPER", ','), pep_db);
+  filter.init(pep_db, 2, 0);
+  TEST_EQUAL(filter.isActive(), true)
+  TEST_EQUAL(filter.getK(), 5)
+  TEST_REAL_SIMILAR(filter.getFillRatio(), 5.0 / (22 * 22 * 22 * 22 * 22))
+  filter.init(pep_db, 2, 1); // mismatches: inactive
+  TEST_EQUAL(filter.isActive(), false)
+  setDB(ListUtils::create<String>("PEPTIDE,KEEP", ','), pep_db);
+  filter.init(pep_db, 2, 0);
+  TEST_EQUAL(filter.getK(), 4)
+  setDB(ListUtils::create<String>("PEPTIDE,KE", ','), pep_db); // too short
+  filter.init(pep_db, 2, 0);
+  TEST_EQUAL(filter.isActive(), false)
+}
+END_SECTION
+
+START_SECTION([AhoCorasickPrefilter] void getCandidateRegions(const String& protein, std::vector<std::pair<Size, Size> >& regions) const)
+{
+  AhoCorasickPrefilter filter;
+  std::vector<std::pair<Size, Size> > regions;
+  filter.getCandidateRegions("AAAA", regions); // inactive: whole protein
+  TEST_EQUAL(regions.size(), 1)
+  TEST_EQUAL(regions[0].second, 4)
+
+  setDB(ListUtils::create<String>("PEPTIDE,KEEPER", ','), pep_db);
+  filter.init(pep_db, 2, 0);
+  filter.getCandidateRegions("PEPT", regions); // shorter than k
+  TEST_EQUAL(regions.size(), 0)
+  filter.getCandidateRegions("AAAAAAAAAA", regions);
+  TEST_EQUAL(regions.size(), 0)
+  //                          0123456789012345678901234
+  filter.getCandidateRegions("AAPEPTIDEAAAKEZPERAXXXXXA", regions);
+  TEST_EQUAL(regions.size(), 2)
+  TEST_EQUAL(regions[0].first, 2)
+  TEST_EQUAL(regions[0].second, 9)
+  TEST_EQUAL(regions[1].first, 12) // 'Z' can be 'E' (KEEPER)
+  TEST_EQUAL(regions[1].second, 18)
+  filter.getCandidateRegions("AAPEPTIDEAAAKEBPERAXXXXXA", regions); // 'B' (D/N) cannot be 'E'
+  TEST_EQUAL(regions.size(), 1)
+  filter.init(pep_db, 0, 0); // no ambiguous amino acids allowed
+  filter.getCandidateRegions("AAPEPTIDEAAAKEZPERAXXXXXA", regions);
+  TEST_EQUAL(regions.size(), 1)
+
+  // all hits of the automaton are found in the candidate regions
+  setDB(ListUtils::create<String>("acdef,cdefg,efghik,ghikl", ','), pep_db);
+  AhoCorasickAmbiguous::initPattern(pep_db, 2, 0, pattern);
+  filter.init(pep_db, 2, 0);
+  String prot = "MMacdefghiklMMxdefgMMbxxefghMMXXXXXX";
+  prot.toUpper();
+  StringList hits_full, hits_regions;
+  AhoCorasickAmbiguous fuzzyAC(prot);
+  while (fuzzyAC.findNext(pattern))
+  {
+    hits_full.push_back(String(fuzzyAC.getHitDBIndex()) + "@" + String(fuzzyAC.getHitProteinPosition()));
+  }
+  filter.getCandidateRegions(prot, regions);
+  for (const auto& r : regions)
+  {
+    fuzzyAC.setProtein(prot.substr(r.first, r.second - r.first));
+    while (fuzzyAC.findNext(pattern))
+    {
+      hits_regions.push_back(String(fuzzyAC.getHitDBIndex()) + "@" + String(fuzzyAC.getHitProteinPosition() + (Int)r.first));
+    }
+  }
+  TEST_EQUAL(hits_full.size() > 0, true)
+  std::sort(hits_full.begin(), hits_full.end());
+  std::sort(hits_regions.begin(), hits_regions.end());
+  TEST_EQUAL(ListUtils::concatenate(hits_regions, ","), ListUtils::concatenate(hits_full, ","))
+  TEST_EQUAL(regions.back().second < prot.size(), true) // the trailing stretch of 'X' is skipped
+}
+END_SECTION
+
 /////////////////////////////////////////////////////////////
 /////////////////////////////////////////////////////////////
 END_TEST
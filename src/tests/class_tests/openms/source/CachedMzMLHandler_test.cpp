@@ -235,6 +235,70 @@ START_SECTION(( void writeMetadata(MapType exp, String out_meta, bool addCacheMe
 }
 END_SECTION
 
+START_SECTION(( void setCompression(bool compress) ))
+{
+  CachedMzMLHandler cache;
+  TEST_EQUAL(cache.getCompression(), false)
+  cache.setCompression(true);
+  TEST_EQUAL(cache.getCompression(), true)
+
+  // compressed data blocks are lossless
+  PeakMap exp;
+  MzMLFile().load(OPENMS_GET_TEST_DATA_PATH("MzMLFile_1.mzML"), exp);
+  std::string tmp_filename;
+  NEW_TMP_FILE(tmp_filename);
+  cache.writeMemdump(exp, tmp_filename);
+
+  PeakMap exp_new;
+  cache.readMemdump(exp_new, tmp_filename);
+  TEST_EQUAL(exp_new.size(), exp.size())
+  TEST_EQUAL(exp_new.getChromatograms().size(), exp.getChromatograms().size())
+  for (Size i = 0; i < exp.size(); i++)
+  {
+    TEST_EQUAL(exp_new[i].size(), exp[i].size())
+    TEST_EQUAL(exp_new[i].getFloatDataArrays().size(), exp[i].getFloatDataArrays().size())
+    for (Size j = 0; j < exp[i].size(); j++)
+    {
+      TEST_EQUAL(exp_new[i][j].getMZ(), exp[i][j].getMZ())
+      TEST_EQUAL(exp_new[i][j].getIntensity(), exp[i][j].getIntensity())
+    }
+  }
+  for (Size i = 0; i < exp.getChromatograms().size(); i++)
+  {
+    TEST_EQUAL(exp_new.getChromatogram(i).size(), exp.getChromatogram(i).size())
+    for (Size j = 0; j < exp.getChromatogram(i).size(); j++)
+    {
+      TEST_EQUAL(exp_new.getChromatogram(i)[j].getRT(), exp.getChromatogram(i)[j].getRT())
+      TEST_EQUAL(exp_new.getChromatogram(i)[j].getIntensity(), exp.getChromatogram(i)[j].getIntensity())
+    }
+  }
+
+  // random access through the index
+  cache.createMemdumpIndex(tmp_filename);
+  TEST_EQUAL(cache.getSpectraIndex().size(), 4)
+  TEST_EQUAL(cache.getChromatogramIndex().size(), 2)
+  std::ifstream ifs_(tmp_filename.c_str(), std::ios::binary);
+  for (Size i = 0; i < cache.getSpectraIndex().size(); i++)
+  {
+    int ms_level = -1;
+    double rt = -1.0;
+    ifs_.seekg(cache.getSpectraIndex()[i]);
+    std::vector<OpenSwath::BinaryDataArrayPtr> darray = CachedMzMLHandler::readSpectrumFast(ifs_, ms_level, rt);
+    TEST_EQUAL(darray[0]->data.size(), exp.getSpectrum(i).size())
+    TEST_EQUAL(darray[1]->data.size(), exp.getSpectrum(i).size())
+    TEST_EQUAL(darray.size(), exp.getSpectrum(i).getFloatDataArrays().size() + exp.getSpectrum(i).getIntegerDataArrays().size() + 2)
+    TEST_REAL_SIMILAR(rt, exp.getSpectrum(i).getRT())
+  }
+  for (Size i = 0; i < cache.getChromatogramIndex().size(); i++)
+  {
+    ifs_.seekg(cache.getChromatogramIndex()[i]);
+    std::vector<OpenSwath::BinaryDataArrayPtr> darray = CachedMzMLHandler::readChromatogramFast(ifs_);
+    TEST_EQUAL(darray[0]->data.size(), exp.getChromatogram(i).size())
+    TEST_EQUAL(darray[1]->data.size(), exp.getChromatogram(i).size())
+  }
+}
+END_SECTION
+
 // Create a single CachedMzML file and use it for the following computations
 // (may be somewhat faster)
 std::string tmp_filename;
@@ -136,6 +136,69 @@ START_SECTION(void extractChromatograms(const OpenSwath::SpectrumAccessPtr input
 }
 END_SECTION
 
+START_SECTION([EXTRA] extractChromatograms is identical to extract_value_tophat)
+{
+  boost::shared_ptr<PeakMap > exp(new PeakMap);
+  MzMLFile().load(OPENMS_GET_TEST_DATA_PATH("ChromatogramExtractor_input.mzML"), *exp);
+  OpenSwath::SpectrumAccessPtr expptr = SimpleOpenMSSpectraFactory::getSpectrumAccessOpenMSPtr(exp);
+
+  // many overlapping windows, some restricted in RT
+  std::vector< ChromatogramExtractorAlgorithm::ExtractionCoordinates > coordinates;
+  for (Size i = 0; i < 200; ++i)
+  {
+    ChromatogramExtractorAlgorithm::ExtractionCoordinates coord;
+    coord.mz = 600.0 + i * 0.37;
+    coord.rt_start = (i % 3 == 0) ? 3050.0 : 0.0;
+    coord.rt_end = (i % 3 == 0) ? 3100.0 : -1.0;
+    coord.id = String(i);
+    coordinates.push_back(coord);
+  }
+
+  for (bool ppm : {false, true})
+  {
+    double extract_window = ppm ? 500.0 : 0.5;
+    std::vector< OpenSwath::ChromatogramPtr > out_exp;
+    for (Size i = 0; i < coordinates.size(); ++i)
+    {
+      out_exp.push_back(OpenSwath::ChromatogramPtr(new OpenSwath::Chromatogram));
+    }
+    ChromatogramExtractorAlgorithm extractor;
+    extractor.extractChromatograms(expptr, out_exp, coordinates, extract_window, ppm, -1, "tophat");
+
+    // reference: extract each coordinate with extract_value_tophat, spectrum by spectrum
+    std::vector< std::vector<double> > ref_rt(coordinates.size()), ref_int(coordinates.size());
+    for (Size s = 0; s < expptr->getNrSpectra(); ++s)
+    {
+      OpenSwath::SpectrumPtr sptr = expptr->getSpectrumById(s);
+      double rt = expptr->getSpectrumMetaById(s).RT;
+      const std::vector<double>& mz = sptr->getMZArray()->data;
+      const std::vector<double>& intensity = sptr->getIntensityArray()->data;
+      if (mz.empty()) continue;
+      std::vector<double>::const_iterator mz_it = mz.begin();
+      std::vector<double>::const_iterator int_it = intensity.begin();
+      for (Size k = 0; k < coordinates.size(); ++k)
+      {
+        if (coordinates[k].rt_end - coordinates[k].rt_start > 0 && (rt < coordinates[k].rt_start || rt > coordinates[k].rt_end)) continue;
+        double integrated_intensity;
+        extractor.extract_value_tophat(mz.begin(), mz_it, mz.end(), int_it, coordinates[k].mz, integrated_intensity, extract_window, ppm);
+        ref_rt[k].push_back(rt);
+        ref_int[k].push_back(integrated_intensity);
+      }
+    }
+
+    Size nr_differences = 0, nr_nonzero = 0;
+    for (Size k = 0; k < coordinates.size(); ++k)
+    {
+      if (out_exp[k]->getTimeArray()->data != ref_rt[k] || out_exp[k]->getIntensityArray()->data != ref_int[k]) ++nr_differences;
+      for (double intensity : ref_int[k]) if (intensity > 0) ++nr_nonzero;
+    }
+    TEST_EQUAL(nr_differences, 0)
+    TEST_EQUAL(nr_nonzero > 0, true)
+    TEST_EQUAL(out_exp[0]->getTimeArray()->data.size() < out_exp[1]->getTimeArray()->data.size(), true)
+  }
+}
+END_SECTION
+
 START_SECTION([EXTRA] void extractChromatograms(const OpenSwath::SpectrumAccessPtr input, std::vector< OpenSwath::ChromatogramPtr > &output, std::vector< ExtractionCoordinates >& extraction_coordinates, double mz_extraction_window, bool ppm, String filter))
 {
   typedef OpenMS::DataArrays::FloatDataArray FloatDataArray;
@@ -0,0 +1,184 @@
+// --------------------------------------------------------------------------
+//                   OpenMS -- Open-Source Mass Spectrometry
+// --------------------------------------------------------------------------
+// Copyright The OpenMS Team -- Eberhard Karls University Tuebingen,
+// ETH Zurich, and Freie Universitaet Berlin 2002-2020.
+//
+// This software is released under a three-clause BSD license:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of any author or any participating institution
+//    may be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+// For a full list of authors, refer to the file AUTHORS.
+// --------------------------------------------------------------------------
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL ANY OF THE AUTHORS OR THE CONTRIBUTING
+// INSTITUTIONS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// --------------------------------------------------------------------------
+// $Maintainer: agent $
+// $Authors: agent $
+// --------------------------------------------------------------------------
+
+#include <OpenMS/CONCEPT/ClassTest.h>
+#include <OpenMS/test_config.h>
+
+///////////////////////////
+
+#include <OpenMS/FORMAT/HANDLERS/ColumnarBinaryHandler.h>
+
+#include <cstring>
+#include <fstream>
+#include <iterator>
+
+///////////////////////////
+
+START_TEST(ColumnarBinaryHandler, "$Id$")
+
+/////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////
+
+using namespace OpenMS;
+using namespace OpenMS::Internal;
+using namespace std;
+
+vector<double> doubles = {1.5, 2.5, 3.5};
+vector<Int32> ints = {-1, 0, 7, 42};
+vector<String> strings = {"a", "bcd", ""};
+
+MetaInfoInterface m1, m2;
+m1.setMetaValue("x", 3);
+m1.setMetaValue("y", "str");
+m1.setMetaValue("il", ListUtils::create<Int>("7,8,9"));
+m2.setMetaValue("x", 4.5);
+m2.setMetaValue("sl", ListUtils::create<String>("p,q"));
+m2.setMetaValue("dl", ListUtils::create<double>("1.0,2.0"));
+
+String filename;
+NEW_TMP_FILE(filename)
+
+START_SECTION((ColumnarBinaryWriter(const String& filename, const String& content_tag)))
+  ColumnarBinaryWriter writer(filename, "test");
+  writer.addColumn("doubles", doubles);
+  writer.addColumn("ints", ints);
+  writer.addStringColumn("strings", strings);
+  ColumnarMetaInfoWriter meta_writer;
+  meta_writer.add(0, m1);
+  meta_writer.add(1, m2);
+  meta_writer.write(writer, "row");
+  writer.close();
+  TEST_EXCEPTION(Exception::UnableToCreateFile, ColumnarBinaryWriter("/does/not/exist/file.bin", "test"))
+END_SECTION
+
+START_SECTION((static bool hasContentTag(const String& filename, const String& content_tag)))
+  TEST_EQUAL(ColumnarBinaryFormat::hasContentTag(filename, "test"), true)
+  TEST_EQUAL(ColumnarBinaryFormat::hasContentTag(filename, "other"), false)
+  TEST_EQUAL(ColumnarBinaryFormat::hasContentTag(OPENMS_GET_TEST_DATA_PATH("IdXMLFile_whole.idXML"), "test"), false)
+END_SECTION
+
+START_SECTION((ColumnarBinaryReader(const String& filename, const String& content_tag)))
+  ColumnarBinaryReader reader(filename, "test");
+  TEST_EQUAL(reader.isOpen(), true)
+  TEST_EXCEPTION(Exception::ParseError, ColumnarBinaryReader(filename, "other"))
+  TEST_EXCEPTION(Exception::FileNotFound, ColumnarBinaryReader("/does/not/exist.bin", "test"))
+
+  // truncated file: section table ends before the first entry
+  String truncated;
+  NEW_TMP_FILE(truncated)
+  {
+    ifstream in(filename.c_str(), ios::binary);
+    string content((istreambuf_iterator<char>(in)), istreambuf_iterator<char>());
+    UInt64 table_offset;
+    memcpy(&table_offset, content.data() + 2 * ColumnarBinaryFormat::TAG_LENGTH + 2 * sizeof(UInt32), sizeof(table_offset));
+    ofstream out(truncated.c_str(), ios::binary);
+    out.write(content.data(), table_offset + sizeof(UInt64) + 2);
+  }
+  TEST_EXCEPTION(Exception::ParseError, ColumnarBinaryReader(truncated, "test"))
+END_SECTION
+
+ColumnarBinaryReader reader(filename, "test");
+
+START_SECTION((bool hasColumn(const String& name) const))
+  TEST_EQUAL(reader.hasColumn("doubles"), true)
+  TEST_EQUAL(reader.hasColumn("nope"), false)
+END_SECTION
+
+START_SECTION((Size getColumnSize(const String& name) const))
+  TEST_EQUAL(reader.getColumnSize("doubles"), 3)
+  TEST_EQUAL(reader.getColumnSize("ints"), 4)
+  TEST_EQUAL(reader.getColumnSize("strings"), 3)
+END_SECTION
+
+START_SECTION((template <typename T> ColumnView<T> getColumn(const String& name) const))
+  ColumnarBinaryReader::ColumnView<double> d = reader.getColumn<double>("doubles");
+  TEST_EQUAL(d.size(), 3)
+  TEST_REAL_SIMILAR(d[0], 1.5)
+  TEST_REAL_SIMILAR(d[2], 3.5)
+  ColumnarBinaryReader::ColumnView<Int32> i = reader.getColumn<Int32>("ints");
+  TEST_EQUAL(vector<Int32>(i.begin(), i.end()) == ints, true)
+  // wrong type or missing column
+  TEST_EXCEPTION(Exception::ParseError, reader.getColumn<Int32>("doubles"))
+  TEST_EXCEPTION(Exception::ElementNotFound, reader.getColumn<double>("nope"))
+END_SECTION
+
+START_SECTION((template <typename T> std::vector<T> getColumnOrEmpty(const String& name) const))
+  TEST_EQUAL(reader.getColumnOrEmpty<double>("nope").size(), 0)
+  TEST_EQUAL(reader.getColumnOrEmpty<double>("doubles").size(), 3)
+END_SECTION
+
+START_SECTION((StringColumnView getStringColumn(const String& name) const))
+  ColumnarBinaryReader::StringColumnView s = reader.getStringColumn("strings");
+  TEST_EQUAL(s.size(), 3)
+  TEST_STRING_EQUAL(s[1], "bcd")
+  TEST_STRING_EQUAL(s[2], "")
+  TEST_EQUAL(s.toVector() == strings, true)
+END_SECTION
+
+START_SECTION((static void read(const ColumnarBinaryReader& reader, const String& prefix, RowToMeta row_to_meta)))
+  MetaInfoInterface out[2];
+  ColumnarMetaInfoReader::read(reader, "row", [&](UInt64 row) { return &out[row]; });
+  TEST_EQUAL(out[0] == m1, true)
+  TEST_EQUAL(out[1] == m2, true)
+END_SECTION
+
+START_SECTION((std::vector<std::pair<UInt64, DataValue> > getColumn(const String& key) const))
+  ColumnarMetaInfoReader meta(reader, "row");
+  TEST_EQUAL(meta.size(), 6)
+  vector<pair<UInt64, DataValue> > x = meta.getColumn("x");
+  TEST_EQUAL(x.size(), 2)
+  TEST_EQUAL(x[0].first, 0)
+  TEST_EQUAL(Int(x[0].second), 3)
+  TEST_REAL_SIMILAR(double(x[1].second), 4.5)
+  TEST_EQUAL(meta.getColumn("nope").empty(), true)
+END_SECTION
+
+START_SECTION((std::vector<Size> findRows(UInt64 first, UInt64 last) const))
+  ColumnarMetaInfoReader meta(reader, "row");
+  TEST_EQUAL(meta.findRows(0, 1).size(), 3)
+  TEST_EQUAL(meta.findRows(1, 2).size(), 3)
+  TEST_EQUAL(meta.findRows(2, 10).size(), 0)
+END_SECTION
+
+START_SECTION((UInt32 index(const String& s)))
+  ColumnarStringPool pool;
+  TEST_EQUAL(pool.index("a"), 0)
+  TEST_EQUAL(pool.index("b"), 1)
+  TEST_EQUAL(pool.index("a"), 0)
+  TEST_EQUAL(pool.size(), 2)
+END_SECTION
+
+/////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////
+END_TEST
@@ -0,0 +1,214 @@
+// --------------------------------------------------------------------------
+//                   OpenMS -- Open-Source Mass Spectrometry
+// --------------------------------------------------------------------------
+// Copyright The OpenMS Team -- Eberhard Karls University Tuebingen,
+// ETH Zurich, and Freie Universitaet Berlin 2002-2020.
+//
+// This software is released under a three-clause BSD license:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of any author or any participating institution
+//    may be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+// For a full list of authors, refer to the file AUTHORS.
+// --------------------------------------------------------------------------
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL ANY OF THE AUTHORS OR THE CONTRIBUTING
+// INSTITUTIONS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// --------------------------------------------------------------------------
+// $Maintainer: agent $
+// $Authors: agent $
+// --------------------------------------------------------------------------
+
+#include <OpenMS/CONCEPT/ClassTest.h>
+#include <OpenMS/test_config.h>
+
+///////////////////////////
+
+#include <OpenMS/FORMAT/ConsensusBinFile.h>
+#include <OpenMS/FORMAT/ConsensusXMLFile.h>
+
+///////////////////////////
+
+using namespace OpenMS;
+using namespace std;
+
+DRange<1> makeRange(double a, double b)
+{
+  DPosition<1> pa(a), pb(b);
+  return DRange<1>(pa, pb);
+}
+
+START_TEST(ConsensusBinFile, "$Id$")
+
+/////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////
+
+ConsensusBinFile* ptr = nullptr;
+ConsensusBinFile* nullPointer = nullptr;
+START_SECTION((ConsensusBinFile()))
+  ptr = new ConsensusBinFile();
+  TEST_NOT_EQUAL(ptr, nullPointer)
+END_SECTION
+
+START_SECTION((~ConsensusBinFile()))
+  delete ptr;
+END_SECTION
+
+ConsensusMap map_xml;
+ConsensusXMLFile().load(OPENMS_GET_TEST_DATA_PATH("ConsensusXMLFile_1.consensusXML"), map_xml);
+// add a ratio, these are not part of the test file
+ConsensusFeature::Ratio ratio;
+ratio.ratio_value_ = 1.5;
+ratio.denominator_ref_ = "light";
+ratio.numerator_ref_ = "heavy";
+ratio.description_ = ListUtils::create<String>("a,b");
+map_xml[1].addRatio(ratio);
+
+String filename;
+NEW_TMP_FILE(filename)
+
+START_SECTION((void store(const String& filename, const ConsensusMap& consensus_map)))
+  ConsensusBinFile().store(filename, map_xml);
+  TEST_EQUAL(Internal::ColumnarBinaryFormat::hasContentTag(filename, ConsensusBinFile::CONTENT_TAG), true)
+END_SECTION
+
+START_SECTION((void load(const String& filename, ConsensusMap& consensus_map)))
+  ConsensusMap map;
+  ConsensusBinFile().load(filename, map);
+  TEST_EQUAL(map.size(), 6)
+  TEST_EQUAL(map == map_xml, true)
+  TEST_EQUAL(map[1].getFeatures().size(), 2)
+  TEST_EQUAL(map[1].getRatios().size(), 1)
+  TEST_EQUAL(map[1].getRatios()[0].description_.size(), 2)
+  TEST_EQUAL(map.getColumnHeaders().size(), map_xml.getColumnHeaders().size())
+  TEST_EQUAL(map.getExperimentType(), map_xml.getExperimentType())
+
+  TEST_EXCEPTION(Exception::FileNotFound, ConsensusBinFile().load("/does/not/exist.consensusBin", map))
+  TEST_EXCEPTION(Exception::ParseError, ConsensusBinFile().load(OPENMS_GET_TEST_DATA_PATH("ConsensusXMLFile_1.consensusXML"), map))
+END_SECTION
+
+START_SECTION((FeatureFileOptions& getOptions()))
+  ConsensusBinFile f;
+  f.getOptions().setRTRange(makeRange(1200.0, 1300.0));
+  ConsensusMap map;
+  f.load(filename, map);
+  TEST_EQUAL(map.size(), 3)
+  for (Size i = 0; i < map.size(); ++i)
+  {
+    TEST_EQUAL(map[i].getRT() >= 1200.0 && map[i].getRT() <= 1300.0, true)
+  }
+
+  f.getOptions() = FeatureFileOptions();
+  f.getOptions().setLoadPeptideIdentifications(false);
+  f.load(filename, map);
+  TEST_EQUAL(map.size(), 6)
+  TEST_EQUAL(map.getUnassignedPeptideIdentifications().empty(), true)
+  for (Size i = 0; i < map.size(); ++i)
+  {
+    TEST_EQUAL(map[i].getPeptideIdentifications().empty(), true)
+  }
+
+  f.getOptions() = FeatureFileOptions();
+  f.getOptions().setMetadataOnly(true);
+  f.load(filename, map);
+  TEST_EQUAL(map.size(), 0)
+  TEST_EQUAL(map.getProteinIdentifications().size(), map_xml.getProteinIdentifications().size())
+END_SECTION
+
+START_SECTION((const FeatureFileOptions& getOptions() const))
+  const ConsensusBinFile f;
+  TEST_EQUAL(f.getOptions().hasRTRange(), false)
+END_SECTION
+
+START_SECTION((void setOptions(const FeatureFileOptions& options)))
+  ConsensusBinFile f;
+  FeatureFileOptions options;
+  options.setMetadataOnly(true);
+  f.setOptions(options);
+  TEST_EQUAL(f.getOptions().getMetadataOnly(), true)
+END_SECTION
+
+START_SECTION((void open(const String& filename)))
+  ConsensusBinFile f;
+  TEST_EXCEPTION(Exception::IllegalArgument, f.size())
+  f.open(filename);
+  TEST_EQUAL(f.size(), 6)
+END_SECTION
+
+START_SECTION((Size size() const))
+  NOT_TESTABLE // tested above
+END_SECTION
+
+START_SECTION((std::vector<double> getRTs() const))
+  ConsensusBinFile f;
+  f.open(filename);
+  vector<double> rts = f.getRTs();
+  TEST_EQUAL(rts.size(), 6)
+  TEST_REAL_SIMILAR(rts[0], map_xml[0].getRT())
+END_SECTION
+
+START_SECTION((std::vector<double> getMZs() const))
+  ConsensusBinFile f;
+  f.open(filename);
+  vector<double> mzs = f.getMZs();
+  TEST_EQUAL(mzs.size(), 6)
+  TEST_REAL_SIMILAR(mzs[5], map_xml[5].getMZ())
+END_SECTION
+
+START_SECTION((std::vector<float> getIntensities() const))
+  ConsensusBinFile f;
+  f.open(filename);
+  vector<float> intensities = f.getIntensities();
+  TEST_EQUAL(intensities.size(), 6)
+  TEST_REAL_SIMILAR(intensities[2], map_xml[2].getIntensity())
+END_SECTION
+
+START_SECTION((std::vector<float> getQualities() const))
+  ConsensusBinFile f;
+  f.open(filename);
+  vector<float> qualities = f.getQualities();
+  TEST_EQUAL(qualities.size(), 6)
+  TEST_REAL_SIMILAR(qualities[2], map_xml[2].getQuality())
+END_SECTION
+
+START_SECTION((std::vector<UInt64> getHandleOffsets() const))
+  ConsensusBinFile f;
+  f.open(filename);
+  vector<UInt64> offsets = f.getHandleOffsets();
+  TEST_EQUAL(offsets.size(), 7)
+  TEST_EQUAL(offsets[6], 10)
+  TEST_EQUAL(offsets[2] - offsets[1], map_xml[1].size())
+END_SECTION
+
+START_SECTION((std::vector<UInt64> getHandleMapIndices() const))
+  ConsensusBinFile f;
+  f.open(filename);
+  vector<UInt64> map_indices = f.getHandleMapIndices();
+  TEST_EQUAL(map_indices.size(), 10)
+  TEST_EQUAL(map_indices[0], map_xml[0].begin()->getMapIndex())
+END_SECTION
+
+START_SECTION((std::vector<float> getHandleIntensities() const))
+  ConsensusBinFile f;
+  f.open(filename);
+  vector<float> intensities = f.getHandleIntensities();
+  TEST_EQUAL(intensities.size(), 10)
+  TEST_REAL_SIMILAR(intensities[0], map_xml[0].begin()->getIntensity())
+END_SECTION
+
+/////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////
+END_TEST
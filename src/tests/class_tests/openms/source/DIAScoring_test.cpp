@@ -39,6 +39,7 @@
 #include <OpenMS/ANALYSIS/OPENSWATH/DIAHelper.h>
 
 #include <OpenMS/CHEMISTRY/TheoreticalSpectrumGenerator.h>
+#include <OpenMS/CHEMISTRY/ISOTOPEDISTRIBUTION/CoarseIsotopePatternGenerator.h>
 
 #include "OpenMS/OPENSWATHALGO/DATAACCESS/DataStructures.h"
 #include "OpenMS/OPENSWATHALGO/DATAACCESS/MockObjects.h"
@@ -356,6 +357,40 @@ START_SECTION(void dia_ms1_isotope_scores(double precursor_mz, SpectrumPtrType s
 }
 END_SECTION
 
+START_SECTION(void dia_ms1_isotope_scores(double precursor_mz, SpectrumPtrType spectrum, size_t charge_state,
+                                const std::vector<double>& theoretical_isotopes, double& isotope_corr, double& isotope_overlap))
+{
+  OpenSwath::SpectrumPtr sptr = prepareSpectrum();
+
+  DIAScoring diascoring;
+  diascoring.setParameters(p_dia);
+
+  // precomputed envelope with more isotopes than needed (as stored in a PQP file)
+  {
+    CoarseIsotopePatternGenerator solver(10);
+    std::vector<double> theoretical_isotopes;
+    for (const auto& peak : solver.estimateFromPeptideWeight(500.0))
+    {
+      theoretical_isotopes.push_back(peak.getIntensity());
+    }
+
+    double isotope_corr = 0, isotope_overlap = 0;
+    diascoring.dia_ms1_isotope_scores(500.0, sptr, 1, theoretical_isotopes, isotope_corr, isotope_overlap);
+    TEST_REAL_SIMILAR(isotope_corr, 0.959692139694113)
+    TEST_REAL_SIMILAR(isotope_overlap, 240/74.0)
+  }
+
+  // too few isotopes: falls back to the averagine model
+  {
+    std::vector<double> theoretical_isotopes(2, 1.0);
+    double isotope_corr = 0, isotope_overlap = 0;
+    diascoring.dia_ms1_isotope_scores(499.0, sptr, 1, theoretical_isotopes, isotope_corr, isotope_overlap);
+    TEST_REAL_SIMILAR(isotope_corr, 0.995485552148335)
+    TEST_REAL_SIMILAR(isotope_overlap, 0.0)
+  }
+}
+END_SECTION
+
 START_SECTION (void dia_massdiff_score(const std::vector< TransitionType > &transitions, SpectrumType spectrum, const std::vector< double > &normalized_library_intensity, double &ppm_score, double &ppm_score_weighted) )
 {
   OpenSwath::SpectrumPtr sptr = prepareShiftedSpectrum();
@@ -447,6 +482,39 @@ START_SECTION ( void dia_by_ion_score(SpectrumType spectrum, AASequence &sequenc
 }
 END_SECTION
 
+START_SECTION ( void dia_by_ion_score(SpectrumPtrType spectrum, const std::vector<double>& bseries, const std::vector<double>& yseries, double& bseries_score, double& yseries_score) )
+{
+  OpenSwath::SpectrumPtr sptr = (OpenSwath::SpectrumPtr)(new OpenSwath::Spectrum);
+  OpenSwath::BinaryDataArrayPtr data1 = (OpenSwath::BinaryDataArrayPtr)(new OpenSwath::BinaryDataArray);
+  OpenSwath::BinaryDataArrayPtr data2 = (OpenSwath::BinaryDataArrayPtr)(new OpenSwath::BinaryDataArray);
+  data1->data = {350.17164, 421.20875, 547.26291, 646.33133};
+  data2->data = std::vector<double>(4, 100);
+  sptr->setMZArray(data1);
+  sptr->setIntensityArray(data2);
+
+  DIAScoring diascoring;
+  diascoring.setParameters(p_dia);
+
+  // precomputed series give the same result as the series generated from the sequence
+  std::vector<double> bseries, yseries;
+  TheoreticalSpectrumGenerator generator;
+  Param p;
+  p.setValue("add_metainfo", "true");
+  generator.setParameters(p);
+  DIAHelpers::getBYSeries(AASequence::fromString("SYVAWDR"), bseries, yseries, &generator, 1);
+
+  double bseries_score = 0, yseries_score = 0;
+  diascoring.dia_by_ion_score(sptr, bseries, yseries, bseries_score, yseries_score);
+  TEST_REAL_SIMILAR (bseries_score, 2);
+  TEST_REAL_SIMILAR (yseries_score, 2);
+
+  std::vector<double> empty;
+  diascoring.dia_by_ion_score(sptr, empty, yseries, bseries_score, yseries_score);
+  TEST_REAL_SIMILAR (bseries_score, 0);
+  TEST_REAL_SIMILAR (yseries_score, 2);
+}
+END_SECTION
+
 START_SECTION( void score_with_isotopes(SpectrumType spectrum, const std::vector< TransitionType > &transitions, double &dotprod, double &manhattan))
 {
   OpenSwath::LightTransition mock_tr1;
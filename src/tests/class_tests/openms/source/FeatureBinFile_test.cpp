@@ -0,0 +1,242 @@
+// --------------------------------------------------------------------------
+//                   OpenMS -- Open-Source Mass Spectrometry
+// --------------------------------------------------------------------------
+// Copyright The OpenMS Team -- Eberhard Karls University Tuebingen,
+// ETH Zurich, and Freie Universitaet Berlin 2002-2020.
+//
+// This software is released under a three-clause BSD license:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of any author or any participating institution
+//    may be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+// For a full list of authors, refer to the file AUTHORS.
+// --------------------------------------------------------------------------
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL ANY OF THE AUTHORS OR THE CONTRIBUTING
+// INSTITUTIONS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// --------------------------------------------------------------------------
+// $Maintainer: agent $
+// $Authors: agent $
+// --------------------------------------------------------------------------
+
+#include <OpenMS/CONCEPT/ClassTest.h>
+#include <OpenMS/test_config.h>
+
+///////////////////////////
+
+#include <OpenMS/FORMAT/FeatureBinFile.h>
+#include <OpenMS/FORMAT/FeatureXMLFile.h>
+
+///////////////////////////
+
+using namespace OpenMS;
+using namespace std;
+
+DRange<1> makeRange(double a, double b)
+{
+  DPosition<1> pa(a), pb(b);
+  return DRange<1>(pa, pb);
+}
+
+/// loads a featureXML and the corresponding featureBin file with the same options
+bool sameAsXML(const String& xml_file, const String& bin_file, const FeatureFileOptions& options)
+{
+  FeatureXMLFile xml;
+  xml.setOptions(options);
+  FeatureMap from_xml;
+  xml.load(xml_file, from_xml);
+
+  FeatureBinFile bin;
+  bin.setOptions(options);
+  FeatureMap from_bin;
+  bin.load(bin_file, from_bin);
+  return from_xml == from_bin;
+}
+
+START_TEST(FeatureBinFile, "$Id$")
+
+/////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////
+
+FeatureBinFile* ptr = nullptr;
+FeatureBinFile* nullPointer = nullptr;
+START_SECTION((FeatureBinFile()))
+  ptr = new FeatureBinFile();
+  TEST_NOT_EQUAL(ptr, nullPointer)
+END_SECTION
+
+START_SECTION((~FeatureBinFile()))
+  delete ptr;
+END_SECTION
+
+// FeatureXMLFile_1: peptide identifications, FeatureXMLFile_2_options: convex hulls and (nested) subordinates
+const String xml_1 = OPENMS_GET_TEST_DATA_PATH("FeatureXMLFile_1.featureXML");
+const String xml_2 = OPENMS_GET_TEST_DATA_PATH("FeatureXMLFile_2_options.featureXML");
+String bin_1, bin_2;
+NEW_TMP_FILE(bin_1)
+NEW_TMP_FILE(bin_2)
+
+START_SECTION((void store(const String& filename, const FeatureMap& feature_map)))
+  FeatureMap map;
+  FeatureXMLFile().load(xml_1, map);
+  FeatureBinFile().store(bin_1, map);
+  FeatureXMLFile().load(xml_2, map);
+  FeatureBinFile().store(bin_2, map);
+  TEST_EQUAL(Internal::ColumnarBinaryFormat::hasContentTag(bin_1, FeatureBinFile::CONTENT_TAG), true)
+END_SECTION
+
+START_SECTION((void load(const String& filename, FeatureMap& feature_map)))
+  FeatureMap map, map_bin;
+  FeatureXMLFile().load(xml_1, map);
+  FeatureBinFile().load(bin_1, map_bin);
+  TEST_EQUAL(map_bin.size(), 2)
+  TEST_EQUAL(map_bin.getUnassignedPeptideIdentifications().size(), 2)
+  TEST_EQUAL(map == map_bin, true)
+
+  FeatureXMLFile().load(xml_2, map);
+  FeatureBinFile().load(bin_2, map_bin);
+  TEST_EQUAL(map_bin.size(), 7)
+  TEST_EQUAL(map_bin[3].getSubordinates().size(), 1)
+  TEST_EQUAL(map_bin[3].getSubordinates()[0].getSubordinates().size(), 1)
+  TEST_EQUAL(map == map_bin, true)
+
+  TEST_EXCEPTION(Exception::FileNotFound, FeatureBinFile().load("/does/not/exist.featureBin", map_bin))
+  TEST_EXCEPTION(Exception::ParseError, FeatureBinFile().load(xml_1, map_bin))
+END_SECTION
+
+START_SECTION((FeatureFileOptions& getOptions()))
+  // each option gives the same result as for featureXML
+  FeatureFileOptions options;
+  options.setLoadConvexHull(false);
+  TEST_EQUAL(sameAsXML(xml_2, bin_2, options), true)
+
+  options = FeatureFileOptions();
+  options.setLoadSubordinates(false);
+  TEST_EQUAL(sameAsXML(xml_2, bin_2, options), true)
+
+  options = FeatureFileOptions();
+  options.setLoadPeptideIdentifications(false);
+  TEST_EQUAL(sameAsXML(xml_1, bin_1, options), true)
+
+  options = FeatureFileOptions();
+  options.setMetadataOnly(true);
+  TEST_EQUAL(sameAsXML(xml_1, bin_1, options), true)
+
+  options = FeatureFileOptions();
+  options.setRTRange(makeRange(1.5, 4.5));
+  TEST_EQUAL(sameAsXML(xml_2, bin_2, options), true)
+
+  options = FeatureFileOptions();
+  options.setMZRange(makeRange(1025.0, 2000.0));
+  options.setIntensityRange(makeRange(290.0, 1000.0));
+  TEST_EQUAL(sameAsXML(xml_2, bin_2, options), true)
+
+  FeatureBinFile f;
+  f.getOptions().setRTRange(makeRange(1.5, 4.5));
+  FeatureMap map;
+  f.load(bin_2, map);
+  TEST_EQUAL(map.size(), 5)
+END_SECTION
+
+START_SECTION((const FeatureFileOptions& getOptions() const))
+  const FeatureBinFile f;
+  TEST_EQUAL(f.getOptions().getLoadConvexHull(), true)
+END_SECTION
+
+START_SECTION((void setOptions(const FeatureFileOptions& options)))
+  FeatureBinFile f;
+  FeatureFileOptions options;
+  options.setLoadPeptideIdentifications(false);
+  f.setOptions(options);
+  TEST_EQUAL(f.getOptions().getLoadPeptideIdentifications(), false)
+END_SECTION
+
+START_SECTION((Size loadSize(const String& filename)))
+  TEST_EQUAL(FeatureBinFile().loadSize(bin_1), 2)
+  TEST_EQUAL(FeatureBinFile().loadSize(bin_2), 7)
+END_SECTION
+
+START_SECTION((void open(const String& filename)))
+  FeatureBinFile f;
+  TEST_EXCEPTION(Exception::IllegalArgument, f.size())
+  f.open(bin_2);
+  TEST_EQUAL(f.size(), 7)
+END_SECTION
+
+START_SECTION((Size size() const))
+  NOT_TESTABLE // tested above
+END_SECTION
+
+START_SECTION((std::vector<double> getRTs() const))
+  FeatureBinFile f;
+  f.open(bin_2);
+  vector<double> rts = f.getRTs();
+  TEST_EQUAL(rts.size(), 7)
+  TEST_REAL_SIMILAR(rts[4], 5.1)
+  TEST_REAL_SIMILAR(rts[5], 4.1)
+END_SECTION
+
+START_SECTION((std::vector<double> getMZs() const))
+  FeatureBinFile f;
+  f.open(bin_2);
+  vector<double> mzs = f.getMZs();
+  TEST_EQUAL(mzs.size(), 7)
+  TEST_REAL_SIMILAR(mzs[4], 1050)
+  TEST_REAL_SIMILAR(mzs[5], 1020)
+END_SECTION
+
+START_SECTION((std::vector<float> getIntensities() const))
+  FeatureBinFile f;
+  f.open(bin_2);
+  vector<float> intensities = f.getIntensities();
+  TEST_EQUAL(intensities.size(), 7)
+  TEST_REAL_SIMILAR(intensities[4], 500)
+  TEST_REAL_SIMILAR(intensities[5], 250)
+END_SECTION
+
+START_SECTION((std::vector<float> getQualities() const))
+  FeatureBinFile f;
+  f.open(bin_1);
+  FeatureMap map;
+  FeatureXMLFile().load(xml_1, map);
+  vector<float> qualities = f.getQualities();
+  TEST_EQUAL(qualities.size(), 2)
+  TEST_REAL_SIMILAR(qualities[1], map[1].getOverallQuality())
+END_SECTION
+
+START_SECTION((std::vector<Int> getCharges() const))
+  FeatureBinFile f;
+  f.open(bin_1);
+  FeatureMap map;
+  FeatureXMLFile().load(xml_1, map);
+  vector<Int> charges = f.getCharges();
+  TEST_EQUAL(charges.size(), 2)
+  TEST_EQUAL(charges[0], map[0].getCharge())
+END_SECTION
+
+START_SECTION((std::vector<UInt64> getUniqueIds() const))
+  FeatureBinFile f;
+  f.open(bin_1);
+  FeatureMap map;
+  FeatureXMLFile().load(xml_1, map);
+  vector<UInt64> ids = f.getUniqueIds();
+  TEST_EQUAL(ids.size(), 2)
+  TEST_EQUAL(ids[1], map[1].getUniqueId())
+END_SECTION
+
+/////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////
+END_TEST
@@ -227,6 +227,22 @@ START_SECTION((void load(const String &filename, FeatureMap&feature_map)))
       e_full[ic].setSubordinates(empty_f);
     TEST_EQUAL(e_full, e)
   }
+
+  // peptide identifications:
+  {
+    dfmap_file.getOptions() = FeatureFileOptions();
+    FeatureMap e_full;
+    dfmap_file.load(OPENMS_GET_TEST_DATA_PATH("FeatureXMLFile_1.featureXML"), e_full);
+    dfmap_file.getOptions().setLoadPeptideIdentifications(false);
+    dfmap_file.load(OPENMS_GET_TEST_DATA_PATH("FeatureXMLFile_1.featureXML"), e);
+    TEST_EQUAL(e.size(), e_full.size())
+    TEST_EQUAL(e.getUnassignedPeptideIdentifications().empty(), true)
+    // delete IDs manually
+    for (Size ic = 0; ic < e_full.size(); ++ic)
+      e_full[ic].getPeptideIdentifications().clear();
+    e_full.getUnassignedPeptideIdentifications().clear();
+    TEST_EQUAL(e_full, e)
+  }
 }
 END_SECTION
 
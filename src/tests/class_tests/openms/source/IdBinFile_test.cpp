@@ -0,0 +1,215 @@
+// --------------------------------------------------------------------------
+//                   OpenMS -- Open-Source Mass Spectrometry
+// --------------------------------------------------------------------------
+// Copyright The OpenMS Team -- Eberhard Karls University Tuebingen,
+// ETH Zurich, and Freie Universitaet Berlin 2002-2020.
+//
+// This software is released under a three-clause BSD license:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of any author or any participating institution
+//    may be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+// For a full list of authors, refer to the file AUTHORS.
+// --------------------------------------------------------------------------
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL ANY OF THE AUTHORS OR THE CONTRIBUTING
+// INSTITUTIONS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// --------------------------------------------------------------------------
+// $Maintainer: agent $
+// $Authors: agent $
+// --------------------------------------------------------------------------
+
+#include <OpenMS/CONCEPT/ClassTest.h>
+#include <OpenMS/test_config.h>
+
+///////////////////////////
+
+#include <OpenMS/FORMAT/IdBinFile.h>
+#include <OpenMS/FORMAT/IdXMLFile.h>
+
+///////////////////////////
+
+START_TEST(IdBinFile, "$Id$")
+
+/////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////
+
+using namespace OpenMS;
+using namespace std;
+
+IdBinFile* ptr = nullptr;
+IdBinFile* nullPointer = nullptr;
+START_SECTION((IdBinFile()))
+  ptr = new IdBinFile();
+  TEST_NOT_EQUAL(ptr, nullPointer)
+END_SECTION
+
+START_SECTION((~IdBinFile()))
+  delete ptr;
+END_SECTION
+
+vector<ProteinIdentification> protein_ids;
+vector<PeptideIdentification> peptide_ids;
+IdXMLFile().load(OPENMS_GET_TEST_DATA_PATH("IdXMLFile_whole.idXML"), protein_ids, peptide_ids);
+// add some meta values of all supported types
+peptide_ids[0].setMetaValue("int", 42);
+peptide_ids[0].getHits()[0].setMetaValue("double", 0.125);
+peptide_ids[1].getHits()[0].setMetaValue("string_list", ListUtils::create<String>("a,b,c"));
+peptide_ids[2].getHits()[0].setMetaValue("double", 1.5);
+peptide_ids[2].getHits()[0].setMetaValue("int_list", ListUtils::create<Int>("1,2,3"));
+protein_ids[0].getHits()[0].setMetaValue("double_list", ListUtils::create<double>("1.5,2.5"));
+// add PepXML analysis results (with and without sub scores)
+PeptideHit::PepXMLAnalysisResult analysis_result;
+analysis_result.score_type = "peptideprophet";
+analysis_result.higher_is_better = true;
+analysis_result.main_score = 0.95;
+analysis_result.sub_scores["fval"] = 1.25;
+analysis_result.sub_scores["ntt"] = 2.0;
+peptide_ids[0].getHits()[0].addAnalysisResults(analysis_result);
+analysis_result.score_type = "interprophet";
+analysis_result.main_score = 0.9;
+analysis_result.sub_scores.clear();
+peptide_ids[0].getHits()[0].addAnalysisResults(analysis_result);
+peptide_ids[2].getHits()[0].addAnalysisResults(analysis_result);
+
+String filename;
+NEW_TMP_FILE(filename)
+
+START_SECTION((void store(const String& filename, const std::vector<ProteinIdentification>& protein_ids, const std::vector<PeptideIdentification>& peptide_ids)))
+  IdBinFile().store(filename, protein_ids, peptide_ids);
+  TEST_EQUAL(Internal::ColumnarBinaryFormat::hasContentTag(filename, IdBinFile::CONTENT_TAG), true)
+END_SECTION
+
+START_SECTION((void load(const String& filename, std::vector<ProteinIdentification>& protein_ids, std::vector<PeptideIdentification>& peptide_ids)))
+  vector<ProteinIdentification> protein_ids2;
+  vector<PeptideIdentification> peptide_ids2;
+  IdBinFile().load(filename, protein_ids2, peptide_ids2);
+
+  TEST_EQUAL(protein_ids2.size(), protein_ids.size())
+  TEST_EQUAL(peptide_ids2.size(), peptide_ids.size())
+  TEST_EQUAL(protein_ids == protein_ids2, true)
+  TEST_EQUAL(peptide_ids == peptide_ids2, true)
+  TEST_EQUAL(peptide_ids2[1].getHits()[0].getMetaValue("string_list").toStringList().size(), 3)
+
+  // analysis results survive the round trip
+  const vector<PeptideHit::PepXMLAnalysisResult>& results = peptide_ids2[0].getHits()[0].getAnalysisResults();
+  TEST_EQUAL(results.size(), 2)
+  TEST_EQUAL(results[0].score_type, "peptideprophet")
+  TEST_EQUAL(results[0].higher_is_better, true)
+  TEST_REAL_SIMILAR(results[0].main_score, 0.95)
+  TEST_EQUAL(results[0].sub_scores.size(), 2)
+  TEST_REAL_SIMILAR(results[0].sub_scores.at("fval"), 1.25)
+  TEST_EQUAL(results[1].score_type, "interprophet")
+  TEST_EQUAL(results[1].sub_scores.empty(), true)
+  TEST_EQUAL(peptide_ids2[2].getHits()[0].getAnalysisResults().size(), 1)
+  TEST_EQUAL(peptide_ids2[1].getHits()[0].getAnalysisResults().empty(), true)
+
+  TEST_EXCEPTION(Exception::FileNotFound, IdBinFile().load("/does/not/exist.idBin", protein_ids2, peptide_ids2))
+  TEST_EXCEPTION(Exception::ParseError, IdBinFile().load(OPENMS_GET_TEST_DATA_PATH("IdXMLFile_whole.idXML"), protein_ids2, peptide_ids2))
+END_SECTION
+
+START_SECTION((void open(const String& filename)))
+  IdBinFile f;
+  TEST_EXCEPTION(Exception::IllegalArgument, f.getNrOfPeptideIdentifications())
+  f.open(filename);
+  TEST_EQUAL(f.getNrOfPeptideIdentifications(), peptide_ids.size())
+END_SECTION
+
+START_SECTION((Size getNrOfPeptideHits() const))
+  IdBinFile f;
+  f.open(filename);
+  Size n_hits = 0;
+  for (const PeptideIdentification& pep : peptide_ids) n_hits += pep.getHits().size();
+  TEST_EQUAL(f.getNrOfPeptideHits(), n_hits)
+END_SECTION
+
+START_SECTION((std::vector<double> getRTs() const))
+  IdBinFile f;
+  f.open(filename);
+  vector<double> rts = f.getRTs();
+  TEST_EQUAL(rts.size(), peptide_ids.size())
+  TEST_REAL_SIMILAR(rts[0], peptide_ids[0].getRT())
+END_SECTION
+
+START_SECTION((std::vector<double> getMZs() const))
+  IdBinFile f;
+  f.open(filename);
+  vector<double> mzs = f.getMZs();
+  TEST_EQUAL(mzs.size(), peptide_ids.size())
+  TEST_REAL_SIMILAR(mzs[0], peptide_ids[0].getMZ())
+END_SECTION
+
+START_SECTION((std::vector<UInt64> getHitOffsets() const))
+  IdBinFile f;
+  f.open(filename);
+  vector<UInt64> offsets = f.getHitOffsets();
+  TEST_EQUAL(offsets.size(), peptide_ids.size() + 1)
+  TEST_EQUAL(offsets[1] - offsets[0], peptide_ids[0].getHits().size())
+END_SECTION
+
+START_SECTION((std::vector<double> getHitScores() const))
+  IdBinFile f;
+  f.open(filename);
+  vector<double> scores = f.getHitScores();
+  TEST_REAL_SIMILAR(scores[0], peptide_ids[0].getHits()[0].getScore())
+END_SECTION
+
+START_SECTION((std::vector<Int> getHitCharges() const))
+  IdBinFile f;
+  f.open(filename);
+  vector<Int> charges = f.getHitCharges();
+  TEST_EQUAL(charges[0], peptide_ids[0].getHits()[0].getCharge())
+END_SECTION
+
+START_SECTION((std::vector<String> getHitSequences() const))
+  IdBinFile f;
+  f.open(filename);
+  vector<String> sequences = f.getHitSequences();
+  TEST_EQUAL(sequences[0], peptide_ids[0].getHits()[0].getSequence().toString())
+END_SECTION
+
+START_SECTION((std::vector<std::pair<UInt64, DataValue> > getHitMetaValues(const String& name) const))
+  IdBinFile f;
+  f.open(filename);
+  vector<pair<UInt64, DataValue> > values = f.getHitMetaValues("double");
+  TEST_EQUAL(values.size(), 2)
+  TEST_EQUAL(values[0].first, 0)
+  TEST_REAL_SIMILAR(double(values[0].second), 0.125)
+  TEST_REAL_SIMILAR(double(values[1].second), 1.5)
+  TEST_EQUAL(f.getHitMetaValues("not_there").empty(), true)
+END_SECTION
+
+START_SECTION((void getProteinIdentifications(std::vector<ProteinIdentification>& protein_ids) const))
+  IdBinFile f;
+  f.open(filename);
+  vector<ProteinIdentification> protein_ids2;
+  f.getProteinIdentifications(protein_ids2);
+  TEST_EQUAL(protein_ids == protein_ids2, true)
+END_SECTION
+
+START_SECTION((PeptideIdentification getPeptideIdentification(Size index) const))
+  IdBinFile f;
+  f.open(filename);
+  for (Size i = 0; i < peptide_ids.size(); ++i)
+  {
+    TEST_EQUAL(f.getPeptideIdentification(i) == peptide_ids[i], true)
+  }
+  TEST_EXCEPTION(Exception::IndexOverflow, f.getPeptideIdentification(peptide_ids.size()))
+END_SECTION
+
+/////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////
+END_TEST
@@ -44,6 +44,7 @@
 #include <OpenMS/FORMAT/ConsensusXMLFile.h>
 #include <OpenMS/FORMAT/MzDataFile.h>
 #include <OpenMS/FORMAT/MzMLFile.h>
+#include <OpenMS/KERNEL/OnDiscMSExperiment.h>
 
 using namespace OpenMS;
 using namespace std;
@@ -515,6 +516,59 @@ START_SECTION((void extractChannels(const PeakMap&ms_exp_data, ConsensusMap & co
 }
 END_SECTION
 
+START_SECTION((void extractChannels(const OnDiscMSExperiment& ms_exp_data, ConsensusMap& consensus_map)))
+{
+  PeakMap exp;
+  MzMLFile().load(OPENMS_GET_TEST_DATA_PATH("IsobaricChannelExtractor_6.mzML"), exp);
+  // write an indexed mzML file to read from disk
+  String indexed_file;
+  NEW_TMP_FILE(indexed_file);
+  MzMLFile().store(indexed_file, exp);
+
+  OnDiscMSExperiment exp_on_disc;
+  TEST_EQUAL(exp_on_disc.openFile(indexed_file), true)
+
+  IsobaricChannelExtractor ice(q_method);
+  // disable activation filtering
+  Param p = ice.getParameters();
+  p.setValue("select_activation", "");
+  p.setValue("min_precursor_purity", 0.75);
+  ice.setParameters(p);
+
+  // the result has to be identical to the extraction from memory
+  ConsensusMap cm_in_memory, cm_on_disc;
+  ice.extractChannels(exp, cm_in_memory);
+  ice.extractChannels(exp_on_disc, cm_on_disc);
+
+  TEST_EQUAL(cm_on_disc.size(), 3)
+  TEST_EQUAL(cm_on_disc.size(), cm_in_memory.size())
+  ABORT_IF(cm_on_disc.size() != cm_in_memory.size())
+  TEST_EQUAL(cm_on_disc.getColumnHeaders().size(), cm_in_memory.getColumnHeaders().size())
+  for (Size i = 0; i < cm_on_disc.size(); ++i)
+  {
+    TEST_EQUAL(cm_on_disc[i].getMetaValue("scan_id"), cm_in_memory[i].getMetaValue("scan_id"))
+    TEST_REAL_SIMILAR(cm_on_disc[i].getRT(), cm_in_memory[i].getRT())
+    TEST_REAL_SIMILAR(cm_on_disc[i].getMZ(), cm_in_memory[i].getMZ())
+    TEST_REAL_SIMILAR(cm_on_disc[i].getIntensity(), cm_in_memory[i].getIntensity())
+    TEST_REAL_SIMILAR(cm_on_disc[i].getMetaValue("precursor_purity"), cm_in_memory[i].getMetaValue("precursor_purity"))
+    TEST_EQUAL(cm_on_disc[i].size(), cm_in_memory[i].size())
+    ABORT_IF(cm_on_disc[i].size() != cm_in_memory[i].size())
+    for (ConsensusFeature::const_iterator it_disc = cm_on_disc[i].begin(), it_mem = cm_in_memory[i].begin();
+         it_disc != cm_on_disc[i].end(); ++it_disc, ++it_mem)
+    {
+      TEST_EQUAL(it_disc->getMapIndex(), it_mem->getMapIndex())
+      TEST_REAL_SIMILAR(it_disc->getIntensity(), it_mem->getIntensity())
+    }
+  }
+
+  // meta data is required
+  OnDiscMSExperiment exp_no_meta;
+  exp_no_meta.openFile(indexed_file, true);
+  ConsensusMap cm_no_meta;
+  TEST_EXCEPTION(Exception::MissingInformation, ice.extractChannels(exp_no_meta, cm_no_meta))
+}
+END_SECTION
+
 START_SECTION(([EXTRA] purity computation without interpolation))
 {
   // check precursor purity computation
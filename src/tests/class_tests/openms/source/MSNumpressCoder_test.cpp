@@ -208,6 +208,60 @@ START_SECTION(([MSNumpressCoder::NumpressConfig] NumpressConfig()))
 }
 END_SECTION
 
+START_SECTION((static Size decodedSizeBound(size_t in_size, const NumpressConfig & config)))
+{
+  MSNumpressCoder::NumpressConfig config;
+  TEST_EQUAL(MSNumpressCoder::decodedSizeBound(20, config), 0)
+  config.np_compression = MSNumpressCoder::LINEAR;
+  TEST_EQUAL(MSNumpressCoder::decodedSizeBound(20, config), 40)
+  config.np_compression = MSNumpressCoder::PIC;
+  TEST_EQUAL(MSNumpressCoder::decodedSizeBound(20, config), 40)
+  config.np_compression = MSNumpressCoder::SLOF;
+  TEST_EQUAL(MSNumpressCoder::decodedSizeBound(20, config), 10)
+}
+END_SECTION
+
+START_SECTION((Size decodeNPRaw(const unsigned char* in, size_t in_size, double* out, const NumpressConfig & config)))
+{
+  // long enough to decode most values from full 64 bit words
+  std::vector<double> in;
+  for (Size i = 0; i < 1000; ++i)
+  {
+    in.push_back(400.0 + i * 0.01 + (i % 7) * 0.001);
+  }
+
+  for (int c = MSNumpressCoder::LINEAR; c <= MSNumpressCoder::SLOF; ++c)
+  {
+    MSNumpressCoder::NumpressConfig config;
+    config.np_compression = (MSNumpressCoder::NumpressCompression)c;
+
+    String raw;
+    MSNumpressCoder().encodeNPRaw(in, raw, config);
+    TEST_EQUAL(raw.empty(), false)
+
+    std::vector<double> expected;
+    MSNumpressCoder().decodeNPRaw(raw, expected, config);
+    TEST_EQUAL(expected.size(), in.size())
+
+    std::vector<double> buffer(MSNumpressCoder::decodedSizeBound(raw.size(), config));
+    Size count = MSNumpressCoder().decodeNPRaw(reinterpret_cast<const unsigned char*>(raw.c_str()), raw.size(), &buffer[0], config);
+    TEST_EQUAL(count, in.size())
+    ABORT_IF(count != expected.size())
+    for (Size i = 0; i < count; ++i)
+    {
+      TEST_EQUAL(buffer[i], expected[i])
+    }
+  }
+
+  // corrupt data (truncated after the fixed point)
+  MSNumpressCoder::NumpressConfig config;
+  config.np_compression = MSNumpressCoder::LINEAR;
+  unsigned char corrupt[10] = {0};
+  double out[20];
+  TEST_EXCEPTION(Exception::ConversionError, MSNumpressCoder().decodeNPRaw(corrupt, 10, out, config))
+}
+END_SECTION
+
 ///////////////////////////////////////////////////////////////////////////
 // Encode / Decode a small vector
 ///////////////////////////////////////////////////////////////////////////
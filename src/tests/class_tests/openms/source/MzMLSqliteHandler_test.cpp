@@ -284,6 +284,66 @@ START_SECTION( void readSpectra(std::vector<MSSpectrum> & exp, const std::vector
 }
 END_SECTION
 
+START_SECTION(void readSpectrumRange(std::vector<MSSpectrum> & exp, Size first, Size last, bool meta_only = false) const)
+{
+  MzMLSqliteHandler handler(OPENMS_GET_TEST_DATA_PATH("SqliteMassFile_1.sqMass"));
+
+  {
+    std::vector<MSSpectrum> exp;
+    handler.readSpectrumRange(exp, 0, 2, false);
+    TEST_EQUAL(exp.size(), 2)
+    TEST_EQUAL(exp[0].size(), 19914)
+    TEST_EQUAL(exp[1].size(), 19800)
+    TEST_REAL_SIMILAR(exp[0].getRT(), 0.2961)
+    TEST_REAL_SIMILAR(exp[1].getRT(), 0.4738)
+
+    // same data as reading by indices
+    std::vector<MSSpectrum> exp2;
+    std::vector<int> indices = {0, 1};
+    handler.readSpectra(exp2, indices, false);
+    TEST_EQUAL(exp == exp2, true)
+  }
+
+  {
+    std::vector<MSSpectrum> exp;
+    handler.readSpectrumRange(exp, 1, 2, true);
+    TEST_EQUAL(exp.size(), 1)
+    TEST_EQUAL(exp[0].size(), 0)
+    TEST_REAL_SIMILAR(exp[0].getRT(), 0.4738)
+  }
+
+  {
+    std::vector<MSSpectrum> exp(1);
+    handler.readSpectrumRange(exp, 1, 1, false);
+    TEST_EQUAL(exp.size(), 0)
+  }
+
+  {
+    std::vector<MSSpectrum> exp;
+    TEST_EXCEPTION(Exception::IllegalArgument, handler.readSpectrumRange(exp, 1, 3, false));
+  }
+}
+END_SECTION
+
+START_SECTION(void readChromatogramRange(std::vector<MSChromatogram> & exp, Size first, Size last, bool meta_only = false) const)
+{
+  MzMLSqliteHandler handler(OPENMS_GET_TEST_DATA_PATH("SqliteMassFile_1.sqMass"));
+
+  {
+    std::vector<MSChromatogram> exp;
+    handler.readChromatogramRange(exp, 0, 1, true);
+    TEST_EQUAL(exp.size(), 1)
+    TEST_EQUAL(exp[0].size(), 0)
+    TEST_STRING_EQUAL(exp[0].getNativeID(), "TIC")
+  }
+
+  {
+    std::vector<MSChromatogram> exp;
+    TEST_EXCEPTION(Exception::IllegalArgument, handler.readChromatogramRange(exp, 0, 2, false));
+  }
+}
+END_SECTION
+
 START_SECTION(void readChromatograms(std::vector<MSChromatogram> & exp, const std::vector<int> & indices, bool meta_only = false) const)
 {
   MzMLSqliteHandler handler(OPENMS_GET_TEST_DATA_PATH("SqliteMassFile_1.sqMass"));
@@ -435,6 +495,53 @@ START_SECTION(std::vector<size_t> getSpectraIndicesbyRT(double RT, double deltaR
 }
 END_SECTION
 
+START_SECTION(void setByteShuffle(bool byte_shuffle))
+{
+  MSExperiment exp_orig;
+  MzMLFile().load(OPENMS_GET_TEST_DATA_PATH("IndexedmzMLFile_1.mzML"), exp_orig);
+
+  std::string tmp_filename;
+  NEW_TMP_FILE(tmp_filename);
+
+  // delete file if present
+  QFile file (String(tmp_filename).toQString());
+  file.remove();
+
+  {
+    MzMLSqliteHandler handler(tmp_filename);
+    handler.setConfig(true, false, 0.0001);
+    handler.setByteShuffle(true);
+    handler.createTables();
+    handler.writeExperiment(exp_orig);
+  }
+
+  // byte shuffling is lossless
+  MzMLSqliteHandler handler(tmp_filename);
+  MSExperiment exp;
+  handler.readExperiment(exp, false);
+  TEST_EQUAL(exp.getNrSpectra(), 2)
+  TEST_EQUAL(exp.getNrChromatograms(), 1)
+  for (Size i = 0; i < exp.getNrSpectra(); i++)
+  {
+    TEST_EQUAL(exp.getSpectrum(i).size(), exp_orig.getSpectrum(i).size())
+    for (Size j = 0; j < exp.getSpectrum(i).size(); j++)
+    {
+      TEST_EQUAL(exp.getSpectrum(i)[j].getMZ(), exp_orig.getSpectrum(i)[j].getMZ())
+      TEST_EQUAL(exp.getSpectrum(i)[j].getIntensity(), exp_orig.getSpectrum(i)[j].getIntensity())
+    }
+  }
+  for (Size i = 0; i < exp.getNrChromatograms(); i++)
+  {
+    TEST_EQUAL(exp.getChromatogram(i).size(), exp_orig.getChromatogram(i).size())
+    for (Size j = 0; j < exp.getChromatogram(i).size(); j++)
+    {
+      TEST_EQUAL(exp.getChromatogram(i)[j].getRT(), exp_orig.getChromatogram(i)[j].getRT())
+      TEST_EQUAL(exp.getChromatogram(i)[j].getIntensity(), exp_orig.getChromatogram(i)[j].getIntensity())
+    }
+  }
+}
+END_SECTION
+
 START_SECTION(void writeExperiment(const MSExperiment & exp))
 {
   MSExperiment exp_orig;
@@ -121,6 +121,51 @@ START_SECTION(void store(const String& filename, MzTab& mzTab) )
 }
 END_SECTION
 
+START_SECTION(void beginStore(const String& filename, const MzTabMetaData& meta_data))
+{
+  MzTabFile f;
+  TEST_EXCEPTION(Exception::UnableToCreateFile, f.beginStore("test.txt", MzTabMetaData()))
+  TEST_EXCEPTION(Exception::IllegalArgument, f.storeRows(MzTabPSMSectionRows(), vector<String>()))
+  TEST_EXCEPTION(Exception::IllegalArgument, f.endStore())
+}
+END_SECTION
+
+START_SECTION(void storeRows(...))
+{
+  // storing in blocks gives the same file as storing everything at once
+  MzTab mzTab;
+  MzTabFile().load(OPENMS_GET_TEST_DATA_PATH("MzTabFile_SILAC.mzTab"), mzTab);
+  mzTab.setCommentRows(std::map<Size, String>());
+  mzTab.setEmptyRows(std::vector<Size>());
+
+  String stored_mzTab;
+  NEW_TMP_FILE(stored_mzTab)
+  MzTabFile().store(stored_mzTab, mzTab);
+
+  String streamed_mzTab;
+  NEW_TMP_FILE(streamed_mzTab)
+  MzTabFile f;
+  f.beginStore(streamed_mzTab, mzTab.getMetaData());
+  f.storeRows(mzTab.getProteinSectionRows(), mzTab.getProteinOptionalColumnNames());
+  const MzTabPeptideSectionRows& peptides = mzTab.getPeptideSectionRows();
+  for (Size i = 0; i < peptides.size(); i += 2)
+  {
+    MzTabPeptideSectionRows block(peptides.begin() + i, peptides.begin() + std::min(i + 2, peptides.size()));
+    f.storeRows(block, mzTab.getPeptideOptionalColumnNames());
+  }
+  f.storeRows(MzTabPSMSectionRows(), mzTab.getPSMOptionalColumnNames()); // empty blocks are ignored
+  f.storeRows(mzTab.getPSMSectionRows(), mzTab.getPSMOptionalColumnNames());
+  if (!mzTab.getPSMSectionRows().empty())
+  {
+    TEST_EXCEPTION(Exception::IllegalArgument, f.storeRows(mzTab.getProteinSectionRows(), mzTab.getProteinOptionalColumnNames()))
+  }
+  f.storeRows(mzTab.getSmallMoleculeSectionRows(), mzTab.getSmallMoleculeOptionalColumnNames());
+  f.endStore();
+
+  TEST_FILE_EQUAL(streamed_mzTab.c_str(), stored_mzTab.c_str())
+}
+END_SECTION
+
 START_SECTION(~MzTabFile())
 {
   delete ptr;
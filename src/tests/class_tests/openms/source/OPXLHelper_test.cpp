@@ -42,6 +42,7 @@
 #include <OpenMS/ANALYSIS/XLMS/OPXLDataStructs.h>
 #include <OpenMS/CHEMISTRY/TheoreticalSpectrumGeneratorXLMS.h>
 #include <OpenMS/CHEMISTRY/TheoreticalSpectrumGenerator.h>
+#include <OpenMS/CHEMISTRY/SimpleTSGXLMS.h>
 #include <OpenMS/ANALYSIS/XLMS/OPXLSpectrumProcessingAlgorithms.h>
 #include <OpenMS/FORMAT/FASTAFile.h>
 #include <OpenMS/CHEMISTRY/ProteaseDigestion.h>
@@ -150,6 +151,62 @@ START_SECTION(static std::vector<OPXLDataStructs::XLPrecursor> enumerateCrossLin
 
 END_SECTION
 
+SimpleTSGXLMS linear_spec_gen;
+OPXLDataStructs::LinearFragmentLadders linear_ladders;
+
+START_SECTION(static OPXLDataStructs::LinearFragmentLadders computeLinearFragmentLadders(const std::vector<OPXLDataStructs::AASeqWithMass>& peptides, const SimpleTSGXLMS& spec_gen, int charge))
+  linear_ladders = OPXLHelper::computeLinearFragmentLadders(peptides, linear_spec_gen, 2);
+
+  TEST_EQUAL(linear_ladders.ladders.size(), peptides.size())
+  TEST_EQUAL(linear_ladders.peptide_index.size(), peptides.size())
+  TEST_EQUAL(&linear_ladders.getLadder(&peptides[700].peptide_seq) == &linear_ladders.ladders[700], true)
+  TEST_EQUAL(std::is_sorted(linear_ladders.ladders[700].begin(), linear_ladders.ladders[700].end()), true)
+
+  // the ladder contains the linear ions for every cross-link position
+  AASequence peptide = peptides[700].peptide_seq;
+  const std::vector< float >& ladder = linear_ladders.ladders[700];
+  for (Size link_pos = 0; link_pos < peptide.size(); ++link_pos)
+  {
+    std::vector< SimpleTSGXLMS::SimplePeak > linear_spectrum;
+    linear_spec_gen.getLinearIonSpectrum(linear_spectrum, peptide, link_pos, 2);
+    Size found = 0;
+    for (const SimpleTSGXLMS::SimplePeak& peak : linear_spectrum)
+    {
+      if (std::binary_search(ladder.begin(), ladder.end(), static_cast<float>(peak.mz))) ++found;
+    }
+    TEST_EQUAL(found, linear_spectrum.size())
+  }
+END_SECTION
+
+START_SECTION(static bool hasLinearFragmentMatches(const std::vector< float >& ladder, const PeakSpectrum& exp_spectrum, Size min_matches, double fragment_mass_tolerance, bool fragment_mass_tolerance_unit_ppm))
+  AASequence peptide = peptides[700].peptide_seq;
+  std::vector< SimpleTSGXLMS::SimplePeak > linear_spectrum;
+  linear_spec_gen.getLinearIonSpectrum(linear_spectrum, peptide, 3, 2);
+
+  // three slightly shifted linear fragment peaks and some noise
+  PeakSpectrum exp_spectrum;
+  exp_spectrum.push_back(Peak1D(linear_spectrum[0].mz - 0.5, 100.0));
+  for (Size i = 0; i < 3; ++i)
+  {
+    exp_spectrum.push_back(Peak1D(linear_spectrum[i * 2].mz + 2e-6 * linear_spectrum[i * 2].mz, 100.0));
+  }
+  exp_spectrum.sortByPosition();
+
+  const std::vector< float >& ladder = linear_ladders.getLadder(&peptides[700].peptide_seq);
+  TEST_EQUAL(OPXLHelper::hasLinearFragmentMatches(ladder, exp_spectrum, 2, 10, true), true)
+  TEST_EQUAL(OPXLHelper::hasLinearFragmentMatches(ladder, exp_spectrum, 3, 10, true), true)
+  TEST_EQUAL(OPXLHelper::hasLinearFragmentMatches(ladder, exp_spectrum, 4, 10, true), false)
+  TEST_EQUAL(OPXLHelper::hasLinearFragmentMatches(ladder, exp_spectrum, 2, 1, true), false)
+  TEST_EQUAL(OPXLHelper::hasLinearFragmentMatches(ladder, exp_spectrum, 2, 0.01, false), true)
+  TEST_EQUAL(OPXLHelper::hasLinearFragmentMatches(ladder, PeakSpectrum(), 2, 10, true), false)
+  TEST_EQUAL(OPXLHelper::hasLinearFragmentMatches(ladder, PeakSpectrum(), 0, 10, true), true)
+
+  // never rejects a candidate accepted by the exact alignment
+  std::vector< std::pair< Size, Size > > alignment;
+  OPXLSpectrumProcessingAlgorithms::getSpectrumAlignmentSimple(alignment, 10, true, linear_spectrum, exp_spectrum, DataArrays::IntegerDataArray());
+  TEST_EQUAL(alignment.size(), 3)
+END_SECTION
+
 // building more data structures required in the following test
 std::cout << std::endl;
 std::vector< int > spectrum_precursor_correction_positions;
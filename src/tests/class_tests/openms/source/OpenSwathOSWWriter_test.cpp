@@ -0,0 +1,146 @@
+// --------------------------------------------------------------------------
+//                   OpenMS -- Open-Source Mass Spectrometry
+// --------------------------------------------------------------------------
+// Copyright The OpenMS Team -- Eberhard Karls University Tuebingen,
+// ETH Zurich, and Freie Universitaet Berlin 2002-2020.
+//
+// This software is released under a three-clause BSD license:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of any author or any participating institution
+//    may be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+// For a full list of authors, refer to the file AUTHORS.
+// --------------------------------------------------------------------------
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL ANY OF THE AUTHORS OR THE CONTRIBUTING
+// INSTITUTIONS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// --------------------------------------------------------------------------
+// $Maintainer: agent $
+// $Authors: agent $
+// --------------------------------------------------------------------------
+
+#include <OpenMS/CONCEPT/ClassTest.h>
+#include <OpenMS/test_config.h>
+
+///////////////////////////
+#include <OpenMS/ANALYSIS/OPENSWATH/OpenSwathOSWWriter.h>
+///////////////////////////
+
+#include <OpenMS/FORMAT/SqliteConnector.h>
+
+#include <sqlite3.h>
+
+#include <limits>
+
+using namespace OpenMS;
+using namespace std;
+
+// returns the (numeric) result of a query returning a single value
+double queryValue(const String& filename, const String& sql)
+{
+  SqliteConnector conn(filename);
+  sqlite3_stmt* stmt;
+  conn.prepareStatement(&stmt, sql);
+  sqlite3_step(stmt);
+  double value = sqlite3_column_double(stmt, 0);
+  sqlite3_finalize(stmt);
+  return value;
+}
+
+START_TEST(OpenSwathOSWWriter, "$Id$")
+/////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////
+
+OpenSwathOSWWriter* ptr = nullptr;
+OpenSwathOSWWriter* nullPointer = nullptr;
+
+START_SECTION(OpenSwathOSWWriter(const String& output_filename, const String& input_filename = "inputfile", bool ms1_scores = false, bool sonar = false, bool uis_scores = false))
+{
+  ptr = new OpenSwathOSWWriter("");
+  TEST_NOT_EQUAL(ptr, nullPointer)
+  TEST_EQUAL(ptr->isActive(), false)
+  delete ptr;
+}
+END_SECTION
+
+START_SECTION(bool isActive() const)
+{
+  TEST_EQUAL(OpenSwathOSWWriter("").isActive(), false)
+  TEST_EQUAL(OpenSwathOSWWriter("out.osw").isActive(), true)
+}
+END_SECTION
+
+START_SECTION(void writeRows(OSWRows& rows, Size max_queued_rows = 1000000))
+{
+  String filename;
+  NEW_TMP_FILE(filename)
+  OpenSwathOSWWriter writer(filename);
+  writer.writeHeader();
+
+  // rows are queued from several threads at once (with a small queue, so
+  // that the threads have to wait for the background writer)
+  const int nr_features = 500;
+#ifdef _OPENMP
+#pragma omp parallel for num_threads(4) schedule(dynamic, 1)
+#endif
+  for (int i = 0; i < nr_features; ++i)
+  {
+    OpenSwathOSWWriter::OSWRows rows;
+    rows.feature.push_back({DataValue(i + 1), DataValue(0), DataValue(i % 7), DataValue(i * 1.5), DataValue(),
+                            DataValue(i * 0.5), DataValue(0.0), DataValue(i * 1.5 - 10), DataValue(i * 1.5 + 10)});
+    for (int k = 0; k < 3; ++k)
+    {
+      rows.feature_transition.push_back({DataValue(i + 1), DataValue(k), DataValue(100.0 * k), DataValue(200.0 * k),
+                                         DataValue(10.0 * k), DataValue(std::numeric_limits<double>::quiet_NaN())});
+    }
+    writer.writeRows(rows, 10);
+  }
+  writer.flush();
+
+  // all rows are written exactly once, with the correct values
+  TEST_EQUAL(queryValue(filename, "SELECT COUNT(*) FROM FEATURE;"), nr_features)
+  TEST_EQUAL(queryValue(filename, "SELECT COUNT(DISTINCT ID) FROM FEATURE;"), nr_features)
+  TEST_EQUAL(queryValue(filename, "SELECT COUNT(*) FROM FEATURE_TRANSITION;"), 3 * nr_features)
+  TEST_REAL_SIMILAR(queryValue(filename, "SELECT SUM(EXP_RT) FROM FEATURE;"), 1.5 * nr_features * (nr_features - 1) / 2)
+  TEST_REAL_SIMILAR(queryValue(filename, "SELECT EXP_RT FROM FEATURE WHERE ID = 42;"), 41 * 1.5)
+  TEST_EQUAL(queryValue(filename, "SELECT PRECURSOR_ID FROM FEATURE WHERE ID = 42;"), 41 % 7)
+  TEST_EQUAL(queryValue(filename, "SELECT COUNT(*) FROM FEATURE WHERE EXP_IM IS NULL;"), nr_features)
+  TEST_REAL_SIMILAR(queryValue(filename, "SELECT SUM(AREA_INTENSITY) FROM FEATURE_TRANSITION;"), 300.0 * nr_features)
+  TEST_EQUAL(queryValue(filename, "SELECT COUNT(*) FROM FEATURE_TRANSITION WHERE TOTAL_MI IS NULL;"), 3 * nr_features)
+
+  // further rows after a flush are appended
+  OpenSwathOSWWriter::OSWRows rows;
+  rows.feature.push_back({DataValue(nr_features + 1), DataValue(0), DataValue(0), DataValue(1.0), DataValue(),
+                          DataValue(1.0), DataValue(0.0), DataValue(0.0), DataValue(2.0)});
+  writer.writeRows(rows);
+  TEST_EQUAL(rows.size(), 0)
+  writer.flush();
+  TEST_EQUAL(queryValue(filename, "SELECT COUNT(*) FROM FEATURE;"), nr_features + 1)
+}
+END_SECTION
+
+START_SECTION(void flush())
+{
+  // nothing queued: no-op
+  OpenSwathOSWWriter writer("");
+  writer.flush();
+  NOT_TESTABLE
+}
+END_SECTION
+
+/////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////
+END_TEST
@@ -273,6 +273,62 @@ START_SECTION((OpenSwath::SpectrumPtr OpenSwathScoring::fetchSpectrumSwath(std::
 }
 END_SECTION
 
+START_SECTION((void setSpectrumCache(SpectrumCachePtr cache)))
+{
+  PeakMap* eptr = new PeakMap;
+  for (Size i = 0; i < 4; ++i)
+  {
+    MSSpectrum s;
+    s.emplace_back(20.0 + i, 100.0 * (i + 1));
+    s.setRT(10.0 * (i + 1));
+    eptr->addSpectrum(s);
+  }
+  boost::shared_ptr<PeakMap > swath_map (eptr);
+  OpenSwath::SpectrumAccessPtr swath_ptr = SimpleOpenMSSpectraFactory::getSpectrumAccessOpenMSPtr(swath_map);
+
+  OpenSwathScoring sc;
+  OpenSwath_Scores_Usage su;
+  sc.initialize(1.0, 1, 0.005, 0.0, su, "simple");
+  OpenSwath::SpectrumPtr uncached = sc.fetchSpectrumSwath(swath_ptr, 21.0, 3, 0, 0);
+
+  OpenSwathScoring::SpectrumCachePtr cache(new OpenSwathScoring::SpectrumCache(1.0));
+  sc.setSpectrumCache(cache);
+  OpenSwath::SpectrumPtr sp1 = sc.fetchSpectrumSwath(swath_ptr, 21.0, 3, 0, 0);
+  TEST_EQUAL(cache->getHits(), 0)
+  TEST_EQUAL(cache->getMisses(), 1)
+  TEST_EQUAL(sp1->getMZArray()->data == uncached->getMZArray()->data, true)
+  TEST_EQUAL(sp1->getIntensityArray()->data == uncached->getIntensityArray()->data, true)
+
+  // same closest spectrum (RT 20) -> same added up spectrum
+  OpenSwath::SpectrumPtr sp2 = sc.fetchSpectrumSwath(swath_ptr, 19.0, 3, 0, 0);
+  TEST_EQUAL(sp1 == sp2, true)
+  TEST_EQUAL(cache->getHits(), 1)
+
+  // different closest spectrum or number of spectra
+  OpenSwath::SpectrumPtr sp3 = sc.fetchSpectrumSwath(swath_ptr, 29.0, 3, 0, 0);
+  TEST_EQUAL(sp1 == sp3, false)
+  TEST_REAL_SIMILAR(sp3->getIntensityArray()->data[0], 200.0)
+  OpenSwath::SpectrumPtr sp4 = sc.fetchSpectrumSwath(swath_ptr, 21.0, 1, 0, 0);
+  TEST_EQUAL(sp4->getMZArray()->data.size(), 1)
+  TEST_EQUAL(cache->getHits(), 1)
+  TEST_EQUAL(cache->getMisses(), 3)
+  TEST_EQUAL(cache->size(), 3)
+
+  cache->clear();
+  TEST_EQUAL(cache->size(), 0)
+  sc.fetchSpectrumSwath(swath_ptr, 21.0, 3, 0, 0);
+  TEST_EQUAL(cache->getMisses(), 4)
+
+  // no space for any spectrum
+  OpenSwathScoring::SpectrumCachePtr empty_cache(new OpenSwathScoring::SpectrumCache(0.0));
+  sc.setSpectrumCache(empty_cache);
+  sc.fetchSpectrumSwath(swath_ptr, 21.0, 3, 0, 0);
+  sc.fetchSpectrumSwath(swath_ptr, 21.0, 3, 0, 0);
+  TEST_EQUAL(empty_cache->size(), 0)
+  TEST_EQUAL(empty_cache->getHits(), 0)
+}
+END_SECTION
+
 /////////////////////////////////////////////////////////////
 /////////////////////////////////////////////////////////////
 END_TEST
@@ -40,6 +40,9 @@
 #include <OpenMS/ANALYSIS/QUANTITATION/PeptideAndProteinQuant.h>
 #include <OpenMS/METADATA/ExperimentalDesign.h>
 
+#ifdef _OPENMP
+  #include <omp.h>
+#endif
 
 using namespace OpenMS;
 using namespace std;
@@ -357,6 +360,72 @@ START_SECTION((const ProteinQuant& getProteinResults()))
 }
 END_SECTION
 
+START_SECTION(([EXTRA] results do not depend on the number of threads))
+{
+  ConsensusMap consensus;
+  ConsensusXMLFile().load(OPENMS_GET_TEST_DATA_PATH("ProteinQuantifier_input.consensusXML"), consensus);
+  ExperimentalDesign design = ExperimentalDesign::fromConsensusMap(consensus);
+  Param parameters;
+  parameters.setValue("top", 0);
+  parameters.setValue("include_all", "true");
+  parameters.setValue("consensus:normalize", "true");
+
+#ifdef _OPENMP
+  int max_threads = omp_get_max_threads();
+  omp_set_num_threads(1);
+#endif
+  PeptideAndProteinQuant serial;
+  serial.setParameters(parameters);
+  serial.readQuantData(consensus, design);
+  serial.quantifyPeptides();
+  serial.quantifyProteins();
+
+#ifdef _OPENMP
+  omp_set_num_threads(4);
+#endif
+  PeptideAndProteinQuant parallel;
+  parallel.setParameters(parameters);
+  parallel.readQuantData(consensus, design);
+  parallel.quantifyPeptides();
+  parallel.quantifyProteins();
+#ifdef _OPENMP
+  omp_set_num_threads(max_threads);
+#endif
+
+  const PeptideAndProteinQuant::PeptideQuant& pep_serial = serial.getPeptideResults();
+  const PeptideAndProteinQuant::PeptideQuant& pep_parallel = parallel.getPeptideResults();
+  TEST_EQUAL(pep_parallel.size(), pep_serial.size());
+  for (auto it_s = pep_serial.begin(), it_p = pep_parallel.begin();
+       it_s != pep_serial.end() && it_p != pep_parallel.end(); ++it_s, ++it_p)
+  {
+    TEST_EQUAL(it_p->first, it_s->first);
+    TEST_EQUAL(it_p->second.total_abundances.size(), it_s->second.total_abundances.size());
+    for (auto const& sa : it_s->second.total_abundances)
+    {
+      TEST_REAL_SIMILAR(it_p->second.total_abundances.at(sa.first), sa.second);
+    }
+  }
+
+  const PeptideAndProteinQuant::ProteinQuant& prot_serial = serial.getProteinResults();
+  const PeptideAndProteinQuant::ProteinQuant& prot_parallel = parallel.getProteinResults();
+  TEST_EQUAL(prot_parallel.size(), prot_serial.size());
+  for (auto it_s = prot_serial.begin(), it_p = prot_parallel.begin();
+       it_s != prot_serial.end() && it_p != prot_parallel.end(); ++it_s, ++it_p)
+  {
+    TEST_EQUAL(it_p->first, it_s->first);
+    TEST_EQUAL(it_p->second.total_abundances.size(), it_s->second.total_abundances.size());
+    for (auto const& sa : it_s->second.total_abundances)
+    {
+      TEST_REAL_SIMILAR(it_p->second.total_abundances.at(sa.first), sa.second);
+    }
+  }
+
+  TEST_EQUAL(parallel.getStatistics().quant_peptides, serial.getStatistics().quant_peptides);
+  TEST_EQUAL(parallel.getStatistics().quant_proteins, serial.getStatistics().quant_proteins);
+  TEST_EQUAL(parallel.getStatistics().quant_features, serial.getStatistics().quant_features);
+}
+END_SECTION
+
 /////////////////////////////////////////////////////////////
 /////////////////////////////////////////////////////////////
 END_TEST
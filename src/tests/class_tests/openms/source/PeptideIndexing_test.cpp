@@ -279,6 +279,44 @@ START_SECTION((ExitCodes run(std::vector<FASTAFile::FASTAEntry>& proteins, std::
 END_SECTION
 
 
+START_SECTION([EXTRA] run with memory_budget (sharded peptides))
+{
+  std::vector<FASTAFile::FASTAEntry> proteins = toFASTAVec(QStringList() << "MKPEPTIDERAAAKLLLKXXXLLKAR" << "AAAKPEPTIDEKLLLR" << "RKEDITPEPK",
+                                                           QStringList() << "P1" << "P2" << "DECOY_P1");
+  QStringList peptides = QStringList() << "PEPTIDER" << "AAAK" << "LLLK" << "AAAK" << "EDITPEPK" << "PEPTIDEK" << "LLLR" << "WWWWK";
+
+  PeptideIndexing pi;
+  Param p = pi.getParameters();
+  p.setValue("decoy_string", "DECOY_");
+  p.setValue("allow_unmatched", "true");
+  p.setValue("enzyme:specificity", "none");
+  pi.setParameters(p);
+  std::vector<ProteinIdentification> prot_ids(1);
+  std::vector<PeptideIdentification> pep_ids = toPepVec(peptides);
+  TEST_EQUAL(pi.run(proteins, prot_ids, pep_ids), PeptideIndexing::EXECUTION_OK)
+
+  p.setValue("memory_budget", 0.00001); // a few bytes: one shard per peptide
+  pi.setParameters(p);
+  std::vector<ProteinIdentification> prot_ids_sharded(1);
+  std::vector<PeptideIdentification> pep_ids_sharded = toPepVec(peptides);
+  TEST_EQUAL(pi.run(proteins, prot_ids_sharded, pep_ids_sharded), PeptideIndexing::EXECUTION_OK)
+
+  TEST_EQUAL(pep_ids_sharded.size(), pep_ids.size())
+  for (Size i = 0; i < pep_ids.size(); ++i)
+  {
+    const PeptideHit& hit = pep_ids[i].getHits()[0];
+    const PeptideHit& hit_sharded = pep_ids_sharded[i].getHits()[0];
+    TEST_EQUAL(hit_sharded.getPeptideEvidences() == hit.getPeptideEvidences(), true)
+    TEST_EQUAL(hit_sharded.getMetaValue("target_decoy"), hit.getMetaValue("target_decoy"))
+    TEST_EQUAL(hit_sharded.getMetaValue("protein_references"), hit.getMetaValue("protein_references"))
+  }
+  TEST_EQUAL(pep_ids_sharded[1].getHits()[0].getPeptideEvidences().size(), 2) // AAAK in P1 and P2
+  TEST_EQUAL(pep_ids_sharded[7].getHits()[0].getPeptideEvidences().size(), 0)
+  TEST_EQUAL(prot_ids_sharded[0].getHits().size(), 3)
+  TEST_EQUAL(prot_ids_sharded[0].getHits() == prot_ids[0].getHits(), true)
+}
+END_SECTION
+
 /////////////////////////////////////////////////////////////
 /////////////////////////////////////////////////////////////
 END_TEST
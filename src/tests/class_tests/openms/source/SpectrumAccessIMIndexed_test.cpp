@@ -0,0 +1,220 @@
+// --------------------------------------------------------------------------
+//                   OpenMS -- Open-Source Mass Spectrometry
+// --------------------------------------------------------------------------
+// Copyright The OpenMS Team -- Eberhard Karls University Tuebingen,
+// ETH Zurich, and Freie Universitaet Berlin 2002-2020.
+//
+// This software is released under a three-clause BSD license:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the distribution.
+//  * Neither the name of any author or any participating institution
+//    may be used to endorse or promote products derived from this software
+//    without specific prior written permission.
+// For a full list of authors, refer to the file AUTHORS.
+// --------------------------------------------------------------------------
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL ANY OF THE AUTHORS OR THE CONTRIBUTING
+// INSTITUTIONS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+// EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+// PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+// OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+// WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+// OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+// ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// --------------------------------------------------------------------------
+// $Maintainer: agent $
+// $Authors: agent $
+// --------------------------------------------------------------------------
+
+#include <OpenMS/CONCEPT/ClassTest.h>
+#include <OpenMS/test_config.h>
+
+#include <OpenMS/ANALYSIS/OPENSWATH/DATAACCESS/SimpleOpenMSSpectraAccessFactory.h>
+#include <OpenMS/ANALYSIS/OPENSWATH/ChromatogramExtractorAlgorithm.h>
+
+///////////////////////////
+#include <OpenMS/ANALYSIS/OPENSWATH/DATAACCESS/SpectrumAccessIMIndexed.h>
+///////////////////////////
+
+#include <cmath>
+
+using namespace OpenMS;
+using namespace std;
+
+// one frame with ion mobility (1000 peaks, unsorted ion mobility) and one spectrum without
+boost::shared_ptr<PeakMap > getData()
+{
+  boost::shared_ptr<PeakMap > exp(new PeakMap);
+  MSSpectrum spec;
+  spec.setRT(10.0);
+  spec.getFloatDataArrays().resize(1);
+  spec.getFloatDataArrays()[0].setName("Ion Mobility");
+  for (Size i = 0; i < 1000; ++i)
+  {
+    Peak1D p;
+    p.setMZ(100.0 + i * 0.01);
+    p.setIntensity(i + 1);
+    spec.push_back(p);
+    spec.getFloatDataArrays()[0].push_back(0.6 + std::fmod(i * 0.37, 0.8));
+  }
+  exp->addSpectrum(spec);
+
+  MSSpectrum spec2;
+  spec2.setRT(20.0);
+  Peak1D p;
+  p.setMZ(100.0);
+  p.setIntensity(50);
+  spec2.push_back(p);
+  exp->addSpectrum(spec2);
+  return exp;
+}
+
+START_TEST(SpectrumAccessIMIndexed, "$Id$")
+
+/////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////
+
+SpectrumAccessIMIndexed* ptr = nullptr;
+SpectrumAccessIMIndexed* nullPointer = nullptr;
+
+boost::shared_ptr<PeakMap > exp = getData();
+OpenSwath::SpectrumAccessPtr expptr = SimpleOpenMSSpectraFactory::getSpectrumAccessOpenMSPtr(exp);
+
+START_SECTION(SpectrumAccessIMIndexed(OpenSwath::SpectrumAccessPtr sptr, Size block_size = 256))
+{
+  ptr = new SpectrumAccessIMIndexed(expptr, 16);
+  TEST_NOT_EQUAL(ptr, nullPointer)
+  TEST_EQUAL(ptr->getNrSpectra(), 2)
+
+  TEST_EXCEPTION(Exception::IllegalArgument, SpectrumAccessIMIndexed(expptr, 0))
+}
+END_SECTION
+
+START_SECTION(~SpectrumAccessIMIndexed())
+{
+  delete ptr;
+}
+END_SECTION
+
+START_SECTION(bool hasIMIndex(int id) const)
+{
+  SpectrumAccessIMIndexed indexed(expptr, 16);
+  TEST_EQUAL(indexed.hasIMIndex(0), true)
+  TEST_EQUAL(indexed.hasIMIndex(1), false)
+}
+END_SECTION
+
+START_SECTION(OpenSwath::SpectrumPtr getSpectrumByIdInIMRange(int id, double drift_lower, double drift_upper))
+{
+  SpectrumAccessIMIndexed indexed(expptr, 16);
+  OpenSwath::SpectrumPtr full = indexed.getSpectrumById(0);
+  TEST_EQUAL(full->getMZArray()->data.size(), 1000)
+
+  OpenSwath::SpectrumPtr filtered = indexed.getSpectrumByIdInIMRange(0, 0.9, 1.0);
+  TEST_NOT_EQUAL(filtered->getDriftTimeArray().get(), (OpenSwath::BinaryDataArray*)nullptr)
+
+  // compare to filtering peak by peak
+  std::vector<double> mz, intensity, im;
+  for (Size i = 0; i < 1000; ++i)
+  {
+    double drift = full->getDriftTimeArray()->data[i];
+    if (drift > 0.9 && drift < 1.0)
+    {
+      mz.push_back(full->getMZArray()->data[i]);
+      intensity.push_back(full->getIntensityArray()->data[i]);
+      im.push_back(drift);
+    }
+  }
+  TEST_EQUAL(mz.empty(), false)
+  TEST_EQUAL(filtered->getMZArray()->data == mz, true)
+  TEST_EQUAL(filtered->getIntensityArray()->data == intensity, true)
+  TEST_EQUAL(filtered->getDriftTimeArray()->data == im, true)
+
+  // empty range
+  TEST_EQUAL(indexed.getSpectrumByIdInIMRange(0, 2.0, 3.0)->getMZArray()->data.size(), 0)
+
+  // no ion mobility: unfiltered spectrum
+  TEST_EQUAL(indexed.getSpectrumByIdInIMRange(1, 0.9, 1.0)->getMZArray()->data.size(), 1)
+
+  // light clones share the index
+  OpenSwath::SpectrumAccessPtr clone = indexed.lightClone();
+  SpectrumAccessIMIndexed* indexed_clone = dynamic_cast<SpectrumAccessIMIndexed*>(clone.get());
+  TEST_NOT_EQUAL(indexed_clone, nullPointer)
+  TEST_EQUAL(indexed_clone->getSpectrumByIdInIMRange(0, 0.9, 1.0)->getMZArray()->data == mz, true)
+}
+END_SECTION
+
+START_SECTION(double integrateBox(int id, const OpenSwath::SpectrumPtr& spectrum, double mz_lower, double mz_upper, double im_lower, double im_upper) const)
+{
+  SpectrumAccessIMIndexed indexed(expptr, 16);
+  OpenSwath::SpectrumPtr full = indexed.getSpectrumById(0);
+
+  double expected = 0;
+  for (Size i = 0; i < 1000; ++i)
+  {
+    double mz = full->getMZArray()->data[i];
+    double drift = full->getDriftTimeArray()->data[i];
+    if (mz > 102.0 && mz < 105.0 && drift > 0.75 && drift < 0.95)
+    {
+      expected += full->getIntensityArray()->data[i];
+    }
+  }
+  TEST_NOT_EQUAL(expected, 0.0)
+  TEST_REAL_SIMILAR(indexed.integrateBox(0, full, 102.0, 105.0, 0.75, 0.95), expected)
+  TEST_REAL_SIMILAR(indexed.integrateBox(0, full, 102.0, 105.0, 2.0, 3.0), 0.0)
+  TEST_REAL_SIMILAR(indexed.integrateBox(0, full, 200.0, 205.0, 0.75, 0.95), 0.0)
+
+  OpenSwath::SpectrumPtr no_im = indexed.getSpectrumById(1);
+  TEST_EXCEPTION(Exception::IllegalArgument, indexed.integrateBox(1, no_im, 99.0, 101.0, 0.75, 0.95))
+}
+END_SECTION
+
+START_SECTION([EXTRA] ChromatogramExtractorAlgorithm with ion mobility index)
+{
+  std::vector<ChromatogramExtractorAlgorithm::ExtractionCoordinates> coordinates(2);
+  coordinates[0].mz = 103.005;
+  coordinates[0].ion_mobility = 0.855;
+  coordinates[0].rt_start = 0;
+  coordinates[0].rt_end = -1;
+  coordinates[0].id = "tr1";
+  coordinates[1].mz = 107.005;
+  coordinates[1].ion_mobility = 1.205;
+  coordinates[1].rt_start = 0;
+  coordinates[1].rt_end = -1;
+  coordinates[1].id = "tr2";
+
+  std::vector<OpenSwath::ChromatogramPtr> out_plain, out_indexed;
+  for (Size i = 0; i < coordinates.size(); ++i)
+  {
+    out_plain.push_back(OpenSwath::ChromatogramPtr(new OpenSwath::Chromatogram));
+    out_indexed.push_back(OpenSwath::ChromatogramPtr(new OpenSwath::Chromatogram));
+  }
+
+  // only the frame with ion mobility
+  boost::shared_ptr<PeakMap > frame(new PeakMap);
+  frame->addSpectrum((*exp)[0]);
+  OpenSwath::SpectrumAccessPtr frameptr = SimpleOpenMSSpectraFactory::getSpectrumAccessOpenMSPtr(frame);
+  OpenSwath::SpectrumAccessPtr indexed(new SpectrumAccessIMIndexed(frameptr, 16));
+
+  ChromatogramExtractorAlgorithm extractor;
+  extractor.extractChromatograms(frameptr, out_plain, coordinates, 2.0, false, 0.1, "tophat");
+  extractor.extractChromatograms(indexed, out_indexed, coordinates, 2.0, false, 0.1, "tophat");
+  for (Size i = 0; i < coordinates.size(); ++i)
+  {
+    TEST_EQUAL(out_indexed[i]->getIntensityArray()->data.size(), 1)
+    TEST_NOT_EQUAL(out_plain[i]->getIntensityArray()->data[0], 0.0)
+    TEST_REAL_SIMILAR(out_indexed[i]->getIntensityArray()->data[0], out_plain[i]->getIntensityArray()->data[0])
+  }
+}
+END_SECTION
+
+/////////////////////////////////////////////////////////////
+/////////////////////////////////////////////////////////////
+END_TEST
+
@@ -207,6 +207,56 @@ START_SECTION((static void uncompressString(const QByteArray& compressed_data, Q
 }
 END_SECTION
 
+START_SECTION((static void compressShuffled(const std::vector<double>& data, std::string& compressed_data)))
+{
+  // values with float precision (as typically stored in mass spectrometric data)
+  std::vector<double> data;
+  for (Size i = 0; i < 1000; ++i)
+  {
+    data.push_back((double)(float)(100.0 + i * 0.1));
+  }
+  std::string raw((const char*)&data[0], data.size() * sizeof(double));
+  std::string compressed_data;
+  std::string compressed_shuffled;
+  ZlibCompression::compressString(raw, compressed_data);
+  ZlibCompression::compressShuffled(data, compressed_shuffled);
+  TEST_EQUAL(compressed_shuffled.size() < compressed_data.size() / 2, true)
+
+  // empty input
+  std::vector<double> empty;
+  ZlibCompression::compressShuffled(empty, compressed_shuffled);
+  TEST_EQUAL(compressed_shuffled.empty(), false)
+}
+END_SECTION
+
+START_SECTION((static void uncompressShuffled(const void * compressed_data, size_t nr_bytes, std::string& buffer, std::vector<double>& data)))
+{
+  std::vector<double> data;
+  for (Size i = 0; i < 1000; ++i)
+  {
+    data.push_back(400.0 + i * 0.123456789);
+  }
+  data.push_back(-1.0);
+  data.push_back(1e300);
+
+  std::string compressed_data;
+  std::string buffer;
+  std::vector<double> uncompressed_data;
+  ZlibCompression::compressShuffled(data, compressed_data);
+  ZlibCompression::uncompressShuffled(&compressed_data[0], compressed_data.size(), buffer, uncompressed_data);
+  TEST_EQUAL(uncompressed_data.size(), data.size())
+  TEST_EQUAL(uncompressed_data == data, true) // lossless
+
+  std::vector<double> empty;
+  ZlibCompression::compressShuffled(empty, compressed_data);
+  ZlibCompression::uncompressShuffled(&compressed_data[0], compressed_data.size(), buffer, uncompressed_data);
+  TEST_EQUAL(uncompressed_data.size(), 0)
+
+  // not a valid zlib stream
+  TEST_EXCEPTION(Exception::ConversionError, ZlibCompression::uncompressShuffled(raw_data.c_str(), raw_data.size(), buffer, uncompressed_data))
+}
+END_SECTION
+
 /////////////////////////////////////////////////////////////
 /////////////////////////////////////////////////////////////
 END_TEST
@@ -34,6 +34,7 @@
 
 #include <OpenMS/FORMAT/FileHandler.h>
 #include <OpenMS/FORMAT/FileTypes.h>
+#include <OpenMS/FORMAT/ConsensusBinFile.h>
 #include <OpenMS/FORMAT/ConsensusXMLFile.h>
 #include <OpenMS/APPLICATIONS/TOPPBase.h>
 
@@ -102,9 +103,9 @@ protected:
   void registerOptionsAndFlags_() override
   {
     registerInputFile_("in", "<file>", "", "input file");
-    setValidFormats_("in", ListUtils::create<String>("consensusXML"));
+    setValidFormats_("in", ListUtils::create<String>("consensusXML,consensusBin"));
     registerOutputFile_("out", "<file>", "", "output file");
-    setValidFormats_("out", ListUtils::create<String>("consensusXML"));
+    setValidFormats_("out", ListUtils::create<String>("consensusXML,consensusBin"));
     addEmptyLine_();
     registerStringOption_("algorithm_type", "<type>", "robust_regression", "The normalization algorithm that is applied. 'robust_regression' scales each map by a fator computed from the ratios of non-differential background features (as determined by the ratio_threshold parameter), 'quantile' performs quantile normalization, 'median' scales all maps to the same median intensity, 'median_shift' shifts the median instead of scaling (WARNING: if you have regular, log-normal MS data, 'median_shift' is probably the wrong choice. Use only if you know what you're doing!)", false, false);
     setValidStrings_("algorithm_type", ListUtils::create<String>("robust_regression,median,median_shift,quantile"));
@@ -126,8 +127,17 @@ protected:
 
     ConsensusXMLFile infile;
     infile.setLogType(log_type_);
+    ConsensusBinFile infile_bin;
+    infile_bin.setLogType(log_type_);
     ConsensusMap map;
-    infile.load(in, map);
+    if (FileHandler::getType(in) == FileTypes::CONSENSUSBIN)
+    {
+      infile_bin.load(in, map);
+    }
+    else
+    {
+      infile.load(in, map);
+    }
 
     //map normalization
     if (algo_type == "robust_regression")
@@ -160,7 +170,14 @@ protected:
 
     //annotate output with data processing info and save output file
     addDataProcessing_(map, getProcessingInfo_(DataProcessing::NORMALIZATION));
-    infile.store(out, map);
+    if (FileHandler::getTypeByFileName(out) == FileTypes::CONSENSUSBIN)
+    {
+      infile_bin.store(out, map);
+    }
+    else
+    {
+      infile.store(out, map);
+    }
 
     return EXECUTION_OK;
   }
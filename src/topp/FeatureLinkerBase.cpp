@@ -32,7 +32,9 @@
 // $Authors: Marc Sturm, Clemens Groepl, Steffen Sass $
 // --------------------------------------------------------------------------
 
+#include <OpenMS/FORMAT/ConsensusBinFile.h>
 #include <OpenMS/FORMAT/ConsensusXMLFile.h>
+#include <OpenMS/FORMAT/FeatureBinFile.h>
 #include <OpenMS/FORMAT/FeatureXMLFile.h>
 #include <OpenMS/FORMAT/FileHandler.h>
 #include <OpenMS/FORMAT/FileTypes.h>
@@ -80,13 +82,13 @@ protected:
   void registerOptionsAndFlags_() override   // only for "unlabeled" algorithms!
   {
     registerInputFileList_("in", "<files>", ListUtils::create<String>(""), "input files separated by blanks", true);
-    setValidFormats_("in", ListUtils::create<String>("featureXML,consensusXML"));
+    setValidFormats_("in", ListUtils::create<String>("featureXML,featureBin,consensusXML,consensusBin"));
     registerOutputFile_("out", "<file>", "", "Output file", true);
-    setValidFormats_("out", ListUtils::create<String>("consensusXML"));
+    setValidFormats_("out", ListUtils::create<String>("consensusXML,consensusBin"));
     registerInputFile_("design", "<file>", "", "input file containing the experimental design", false);
     setValidFormats_("design", ListUtils::create<String>("tsv"));
     addEmptyLine_();
-    registerFlag_("keep_subelements", "For consensusXML input only: If set, the sub-features of the inputs are transferred to the output.");
+    registerFlag_("keep_subelements", "For consensus map input only (consensusXML or consensusBin): If set, the sub-features of the inputs are transferred to the output.");
   }
 
   ExitCodes common_main_(FeatureGroupingAlgorithm * algorithm,
@@ -142,15 +144,15 @@ protected:
       design_file = getStringOption_("design");
     }
 
-    if (file_type == FileTypes::CONSENSUSXML && !design_file.empty())
+    if ((file_type == FileTypes::CONSENSUSXML || file_type == FileTypes::CONSENSUSBIN) && !design_file.empty())
     {
-      writeLog_("Error: Using fractionated design with consensusXML als input is not supported!");
+      writeLog_("Error: Using fractionated design with consensus map input (" + FileTypes::typeToName(file_type) + ") is not supported!");
       return ILLEGAL_PARAMETERS;
     }
   
-    if (file_type == FileTypes::FEATUREXML)
+    if (file_type == FileTypes::FEATUREXML || file_type == FileTypes::FEATUREBIN)
     {
-      OPENMS_LOG_INFO << "Linking " << ins.size() << " featureXMLs." << endl;
+      OPENMS_LOG_INFO << "Linking " << ins.size() << " feature maps." << endl;
   
       //-------------------------------------------------------------
       // Extract (optional) fraction identifiers and associate with featureXMLs
@@ -186,12 +188,14 @@ protected:
 
       vector<FeatureMap > maps(ins.size());
       FeatureXMLFile f;
+      FeatureBinFile f_bin;
       FeatureFileOptions param = f.getOptions();
 
       // to save memory don't load convex hulls and subordinates
       param.setLoadSubordinates(false);
       param.setLoadConvexHull(false);
       f.setOptions(param);
+      f_bin.setOptions(param);
 
       Size progress = 0;
       setLogType(ProgressLogger::CMD);
@@ -199,7 +203,14 @@ protected:
       for (Size i = 0; i < ins.size(); ++i)
       {
         FeatureMap tmp;
-        f.load(ins[i], tmp);
+        if (file_type == FileTypes::FEATUREBIN)
+        {
+          f_bin.load(ins[i], tmp);
+        }
+        else
+        {
+          f.load(ins[i], tmp);
+        }
 
         StringList ms_runs;
         tmp.getPrimaryMSRunPath(ms_runs);
@@ -287,9 +298,17 @@ protected:
       bool keep_subelements = getFlag_("keep_subelements");
       vector<ConsensusMap> maps(ins.size());
       ConsensusXMLFile f;
+      ConsensusBinFile f_bin;
       for (Size i = 0; i < ins.size(); ++i)
       {
-        f.load(ins[i], maps[i]);
+        if (file_type == FileTypes::CONSENSUSBIN)
+        {
+          f_bin.load(ins[i], maps[i]);
+        }
+        else
+        {
+          f.load(ins[i], maps[i]);
+        }
         maps[i].updateRanges();
         // copy over information on the primary MS run
         StringList ms_runs;
@@ -347,7 +366,14 @@ protected:
     out_map.sortPeptideIdentificationsByMapIndex();
 
     // write output
-    ConsensusXMLFile().store(out, out_map);
+    if (FileHandler::getTypeByFileName(out) == FileTypes::CONSENSUSBIN)
+    {
+      ConsensusBinFile().store(out, out_map);
+    }
+    else
+    {
+      ConsensusXMLFile().store(out, out_map);
+    }
 
     // some statistics
     map<Size, UInt> num_consfeat_of_size;
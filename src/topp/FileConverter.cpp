@@ -38,7 +38,9 @@
 #include <OpenMS/FORMAT/FileHandler.h>
 #include <OpenMS/FORMAT/FileTypes.h>
 #include <OpenMS/FORMAT/FeatureXMLFile.h>
+#include <OpenMS/FORMAT/FeatureBinFile.h>
 #include <OpenMS/FORMAT/ConsensusXMLFile.h>
+#include <OpenMS/FORMAT/ConsensusBinFile.h>
 #include <OpenMS/FORMAT/MzXMLFile.h>
 #include <OpenMS/FORMAT/MzMLFile.h>
 #include <OpenMS/FORMAT/MzDataFile.h>
@@ -116,7 +118,9 @@ using namespace std;
   @ref OpenMS::DTA2DFile "dta2d"
   @ref OpenMS::DTAFile "dta"
   @ref OpenMS::FeatureXMLFile "featureXML"
+  @ref OpenMS::FeatureBinFile "featureBin"
   @ref OpenMS::ConsensusXMLFile "consensusXML"
+  @ref OpenMS::ConsensusBinFile "consensusBin"
   @ref OpenMS::MS2File "ms2"
   @ref OpenMS::XMassFile "fid/XMASS"
   @ref OpenMS::MsInspectFile "tsv"
@@ -328,7 +332,7 @@ protected:
   {
     registerInputFile_("in", "<file>", "", "Input file to convert.");
     registerStringOption_("in_type", "<type>", "", "Input file type -- default: determined from file extension or content\n", false, true); // for TOPPAS
-    vector<String> input_formats = {"mzML", "mzXML", "mgf", "raw", "cachedMzML", "mzData", "dta", "dta2d", "featureXML", "consensusXML", "ms2", "fid", "tsv", "peplist", "kroenik", "edta"};
+    vector<String> input_formats = {"mzML", "mzXML", "mgf", "raw", "cachedMzML", "mzData", "dta", "dta2d", "featureXML", "featureBin", "consensusXML", "consensusBin", "ms2", "fid", "tsv", "peplist", "kroenik", "edta"};
     setValidFormats_("in", input_formats);
     setValidStrings_("in_type", input_formats);
     
@@ -336,7 +340,7 @@ protected:
     String method("none,ensure,reassign");
     setValidStrings_("UID_postprocessing", ListUtils::create<String>(method));
 
-    vector<String> output_formats = {"mzML", "mzXML", "cachedMzML", "mgf", "featureXML", "consensusXML", "edta", "mzData", "dta2d", "csv"};
+    vector<String> output_formats = {"mzML", "mzXML", "cachedMzML", "mgf", "featureXML", "featureBin", "consensusXML", "consensusBin", "edta", "mzData", "dta2d", "csv"};
     registerOutputFile_("out", "<file>", "", "Output file");
     setValidFormats_("out", output_formats);
     registerStringOption_("out_type", "<type>", "", "Output file type -- default: determined from file extension or content\nNote: that not all conversion paths work or make sense.", false, true);
@@ -445,12 +449,19 @@ protected:
 
     writeDebug_(String("Loading input file"), 1);
 
-    if (in_type == FileTypes::CONSENSUSXML)
+    if (in_type == FileTypes::CONSENSUSXML || in_type == FileTypes::CONSENSUSBIN)
     {
-      ConsensusXMLFile().load(in, cm);
+      if (in_type == FileTypes::CONSENSUSBIN)
+      {
+        ConsensusBinFile().load(in, cm);
+      }
+      else
+      {
+        ConsensusXMLFile().load(in, cm);
+      }
       cm.sortByPosition();
-      if ((out_type != FileTypes::FEATUREXML) &&
-          (out_type != FileTypes::CONSENSUSXML))
+      if ((out_type != FileTypes::FEATUREXML) && (out_type != FileTypes::FEATUREBIN) &&
+          (out_type != FileTypes::CONSENSUSXML) && (out_type != FileTypes::CONSENSUSBIN))
       {
         // You you will lose information and waste memory. Enough reasons to issue a warning!
         writeLog_("Warning: Converting consensus features to peaks. You will lose information!");
@@ -505,8 +516,8 @@ protected:
     {
       EDTAFile().load(in, cm);
       cm.sortByPosition();
-      if ((out_type != FileTypes::FEATUREXML) &&
-          (out_type != FileTypes::CONSENSUSXML))
+      if ((out_type != FileTypes::FEATUREXML) && (out_type != FileTypes::FEATUREBIN) &&
+          (out_type != FileTypes::CONSENSUSXML) && (out_type != FileTypes::CONSENSUSBIN))
       {
         // You you will lose information and waste memory. Enough reasons to issue a warning!
         writeLog_("Warning: Converting consensus features to peaks. You will lose information!");
@@ -514,14 +525,15 @@ protected:
       }
     }
     else if (in_type == FileTypes::FEATUREXML ||
+             in_type == FileTypes::FEATUREBIN ||
              in_type == FileTypes::TSV ||
              in_type == FileTypes::PEPLIST ||
              in_type == FileTypes::KROENIK)
     {
       fh.loadFeatures(in, fm, in_type);
       fm.sortByPosition();
-      if ((out_type != FileTypes::FEATUREXML) &&
-          (out_type != FileTypes::CONSENSUSXML))
+      if ((out_type != FileTypes::FEATUREXML) && (out_type != FileTypes::FEATUREBIN) &&
+          (out_type != FileTypes::CONSENSUSXML) && (out_type != FileTypes::CONSENSUSBIN))
       {
         // You will lose information and waste memory. Enough reasons to issue a warning!
         writeLog_("Warning: Converting features to peaks. You will lose information! Mass traces are added, if present as 'num_of_masstraces' and 'masstrace_intensity' (X>=0) meta values.");
@@ -772,9 +784,9 @@ protected:
       f.setLogType(log_type_);
       f.store(out, exp, getFlag_("MGF_compact"));
     }
-    else if (out_type == FileTypes::FEATUREXML)
+    else if (out_type == FileTypes::FEATUREXML || out_type == FileTypes::FEATUREBIN)
     {
-      if ((in_type == FileTypes::FEATUREXML) || (in_type == FileTypes::TSV) ||
+      if ((in_type == FileTypes::FEATUREXML) || (in_type == FileTypes::FEATUREBIN) || (in_type == FileTypes::TSV) ||
           (in_type == FileTypes::PEPLIST) || (in_type == FileTypes::KROENIK))
       {
         if (uid_postprocessing == "ensure")
@@ -786,7 +798,7 @@ protected:
           fm.applyMemberFunction(&UniqueIdInterface::setUniqueId);
         }
       }
-      else if (in_type == FileTypes::CONSENSUSXML || in_type == FileTypes::EDTA)
+      else if (in_type == FileTypes::CONSENSUSXML || in_type == FileTypes::CONSENSUSBIN || in_type == FileTypes::EDTA)
       {
         MapConversion::convert(cm, true, fm);
       }
@@ -823,11 +835,18 @@ protected:
 
       addDataProcessing_(fm, getProcessingInfo_(DataProcessing::
                                                 FORMAT_CONVERSION));
-      FeatureXMLFile().store(out, fm);
+      if (out_type == FileTypes::FEATUREBIN)
+      {
+        FeatureBinFile().store(out, fm);
+      }
+      else
+      {
+        FeatureXMLFile().store(out, fm);
+      }
     }
-    else if (out_type == FileTypes::CONSENSUSXML)
+    else if (out_type == FileTypes::CONSENSUSXML || out_type == FileTypes::CONSENSUSBIN)
     {
-      if ((in_type == FileTypes::FEATUREXML) || (in_type == FileTypes::TSV) ||
+      if ((in_type == FileTypes::FEATUREXML) || (in_type == FileTypes::FEATUREBIN) || (in_type == FileTypes::TSV) ||
           (in_type == FileTypes::PEPLIST) || (in_type == FileTypes::KROENIK))
       {
         if (uid_postprocessing == "ensure")
@@ -841,7 +860,7 @@ protected:
         MapConversion::convert(0, fm, cm);
       }
       // nothing to do for consensus input
-      else if (in_type == FileTypes::CONSENSUSXML || in_type == FileTypes::EDTA)
+      else if (in_type == FileTypes::CONSENSUSXML || in_type == FileTypes::CONSENSUSBIN || in_type == FileTypes::EDTA)
       {
       }
       else // experimental data
@@ -855,7 +874,14 @@ protected:
 
       addDataProcessing_(cm, getProcessingInfo_(DataProcessing::
                                                 FORMAT_CONVERSION));
-      ConsensusXMLFile().store(out, cm);
+      if (out_type == FileTypes::CONSENSUSBIN)
+      {
+        ConsensusBinFile().store(out, cm);
+      }
+      else
+      {
+        ConsensusXMLFile().store(out, cm);
+      }
     }
     else if (out_type == FileTypes::EDTA)
     {
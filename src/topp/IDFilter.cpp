@@ -142,9 +142,9 @@ protected:
     specificity.assign(EnzymaticDigestion::NamesOfSpecificity, EnzymaticDigestion::NamesOfSpecificity + EnzymaticDigestion::SIZE_OF_SPECIFICITY);
 
     registerInputFile_("in", "<file>", "", "input file ");
-    setValidFormats_("in", ListUtils::create<String>("idXML"));
+    setValidFormats_("in", ListUtils::create<String>("idXML,idBin"));
     registerOutputFile_("out", "<file>", "", "output file ");
-    setValidFormats_("out", ListUtils::create<String>("idXML"));
+    setValidFormats_("out", ListUtils::create<String>("idXML,idBin"));
 
     registerTOPPSubsection_("precursor", "Filtering by precursor attributes (RT, m/z, charge, length)");
     registerStringOption_("precursor:rt", "[min]:[max]", ":", "Retention time range to extract.", false);
@@ -243,7 +243,11 @@ protected:
 
     vector<ProteinIdentification> proteins;
     vector<PeptideIdentification> peptides;
-    IdXMLFile().load(inputfile_name, proteins, peptides);
+    if (!FileHandler().loadIdentifications(inputfile_name, proteins, peptides))
+    {
+      writeLog_("Error: Could not load identifications from '" + inputfile_name + "' (unreadable file or unsupported file type). Aborting!");
+      return INPUT_FILE_CORRUPT;
+    }
 
     Size n_prot_ids = proteins.size();
     Size n_prot_hits = IDFilter::countHits(proteins);
@@ -705,7 +709,7 @@ protected:
              << peptides.size() << " spectra identified with "
              << IDFilter::countHits(peptides) << " spectrum matches." << endl;
 
-    IdXMLFile().store(outputfile_name, proteins, peptides);
+    FileHandler().storeIdentifications(outputfile_name, proteins, peptides);
 
     return EXECUTION_OK;
   }
@@ -34,6 +34,7 @@
 
 #include <OpenMS/config.h>
 
+#include <OpenMS/FORMAT/IdBinFile.h>
 #include <OpenMS/FORMAT/IdXMLFile.h>
 #include <OpenMS/FORMAT/MzIdentMLFile.h>
 #include <OpenMS/FORMAT/FeatureXMLFile.h>
@@ -133,7 +134,7 @@ protected:
   void registerOptionsAndFlags_() override
   {
     registerInputFile_("id", "<file>", "", "Protein/peptide identifications file");
-    setValidFormats_("id", ListUtils::create<String>("mzid,idXML"));
+    setValidFormats_("id", ListUtils::create<String>("mzid,idXML,idBin"));
     registerInputFile_("in", "<file>", "", "Feature map/consensus map file");
     setValidFormats_("in", ListUtils::create<String>("featureXML,consensusXML,mzq"));
     registerOutputFile_("out", "<file>", "", "Output file (the format depends on the input file format).");
@@ -185,6 +186,10 @@ protected:
     {
       IdXMLFile().load(id, protein_ids, peptide_ids);
     }
+    else if (in_type == FileTypes::IDBIN)
+    {
+      IdBinFile().load(id, protein_ids, peptide_ids);
+    }
     else if (in_type == FileTypes::MZIDENTML)
     {
       MzIdentMLFile().load(id, protein_ids, peptide_ids);
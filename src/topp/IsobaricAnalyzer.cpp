@@ -54,6 +54,8 @@
 #include <OpenMS/FORMAT/MzMLFile.h>
 #include <OpenMS/FORMAT/MzQuantMLFile.h>
 
+#include <OpenMS/KERNEL/OnDiscMSExperiment.h>
+
 #include <OpenMS/METADATA/MSQuantifications.h>
 
 using namespace OpenMS;
@@ -220,6 +222,7 @@ protected:
     setValidFormats_("in", ListUtils::create<String>("mzML"));
     registerOutputFile_("out", "<file>", "", "output consensusXML file with quantitative information");
     setValidFormats_("out", ListUtils::create<String>("consensusXML"));
+    registerFlag_("low_memory", "Read the spectra from disk as needed instead of loading the whole input file into memory (requires an indexed mzML file; other files are loaded completely).", true);
 
     registerSubsection_("extraction", "Parameters for the channel extraction.");
     registerSubsection_("quantification", "Parameters for the peptide quantification.");
@@ -270,10 +273,21 @@ protected:
     // loading input
     //-------------------------------------------------------------
 
+    // only decode the spectra needed for quantification, if possible
+    OnDiscMSExperiment exp_on_disc;
+    bool on_disc = getFlag_("low_memory") && exp_on_disc.openFile(in);
+    if (getFlag_("low_memory") && !on_disc)
+    {
+      OPENMS_LOG_WARN << "Input file '" << in << "' is not an indexed mzML file. Loading it completely." << std::endl;
+    }
+
     MzMLFile mz_data_file;
     PeakMap exp;
-    mz_data_file.setLogType(log_type_);
-    mz_data_file.load(in, exp);
+    if (!on_disc)
+    {
+      mz_data_file.setLogType(log_type_);
+      mz_data_file.load(in, exp);
+    }
 
     //-------------------------------------------------------------
     // init quant method
@@ -293,7 +307,14 @@ protected:
     ConsensusMap consensus_map_raw, consensus_map_quant;
 
     // extract channel information
-    channel_extractor.extractChannels(exp, consensus_map_raw);
+    if (on_disc)
+    {
+      channel_extractor.extractChannels(exp_on_disc, consensus_map_raw);
+    }
+    else
+    {
+      channel_extractor.extractChannels(exp, consensus_map_raw);
+    }
 
     IsobaricQuantifier quantifier(quant_method);
     Param quant_param(getParam_().copy("quantification:", true));
@@ -86,8 +86,10 @@
 
 #include <algorithm>
 #include <iostream>
+#include <limits>
 #include <vector>
 #include <map>
+#include <tuple>
 
 // multithreading
 #ifdef _OPENMP
@@ -321,6 +323,96 @@ protected:
     return modifications;
   }
 
+  // determine the range of mass shifts that up to "max_mods" variable
+  // modifications can cause (lower bound <= 0, upper bound >= 0):
+  pair<double, double> getVariableModShiftRange_(
+    const set<ConstRibonucleotidePtr>& mods, Size max_mods, bool use_avg_mass)
+  {
+    static const EmpiricalFormula H_form = EmpiricalFormula("H");
+    auto db_ptr = RibonucleotideDB::getInstance();
+    double min_shift = 0.0, max_shift = 0.0;
+    for (ConstRibonucleotidePtr mod : mods)
+    {
+      EmpiricalFormula delta;
+      if (mod->getTermSpecificity() == Ribonucleotide::ANYWHERE)
+      {
+        try
+        {
+          ConstRibonucleotidePtr origin =
+            db_ptr->getRibonucleotide(String(mod->getOrigin()));
+          delta = mod->getFormula() - origin->getFormula();
+        }
+        catch (Exception::ElementNotFound& /*e*/)
+        {
+          // unknown mass shift - no restriction possible:
+          return make_pair(-numeric_limits<double>::infinity(),
+                           numeric_limits<double>::infinity());
+        }
+      }
+      else // terminal mod. (see "NASequence::getFormula"):
+      {
+        delta = mod->getFormula() - H_form;
+      }
+      double shift = (use_avg_mass ? delta.getAverageWeight() :
+                      delta.getMonoWeight());
+      min_shift = min(min_shift, shift);
+      max_shift = max(max_shift, shift);
+    }
+    return make_pair(min_shift * max_mods, max_shift * max_mods);
+  }
+
+  // order of hits with equal scores (by sequence, then by spectrum index and
+  // remaining precursor information), so that the order of tied hits doesn't
+  // depend on the order in which they were found (e.g. by different threads):
+  static bool precedesTiedHit_(const AnnotatedHit& a, const AnnotatedHit& b)
+  {
+    // (not "NASequence::operator<", which compares terminal mods by address)
+    String seq_a = a.sequence.toString(), seq_b = b.sequence.toString();
+    if (seq_a != seq_b) return seq_a < seq_b;
+    const PrecursorInfo& prec_a = *a.precursor_ref;
+    const PrecursorInfo& prec_b = *b.precursor_ref;
+    return tie(prec_a.scan_index, prec_a.charge, prec_a.isotope, prec_a.adduct) <
+      tie(prec_b.scan_index, prec_b.charge, prec_b.isotope, prec_b.adduct);
+  }
+
+  // check if a hit with this score would be added to the list of hits for a
+  // spectrum (see "addHit_"):
+  bool isGoodEnough_(const HitsByScore& hits, double score, Size top_hits)
+  {
+    if ((top_hits == 0) || (hits.size() < top_hits)) return true;
+    return score >= (--hits.end())->first;
+  }
+
+  // add a hit to the list of hits for a spectrum, if its score is good
+  // enough; keeps the "top_hits" best hits plus ties (ordered using
+  // "precedesTiedHit_"); returns whether the hit was added:
+  bool addHit_(HitsByScore& hits, double score, AnnotatedHit&& hit,
+               Size top_hits)
+  {
+    if (!isGoodEnough_(hits, score, top_hits)) return false;
+    bool prune = ((top_hits > 0) && (hits.size() >= top_hits));
+    double worst_score = hits.empty() ? 0.0 : (--hits.end())->first;
+    // "emplace_hint" inserts directly before the hint for equivalent keys:
+    pair<HitsByScore::iterator, HitsByScore::iterator> range =
+      hits.equal_range(score);
+    HitsByScore::iterator hint = range.first;
+    while ((hint != range.second) && !precedesTiedHit_(hit, hint->second))
+    {
+      ++hint;
+    }
+    hits.emplace_hint(hint, score, std::move(hit));
+    // prune list of hits if possible (careful about tied scores):
+    if (prune)
+    {
+      Size n_worst = hits.count(worst_score);
+      if (hits.size() - n_worst >= top_hits)
+      {
+        hits.erase(worst_score);
+      }
+    }
+    return true;
+  }
+
   // check for minimum and maximum size
   class HasInvalidLength
   {
@@ -1172,145 +1264,206 @@ protected:
 
     Int base_charge = negative_mode ? -1 : 1;
 
+    // oligos whose mass range (considering all possible variable
+    // modifications) doesn't overlap with any precursor mass can be skipped
+    // without generating their modified variants:
+    pair<double, double> mod_shift_range =
+      getVariableModShiftRange_(variable_modifications,
+                                max_variable_mods_per_oligo, use_avg_mass);
+    // allowance for rounding differences between summed and direct masses:
+    const double mass_slack = 1e-6;
+
+#pragma omp parallel
+    {
+      // each thread collects its hits separately (indexed by scan); they are
+      // merged in the end, so threads don't need to synchronize for every hit
+      // (the result doesn't depend on the order, as tied hits are kept and
+      // sorted by "precedesTiedHit_"):
+      map<Size, HitsByScore> thread_hits;
+      Size thread_hit_counter = 0;
+
 // shorter oligos take (possibly much) less time to process than longer ones;
 // due to the sorting order of "NASequence", they also appear earlier in the
 // container - therefore use dynamic scheduling to distribute work evenly:
-#pragma omp parallel for schedule(dynamic)
-    for (SignedSize index = 0; index < SignedSize(digest.size()); ++index)
-    {
-      IF_MASTERTHREAD
-      {
-        progresslogger.setProgress(index);
-      }
-
-      IdentificationData::IdentifiedOligoRef oligo_ref = digest[index];
-      vector<NASequence> all_modified_oligos;
-      NASequence ns = oligo_ref->sequence;
-      ModifiedNASequenceGenerator::applyVariableModifications(
-        variable_modifications, ns, max_variable_mods_per_oligo,
-        all_modified_oligos, true);
-
-      // group modified oligos by precursor mass - oligos with the same
-      // combination of mods (just different placements) will have same mass:
-      map<double, vector<const NASequence*>> modified_oligos_by_mass;
-      for (const NASequence& seq : all_modified_oligos)
+#pragma omp for schedule(dynamic) nowait
+      for (SignedSize index = 0; index < SignedSize(digest.size()); ++index)
       {
-        double mass = (use_avg_mass ? seq.getAverageWeight() :
-                       seq.getMonoWeight());
-        modified_oligos_by_mass[mass].push_back(&seq);
-      }
+        IF_MASTERTHREAD
+        {
+          progresslogger.setProgress(index);
+        }
 
-      for (const auto& pair : modified_oligos_by_mass)
-      {
-        double candidate_mass = pair.first;
+        IdentificationData::IdentifiedOligoRef oligo_ref = digest[index];
+        NASequence ns = oligo_ref->sequence;
 
-        // determine MS2 precursors that match to the current mass:
-        double tol = search_param.precursor_mass_tolerance;
+        // any precursors in the mass range of the (modified) oligo?
+        double base_mass = (use_avg_mass ? ns.getAverageWeight() :
+                            ns.getMonoWeight());
+        double max_mass = base_mass + mod_shift_range.second;
+        double max_tol = search_param.precursor_mass_tolerance;
         if (search_param.precursor_tolerance_ppm)
         {
-          tol *= candidate_mass * 1e-6;
+          max_tol *= max_mass * 1e-6;
+        }
+        max_tol += mass_slack;
+        multimap<double, PrecursorInfo>::const_iterator range_it =
+          precursor_mass_map.lower_bound(base_mass + mod_shift_range.first -
+                                         max_tol);
+        if ((range_it == precursor_mass_map.end()) ||
+            (range_it->first > max_mass + max_tol))
+        {
+          continue;
         }
-        multimap<double, PrecursorInfo>::const_iterator low_it =
-          precursor_mass_map.lower_bound(candidate_mass - tol), up_it =
-          precursor_mass_map.upper_bound(candidate_mass + tol);
-
-        if (low_it == up_it) continue; // no matching precursor in data
 
-        // collect all relevant charge states for theoret. spectrum generation:
-        set<Int> precursor_charges;
-        for (auto prec_it = low_it; prec_it != up_it; ++prec_it) // OMS_CODING_TEST_EXCLUDE
+        vector<NASequence> all_modified_oligos;
+        ModifiedNASequenceGenerator::applyVariableModifications(
+          variable_modifications, ns, max_variable_mods_per_oligo,
+          all_modified_oligos, true);
+
+        // sort modified oligos by precursor mass - oligos with the same
+        // combination of mods (just different placements) will have same mass
+        // and form a group; (mass, index) pairs are stored in a flat vector
+        // instead of a map of pointer vectors to avoid per-mass allocations.
+        // The mass only depends on the composition (ribonucleotides and
+        // terminal mods, regardless of order), so it is computed once for each
+        // composition instead of once for each placement of the mods:
+        map<vector<ConstRibonucleotidePtr>, double> mass_by_composition;
+        vector<ConstRibonucleotidePtr> composition;
+        vector<std::pair<double, Size>> modified_oligo_masses;
+        modified_oligo_masses.reserve(all_modified_oligos.size());
+        for (Size i = 0; i < all_modified_oligos.size(); ++i)
         {
-          precursor_charges.insert(prec_it->second.charge * base_charge);
+          const NASequence& seq = all_modified_oligos[i];
+          composition.clear();
+          for (Size j = 0; j < seq.size(); ++j)
+          {
+            composition.push_back(seq[j]);
+          }
+          sort(composition.begin(), composition.end());
+          composition.push_back(seq.getFivePrimeMod());
+          composition.push_back(seq.getThreePrimeMod());
+          auto pos = mass_by_composition.find(composition);
+          if (pos == mass_by_composition.end())
+          {
+            double mass = (use_avg_mass ? seq.getAverageWeight() :
+                           seq.getMonoWeight());
+            pos = mass_by_composition.insert(make_pair(composition, mass)).first;
+          }
+          modified_oligo_masses.push_back(make_pair(pos->second, i));
         }
+        sort(modified_oligo_masses.begin(), modified_oligo_masses.end());
 
-        for (const NASequence* seq_ptr : pair.second)
+        for (auto mass_it = modified_oligo_masses.begin();
+             mass_it != modified_oligo_masses.end(); )
         {
-          const NASequence& candidate = *seq_ptr;
-          OPENMS_LOG_DEBUG << "Candidate: " << candidate.toString() << " ("
-                           << float(candidate_mass) << " Da)" << endl;
+          double candidate_mass = mass_it->first;
+          auto group_begin = mass_it;
+          while ((mass_it != modified_oligo_masses.end()) &&
+                 (mass_it->first == candidate_mass))
+          {
+            ++mass_it;
+          }
+          auto group_end = mass_it;
+
+          // determine MS2 precursors that match to the current mass:
+          double tol = search_param.precursor_mass_tolerance;
+          if (search_param.precursor_tolerance_ppm)
+          {
+            tol *= candidate_mass * 1e-6;
+          }
+          multimap<double, PrecursorInfo>::const_iterator low_it =
+            precursor_mass_map.lower_bound(candidate_mass - tol), up_it =
+            precursor_mass_map.upper_bound(candidate_mass + tol);
 
-          // pre-generate spectra:
-          map<Int, MSSpectrum> theo_spectra_by_charge;
-          spectrum_generator.getMultipleSpectra(theo_spectra_by_charge,
-                                                candidate, precursor_charges,
-                                                base_charge);
+          if (low_it == up_it) continue; // no matching precursor in data
 
+          // collect all relevant charge states for theoret. spectrum generation:
+          set<Int> precursor_charges;
           for (auto prec_it = low_it; prec_it != up_it; ++prec_it) // OMS_CODING_TEST_EXCLUDE
           {
-            OPENMS_LOG_DEBUG << "Matching precursor mass: "
-                             << float(prec_it->first) << endl;
-
-            Size charge = prec_it->second.charge;
-            // look up theoretical spectrum for this charge:
-            MSSpectrum& theo_spectrum =
-              theo_spectra_by_charge[charge * base_charge];
-
-            Size scan_index = prec_it->second.scan_index;
-            const MSSpectrum& exp_spectrum = spectra[scan_index];
-            vector<PeptideHit::PeakAnnotation> annotations;
-            double score = MetaboliteSpectralMatching::computeHyperScore(
-              search_param.fragment_mass_tolerance,
-              search_param.fragment_tolerance_ppm, exp_spectrum, theo_spectrum,
-              annotations);
-
-            if (!exp_ms2_out.empty())
-            {
-#pragma omp critical (exp_ms2_out)
-              exp_ms2_spectra.addSpectrum(exp_spectrum);
-            }
-            if (!theo_ms2_out.empty())
-            {
-              theo_spectrum.setName(candidate.toString());
-#pragma omp critical (theo_ms2_out)
-              theo_ms2_spectra.addSpectrum(theo_spectrum);
-            }
-
-            if (score < 1e-16) continue; // no hit
+            precursor_charges.insert(prec_it->second.charge * base_charge);
+          }
 
-#pragma omp atomic
-            ++hit_counter;
+          for (auto group_it = group_begin; group_it != group_end; ++group_it)
+          {
+            const NASequence& candidate = all_modified_oligos[group_it->second];
+            OPENMS_LOG_DEBUG << "Candidate: " << candidate.toString() << " ("
+                             << float(candidate_mass) << " Da)" << endl;
 
-            OPENMS_LOG_DEBUG << "Score: " << score << endl;
+            // pre-generate spectra:
+            map<Int, MSSpectrum> theo_spectra_by_charge;
+            spectrum_generator.getMultipleSpectra(theo_spectra_by_charge,
+                                                  candidate, precursor_charges,
+                                                  base_charge);
 
-#pragma omp critical (annotated_hits_access)
+            for (auto prec_it = low_it; prec_it != up_it; ++prec_it) // OMS_CODING_TEST_EXCLUDE
             {
-              HitsByScore& scan_hits = annotated_hits[scan_index];
-              HitsByScore::iterator pos = scan_hits.end();
-              if ((report_top_hits == 0) ||
-                  (scan_hits.size() < report_top_hits))
+              OPENMS_LOG_DEBUG << "Matching precursor mass: "
+                               << float(prec_it->first) << endl;
+
+              Size charge = prec_it->second.charge;
+              // look up theoretical spectrum for this charge:
+              MSSpectrum& theo_spectrum =
+                theo_spectra_by_charge[charge * base_charge];
+
+              Size scan_index = prec_it->second.scan_index;
+              const MSSpectrum& exp_spectrum = spectra[scan_index];
+              vector<PeptideHit::PeakAnnotation> annotations;
+              double score = MetaboliteSpectralMatching::computeHyperScore(
+                search_param.fragment_mass_tolerance,
+                search_param.fragment_tolerance_ppm, exp_spectrum,
+                theo_spectrum, annotations);
+
+              if (!exp_ms2_out.empty())
               {
-                pos = scan_hits.insert(make_pair(score, AnnotatedHit()));
+#pragma omp critical (exp_ms2_out)
+                exp_ms2_spectra.addSpectrum(exp_spectrum);
               }
-              else // already have enough hits for this spectrum - replace one?
+              if (!theo_ms2_out.empty())
               {
-                double worst_score = (--scan_hits.end())->first;
-                if (score >= worst_score)
-                {
-                  pos = scan_hits.insert(make_pair(score, AnnotatedHit()));
-                  // prune list of hits if possible (careful about tied scores):
-                  Size n_worst = scan_hits.count(worst_score);
-                  if (scan_hits.size() - n_worst >= report_top_hits)
-                  {
-                    scan_hits.erase(worst_score);
-                  }
-                }
+                theo_spectrum.setName(candidate.toString());
+#pragma omp critical (theo_ms2_out)
+                theo_ms2_spectra.addSpectrum(theo_spectrum);
               }
+
+              if (score < 1e-16) continue; // no hit
+
+              ++thread_hit_counter;
+
+              OPENMS_LOG_DEBUG << "Score: " << score << endl;
+
               // add oligo hit data only if necessary (good enough score):
-              if (pos != scan_hits.end())
+              HitsByScore& scan_hits = thread_hits[scan_index];
+              if (isGoodEnough_(scan_hits, score, report_top_hits))
               {
-                AnnotatedHit& ah = pos->second;
+                AnnotatedHit ah;
                 ah.oligo_ref = oligo_ref;
                 ah.sequence = candidate;
                 // @TODO: is "observed - calculated" the right way around?
                 ah.precursor_error_ppm =
                   (prec_it->first - candidate_mass) / candidate_mass * 1.0e6;
-                ah.annotations = annotations;
+                ah.annotations = std::move(annotations);
                 ah.precursor_ref = &(prec_it->second);
+                addHit_(scan_hits, score, std::move(ah), report_top_hits);
               }
             }
           }
         }
       }
+
+#pragma omp critical (annotated_hits_access)
+      {
+        hit_counter += thread_hit_counter;
+        for (auto& scan_pair : thread_hits)
+        {
+          HitsByScore& scan_hits = annotated_hits[scan_pair.first];
+          for (auto& hit_pair : scan_pair.second)
+          {
+            addHit_(scan_hits, hit_pair.first, std::move(hit_pair.second),
+                    report_top_hits);
+          }
+        }
+      }
     }
     progresslogger.endProgress();
 
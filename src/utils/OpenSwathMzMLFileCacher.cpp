@@ -121,6 +121,7 @@ class TOPPOpenSwathMzMLFileCacher
     setValidStrings_("full_meta", ListUtils::create<String>("true,false"));
 
     registerDoubleOption_("lossy_mass_accuracy", "<error>", -1.0, "Desired (absolute) m/z accuracy for lossy compression (e.g. use 0.0001 for a mass accuracy of 0.2 ppm at 500 m/z, default uses -1.0 for maximal accuracy).", false, true);
+    registerFlag_("lossless_shuffle", "Use byte shuffling and zlib for lossless compression (sqMass: if lossy_compression is false, cached mzML: compresses the data of each spectrum/chromatogram). Yields smaller files that decode faster, but these cannot be read by older versions.", true);
 
     registerFlag_("process_lowmemory", "Whether to process the file on the fly without loading the whole file into memory first (only for conversions of mzXML/mzML to mzML).\nNote: this flag will prevent conversion from spectra to chromatograms.", true);
     registerIntOption_("lowmem_batchsize", "<number>", 500, "The batch size of the low memory conversion", false, true);
@@ -138,6 +139,7 @@ class TOPPOpenSwathMzMLFileCacher
     bool full_meta = (getStringOption_("full_meta") == "true");
     bool lossy_compression = (getStringOption_("lossy_compression") == "true");
     double mass_acc = getDoubleOption_("lossy_mass_accuracy");
+    bool lossless_shuffle = getFlag_("lossless_shuffle");
 
     FileHandler fh;
 
@@ -185,6 +187,7 @@ class TOPPOpenSwathMzMLFileCacher
     else if (in_type == FileTypes::MZML && out_type == FileTypes::SQMASS && process_lowmemory)
     {
       MSDataSqlConsumer consumer(out, batchSize, full_meta, lossy_compression, mass_acc);
+      consumer.setByteShuffle(lossless_shuffle);
       MzMLFile f;
       PeakFileOptions opt = f.getOptions();
       opt.setMaxDataPoolSize(batchSize); 
@@ -208,6 +211,7 @@ class TOPPOpenSwathMzMLFileCacher
       config.write_full_meta = full_meta;
       config.use_lossy_numpress = lossy_compression;
       config.linear_fp_mass_acc = mass_acc;
+      config.use_byte_shuffle = lossless_shuffle;
 
       SqMassFile sqfile;
       sqfile.setConfig(config);
@@ -226,7 +230,7 @@ class TOPPOpenSwathMzMLFileCacher
         MzMLFile f;
         f.setLogType(log_type_);
 
-        MSDataCachedConsumer consumer(out_cached, true);
+        MSDataCachedConsumer consumer(out_cached, true, lossless_shuffle);
         PeakFileOptions opt = f.getOptions();
         opt.setMaxDataPoolSize(batchSize);
         f.setOptions(opt);
@@ -246,6 +250,7 @@ class TOPPOpenSwathMzMLFileCacher
         f.setLogType(log_type_);
 
         f.load(in, exp);
+        cacher.setCompression(lossless_shuffle);
         cacher.writeMemdump(exp, out_cached);
         cacher.writeMetadata(exp, out_meta, true);
       }
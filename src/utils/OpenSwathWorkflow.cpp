@@ -449,6 +449,11 @@ protected:
     registerInputFile_("rt_norm", "<file>", "", "RT normalization file (how to map the RTs of this run to the ones stored in the library). If set, tr_irt may be omitted.", false, true);
     setValidFormats_("rt_norm", ListUtils::create<String>("trafoXML"));
 
+    registerInputFile_("rt_norm_cache_in", "<file>", "", "RT normalization of a previous run on the same instrument and method (see rt_norm_cache_out, requires tr_irt). The stored RT normalization is reused as long as the iRT peptides are found within RTNormalization:cacheMaxResidual of it (only m/z and ion mobility calibration are performed). Otherwise, a full RT normalization is performed.", false, true);
+    setValidFormats_("rt_norm_cache_in", ListUtils::create<String>("trafoXML"));
+    registerOutputFile_("rt_norm_cache_out", "<file>", "", "Stores the RT normalization of this run (reused or newly computed, requires tr_irt) for use as rt_norm_cache_in in later runs.", false, true);
+    setValidFormats_("rt_norm_cache_out", ListUtils::create<String>("trafoXML"));
+
     registerInputFile_("swath_windows_file", "<file>", "", "Optional, tab-separated file containing the SWATH windows for extraction: lower_offset upper_offset. Note that the first line is a header and will be skipped.", false, true);
     registerFlag_("sort_swath_maps", "Sort input SWATH files when matching to SWATH windows from swath_windows_file", true);
 
@@ -527,7 +532,7 @@ protected:
 
     registerIntOption_("batchSize", "<number>", 250, "The batch size of chromatograms to process (0 means to only have one batch, sensible values are around 250-1000)", false, true);
     setMinInt_("batchSize", 0);
-    registerIntOption_("outer_loop_threads", "<number>", -1, "How many threads should be used for the outer loop (-1 use all threads, use 4 to analyze 4 SWATH windows in memory at once).", false, true);
+    registerIntOption_("outer_loop_threads", "<number>", -1, "How many SWATH windows should be analyzed at the same time (-1 no limit, use 4 to keep at most 4 SWATH windows in memory at once). All threads are shared between the windows.", false, true);
 
     registerIntOption_("ms1_isotopes", "<number>", 0, "The number of MS1 isotopes used for extraction", false, true);
     setMinInt_("ms1_isotopes", 0);
@@ -622,6 +627,11 @@ protected:
       p.setValue("NrRTBins", 10, "Number of RT bins to use to compute coverage. This option should be used to ensure that there is a complete coverage of the RT space (this should detect cases where only a part of the RT gradient is actually covered by normalization peptides)");
       p.setValue("MinPeptidesPerBin", 1, "Minimal number of peptides that are required for a bin to counted as 'covered'");
       p.setValue("MinBinsFilled", 8, "Minimal number of bins required to be covered");
+
+      p.setValue("cacheMaxResidual", 5.0, "Maximal residual (in normalized RT) of an iRT peptide under the cached RT normalization (see rt_norm_cache_in). The cached RT normalization is only reused if at least min_coverage of the peptides are within this residual.");
+      p.setMinFloat("cacheMaxResidual", 0.0);
+      p.setValue("cacheRTExtractionWindow", 300.0, "RT extraction window (in seconds) around the RT predicted by the cached RT normalization (see rt_norm_cache_in) used to find the iRT peptides.");
+      p.setMinFloat("cacheRTExtractionWindow", 0.0);
       return p;
     }
     else if (name == "Library")
@@ -675,6 +685,8 @@ protected:
     String irt_tr_file = getStringOption_("tr_irt");
     String nonlinear_irt_tr_file = getStringOption_("tr_irt_nonlinear");
     String trafo_in = getStringOption_("rt_norm");
+    String trafo_cache_in = getStringOption_("rt_norm_cache_in");
+    String trafo_cache_out = getStringOption_("rt_norm_cache_out");
     String swath_windows_file = getStringOption_("swath_windows_file");
 
     String out_chrom = getStringOption_("out_chrom");
@@ -867,7 +879,7 @@ protected:
                                         min_rsq, min_coverage, feature_finder_param,
                                         cp_irt, irt_detection_param, calibration_param,
                                         debug_level, sonar, load_into_memory,
-                                        irt_trafo_out, irt_mzml_out);
+                                        irt_trafo_out, irt_mzml_out, trafo_cache_in, trafo_cache_out);
     }
     else
     {
@@ -883,7 +895,7 @@ protected:
                                         min_rsq, min_coverage, feature_finder_param,
                                         cp_irt, linear_irt, no_calibration,
                                         debug_level, sonar, load_into_memory,
-                                        irt_trafo_out, irt_mzml_out);
+                                        irt_trafo_out, irt_mzml_out, trafo_cache_in, trafo_cache_out);
 
       cp_irt.rt_extraction_window = 900; // extract some substantial part of the RT range (should be covered by linear correction)
       cp_irt.rt_extraction_window = 600; // extract some substantial part of the RT range (should be covered by linear correction)
@@ -84,6 +84,20 @@
 #include <OpenMS/ANALYSIS/ID/PeptideIndexing.h>
 #include <OpenMS/ANALYSIS/ID/IDMergerAlgorithm.h>
 
+#include <OpenMS/FORMAT/FeatureXMLFile.h>
+
+#include <QtCore/QCryptographicHash>
+#include <QtCore/QDateTime>
+#include <QtCore/QDir>
+#include <QtCore/QFileInfo>
+
+#include <exception>
+#include <sstream>
+
+#ifdef _OPENMP
+  #include <omp.h>
+#endif
+
 using namespace OpenMS;
 using namespace std;
 using Internal::IDBoostGraph;
@@ -193,6 +207,16 @@ protected:
     registerStringOption_("mass_recalibration", "<option>", "false", "Mass recalibration.", false, true);
     setValidStrings_("mass_recalibration", ListUtils::create<String>("true,false"));
 
+    registerIntOption_("parallel_files", "<number>", 1,
+      "Number of MS files of a fraction that are processed (centroiding, calibration and feature detection) at the same time (at most 'threads').\n"
+      "Each of them is held in memory, so this limits the memory used. Each file is then processed by a single thread "
+      "(the multi-threaded steps within a file do not use additional threads), so values > 1 pay off for many small files.", false, true);
+    setMinInt_("parallel_files", 1);
+
+    registerStringOption_("checkpoint_dir", "<directory>", "",
+      "Directory for checkpoints of the features of each MS file (empty: no checkpoints; created if it does not exist).\n"
+      "If the tool is run again with the same input files and parameters, the features are loaded from this directory instead of being detected again.", false, true);
+
 
     /// TODO: think about export of quality control files (qcML?)
 
@@ -732,239 +756,443 @@ protected:
     return transfer_ids;
   }
  
-  ExitCodes quantifyFraction_(
-    const pair<unsigned int, std::vector<String> > & ms_files, 
-    const map<String, String>& mzfile2idfile, 
-    double median_fwhm,
+  // Path of the checkpoint file of a single MS file (empty if checkpointing is disabled)
+  String checkpointPath_(const String& mz_file, const Size fraction, const Size fraction_group, bool requantification)
+  {
+    String checkpoint_dir = getStringOption_("checkpoint_dir");
+    if (checkpoint_dir.empty()) return "";
+    return checkpoint_dir.ensureLastChar('/') + File::removeExtension(File::basename(mz_file))
+      + "_F" + String(fraction) + "_G" + String(fraction_group) + (requantification ? "_requant" : "") + ".featureXML";
+  }
+
+  // Identifies the input of a checkpoint: input files (path, size, modification time) and the parameters used before linking.
+  // For requantification, the RT transformation of the file, the IDs transferred to it and the alignment and linking
+  // parameters are part of the input as well.
+  String checkpointKey_(const String& mz_file_abs_path, const String& id_file_abs_path,
+    const Size fraction_group,
     const multimap<Size, PeptideIdentification> & transfered_ids,
-    ConsensusMap & consensus_fraction,
-    vector<TransformationDescription> & transformations,
-    double& max_alignment_diff,
-    set<String>& fixed_modifications,
-    set<String>& variable_modifications)
+    const vector<TransformationDescription> & transformations)
   {
-    vector<FeatureMap> feature_maps;
-    const Size fraction = ms_files.first;
+    std::stringstream ss;
+    ss.precision(17);
+    for (const String& f : {mz_file_abs_path, id_file_abs_path})
+    {
+      QFileInfo fi(f.toQString());
+      ss << f << ";" << fi.size() << ";" << fi.lastModified().toMSecsSinceEpoch() << ";";
+    }
+    ss << getStringOption_("targeted_only") << ";" << getStringOption_("mass_recalibration") << ";"
+       << getParam_().copy("Centroiding:", true) << getParam_().copy("PeptideQuantification:", true);
 
-    const bool is_already_aligned = !transformations.empty();
+    if (!transfered_ids.empty())
+    {
+      ss << getStringOption_("transfer_ids") << ";"
+         << getParam_().copy("Alignment:", true) << getParam_().copy("Linking:", true);
+      if (fraction_group <= transformations.size())
+      {
+        const TransformationDescription& trafo = transformations[fraction_group - 1];
+        ss << trafo.getModelType() << ";";
+        for (const TransformationDescription::DataPoint& p : trafo.getDataPoints())
+        {
+          ss << p.first << "," << p.second << ";";
+        }
+      }
+      auto range = transfered_ids.equal_range(fraction_group - 1);
+      for (auto it = range.first; it != range.second; ++it)
+      {
+        ss << it->second.getRT() << "," << it->second.getMZ() << ",";
+        for (const PeptideHit& hit : it->second.getHits())
+        {
+          ss << hit.getSequence().toString() << "/" << hit.getCharge() << ",";
+        }
+        ss << ";";
+      }
+    }
+    // stable digest (unlike std::hash, independent of the platform and standard library):
+    const std::string key = ss.str();
+    QByteArray digest = QCryptographicHash::hash(QByteArray(key.data(), int(key.size())), QCryptographicHash::Sha256);
+    return String((QString)digest.toHex());
+  }
 
-    // debug output
-    writeDebug_("Processing fraction number: " + String(fraction) + "\nFiles: ",  1);
-    for (String const & mz_file : ms_files.second) { writeDebug_(mz_file,  1); }
+  // Loads the features of a single MS file stored by a previous (interrupted) run
+  bool loadCheckpoint_(const String& checkpoint, const String& key,
+    FeatureMap& feature_map, double& median_fwhm,
+    set<String>& fixed_modifications, set<String>& variable_modifications)
+  {
+    if (checkpoint.empty() || !File::exists(checkpoint)) return false;
 
-    // for each MS file of current fraction
-    Size fraction_group{1};
-    for (String const & mz_file : ms_files.second)
-    { 
-      // centroid spectra (if in profile mode) and correct precursor masses
-      MSExperiment ms_centroided;    
-      ExitCodes e = centroidAndCorrectPrecursors_(mz_file, ms_centroided);
-      if (e != EXECUTION_OK) { return e; }
+    FeatureMap fm;
+    try
+    {
+      FeatureXMLFile().load(checkpoint, fm);
+    }
+    catch (Exception::BaseException& e)
+    {
+      OPENMS_LOG_WARN << "Ignoring unreadable checkpoint '" << checkpoint << "': " << e.what() << endl;
+      return false;
+    }
+    if (fm.getMetaValue("ProteomicsLFQ:checkpoint_key", String()).toString() != key)
+    {
+      OPENMS_LOG_INFO << "Ignoring checkpoint '" << checkpoint << "' (input files or parameters changed)." << endl;
+      return false;
+    }
 
-      // writing picked mzML files for data submission
-      // annotate output with data processing info
-      // TODO: how to store picked files? by specifying a folder? or by output files that match in number to input files
-      // TODO: overwrite primaryMSRun with picked mzML name (for submission)
-      // mzML_file.store(OUTPUTFILENAME, ms_centroided);
+    median_fwhm = fm.getMetaValue("ProteomicsLFQ:median_fwhm");
+    for (const String& m : fm.getMetaValue("ProteomicsLFQ:fixed_modifications").toStringList()) fixed_modifications.insert(m);
+    for (const String& m : fm.getMetaValue("ProteomicsLFQ:variable_modifications").toStringList()) variable_modifications.insert(m);
+    for (const String& m : {"ProteomicsLFQ:checkpoint_key", "ProteomicsLFQ:median_fwhm", "ProteomicsLFQ:fixed_modifications", "ProteomicsLFQ:variable_modifications"})
+    {
+      fm.removeMetaValue(m);
+    }
+    feature_map.swap(fm);
+    OPENMS_LOG_INFO << "Loaded features from checkpoint '" << checkpoint << "'." << endl;
+    return true;
+  }
 
-      vector<ProteinIdentification> protein_ids;
-      vector<PeptideIdentification> peptide_ids;
-      const String& mz_file_abs_path = File::absolutePath(mz_file);
-      const String& id_file_abs_path = File::absolutePath(mzfile2idfile.at(mz_file_abs_path));
-      IdXMLFile().load(id_file_abs_path, protein_ids, peptide_ids);
+  // Stores the features of a single MS file (together with the values needed to resume)
+  void storeCheckpoint_(const String& checkpoint, const String& key,
+    FeatureMap& feature_map, double median_fwhm,
+    const set<String>& fixed_modifications, const set<String>& variable_modifications)
+  {
+    if (checkpoint.empty()) return;
+
+    feature_map.setMetaValue("ProteomicsLFQ:checkpoint_key", key);
+    feature_map.setMetaValue("ProteomicsLFQ:median_fwhm", median_fwhm);
+    feature_map.setMetaValue("ProteomicsLFQ:fixed_modifications", StringList(fixed_modifications.begin(), fixed_modifications.end()));
+    feature_map.setMetaValue("ProteomicsLFQ:variable_modifications", StringList(variable_modifications.begin(), variable_modifications.end()));
+    // write to a temporary file first, so an interrupted write never leaves a truncated checkpoint
+    FeatureXMLFile().store(checkpoint + ".tmp.featureXML", feature_map);
+    File::rename(checkpoint + ".tmp.featureXML", checkpoint, true, false);
+    OPENMS_LOG_INFO << "Stored features in checkpoint '" << checkpoint << "'." << endl;
+    for (const String& m : {"ProteomicsLFQ:checkpoint_key", "ProteomicsLFQ:median_fwhm", "ProteomicsLFQ:fixed_modifications", "ProteomicsLFQ:variable_modifications"})
+    {
+      feature_map.removeMetaValue(m);
+    }
+  }
 
-      if (protein_ids.size() != 1)
+  // Centroiding, calibration and feature detection of a single MS file
+  ExitCodes quantifyFile_(
+    const String& mz_file,
+    const Size fraction,
+    const Size fraction_group,
+    const map<String, String>& mzfile2idfile,
+    const multimap<Size, PeptideIdentification> & transfered_ids,
+    const vector<TransformationDescription> & transformations,
+    FeatureMap& feature_map,
+    double& median_fwhm,
+    set<String>& fixed_modifications,
+    set<String>& variable_modifications)
+  {
+    const String checkpoint = checkpointPath_(mz_file, fraction, fraction_group, !transfered_ids.empty());
+    String checkpoint_key;
+    if (!checkpoint.empty())
+    {
+      checkpoint_key = checkpointKey_(File::absolutePath(mz_file), File::absolutePath(mzfile2idfile.at(File::absolutePath(mz_file))),
+        fraction_group, transfered_ids, transformations);
+      if (loadCheckpoint_(checkpoint, checkpoint_key, feature_map, median_fwhm, fixed_modifications, variable_modifications))
       {
-        OPENMS_LOG_FATAL_ERROR << "Exactly one protein identification run must be annotated in " << id_file_abs_path << endl;
-        return ExitCodes::INCOMPATIBLE_INPUT_DATA;
+        return EXECUTION_OK;
       }
+    }
 
-      IDFilter::keepBestPeptideHits(peptide_ids, false); // strict = false
-      IDFilter::removeDecoyHits(peptide_ids);
-      IDFilter::removeDecoyHits(protein_ids);
-      IDFilter::removeEmptyIdentifications(peptide_ids);
-      IDFilter::removeUnreferencedProteins(protein_ids, peptide_ids);
+    // centroid spectra (if in profile mode) and correct precursor masses
+    MSExperiment ms_centroided;    
+    ExitCodes e = centroidAndCorrectPrecursors_(mz_file, ms_centroided);
+    if (e != EXECUTION_OK) { return e; }
 
-      // add to the (global) set of fixed and variable modifications
-      for (auto & p : protein_ids)
-      {
-        const vector<String>& var_mods = p.getSearchParameters().variable_modifications;
-        const vector<String>& fixed_mods = p.getSearchParameters().fixed_modifications;
-        std::copy(var_mods.begin(), var_mods.end(), std::inserter(variable_modifications, variable_modifications.begin())); 
-        std::copy(fixed_mods.begin(), fixed_mods.end(), std::inserter(fixed_modifications, fixed_modifications.end())); 
-      }
+    // writing picked mzML files for data submission
+    // annotate output with data processing info
+    // TODO: how to store picked files? by specifying a folder? or by output files that match in number to input files
+    // TODO: overwrite primaryMSRun with picked mzML name (for submission)
+    // mzML_file.store(OUTPUTFILENAME, ms_centroided);
+
+    vector<ProteinIdentification> protein_ids;
+    vector<PeptideIdentification> peptide_ids;
+    const String& mz_file_abs_path = File::absolutePath(mz_file);
+    const String& id_file_abs_path = File::absolutePath(mzfile2idfile.at(mz_file_abs_path));
+    IdXMLFile().load(id_file_abs_path, protein_ids, peptide_ids);
+
+    if (protein_ids.size() != 1)
+    {
+      OPENMS_LOG_FATAL_ERROR << "Exactly one protein identification run must be annotated in " << id_file_abs_path << endl;
+      return ExitCodes::INCOMPATIBLE_INPUT_DATA;
+    }
+
+    IDFilter::keepBestPeptideHits(peptide_ids, false); // strict = false
+    IDFilter::removeDecoyHits(peptide_ids);
+    IDFilter::removeDecoyHits(protein_ids);
+    IDFilter::removeEmptyIdentifications(peptide_ids);
+    IDFilter::removeUnreferencedProteins(protein_ids, peptide_ids);
+
+    // add to the (global) set of fixed and variable modifications
+    for (auto & p : protein_ids)
+    {
+      const vector<String>& var_mods = p.getSearchParameters().variable_modifications;
+      const vector<String>& fixed_mods = p.getSearchParameters().fixed_modifications;
+      std::copy(var_mods.begin(), var_mods.end(), std::inserter(variable_modifications, variable_modifications.begin())); 
+      std::copy(fixed_mods.begin(), fixed_mods.end(), std::inserter(fixed_modifications, fixed_modifications.end())); 
+    }
 
-      // delete meta info to free some space
-      for (PeptideIdentification & pid : peptide_ids)
+    // delete meta info to free some space
+    for (PeptideIdentification & pid : peptide_ids)
+    {
+      // we currently can't clear the PeptideIdentification meta data
+      // because the spectrum_reference is stored in the meta value (which it probably shouldn't)
+      // TODO: pid.clearMetaInfo(); if we move it to the PeptideIdentification structure
+      for (PeptideHit & ph : pid.getHits())
       {
-        // we currently can't clear the PeptideIdentification meta data
-        // because the spectrum_reference is stored in the meta value (which it probably shouldn't)
-        // TODO: pid.clearMetaInfo(); if we move it to the PeptideIdentification structure
-        for (PeptideHit & ph : pid.getHits())
-        {
-          // TODO: keep target_decoy information for QC
-          ph.clearMetaInfo();
-        }
+        // TODO: keep target_decoy information for QC
+        ph.clearMetaInfo();
       }
+    }
 
-      // annotate experimental design
-      StringList id_msfile_ref;
-      protein_ids[0].getPrimaryMSRunPath(id_msfile_ref);
-      if (id_msfile_ref.empty())
+    // annotate experimental design
+    StringList id_msfile_ref;
+    protein_ids[0].getPrimaryMSRunPath(id_msfile_ref);
+    if (id_msfile_ref.empty())
+    {
+      OPENMS_LOG_DEBUG << "MS run path not set in ID file." << endl;
+    }
+    else
+    {
+      // TODO: we could add a check (e.g., matching base name) here
+      id_msfile_ref.clear();
+    }                
+    id_msfile_ref.push_back(mz_file);
+    protein_ids[0].setPrimaryMSRunPath(id_msfile_ref);
+    protein_ids[0].setMetaValue("fraction_group", fraction_group);
+    protein_ids[0].setMetaValue("fraction", fraction);
+
+    // update identifiers to make them unique
+    // fixes some bugs related to users splitting the original mzML and id files before running the analysis
+    // in that case these files might have the same identifier
+    const String old_identifier = protein_ids[0].getIdentifier();
+    const String new_identifier = old_identifier + "_" + String(fraction_group) + "F" + String(fraction);
+    protein_ids[0].setIdentifier(new_identifier);
+    for (PeptideIdentification & p : peptide_ids)
+    {
+      if (p.getIdentifier() == old_identifier)
       {
-        OPENMS_LOG_DEBUG << "MS run path not set in ID file." << endl;
+        p.setIdentifier(new_identifier);
       }
       else
       {
-        // TODO: we could add a check (e.g., matching base name) here
-        id_msfile_ref.clear();
-      }                
-      id_msfile_ref.push_back(mz_file);
-      protein_ids[0].setPrimaryMSRunPath(id_msfile_ref);
-      protein_ids[0].setMetaValue("fraction_group", fraction_group);
-      protein_ids[0].setMetaValue("fraction", fraction);
-
-      // update identifiers to make them unique
-      // fixes some bugs related to users splitting the original mzML and id files before running the analysis
-      // in that case these files might have the same identifier
-      const String old_identifier = protein_ids[0].getIdentifier();
-      const String new_identifier = old_identifier + "_" + String(fraction_group) + "F" + String(fraction);
-      protein_ids[0].setIdentifier(new_identifier);
-      for (PeptideIdentification & p : peptide_ids)
+        OPENMS_LOG_WARN << "Peptide ID identifier found not present in the protein ID" << endl;
+      }
+    }
+
+    bool missing_spec_ref(false);
+    for (const PeptideIdentification & pid : peptide_ids)
+    {
+      if (!pid.metaValueExists("spectrum_reference") 
+        || pid.getMetaValue("spectrum_reference").toString().empty()) 
+      {          
+        missing_spec_ref = true;
+        break;
+      }
+    }
+    // reannotate spectrum references if missing
+    if (missing_spec_ref)
+    {
+      OPENMS_LOG_WARN << "Warning: The identification files don't contain a meta value with the spectrum native id.\n"
+                         "OpenMS will try to reannotate them by matching retention times between id and spectra." << endl;
+
+      SpectrumMetaDataLookup::addMissingSpectrumReferences(
+        peptide_ids, 
+        mz_file_abs_path,
+        true);
+    }
+
+    //-------------------------------------------------------------
+    // Internal Calibration of spectra peaks and precursor peaks with high-confidence IDs
+    //-------------------------------------------------------------
+    if (getStringOption_("mass_recalibration") == "true")
+    {
+      // the RANSAC parameters of MZTrafoModel are static (exceptions may not
+      // leave the critical section and are rethrown after it)
+      std::exception_ptr recalibration_error;
+#ifdef _OPENMP
+#pragma omp critical (ProteomicsLFQ_recalibration)
+#endif
       {
-        if (p.getIdentifier() == old_identifier)
+        try
         {
-          p.setIdentifier(new_identifier);
+          recalibrateMasses_(ms_centroided, peptide_ids, id_file_abs_path);
         }
-        else
+        catch (...)
         {
-          OPENMS_LOG_WARN << "Peptide ID identifier found not present in the protein ID" << endl;
+          recalibration_error = std::current_exception();
         }
       }
+      if (recalibration_error) { std::rethrow_exception(recalibration_error); }
+    }
 
-      bool missing_spec_ref(false);
-      for (const PeptideIdentification & pid : peptide_ids)
-      {
-        if (!pid.metaValueExists("spectrum_reference") 
-          || pid.getMetaValue("spectrum_reference").toString().empty()) 
-        {          
-          missing_spec_ref = true;
-          break;
-        }
-      }
-      // reannotate spectrum references if missing
-      if (missing_spec_ref)
-      {
-        OPENMS_LOG_WARN << "Warning: The identification files don't contain a meta value with the spectrum native id.\n"
-                           "OpenMS will try to reannotate them by matching retention times between id and spectra." << endl;
+    vector<ProteinIdentification> ext_protein_ids;
+    vector<PeptideIdentification> ext_peptide_ids;
 
-        SpectrumMetaDataLookup::addMissingSpectrumReferences(
-          peptide_ids, 
-          mz_file_abs_path,
-          true);
-      }
+    //////////////////////////////////////////////////////
+    // Transfer aligned IDs
+    //////////////////////////////////////////////////////
+    if (!transfered_ids.empty())
+    {
+      OPENMS_PRECONDITION(!transformations.empty(), "Data has not been aligned.")
+
+      // transform observed IDs and spectra
+      MapAlignmentTransformer::transformRetentionTimes(peptide_ids, transformations[fraction_group - 1]);
+      MapAlignmentTransformer::transformRetentionTimes(ms_centroided, transformations[fraction_group - 1]);
 
-      //-------------------------------------------------------------
-      // Internal Calibration of spectra peaks and precursor peaks with high-confidence IDs
-      //-------------------------------------------------------------
-      if (getStringOption_("mass_recalibration") == "true")
+      // copy the (already) aligned, consensus feature derived ids that are to be transferred to this map to peptide_ids
+      auto range = transfered_ids.equal_range(fraction_group - 1);
+      for (auto& it = range.first; it != range.second; ++it)
       {
-        recalibrateMasses_(ms_centroided, peptide_ids, id_file_abs_path);
+        peptide_ids.push_back(it->second);
       }
+    }
 
-      vector<ProteinIdentification> ext_protein_ids;
-      vector<PeptideIdentification> ext_peptide_ids;
+    //////////////////////////////////////////
+    // Chromatographic parameter estimation
+    //////////////////////////////////////////
+    median_fwhm = estimateMedianChromatographicFWHM_(ms_centroided);
 
-      //////////////////////////////////////////////////////
-      // Transfer aligned IDs
-      //////////////////////////////////////////////////////
-      if (!transfered_ids.empty())
-      {
-        OPENMS_PRECONDITION(is_already_aligned, "Data has not been aligned.")
+    //-------------------------------------------------------------
+    // Feature detection
+    //-------------------------------------------------------------   
+    ///////////////////////////////////////////////
 
-        // transform observed IDs and spectra
-        MapAlignmentTransformer::transformRetentionTimes(peptide_ids, transformations[fraction_group - 1]);
-        MapAlignmentTransformer::transformRetentionTimes(ms_centroided, transformations[fraction_group - 1]);
+    // Run MTD before FFM
 
-        // copy the (already) aligned, consensus feature derived ids that are to be transferred to this map to peptide_ids
-        auto range = transfered_ids.equal_range(fraction_group - 1);
-        for (auto& it = range.first; it != range.second; ++it)
-        {
-          peptide_ids.push_back(it->second);
-        }
+    // create empty feature map and annotate MS file
+    FeatureMap seeds;
+
+    StringList sl;
+    sl.push_back(mz_file);
+    seeds.setPrimaryMSRunPath(sl);
+
+    if (getStringOption_("targeted_only") == "false")
+    {
+      calculateSeeds_(ms_centroided, seeds, median_fwhm);
+      if (debug_level_ > 666)
+      {
+        FeatureXMLFile().store("debug_seeds_fraction_" + String(fraction) + "_" + String(fraction_group) + ".featureXML", seeds);
       }
+    }
 
-      //////////////////////////////////////////
-      // Chromatographic parameter estimation
-      //////////////////////////////////////////
-      median_fwhm = estimateMedianChromatographicFWHM_(ms_centroided);
+    /////////////////////////////////////////////////
+    // Run FeatureFinderIdentification
+
+    FeatureMap fm;
+    StringList feature_msfile_ref;
+    feature_msfile_ref.push_back(mz_file);
+    fm.setPrimaryMSRunPath(feature_msfile_ref);
+
+    FeatureFinderIdentificationAlgorithm ffi;
+    ffi.getMSData().swap(ms_centroided);
+    ffi.getProgressLogger().setLogType(log_type_);
+
+    Param ffi_param = getParam_().copy("PeptideQuantification:", true);
+    ffi_param.setValue("detect:peak_width", 5.0 * median_fwhm);
+    ffi.setParameters(ffi_param);
+    writeDebug_("Parameters passed to FeatureFinderIdentification algorithm", ffi_param, 3);
+
+    FeatureMap tmp = fm;
+    ffi.run(peptide_ids, 
+      protein_ids, 
+      ext_peptide_ids, 
+      ext_protein_ids, 
+      tmp,
+      seeds);
+
+    // TODO: consider moving this to FFid
+    // free parts of feature map not needed for further processing (e.g., subfeatures...)
+    for (auto & f : tmp)
+    {
+      //TODO keep FWHM meta value for QC
+      f.clearMetaInfo();
+      f.setSubordinates({});
+      f.setConvexHulls({});
+    }
+    feature_map.swap(tmp);
+    
+    if (debug_level_ > 666)
+    {
+      FeatureXMLFile().store("debug_fraction_" + String(fraction) + "_" + String(fraction_group) + ".featureXML", feature_map);
+    }
 
-      //-------------------------------------------------------------
-      // Feature detection
-      //-------------------------------------------------------------   
-      ///////////////////////////////////////////////
+    storeCheckpoint_(checkpoint, checkpoint_key, feature_map, median_fwhm, fixed_modifications, variable_modifications);
+    return EXECUTION_OK;
+  }
 
-      // Run MTD before FFM
+  ExitCodes quantifyFraction_(
+    const pair<unsigned int, std::vector<String> > & ms_files, 
+    const map<String, String>& mzfile2idfile, 
+    double median_fwhm,
+    const multimap<Size, PeptideIdentification> & transfered_ids,
+    ConsensusMap & consensus_fraction,
+    vector<TransformationDescription> & transformations,
+    double& max_alignment_diff,
+    set<String>& fixed_modifications,
+    set<String>& variable_modifications)
+  {
+    const Size fraction = ms_files.first;
 
-      // create empty feature map and annotate MS file
-      FeatureMap seeds;
+    const bool is_already_aligned = !transformations.empty();
 
-      StringList sl;
-      sl.push_back(mz_file);
-      seeds.setPrimaryMSRunPath(sl);
+    // debug output
+    writeDebug_("Processing fraction number: " + String(fraction) + "\nFiles: ",  1);
+    for (String const & mz_file : ms_files.second) { writeDebug_(mz_file,  1); }
 
-      if (getStringOption_("targeted_only") == "false")
-      {
-        calculateSeeds_(ms_centroided, seeds, median_fwhm);
-        if (debug_level_ > 666)
-        {
-          FeatureXMLFile().store("debug_seeds_fraction_" + String(ms_files.first) + "_" + String(fraction_group) + ".featureXML", seeds);
-        }
-      }
+    // for each MS file of current fraction: process up to parallel_files
+    // files at the same time (each one holds its raw data in memory)
+    const Size nr_files = ms_files.second.size();
+    vector<FeatureMap> feature_maps(nr_files);
+    vector<double> median_fwhms(nr_files, median_fwhm);
+    vector<ExitCodes> exit_codes(nr_files, EXECUTION_OK);
+    vector<set<String> > file_fixed_modifications(nr_files), file_variable_modifications(nr_files);
+
+    int nr_parallel_files = 1;
+#ifdef _OPENMP
+    nr_parallel_files = std::max(1, std::min(getIntOption_("parallel_files"), omp_get_max_threads()));
+#endif
+    const ProgressLogger::LogType log_type = log_type_;
+    if (nr_parallel_files > 1)
+    {
+      log_type_ = ProgressLogger::NONE; // progress of concurrently processed files would be interleaved
+    }
 
-      /////////////////////////////////////////////////
-      // Run FeatureFinderIdentification
-
-      FeatureMap fm;
-      StringList feature_msfile_ref;
-      feature_msfile_ref.push_back(mz_file);
-      fm.setPrimaryMSRunPath(feature_msfile_ref);
-
-      FeatureFinderIdentificationAlgorithm ffi;
-      ffi.getMSData().swap(ms_centroided);
-      ffi.getProgressLogger().setLogType(log_type_);
-
-      Param ffi_param = getParam_().copy("PeptideQuantification:", true);
-      ffi_param.setValue("detect:peak_width", 5.0 * median_fwhm);
-      ffi.setParameters(ffi_param);
-      writeDebug_("Parameters passed to FeatureFinderIdentification algorithm", ffi_param, 3);
-
-      FeatureMap tmp = fm;
-      ffi.run(peptide_ids, 
-        protein_ids, 
-        ext_peptide_ids, 
-        ext_protein_ids, 
-        tmp,
-        seeds);
-
-      // TODO: consider moving this to FFid
-      // free parts of feature map not needed for further processing (e.g., subfeatures...)
-      for (auto & f : tmp)
+    std::exception_ptr error;
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic, 1) num_threads(nr_parallel_files)
+#endif
+    for (SignedSize i = 0; i < (SignedSize)nr_files; ++i)
+    {
+      try
       {
-        //TODO keep FWHM meta value for QC
-        f.clearMetaInfo();
-        f.setSubordinates({});
-        f.setConvexHulls({});
+        exit_codes[i] = quantifyFile_(ms_files.second[i], fraction, i + 1,
+          mzfile2idfile, transfered_ids, transformations,
+          feature_maps[i], median_fwhms[i],
+          file_fixed_modifications[i], file_variable_modifications[i]);
       }
-      feature_maps.push_back(tmp);
-      
-      if (debug_level_ > 666)
+      catch (...)
       {
-        FeatureXMLFile().store("debug_fraction_" + String(ms_files.first) + "_" + String(fraction_group) + ".featureXML", feature_maps.back());
+#ifdef _OPENMP
+#pragma omp critical (ProteomicsLFQ_error)
+#endif
+        if (!error) error = std::current_exception();
       }
+    }
+    log_type_ = log_type;
 
-      ++fraction_group;
+    if (error) { std::rethrow_exception(error); }
+    for (ExitCodes e : exit_codes)
+    {
+      if (e != EXECUTION_OK) { return e; }
     }
+    for (Size i = 0; i != nr_files; ++i)
+    {
+      fixed_modifications.insert(file_fixed_modifications[i].begin(), file_fixed_modifications[i].end());
+      variable_modifications.insert(file_variable_modifications[i].begin(), file_variable_modifications[i].end());
+    }
+    // the chromatographic parameters of the last file are used for alignment and linking
+    if (nr_files > 0) { median_fwhm = median_fwhms.back(); }
 
     //-------------------------------------------------------------
     // Align all features of this fraction (if not already aligned)
@@ -1070,6 +1298,18 @@ protected:
         OPENMS_PRETTY_FUNCTION, "Number of id and spectra files don't match.");
     }
 
+    // checkpoints are written after feature detection - fail before any processing if that is impossible
+    String checkpoint_dir = getStringOption_("checkpoint_dir");
+    if (!checkpoint_dir.empty())
+    {
+      QDir().mkpath(checkpoint_dir.toQString());
+      if (!File::isDirectory(checkpoint_dir) || !File::writable(checkpoint_dir))
+      {
+        throw Exception::UnableToCreateFile(__FILE__, __LINE__, OPENMS_PRETTY_FUNCTION, checkpoint_dir,
+          "Checkpoint directory cannot be created or is not writable.");
+      }
+    }
+
     //-------------------------------------------------------------
     // Experimental design: read or generate default
     //-------------------------------------------------------------      
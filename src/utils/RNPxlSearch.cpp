@@ -296,6 +296,16 @@ protected:
     vector<FragmentAdductDefinition_> marker_ions;
   };
 
+  // precomputed information on a single precursor adduct, stored in the order of RNPxlModificationMassesResult::mod_masses
+  // (i.e. indexed by AnnotatedHit::rna_mod_index) and shared by all peptides and threads during the search
+  struct PrecursorAdductTableEntry_
+  {
+    String name; // precursor adduct (nucleotide formula, e.g. "UU-H2O", or "none")
+    double mass = 0.; // mass of the precursor adduct
+    const MS2AdductsOfSinglePrecursorAdduct* ms2_adducts = nullptr; // feasible fragment adducts and marker ions (not set for "none")
+    vector<PeakSpectrum> marker_ion_spectra; // marker ion spectrum used when scoring the i-th feasible cross-linked nucleotide
+  };
+
   // helper struct to facilitate parsing of parameters (modifications, nucleotide adducts, ...)
   struct RNPxlParameterParsing
   {
@@ -329,6 +339,11 @@ protected:
                                                           const NucleotideToFragmentAdductMap& nucleotide_to_fragment_adducts,
                                                           const set<char>& can_xl);
 
+    // @brief Precompute the adduct table used during the search (one entry per precursor adduct in @p precursor_adducts)
+    // The entries point into @p all_feasible_adducts, which has to outlive the table.
+    static vector<PrecursorAdductTableEntry_> getPrecursorAdductTable(const RNPxlModificationMassesResult& precursor_adducts,
+                                                                     const PrecursorsToMS2Adducts& all_feasible_adducts);
+
   };
 
   /// Slimmer structure as storing all scored candidates in PeptideHit objects takes too much space
@@ -1700,6 +1715,9 @@ protected:
     // calculate all feasible fragment adducts from all possible precursor adducts
     RNPxlParameterParsing::PrecursorsToMS2Adducts all_feasible_fragment_adducts = RNPxlParameterParsing::getAllFeasibleFragmentAdducts(mm, nucleotide_to_fragment_adducts, can_xl_);
 
+    // precompute names, fragment adducts and marker ion spectra of all precursor adducts once for the whole search
+    const vector<PrecursorAdductTableEntry_> precursor_adduct_table = RNPxlParameterParsing::getPrecursorAdductTable(mm, all_feasible_fragment_adducts);
+
     // calculate FDR
     FalseDiscoveryRate fdr;
     Param p = fdr.getParameters();
@@ -1893,13 +1911,16 @@ protected:
                        precursor_sub_score_spectrum,
                        marker_ions_sub_score_spectrum;
 
-          // iterate over all RNA sequences, calculate peptide mass and generate complete loss spectrum only once as this can potentially be reused
-          Size rna_mod_index = 0;
+          // unshifted fragment ladders used as templates for the partial loss spectra of all RNA adducts and nucleotides
+          PeakSpectrum partial_loss_template_z1, partial_loss_template_z2, partial_loss_template_z3;
+          bool partial_loss_templates_initialized = false;
 
+          // iterate over all RNA sequences, calculate peptide mass and generate complete loss spectrum only once as this can potentially be reused
           // TODO: track the XL-able nt here
-          for (std::map<String, double>::const_iterator rna_mod_it = mm.mod_masses.begin(); rna_mod_it != mm.mod_masses.end(); ++rna_mod_it, ++rna_mod_index)
+          for (Size rna_mod_index = 0; rna_mod_index != precursor_adduct_table.size(); ++rna_mod_index)
           {
-            const double precursor_rna_weight = rna_mod_it->second;
+            const PrecursorAdductTableEntry_& precursor_adduct = precursor_adduct_table[rna_mod_index];
+            const double precursor_rna_weight = precursor_adduct.mass;
             const double current_peptide_mass = current_peptide_mass_without_RNA + precursor_rna_weight; // add RNA mass
             // TODO: const char xl_nucleotide; // can be none
 
@@ -1939,14 +1960,11 @@ protected:
 
             if (!fast_scoring_)
             {
-              PeakSpectrum marker_ions_sub_score_spectrum_z1;
               //shifted_immonium_ions_sub_score_spectrum;
               PeakSpectrum partial_loss_spectrum_z1, partial_loss_spectrum_z2;
 
               // retrieve RNA adduct name
-              auto mod_combinations_it = mm.mod_combinations.begin();
-              std::advance(mod_combinations_it, rna_mod_index);
-              const String& precursor_rna_adduct = *mod_combinations_it->second.begin();
+              const String& precursor_rna_adduct = precursor_adduct.name;
 
               if (precursor_rna_adduct == "none")
               {
@@ -2030,17 +2048,19 @@ protected:
               }
               else  // score peptide with RNA adduct
               {
-                PeakSpectrum partial_loss_template_z1, partial_loss_template_z2, partial_loss_template_z3;
-                partial_loss_spectrum_generator.getSpectrum(partial_loss_template_z1, fixed_and_variable_modified_peptide, 1, 1);
-                partial_loss_spectrum_generator.getSpectrum(partial_loss_template_z2, fixed_and_variable_modified_peptide, 2, 2);
-                partial_loss_spectrum_generator.getSpectrum(partial_loss_template_z3, fixed_and_variable_modified_peptide, 3, 3);
+                // the unshifted ladders only depend on the peptide, so they are generated once and reused for all RNA adducts
+                // (use a flag: the templates may legitimately be empty, e.g. if all ion types are disabled)
+                if (!partial_loss_templates_initialized)
+                {
+                  partial_loss_spectrum_generator.getSpectrum(partial_loss_template_z1, fixed_and_variable_modified_peptide, 1, 1);
+                  partial_loss_spectrum_generator.getSpectrum(partial_loss_template_z2, fixed_and_variable_modified_peptide, 2, 2);
+                  partial_loss_spectrum_generator.getSpectrum(partial_loss_template_z3, fixed_and_variable_modified_peptide, 3, 3);
+                  partial_loss_templates_initialized = true;
+                }
 
                 // generate all partial loss spectra (excluding the complete loss spectrum) merged into one spectrum
                 // get RNA fragment shifts in the MS2 (based on the precursor RNA/DNA)
-                auto const & all_NA_adducts = all_feasible_fragment_adducts.at(precursor_rna_adduct);
-                const vector<NucleotideToFeasibleFragmentAdducts>& feasible_MS2_adducts = all_NA_adducts.feasible_adducts;
-                // get marker ions
-                const vector<FragmentAdductDefinition_>& marker_ions = all_NA_adducts.marker_ions;
+                const vector<NucleotideToFeasibleFragmentAdducts>& feasible_MS2_adducts = precursor_adduct.ms2_adducts->feasible_adducts;
 
                 //cout << "'" << precursor_rna_adduct << "'" << endl;
                 //OPENMS_POSTCONDITION(!feasible_MS2_adducts.empty(),
@@ -2051,8 +2071,9 @@ protected:
                 // If so, generate spectra for shifted ion series
 
                 // score individually for every nucleotide
-                for (auto const & nuc_2_adducts : feasible_MS2_adducts)
+                for (Size nuc_index = 0; nuc_index != feasible_MS2_adducts.size(); ++nuc_index)
                 {
+                  auto const & nuc_2_adducts = feasible_MS2_adducts[nuc_index];
                   const char& cross_linked_nucleotide = nuc_2_adducts.first;
                   const vector<FragmentAdductDefinition_>& partial_loss_modification = nuc_2_adducts.second;
 
@@ -2085,14 +2106,8 @@ protected:
                     for (auto& n : partial_loss_spectrum_z2.getStringDataArrays()[0]) { n[0] = 'y'; } // hyperscore hack
                   }
 
-                  // add shifted marker ions
-                  marker_ions_sub_score_spectrum_z1.getStringDataArrays().resize(1); // annotation
-                  marker_ions_sub_score_spectrum_z1.getIntegerDataArrays().resize(1); // annotation
-                  RNPxlFragmentIonGenerator::addMS2MarkerIons(
-                    marker_ions,
-                    marker_ions_sub_score_spectrum_z1,
-                    marker_ions_sub_score_spectrum_z1.getIntegerDataArrays()[0],
-                    marker_ions_sub_score_spectrum_z1.getStringDataArrays()[0]);
+                  // shifted marker ions (precomputed)
+                  const PeakSpectrum& marker_ions_sub_score_spectrum_z1 = precursor_adduct.marker_ion_spectra[nuc_index];
 
                   for (auto l = low_it; l != up_it; ++l) // OMS_CODING_TEST_EXCLUDE
                   {
@@ -2651,6 +2666,43 @@ RNPxlSearch::RNPxlParameterParsing::getTargetNucleotideToFragmentAdducts(StringL
   return nucleotide_to_fragment_adducts;
 }
 
+vector<RNPxlSearch::PrecursorAdductTableEntry_>
+RNPxlSearch::RNPxlParameterParsing::getPrecursorAdductTable(
+  const RNPxlModificationMassesResult &precursor_adducts,
+  const RNPxlSearch::RNPxlParameterParsing::PrecursorsToMS2Adducts &all_feasible_adducts)
+{
+  vector<PrecursorAdductTableEntry_> table;
+  table.reserve(precursor_adducts.mod_masses.size());
+
+  for (auto const & pa : precursor_adducts.mod_masses)
+  {
+    PrecursorAdductTableEntry_ entry;
+    entry.name = *precursor_adducts.mod_combinations.at(pa.first).begin();
+    entry.mass = pa.second;
+
+    if (entry.name != "none")
+    {
+      entry.ms2_adducts = &all_feasible_adducts.at(entry.name);
+
+      // the marker ions are added once for every scored nucleotide to the (growing) marker ion spectrum of a precursor adduct
+      PeakSpectrum marker_ions_sub_score_spectrum_z1;
+      marker_ions_sub_score_spectrum_z1.getStringDataArrays().resize(1); // annotation
+      marker_ions_sub_score_spectrum_z1.getIntegerDataArrays().resize(1); // charge
+      for (Size i = 0; i != entry.ms2_adducts->feasible_adducts.size(); ++i)
+      {
+        RNPxlFragmentIonGenerator::addMS2MarkerIons(
+          entry.ms2_adducts->marker_ions,
+          marker_ions_sub_score_spectrum_z1,
+          marker_ions_sub_score_spectrum_z1.getIntegerDataArrays()[0],
+          marker_ions_sub_score_spectrum_z1.getStringDataArrays()[0]);
+        entry.marker_ion_spectra.push_back(marker_ions_sub_score_spectrum_z1);
+      }
+    }
+    table.push_back(std::move(entry));
+  }
+  return table;
+}
+
 RNPxlSearch::MS2AdductsOfSinglePrecursorAdduct
 RNPxlSearch::RNPxlParameterParsing::getFeasibleFragmentAdducts(const String &exp_pc_adduct,
                                                                const String &exp_pc_formula,
@@ -2839,15 +2891,19 @@ void RNPxlSearch::RNPxlFragmentIonGenerator::addSpecialLysImmonumIons(
   PeakSpectrum::IntegerDataArray &spectrum_charge,
   PeakSpectrum::StringDataArray &spectrum_annotation)
 {
+  // the formulas are parsed only once, as these ions are added for every peptide and fragment adduct
+  static const double mono_weight_C5H10N1 = EmpiricalFormula("C5H10N1").getMonoWeight();
+  static const double mono_weight_C6H13N2O = EmpiricalFormula("C6H13N2O").getMonoWeight();
+
    if (unmodified_sequence.has('K'))
    {
-      const double immonium_ion2_mz = EmpiricalFormula("C5H10N1").getMonoWeight();
+      const double immonium_ion2_mz = mono_weight_C5H10N1;
       spectrum.emplace_back(immonium_ion2_mz, 1.0);
       spectrum_charge.emplace_back(1);
       spectrum_annotation.emplace_back(String("iK(C5H10N1)"));
 
       // usually only observed without shift (A. Stuetzer)
-      const double immonium_ion3_mz = EmpiricalFormula("C6H13N2O").getMonoWeight();
+      const double immonium_ion3_mz = mono_weight_C6H13N2O;
       spectrum.emplace_back(immonium_ion3_mz, 1.0);
       spectrum_charge.emplace_back(1);
       spectrum_annotation.emplace_back(String("iK(C6H13N2O)"));
@@ -2861,52 +2917,64 @@ void RNPxlSearch::RNPxlFragmentIonGenerator::addShiftedImmoniumIons(const String
                                                                     PeakSpectrum::IntegerDataArray &partial_loss_spectrum_charge,
                                                                     PeakSpectrum::StringDataArray &partial_loss_spectrum_annotation)
 {
+  // the formulas are parsed only once, as these ions are added for every peptide and fragment adduct
+  static const double mono_weight_C8H10NO = EmpiricalFormula("C8H10NO").getMonoWeight();
+  static const double mono_weight_C10H11N2 = EmpiricalFormula("C10H11N2").getMonoWeight();
+  static const double mono_weight_C8H10N = EmpiricalFormula("C8H10N").getMonoWeight();
+  static const double mono_weight_C5H8N3 = EmpiricalFormula("C5H8N3").getMonoWeight();
+  static const double mono_weight_C2H6NS = EmpiricalFormula("C2H6NS").getMonoWeight();
+  static const double mono_weight_C4H8N = EmpiricalFormula("C4H8N").getMonoWeight();
+  static const double mono_weight_C5H12N = EmpiricalFormula("C5H12N").getMonoWeight();
+  static const double mono_weight_C5H13N2 = EmpiricalFormula("C5H13N2").getMonoWeight();
+  static const double mono_weight_C5H10N1 = EmpiricalFormula("C5H10N1").getMonoWeight();
+  static const double mono_weight_C6H13N2O = EmpiricalFormula("C6H13N2O").getMonoWeight();
+
 
   if (unmodified_sequence.hasSubstring("Y"))
   {
-    const double immonium_ion_mz = EmpiricalFormula("C8H10NO").getMonoWeight() + fragment_shift_mass;
+    const double immonium_ion_mz = mono_weight_C8H10NO + fragment_shift_mass;
     partial_loss_spectrum.emplace_back(immonium_ion_mz, 1.0);
     partial_loss_spectrum_charge.emplace_back(1);
     partial_loss_spectrum_annotation.emplace_back(RNPxlFragmentAnnotationHelper::getAnnotatedImmoniumIon('Y', fragment_shift_name));
   }
   else if (unmodified_sequence.hasSubstring("W"))
   {
-    const double immonium_ion_mz = EmpiricalFormula("C10H11N2").getMonoWeight() + fragment_shift_mass;
+    const double immonium_ion_mz = mono_weight_C10H11N2 + fragment_shift_mass;
     partial_loss_spectrum.emplace_back(immonium_ion_mz, 1.0);
     partial_loss_spectrum_charge.emplace_back(1);
     partial_loss_spectrum_annotation.emplace_back(RNPxlFragmentAnnotationHelper::getAnnotatedImmoniumIon('W', fragment_shift_name));
   }
   else if (unmodified_sequence.hasSubstring("F"))
   {
-    const double immonium_ion_mz = EmpiricalFormula("C8H10N").getMonoWeight() + fragment_shift_mass;
+    const double immonium_ion_mz = mono_weight_C8H10N + fragment_shift_mass;
     partial_loss_spectrum.emplace_back(immonium_ion_mz, 1.0);
     partial_loss_spectrum_charge.emplace_back(1);
     partial_loss_spectrum_annotation.emplace_back(RNPxlFragmentAnnotationHelper::getAnnotatedImmoniumIon('F', fragment_shift_name));
   }
   else if (unmodified_sequence.hasSubstring("H"))
   {
-    const double immonium_ion_mz = EmpiricalFormula("C5H8N3").getMonoWeight() + fragment_shift_mass;
+    const double immonium_ion_mz = mono_weight_C5H8N3 + fragment_shift_mass;
     partial_loss_spectrum.emplace_back(immonium_ion_mz, 1.0);
     partial_loss_spectrum_charge.emplace_back(1);
     partial_loss_spectrum_annotation.emplace_back(RNPxlFragmentAnnotationHelper::getAnnotatedImmoniumIon('H', fragment_shift_name));
   }
   else if (unmodified_sequence.hasSubstring("C"))
   {
-    const double immonium_ion_mz = EmpiricalFormula("C2H6NS").getMonoWeight() + fragment_shift_mass;
+    const double immonium_ion_mz = mono_weight_C2H6NS + fragment_shift_mass;
     partial_loss_spectrum.emplace_back(immonium_ion_mz, 1.0);
     partial_loss_spectrum_charge.emplace_back(1);
     partial_loss_spectrum_annotation.emplace_back(RNPxlFragmentAnnotationHelper::getAnnotatedImmoniumIon('C', fragment_shift_name));
   }
   else if (unmodified_sequence.hasSubstring("P"))
   {
-    const double immonium_ion_mz = EmpiricalFormula("C4H8N").getMonoWeight() + fragment_shift_mass;
+    const double immonium_ion_mz = mono_weight_C4H8N + fragment_shift_mass;
     partial_loss_spectrum.emplace_back(immonium_ion_mz, 1.0);
     partial_loss_spectrum_charge.emplace_back(1);
     partial_loss_spectrum_annotation.emplace_back(RNPxlFragmentAnnotationHelper::getAnnotatedImmoniumIon('P', fragment_shift_name));
   }
   else if (unmodified_sequence.hasSubstring("L") || unmodified_sequence.hasSubstring("I"))
   {
-    const double immonium_ion_mz = EmpiricalFormula("C5H12N").getMonoWeight() + fragment_shift_mass;
+    const double immonium_ion_mz = mono_weight_C5H12N + fragment_shift_mass;
     partial_loss_spectrum.emplace_back(immonium_ion_mz, 1.0);
     partial_loss_spectrum_charge.emplace_back(1);
     partial_loss_spectrum_annotation.emplace_back(RNPxlFragmentAnnotationHelper::getAnnotatedImmoniumIon('L', fragment_shift_name));
@@ -2914,20 +2982,20 @@ void RNPxlSearch::RNPxlFragmentIonGenerator::addShiftedImmoniumIons(const String
   else if (unmodified_sequence.hasSubstring("K"))
   {
     // classical immonium ion
-    const double immonium_ion_mz = EmpiricalFormula("C5H13N2").getMonoWeight() + fragment_shift_mass;
+    const double immonium_ion_mz = mono_weight_C5H13N2 + fragment_shift_mass;
     partial_loss_spectrum.emplace_back(immonium_ion_mz, 1.0);
     partial_loss_spectrum_charge.emplace_back(1);
     partial_loss_spectrum_annotation.emplace_back(RNPxlFragmentAnnotationHelper::getAnnotatedImmoniumIon('K', fragment_shift_name));
 
     // TODO: check if only DNA specific and if also other shifts are observed
     // according to A. Stuetzer mainly observed with C‘-NH3 (94.0167 Da)
-    const double immonium_ion2_mz = EmpiricalFormula("C5H10N1").getMonoWeight()  + fragment_shift_mass;
+    const double immonium_ion2_mz = mono_weight_C5H10N1  + fragment_shift_mass;
     partial_loss_spectrum.emplace_back(immonium_ion2_mz, 1.0);
     partial_loss_spectrum_charge.emplace_back(1);
     partial_loss_spectrum_annotation.emplace_back(String("iK(C5H10N1)" + fragment_shift_name));
 
     // usually only observed without shift (A. Stuetzer)
-    const double immonium_ion3_mz = EmpiricalFormula("C6H13N2O").getMonoWeight()  + fragment_shift_mass;
+    const double immonium_ion3_mz = mono_weight_C6H13N2O  + fragment_shift_mass;
     partial_loss_spectrum.emplace_back(immonium_ion3_mz, 1.0);
     partial_loss_spectrum_charge.emplace_back(1);
     partial_loss_spectrum_annotation.emplace_back(String("iK(C6H13N2O)" + fragment_shift_name));